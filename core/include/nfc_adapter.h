@@ -109,6 +109,13 @@ nfc_adapter_peers(
     NfcAdapter* adapter) /* Since 1.1.0 */
     NFCD_EXPORT;
 
+NfcTag*
+nfc_adapter_add_tag_t1(
+    NfcAdapter* adapter,
+    NfcTarget* target,
+    const NfcParamPollA* poll_a) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
 NfcTag*
 nfc_adapter_add_tag_t2(
     NfcAdapter* adapter,
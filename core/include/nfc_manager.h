@@ -53,6 +53,8 @@ struct nfc_manager {
     /* Since 1.1.1 */
     NFC_LLCP_VERSION llcp_version;
     NfcPeerService* const* services;
+    /* Since 1.1.19 */
+    NFC_TAG_READ_POLICY tag_read_policy;
 };
 
 GType nfc_manager_get_type() NFCD_EXPORT;
@@ -140,6 +142,18 @@ nfc_manager_register_service(
     NfcPeerService* service) /* Since 1.1.0 */
     NFCD_EXPORT;
 
+/*
+ * Registers the service at the specified SAP, which must be in the
+ * range matching the service name and not taken by another service.
+ * Zero SAP means any, same as nfc_manager_register_service().
+ */
+gboolean
+nfc_manager_register_service2(
+    NfcManager* manager,
+    NfcPeerService* service,
+    guint8 sap) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
 void
 nfc_manager_unregister_service(
     NfcManager* manager,
@@ -240,6 +254,47 @@ nfc_manager_mode_request_free(
     NfcModeRequest* req) /* Since 1.1.0 */
     NFCD_EXPORT;
 
+/*
+ * Tag read policy defines what gets read at tag initialization time.
+ * The default one comes from the configuration, the most recent mode
+ * request which cares (i.e. has something other than DEFAULT) wins.
+ *
+ * Note that the policy is global, i.e. it applies to all tags and all
+ * clients, not just the owner of the request. Once the request is
+ * freed, the next most recent one (or the default) takes over. The
+ * new policy only affects tags discovered after the change. Type 2
+ * tags initialized with NFC_TAG_READ_NONE have no data area known,
+ * nfc_tag_t2_read_data() and friends fail for them.
+ */
+
+void
+nfc_manager_set_tag_read_policy(
+    NfcManager* manager,
+    NFC_TAG_READ_POLICY policy) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+NfcModeRequest*
+nfc_manager_mode_request_new2(
+    NfcManager* manager,
+    NFC_MODE enable,
+    NFC_MODE disable,
+    NFC_TAG_READ_POLICY read_policy) /* Since 1.1.19 */
+    G_GNUC_WARN_UNUSED_RESULT
+    NFCD_EXPORT;
+
+/*
+ * Tag filters are applied by the adapters to the tags discovered from
+ * now on. The list is copied, the caller retains the ownership of the
+ * filters. Setting an empty list turns the filtering off.
+ */
+
+void
+nfc_manager_set_tag_filters(
+    NfcManager* manager,
+    const NfcTagFilter* filters,
+    guint count) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
 G_END_DECLS
 
 #endif /* NFC_MANAGER_H */
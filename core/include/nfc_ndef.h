@@ -243,6 +243,83 @@ nfc_ndef_valid_mediatype(
     gboolean wildcard) /* Since 1.0.18 */
     NFCD_EXPORT;
 
+/*
+ * Templates (since 1.1.19)
+ *
+ * NDEF template is a pre-compiled NDEF Message TLV (as stored in the
+ * data area of a Type 2 tag), terminated by the Terminator TLV. Fixed
+ * width fields are located by their placeholders, e.g. a URI record
+ * created for "https://example.com/id/XXXXXXXX" and "XXXXXXXX" field,
+ * and patched in place. The range which differs from the baseline
+ * (what's believed to be on the tag) is tracked as fields are updated.
+ *
+ * The baseline is the tag's data area starting at offset zero. Lock
+ * Control, Memory Control and other TLVs found there ahead of the NDEF
+ * Message TLV are copied to the beginning of the image, so that the
+ * image and the offsets returned by nfc_ndef_template_diff() are
+ * relative to the beginning of the data area. Without the baseline,
+ * the image starts with the NDEF Message TLV, which is only correct
+ * for tags without control TLVs. Areas reserved by Memory Control
+ * TLVs after the NDEF Message TLV are not skipped, Type 2 tags reject
+ * such writes up front.
+ */
+
+typedef struct nfc_ndef_template NfcNdefTemplate;
+
+NfcNdefTemplate*
+nfc_ndef_template_new(
+    NfcNdefRec* rec) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+NfcNdefTemplate*
+nfc_ndef_template_ref(
+    NfcNdefTemplate* tmpl) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+void
+nfc_ndef_template_unref(
+    NfcNdefTemplate* tmpl) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+guint
+nfc_ndef_template_add_field(
+    NfcNdefTemplate* tmpl,
+    const void* placeholder,
+    guint size) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+gboolean
+nfc_ndef_template_set_field(
+    NfcNdefTemplate* tmpl,
+    guint field,
+    const void* value,
+    guint size) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+const GUtilData*
+nfc_ndef_template_data(
+    NfcNdefTemplate* tmpl) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+void
+nfc_ndef_template_set_baseline(
+    NfcNdefTemplate* tmpl,
+    const GUtilData* data) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+void
+nfc_ndef_template_commit(
+    NfcNdefTemplate* tmpl) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+gboolean
+nfc_ndef_template_diff(
+    NfcNdefTemplate* tmpl,
+    guint align,
+    guint* offset,
+    GUtilData* data) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
 /* These are not yet implemented: */
 
 typedef struct nfc_ndef_rec_hs NfcNdefRecHs;  /* Handover select */
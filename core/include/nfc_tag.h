@@ -88,6 +88,11 @@ nfc_tag_deactivate(
     NfcTag* tag)
     NFCD_EXPORT;
 
+guint
+nfc_tag_cache_size(
+    NfcTag* tag) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
 gulong
 nfc_tag_add_gone_handler(
     NfcTag* tag,
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef NFC_TAG_T1_H
+#define NFC_TAG_T1_H
+
+#include "nfc_tag.h"
+
+/* Type 1 tag (Topaz) */
+
+G_BEGIN_DECLS
+
+typedef struct nfc_tag_t1_priv NfcTagType1Priv;
+
+typedef enum nfc_tag_t1_flags {
+    NFC_TAG_T1_FLAGS_NONE = 0x00,
+    NFC_TAG_T1_FLAG_NFC_FORUM_COMPATIBLE = 0x01,
+    NFC_TAG_T1_FLAG_DYNAMIC_MEMORY = 0x02
+} NFC_TAG_T1_FLAGS;
+
+struct nfc_tag_t1 {
+    NfcTag tag;
+    NfcTagType1Priv* priv;
+    GUtilData uid;      /* UID0..UID3 */
+    guint8 hr0;         /* Header ROM, valid only when initialized */
+    guint8 hr1;
+    NFC_TAG_T1_FLAGS t1flags;
+    guint data_size;    /* Valid only when initialized */
+};
+
+GType nfc_tag_t1_get_type(void) NFCD_EXPORT; /* Since 1.1.19 */
+#define NFC_TYPE_TAG_T1 (nfc_tag_t1_get_type())
+#define NFC_TAG_T1(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), \
+        NFC_TYPE_TAG_T1, NfcTagType1))
+#define NFC_IS_TAG_T1(obj) G_TYPE_CHECK_INSTANCE_TYPE(obj, \
+        NFC_TYPE_TAG_T1)
+
+/*
+ * Static memory tags are read with a single RALL. Dynamic memory tags
+ * are read with RALL followed by RSEG (or READ8, if only one more block
+ * is needed) until the TLV sequence is complete. The data area excludes
+ * UID, CC, lock and reserved bytes, including the ones declared by Lock
+ * Control and Memory Control TLVs.
+ *
+ * Only the cached part of the data area can be read synchronously.
+ */
+
+typedef enum nfc_tag_t1_io_status {
+    NFC_TAG_T1_IO_STATUS_OK,          /* Data copied */
+    NFC_TAG_T1_IO_STATUS_FAILURE,     /* Unspecified failure */
+    NFC_TAG_T1_IO_STATUS_BAD_SIZE,    /* Range is outside of the data area */
+    NFC_TAG_T1_IO_STATUS_NOT_CACHED   /* Requested region is not cached */
+} NFC_TAG_T1_IO_STATUS;
+
+NFC_TAG_T1_IO_STATUS
+nfc_tag_t1_read_data_sync(
+    NfcTagType1* tag,
+    guint offset,
+    guint nbytes,
+    void* buffer) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+G_END_DECLS
+
+#endif /* NFC_TAG_T1_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
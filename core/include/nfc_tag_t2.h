@@ -130,9 +130,27 @@ typedef enum nfc_tag_t2_io_status {
     NFC_TAG_T2_IO_STATUS_IO_ERROR,    /* Transmission error of CRC mismatch */
     NFC_TAG_T2_IO_STATUS_BAD_BLOCK,   /* Invalid start block */
     NFC_TAG_T2_IO_STATUS_BAD_SIZE,    /* Too much data requested */
-    NFC_TAG_T2_IO_STATUS_NOT_CACHED   /* Requested region is not cached */
+    NFC_TAG_T2_IO_STATUS_NOT_CACHED,  /* Requested region is not cached */
+    NFC_TAG_T2_IO_STATUS_VERIFY_FAILED /* Read back data mismatch */
 } NFC_TAG_T2_IO_STATUS;
 
+/*
+ * With NFC_TAG_T2_WRITE_FLAG_VERIFY the written range is read back
+ * (one READ per 4 blocks) within the same sequence and compared with
+ * what was written. The sector cache gets updated with what the tag
+ * actually holds. On mismatch, the completion callback receives
+ * NFC_TAG_T2_IO_STATUS_VERIFY_FAILED and the number of bytes which
+ * have been successfully verified. The same happens if the data can't
+ * be read back. Verification only starts after the whole range has
+ * been written, so VERIFY_FAILED always means that all the requested
+ * bytes have been sent to the tag.
+ */
+
+typedef enum nfc_tag_t2_write_flags {
+    NFC_TAG_T2_WRITE_FLAGS_NONE = 0x00,
+    NFC_TAG_T2_WRITE_FLAG_VERIFY = 0x01
+} NFC_TAG_T2_WRITE_FLAGS; /* Since 1.1.19 */
+
 typedef
 void
 (*NfcTagType2ReadDataFunc)(
@@ -200,6 +218,76 @@ nfc_tag_t2_write_data_seq(
     void* user_data) /* Since 1.0.17 */
     NFCD_EXPORT;
 
+guint
+nfc_tag_t2_write_data_seq2(
+    NfcTagType2* tag,
+    guint offset,
+    GBytes* bytes,
+    NfcTargetSequence* seq,
+    NFC_TAG_T2_WRITE_FLAGS flags,
+    NfcTagType2WriteDataFunc complete,
+    GDestroyNotify destroy,
+    void* user_data) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+/*
+ * Transactional write of the TLV area (data offset zero), which must
+ * contain an NDEF Message TLV. The tag remains valid at every point:
+ * NDEF length is zeroed first, then the changed blocks are written in
+ * ascending order, and the block containing the NDEF length goes last.
+ * Progress is journaled per UID. If the tag leaves mid-way, writing
+ * the same TLV data on the next tap only writes the remaining blocks.
+ * nfc_tag_t2_write_tlv_pending() tells whether the tag has got an
+ * unfinished transaction.
+ */
+
+guint
+nfc_tag_t2_write_tlv_seq(
+    NfcTagType2* tag,
+    GBytes* tlv,
+    NfcTargetSequence* seq,
+    NfcTagType2WriteDataFunc complete,
+    GDestroyNotify destroy,
+    void* user_data) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+gboolean
+nfc_tag_t2_write_tlv_pending(
+    NfcTagType2* tag) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+/*
+ * Static lock bits, read-only CC and the areas reserved by Lock Control
+ * and Memory Control TLVs are parsed at initialization. Data writes
+ * touching such blocks are rejected up front (write methods return zero)
+ * rather than failing on the tag after partial success.
+ *
+ * Dynamic lock bits are only known at initialization if they happen to
+ * be cached. Otherwise they are fetched by the first data write, within
+ * its sequence. If the write turns out to be touching locked blocks,
+ * it completes with NFC_TAG_T2_IO_STATUS_FAILURE without writing
+ * anything. Until then, nfc_tag_t2_data_locked() doesn't know about
+ * the dynamic lock bits.
+ */
+
+gboolean
+nfc_tag_t2_data_locked(
+    NfcTagType2* tag,
+    guint offset,
+    guint nbytes) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+/*
+ * The sector cache is allocated in 64-byte pages as the data is being
+ * read. This returns the number of bytes currently held by the cache,
+ * same as nfc_tag_cache_size() does.
+ */
+
+guint
+nfc_tag_t2_cache_size(
+    NfcTagType2* tag) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
 G_END_DECLS
 
 #endif /* NFC_TAG_T2_H */
@@ -71,6 +71,13 @@ void
     NfcTarget* target,
     void* user_data);
 
+typedef
+void
+(*NfcTargetSequenceFunc)(
+    NfcTarget* target,
+    NfcTargetSequence* seq,
+    void* user_data); /* Since 1.1.19 */
+
 typedef
 void
 (*NfcTargetTransmitFunc)(
@@ -130,11 +137,16 @@ nfc_target_remove_handlers(
  * That's done by allocating and holding a reference to NfcTargetSequence
  * object. As long as NfcTargetSequence is alive, NfcTarget will only
  * perform transmissions associated with this sequence.
+ *
+ * INTERACTIVE and BACKGROUND flags (since 1.1.19) define the default
+ * priority class of the requests associated with the sequence.
  */
 
 typedef enum nfc_sequence_flags {
     NFC_SEQUENCE_FLAGS_NONE = 0x00,
-    NFC_SEQUENCE_FLAG_ALLOW_PRESENCE_CHECK = 0x01
+    NFC_SEQUENCE_FLAG_ALLOW_PRESENCE_CHECK = 0x01,
+    NFC_SEQUENCE_FLAG_INTERACTIVE = 0x02,
+    NFC_SEQUENCE_FLAG_BACKGROUND = 0x04
 } NFC_SEQUENCE_FLAGS; /* Since 1.1.4 */
 
 NfcTargetSequence*
@@ -158,6 +170,39 @@ nfc_target_sequence_flags(
     NfcTargetSequence* seq) /* Since 1.1.4 */
     NFCD_EXPORT;
 
+/*
+ * Sequence lease (since 1.1.19) limits the time a sequence can block
+ * everyone else. The lease expires if the sequence stays idle (has no
+ * transmissions in progress) for longer than max_idle_ms or remains
+ * current for longer than max_hold_ms (zero means no limit). The lease
+ * expiration is signaled, then the sequence yields to whoever else is
+ * waiting, as soon as its current transmission (if any) completes. Its
+ * requests remain queued, and it becomes current again when its turn
+ * comes, with a fresh lease.
+ *
+ * nfc_target_sequence_renew() restarts the lease of the current sequence.
+ * Expired lease can only be renewed if nobody else is waiting.
+ */
+
+void
+nfc_target_sequence_set_lease(
+    NfcTargetSequence* seq,
+    guint max_idle_ms,
+    guint max_hold_ms) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+gboolean
+nfc_target_sequence_renew(
+    NfcTargetSequence* seq) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
+gulong
+nfc_target_add_lease_expired_handler(
+    NfcTarget* target,
+    NfcTargetSequenceFunc func,
+    void* user_data) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
 /*
  * These functions can be used for sending internal requests (e.g. presence
  * check) to take advantage of queueing provided by NfcTarget:
@@ -174,6 +219,41 @@ nfc_target_transmit(
     void* user_data)
     NFCD_EXPORT;
 
+/*
+ * Queued requests are served in the order of their priority class,
+ * then earliest deadline first (requests without deadline go after
+ * those with one), then in the order of submission. That only applies
+ * to the requests which are allowed to run, i.e. sequence constraints
+ * still apply. Requests belonging to the same sequence are always served
+ * in the order of submission, priority classes and deadlines only pick
+ * between sequences. Background requests with expired deadline are dropped
+ * (completed with NFC_TRANSMIT_STATUS_TIMEOUT) without being sent.
+ *
+ * NFC_TARGET_PRIORITY_DEFAULT means the priority of the sequence, or
+ * NFC_TARGET_PRIORITY_NORMAL if there's no sequence. Zero deadline_ms
+ * means no deadline.
+ */
+
+typedef enum nfc_target_priority {
+    NFC_TARGET_PRIORITY_DEFAULT,
+    NFC_TARGET_PRIORITY_INTERACTIVE,
+    NFC_TARGET_PRIORITY_NORMAL,
+    NFC_TARGET_PRIORITY_BACKGROUND
+} NFC_TARGET_PRIORITY; /* Since 1.1.19 */
+
+guint
+nfc_target_transmit2(
+    NfcTarget* target,
+    const void* data,
+    guint len,
+    NfcTargetSequence* seq,
+    NFC_TARGET_PRIORITY priority,
+    guint deadline_ms,
+    NfcTargetTransmitFunc complete,
+    GDestroyNotify destroy,
+    void* user_data) /* Since 1.1.19 */
+    NFCD_EXPORT;
+
 gboolean
 nfc_target_cancel_transmit(
     NfcTarget* target,
@@ -56,6 +56,7 @@ typedef struct nfc_peer NfcPeer;         /* Since 1.1.0 */
 typedef struct nfc_plugin NfcPlugin;
 typedef struct nfc_plugin_desc NfcPluginDesc;
 typedef struct nfc_tag NfcTag;
+typedef struct nfc_tag_t1 NfcTagType1;   /* Since 1.1.19 */
 typedef struct nfc_tag_t2 NfcTagType2;
 typedef struct nfc_tag_t4 NfcTagType4;   /* Since 1.0.20 */
 typedef struct nfc_tag_t4a NfcTagType4a; /* Since 1.0.20 */
@@ -89,6 +90,14 @@ typedef enum nfc_mode {
 #define NFC_MODES_ALL (NFC_MODE_P2P_INITIATOR | NFC_MODE_P2P_TARGET | \
     NFC_MODE_READER_WRITER | NFC_MODE_CARD_EMULATION)
 
+/* What gets read at tag initialization time (since 1.1.19) */
+typedef enum nfc_tag_read_policy {
+    NFC_TAG_READ_DEFAULT,   /* Don't care (mode requests only) */
+    NFC_TAG_READ_NONE,      /* Nothing, tag is initialized right away */
+    NFC_TAG_READ_NDEF,      /* NDEF (the default) */
+    NFC_TAG_READ_FULL       /* Entire tag image */
+} NFC_TAG_READ_POLICY;
+
 typedef enum nfc_technology {
     NFC_TECHNOLOGY_UNKNOWN = 0x00,
     NFC_TECHNOLOGY_A = 0x01,       /* NFC-A */
@@ -171,6 +180,27 @@ typedef union nfc_param_poll {
     NfcParamPollF f;
 } NfcParamPoll; /* Since 1.0.33 */
 
+/*
+ * Tag filters (since 1.1.19) are evaluated before the tag object is
+ * created, using nothing but the poll parameters. The first matching
+ * filter decides what happens to the tag. Tags not matching any filter
+ * are accepted.
+ */
+typedef enum nfc_tag_filter_action {
+    NFC_TAG_FILTER_ACCEPT,  /* Tag is created and announced as usual */
+    NFC_TAG_FILTER_STUB,    /* Generic tag, nothing read or announced */
+    NFC_TAG_FILTER_SKIP     /* No tag at all */
+} NFC_TAG_FILTER_ACTION;
+
+typedef struct nfc_tag_filter {
+    NFC_TAG_FILTER_ACTION action;
+    NFC_TECHNOLOGY technology;  /* Mask, zero matches any */
+    NFC_PROTOCOL protocol;      /* Mask, zero matches any */
+    GUtilData uid_prefix;       /* NFCID1, NFCID0 or NFCID2 */
+    guint8 sel_res;             /* NFC-A SAK (after applying the mask) */
+    guint8 sel_res_mask;        /* Zero matches any */
+} NfcTagFilter;
+
 /* Mark functions exported to plugins as weak */
 #ifndef NFCD_EXPORT
 #  define NFCD_EXPORT __attribute__((weak))
@@ -59,6 +59,7 @@ struct nfc_adapter_priv {
     char* name;
     NfcPeerServices* services;
     GHashTable* tag_table;
+    GHashTable* stub_table;
     GHashTable* peer_table;
     NfcPeer** peers;
     guint next_tag_index;
@@ -68,6 +69,8 @@ struct nfc_adapter_priv {
     gboolean mode_pending;
     gboolean power_submitted;
     gboolean power_pending;
+    NFC_TAG_READ_POLICY tag_read_policy;
+    NfcTagFilters* tag_filters;
 };
 
 #define THIS(obj) NFC_ADAPTER(obj)
@@ -245,6 +248,13 @@ nfc_adapter_update_presence(
         present = ((NfcAdapterTagEntry*)value)->tag->present;
     }
 
+    if (!present) {
+        g_hash_table_iter_init(&it, priv->stub_table);
+        while (g_hash_table_iter_next(&it, NULL, &value) && !present) {
+            present = ((NfcAdapterTagEntry*)value)->tag->present;
+        }
+    }
+
     if (!present) {
         g_hash_table_iter_init(&it, priv->peer_table);
         while (g_hash_table_iter_next(&it, NULL, &value) && !present) {
@@ -399,6 +409,108 @@ nfc_adapter_add_tag(
     }
 }
 
+static
+void
+nfc_adapter_stub_gone(
+    NfcTag* tag,
+    void* adapter)
+{
+    NfcAdapter* self = THIS(adapter);
+
+    g_hash_table_remove(self->priv->stub_table, tag);
+    nfc_adapter_update_presence(self);
+    nfc_adapter_emit_pending_signals(self);
+}
+
+static
+NfcTag*
+nfc_adapter_add_stub(
+    NfcAdapter* self,
+    NfcTarget* target,
+    const NfcParamPoll* poll)
+{
+    NfcTag* tag = nfc_tag_new(target, poll);
+
+    /*
+     * Stubs keep the target (and therefore the adapter) busy while
+     * it's in the field but they have no name, aren't in the tag list
+     * and nobody gets notified about them.
+     */
+    if (tag && tag->present) {
+        NfcAdapterPriv* priv = self->priv;
+        NfcAdapterTagEntry* entry = g_slice_new(NfcAdapterTagEntry);
+
+        entry->tag = tag;
+        entry->gone_id = nfc_tag_add_gone_handler(tag, nfc_adapter_stub_gone,
+            self);
+        g_hash_table_insert(priv->stub_table, tag, entry);
+        nfc_tag_set_initialized(tag);
+        nfc_adapter_update_presence(self);
+        nfc_adapter_emit_pending_signals(self);
+        return tag;
+    } else {
+        nfc_tag_unref(tag);
+        return NULL;
+    }
+}
+
+static
+const NfcParamPoll*
+nfc_adapter_poll_a(
+    NfcParamPoll* poll,
+    const NfcParamPollA* poll_a)
+{
+    if (poll_a) {
+        memset(poll, 0, sizeof(*poll));
+        poll->a = *poll_a;
+        return poll;
+    }
+    return NULL;
+}
+
+static
+const NfcParamPoll*
+nfc_adapter_poll_b(
+    NfcParamPoll* poll,
+    const NfcParamPollB* poll_b)
+{
+    if (poll_b) {
+        memset(poll, 0, sizeof(*poll));
+        poll->b = *poll_b;
+        return poll;
+    }
+    return NULL;
+}
+
+static
+gboolean
+nfc_adapter_filter_tag(
+    NfcAdapter* self,
+    NfcTarget* target,
+    const NfcParamPoll* poll,
+    NfcTag** stub)
+{
+    NfcAdapterPriv* priv = self->priv;
+
+    /* Returns TRUE if the tag has been filtered out */
+    if (priv->tag_filters && target) {
+        switch (nfc_tag_filters_check(priv->tag_filters, target->technology,
+            target->protocol, poll)) {
+        case NFC_TAG_FILTER_STUB:
+            GDEBUG("Tag filtered out, creating a stub");
+            *stub = nfc_adapter_add_stub(self, target, poll);
+            return TRUE;
+        case NFC_TAG_FILTER_SKIP:
+            GDEBUG("Tag filtered out, skipping it");
+            *stub = NULL;
+            return TRUE;
+        case NFC_TAG_FILTER_ACCEPT:
+            break;
+        }
+    }
+    return FALSE;
+}
+
 static
 void
 nfc_adapter_peer_free(
@@ -572,6 +684,29 @@ nfc_adapter_peers(
     return G_LIKELY(self) ? self->priv->peers : NULL;
 }
 
+NfcTag*
+nfc_adapter_add_tag_t1(
+    NfcAdapter* self,
+    NfcTarget* target,
+    const NfcParamPollA* poll_a) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self) && G_LIKELY(target)) {
+        NfcParamPoll poll;
+        NfcTagType1* t1;
+        NfcTag* stub;
+
+        if (nfc_adapter_filter_tag(self, target,
+            nfc_adapter_poll_a(&poll, poll_a), &stub)) {
+            return stub;
+        }
+        t1 = nfc_tag_t1_new(target, poll_a, self->priv->tag_read_policy);
+        if (t1) {
+            return nfc_adapter_add_tag(self, NFC_TAG(t1));
+        }
+    }
+    return NULL;
+}
+
 NfcTag*
 nfc_adapter_add_tag_t2(
     NfcAdapter* self,
@@ -579,8 +714,15 @@ nfc_adapter_add_tag_t2(
     const NfcTagParamT2* params)
 {
     if (G_LIKELY(self)) {
-        NfcTagType2* t2 = nfc_tag_t2_new(target, params);
+        NfcParamPoll poll;
+        NfcTagType2* t2;
+        NfcTag* stub;
 
+        if (nfc_adapter_filter_tag(self, target,
+            nfc_adapter_poll_a(&poll, params), &stub)) {
+            return stub;
+        }
+        t2 = nfc_tag_t2_new2(target, params, self->priv->tag_read_policy);
         if (t2) {
             return nfc_adapter_add_tag(self, NFC_TAG(t2));
         }
@@ -596,8 +738,16 @@ nfc_adapter_add_tag_t4a(
     const NfcParamIsoDepPollA* iso_dep_param) /* Since 1.0.20 */
 {
     if (G_LIKELY(self) && G_LIKELY(target)) {
-        NfcTagType4a* t4a = nfc_tag_t4a_new(target, tech_param, iso_dep_param);
+        NfcParamPoll poll;
+        NfcTagType4a* t4a;
+        NfcTag* stub;
 
+        if (nfc_adapter_filter_tag(self, target,
+            nfc_adapter_poll_a(&poll, tech_param), &stub)) {
+            return stub;
+        }
+        t4a = nfc_tag_t4a_new2(target, tech_param, iso_dep_param,
+            self->priv->tag_read_policy);
         if (t4a) {
             return nfc_adapter_add_tag(self, NFC_TAG(t4a));
         }
@@ -613,8 +763,16 @@ nfc_adapter_add_tag_t4b(
     const NfcParamIsoDepPollB* iso_dep_param) /* Since 1.0.20 */
 {
     if (G_LIKELY(self) && G_LIKELY(target)) {
-        NfcTagType4b* t4b = nfc_tag_t4b_new(target, tech_param, iso_dep_param);
+        NfcParamPoll poll;
+        NfcTagType4b* t4b;
+        NfcTag* stub;
 
+        if (nfc_adapter_filter_tag(self, target,
+            nfc_adapter_poll_b(&poll, tech_param), &stub)) {
+            return stub;
+        }
+        t4b = nfc_tag_t4b_new2(target, tech_param, iso_dep_param,
+            self->priv->tag_read_policy);
         if (t4b) {
             return nfc_adapter_add_tag(self, NFC_TAG(t4b));
         }
@@ -637,8 +795,12 @@ nfc_adapter_add_other_tag2(
     const NfcParamPoll* poll) /* Since 1.0.33 */
 {
     if (G_LIKELY(self)) {
-        NfcTag* tag = nfc_tag_new(target, poll);
+        NfcTag* tag;
 
+        if (nfc_adapter_filter_tag(self, target, poll, &tag)) {
+            return tag;
+        }
+        tag = nfc_tag_new(target, poll);
         if (tag) {
             return nfc_adapter_add_tag(self, tag);
         }
@@ -886,6 +1048,31 @@ nfc_adapter_set_services(
     }
 }
 
+void
+nfc_adapter_set_tag_read_policy(
+    NfcAdapter* self,
+    NFC_TAG_READ_POLICY policy)
+{
+    if (G_LIKELY(self)) {
+        /* Applies to the tags discovered from now on */
+        self->priv->tag_read_policy = policy;
+    }
+}
+
+void
+nfc_adapter_set_tag_filters(
+    NfcAdapter* self,
+    NfcTagFilters* filters)
+{
+    if (G_LIKELY(self)) {
+        NfcAdapterPriv* priv = self->priv;
+
+        /* Applies to the tags discovered from now on */
+        nfc_tag_filters_unref(priv->tag_filters);
+        priv->tag_filters = nfc_tag_filters_ref(filters);
+    }
+}
+
 void
 nfc_adapter_mode_notify(
     NfcAdapter* self,
@@ -996,8 +1183,11 @@ nfc_adapter_init(
     priv->peers = g_new0(NfcPeer*, 1);
     priv->tag_table = g_hash_table_new_full(g_str_hash, g_str_equal,
         g_free, nfc_adapter_tag_free);
+    priv->stub_table = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+        NULL, nfc_adapter_tag_free);
     priv->peer_table = g_hash_table_new_full(g_str_hash, g_str_equal,
         g_free, nfc_adapter_peer_free);
+    priv->tag_read_policy = NFC_TAG_READ_NDEF;
 }
 
 static
@@ -1018,6 +1208,7 @@ nfc_adapter_dispose(
         c->cancel_power_request(self);
     }
     g_hash_table_remove_all(priv->tag_table);
+    g_hash_table_remove_all(priv->stub_table);
     G_OBJECT_CLASS(PARENT_CLASS)->dispose(object);
 }
 
@@ -1031,7 +1222,9 @@ nfc_adapter_finalize(
 
     nfc_peer_services_unref(priv->services);
     g_hash_table_destroy(priv->tag_table);
+    g_hash_table_destroy(priv->stub_table);
     g_hash_table_destroy(priv->peer_table);
+    nfc_tag_filters_unref(priv->tag_filters);
     g_free(priv->peers);
     g_free(self->tags);
     g_free(priv->name);
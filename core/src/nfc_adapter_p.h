@@ -34,6 +34,7 @@
 #define NFC_ADAPTER_PRIVATE_H
 
 #include "nfc_types_p.h"
+#include "nfc_tag_filter.h"
 
 #include <nfc_adapter.h>
 
@@ -54,6 +55,18 @@ nfc_adapter_set_services(
     NfcPeerServices* services)
     NFCD_INTERNAL;
 
+void
+nfc_adapter_set_tag_read_policy(
+    NfcAdapter* adapter,
+    NFC_TAG_READ_POLICY policy)
+    NFCD_INTERNAL;
+
+void
+nfc_adapter_set_tag_filters(
+    NfcAdapter* adapter,
+    NfcTagFilters* filters)
+    NFCD_INTERNAL;
+
 #endif /* NFC_ADAPTER_PRIVATE_H */
 
 /*
@@ -309,6 +309,52 @@ nfc_llc_dequeue_pdu(
     return NULL;
 }
 
+static
+guint
+nfc_llc_apply_param(
+    NfcLlcObject* self,
+    const NfcLlcParam* param)
+{
+    const NfcLlcParamValue* value = &param->value;
+    NfcLlc* llc = &self->pub;
+    guint mask = 0;
+
+    switch (param->type) {
+    case NFC_LLC_PARAM_VERSION:
+        if (self->version != value->version) {
+            self->version = value->version;
+            mask |= (1 << param->type);
+        }
+        GDEBUG("  Version: %u.%u", self->version >> 4,
+            self->version & 0x0f);
+        break;
+    case NFC_LLC_PARAM_MIUX:
+        if (self->miu != value->miu) {
+            self->miu = value->miu;
+            mask |= (1 << param->type);
+        }
+        GDEBUG("  MIU: %u bytes", self->miu);
+        break;
+    case NFC_LLC_PARAM_WKS:
+        if (llc->wks != value->wks) {
+            llc->wks = value->wks;
+            mask |= (1 << param->type);
+        }
+        GDEBUG("  WKS: 0x%04x", llc->wks);
+        break;
+    case NFC_LLC_PARAM_LTO:
+        if (self->lto != value->lto) {
+            self->lto = value->lto;
+            mask |= (1 << param->type);
+        }
+        GDEBUG("  Link Timeout: %u ms", self->lto);
+        break;
+    default:
+        break;
+    }
+    return mask;
+}
+
 static
 guint
 nfc_llc_apply_params(
@@ -318,51 +364,33 @@ nfc_llc_apply_params(
     guint mask = 0;
 
     if (params) {
-        NfcLlc* llc = &self->pub;
         const NfcLlcParam* const* ptr = params;
 
         while (*ptr) {
-            const NfcLlcParam* param = *ptr++;
-            const NfcLlcParamValue* value = &param->value;
-
-            switch (param->type) {
-            case NFC_LLC_PARAM_VERSION:
-                if (self->version != value->version) {
-                    self->version = value->version;
-                    mask |= (1 << param->type);
-                }
-                GDEBUG("  Version: %u.%u", self->version >> 4,
-                    self->version & 0x0f);
-                break;
-            case NFC_LLC_PARAM_MIUX:
-                if (self->miu != value->miu) {
-                    self->miu = value->miu;
-                    mask |= (1 << param->type);
-                }
-                GDEBUG("  MIU: %u bytes", self->miu);
-                break;
-            case NFC_LLC_PARAM_WKS:
-                if (llc->wks != value->wks) {
-                    llc->wks = value->wks;
-                    mask |= (1 << param->type);
-                }
-                GDEBUG("  WKS: 0x%04x", llc->wks);
-                break;
-            case NFC_LLC_PARAM_LTO:
-                if (self->lto != value->lto) {
-                    self->lto = value->lto;
-                    mask |= (1 << param->type);
-                }
-                GDEBUG("  Link Timeout: %u ms", self->lto);
-                break;
-            default:
-                break;
-            }
+            mask |= nfc_llc_apply_param(self, *ptr++);
         }
     }
     return mask;
 }
 
+static
+guint
+nfc_llc_apply_tlvs(
+    NfcLlcObject* self,
+    const void* tlvs,
+    guint size)
+{
+    const NfcLlcParam* param;
+    NfcLlcParamIter iter;
+    guint mask = 0;
+
+    nfc_llc_param_iter_init(&iter, tlvs, size);
+    while ((param = nfc_llc_param_iter_next(&iter)) != NULL) {
+        mask |= nfc_llc_apply_param(self, param);
+    }
+    return mask;
+}
+
 static
 GByteArray*
 nfc_llc_pdu_new(
@@ -467,7 +495,7 @@ nfc_llc_submit_next_connect(
         if (conn->name) {
             NfcLlcParam sn;
             const guint n = nfc_llc_param_count(lp);
-            const NfcLlcParam** params = g_new(const NfcLlcParam*, n + 2);
+            const NfcLlcParam** params = g_newa(const NfcLlcParam*, n + 2);
             guint i;
 
             /* Add SN parameter */
@@ -482,7 +510,6 @@ nfc_llc_submit_next_connect(
 
             /* Submit CONNECT */
             nfc_llc_submit_connect(self, NFC_LLC_SAP_SDP, lsap, params);
-            g_free(params);
         } else {
             /* CONNECT to the particular SAP */
             nfc_llc_submit_connect(self, conn->rsap, lsap, lp);
@@ -574,7 +601,6 @@ nfc_llc_handle_connect(
     guint plen)
 {
     NfcPeerService* service = NULL;
-    NfcLlcParam** params = nfc_llc_param_decode_bytes(plist, plen);
 
     if (dsap == NFC_LLC_SAP_SDP) {
         /*
@@ -591,8 +617,11 @@ nfc_llc_handle_connect(
          * PDU to a destination service access point other than 01h, it
          * SHALL be ignored.
          */
-        const NfcLlcParam* sn_param = nfc_llc_param_find
-            (nfc_llc_param_constify(params), NFC_LLC_PARAM_SN);
+        NfcLlcParamIter iter;
+        const NfcLlcParam* sn_param;
+
+        nfc_llc_param_iter_init(&iter, plist, plen);
+        sn_param = nfc_llc_param_iter_find(&iter, NFC_LLC_PARAM_SN);
 
         /* Why would we access connection to SDP SAP (without a name) ? */
         if (sn_param) {
@@ -644,8 +673,8 @@ nfc_llc_handle_connect(
                 if (conn->state != NFC_LLC_CO_DEAD) {
                     g_hash_table_insert(self->conn_table, key, conn);
                     nfc_peer_connection_set_llc(conn, &self->pub);
-                    nfc_peer_connection_apply_remote_params(conn,
-                        nfc_llc_param_constify(params));
+                    nfc_peer_connection_apply_remote_tlvs(conn,
+                        plist, plen);
                     nfc_peer_connection_accept(conn);
                 } else {
                     /* Stillborn connection */
@@ -659,7 +688,6 @@ nfc_llc_handle_connect(
     } else {
         nfc_llc_submit_dm(self, ssap, dsap, NFC_LLC_DM_NO_SERVICE);
     }
-    nfc_llc_param_free(params);
 }
 
 static
@@ -689,16 +717,8 @@ nfc_llc_handle_cc(
             conn->rsap = ssap;
             key = nfc_peer_connection_key(conn);
 
-            if (plen > 0) {
-                NfcLlcParam** cp = nfc_llc_param_decode_bytes(plist, plen);
-
-                /* Apply connection parameters */
-                if (cp) {
-                    nfc_peer_connection_apply_remote_params(conn,
-                        nfc_llc_param_constify(cp));
-                    nfc_llc_param_free(cp);
-                }
-            }
+            /* Apply connection parameters */
+            nfc_peer_connection_apply_remote_tlvs(conn, plist, plen);
 
             /* Complete the request */
             if (req->complete) {
@@ -888,23 +908,22 @@ nfc_llc_handle_snl(
 {
     GByteArray* pdu_bytes = nfc_llc_pdu_new
         (NFC_LLC_SAP_SDP, LLCP_PTYPE_SNL, NFC_LLC_SAP_SDP);
-    GPtrArray* resp_list = g_ptr_array_new_with_free_func(g_free);
-    NfcLlcParam** params = nfc_llc_param_decode_bytes(plist, plen);
-    NfcLlcParam** ptr = params;
+    const NfcLlcParam* param;
+    NfcLlcParamIter iter;
     GBytes* pdu;
 
     /* Resolve names */
-    while (*ptr) {
-        const NfcLlcParam* param = *ptr++;
-
+    nfc_llc_param_iter_init(&iter, plist, plen);
+    while ((param = nfc_llc_param_iter_next(&iter)) != NULL) {
         if (param->type == NFC_LLC_PARAM_SDREQ) {
             const NfcLlcParamSdReq* sdreq = &param->value.sdreq;
-            NfcLlcParam* resp_param = g_new(NfcLlcParam, 1);
-            NfcLlcParamSdRes* sdres = &resp_param->value.sdres;
             NfcPeerService* svc = nfc_peer_services_find_sn
                 (self->services, sdreq->uri);
+            NfcLlcParam resp_param;
+            NfcLlcParamSdRes* sdres = &resp_param.value.sdres;
+            const NfcLlcParam* resp_list[2];
 
-            resp_param->type = NFC_LLC_PARAM_SDRES;
+            resp_param.type = NFC_LLC_PARAM_SDRES;
             sdres->tid = sdreq->tid;
             if (svc) {
                 sdres->sap = svc->sap;
@@ -916,16 +935,13 @@ nfc_llc_handle_snl(
                 sdres->sap = 0;
                 GDEBUG("  \"%s\" (unknown)", sdreq->uri);
             }
-            g_ptr_array_add(resp_list, resp_param);
+
+            /* Encode the response parameter */
+            resp_list[0] = &resp_param;
+            resp_list[1] = NULL;
+            nfc_llc_param_encode(resp_list, pdu_bytes, self->miu);
         }
     }
-    nfc_llc_param_free(params);
-
-    /* Encode response parameters */
-    g_ptr_array_add(resp_list, NULL);
-    nfc_llc_param_encode((const NfcLlcParam**)resp_list->pdata,
-        pdu_bytes, self->miu);
-    g_ptr_array_free(resp_list, TRUE);
 
     /* Submit the packet */
     pdu = g_byte_array_free_to_bytes(pdu_bytes);
@@ -940,10 +956,8 @@ nfc_llc_handle_pax(
     const void* plist,
     guint plen)
 {
-    NfcLlcParam** params = nfc_llc_param_decode_bytes(plist, plen);
-    guint change = nfc_llc_apply_params(self, nfc_llc_param_constify(params));
+    const guint change = nfc_llc_apply_tlvs(self, plist, plen);
 
-    nfc_llc_param_free(params);
     /* Signal the change */
     if (change & (1 << NFC_LLC_PARAM_WKS)) {
         g_signal_emit(self, nfc_llc_signals[SIGNAL_WKS_CHANGED], 0);
@@ -1455,15 +1469,13 @@ nfc_llc_send_next_pdu(
     }
 }
 
-/*==========================================================================*
- * Interface
- *==========================================================================*/
-
+static
 NfcLlc*
-nfc_llc_new(
+nfc_llc_new_full(
     NfcLlcIo* io,
     NfcPeerServices* services,
-    const NfcLlcParam* const* params)
+    const NfcLlcParam* const* params,
+    const GUtilData* tlvs)
 {
     NfcLlc* llc = NULL;
 
@@ -1477,6 +1489,9 @@ nfc_llc_new(
 
         /* Apply parameters provided by the MAC layer */
         nfc_llc_apply_params(self, params);
+        if (tlvs) {
+            nfc_llc_apply_tlvs(self, tlvs->bytes, tlvs->size);
+        }
 
         /*
          * PAX PDU exchange is defined in LLCP spec but SHALL NOT be used.
@@ -1522,6 +1537,28 @@ nfc_llc_new(
     return llc;
 }
 
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+NfcLlc*
+nfc_llc_new(
+    NfcLlcIo* io,
+    NfcPeerServices* services,
+    const NfcLlcParam* const* params)
+{
+    return nfc_llc_new_full(io, services, params, NULL);
+}
+
+NfcLlc*
+nfc_llc_new_tlvs(
+    NfcLlcIo* io,
+    NfcPeerServices* services,
+    const GUtilData* tlvs)
+{
+    return nfc_llc_new_full(io, services, NULL, tlvs);
+}
+
 void
 nfc_llc_free(
     NfcLlc* llc)
@@ -112,6 +112,14 @@ nfc_llc_new(
     const NfcLlcParam* const* params)
     NFCD_INTERNAL;
 
+/* Same as above but decodes raw TLVs without allocating anything */
+NfcLlc*
+nfc_llc_new_tlvs(
+    NfcLlcIo* io,
+    NfcPeerServices* services,
+    const GUtilData* tlvs)
+    NFCD_INTERNAL;
+
 void
 nfc_llc_free(
     NfcLlc* llc)
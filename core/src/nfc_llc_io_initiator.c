@@ -32,11 +32,13 @@
 
 #include "nfc_llc_io_impl.h"
 #include "nfc_target_p.h"
+#include "nfc_timer.h"
 
 #define GLOG_MODULE_NAME NFC_LLC_LOG_MODULE
 #include <gutil_log.h>
 
 #define DEFAULT_POLL_PERIOD (100) /* ms */
+#define DEFAULT_POLL_SLACK (20) /* ms */
 
 typedef struct nfc_llc_io_initiator {
     NfcLlcIo io;
@@ -111,8 +113,8 @@ nfc_llc_io_initiator_symm_transmit_done(
             }
         } else if (!self->tx_id) {
             /* Nothing is expected to arrive urgently, start polling. */
-            self->poll_id = g_timeout_add(self->poll_period,
-                nfc_llc_io_initiator_poll, self);
+            self->poll_id = nfc_timer_add(self->poll_period,
+                DEFAULT_POLL_SLACK, nfc_llc_io_initiator_poll, self);
             nfc_llc_io_can_send(io);
         }
     } else {
@@ -217,7 +219,7 @@ nfc_llc_io_initiator_send(
     GASSERT(io->can_send);
     if (self->poll_id) {
         /* Cancel scheduled polling */
-        g_source_remove(self->poll_id);
+        nfc_timer_remove(self->poll_id);
         self->poll_id = 0;
     }
 
@@ -252,7 +254,7 @@ nfc_llc_io_initiator_finalize(
     NfcLlcIoInitiator* self = THIS(object);
 
     if (self->poll_id) {
-        g_source_remove(self->poll_id);
+        nfc_timer_remove(self->poll_id);
     }
     nfc_target_cancel_transmit(self->target, self->tx_id);
     nfc_target_unref(self->target);
@@ -32,6 +32,7 @@
 
 #include "nfc_llc_param.h"
 
+#include <gutil_misc.h>
 #include <gutil_macros.h>
 
 /*
@@ -151,6 +152,137 @@ nfc_llc_param_encode(
     return dest;
 }
 
+void
+nfc_llc_param_iter_init(
+    NfcLlcParamIter* iter,
+    const void* data,
+    guint size)
+{
+    iter->ptr = data;
+    iter->end = iter->ptr + (data ? size : 0);
+}
+
+const NfcLlcParam*
+nfc_llc_param_iter_next(
+    NfcLlcParamIter* iter)
+{
+    NfcLlcParam* param = &iter->param;
+    NfcLlcParamValue* value = &param->value;
+
+    while (iter->ptr + 1 < iter->end &&
+        iter->ptr + (iter->ptr[1] + 1) < iter->end) {
+        const guint t = iter->ptr[0];
+        const guint l = iter->ptr[1];
+        const guint8* v = iter->ptr + 2;
+        gboolean ok = FALSE;
+
+        /* Advance to the next block */
+        iter->ptr += l + 2;
+        memset(value, 0, sizeof(*value));
+        switch (t) {
+        /* 4.5.1 Version Number, VERSION */
+        case NFC_LLC_PARAM_VERSION:
+            if (l == 1) {
+                value->version = v[0];
+                ok = TRUE;
+            }
+            break;
+        /* 4.5.2 Maximum Information Unit Extension, MIUX */
+        case NFC_LLC_PARAM_MIUX:
+            if (l == 2) {
+                const guint miux = (((((guint)v[0]) << 8) | v[1]) & 0x7ff);
+
+                value->miu = miux + NFC_LLC_MIU_MIN;
+                ok = TRUE;
+            }
+            break;
+        /* 4.5.3 Well-Known Service List, WKS */
+        case NFC_LLC_PARAM_WKS:
+            if (l == 2) {
+                value->wks = ((((guint)v[0]) << 8) | v[1]);
+                ok = TRUE;
+            }
+            break;
+        /* 4.5.4 Link Timeout, LTO */
+        case NFC_LLC_PARAM_LTO:
+            /*
+             * The LTO parameter value SHALL be an 8-bit unsigned
+             * integer that specifies the link timeout value in
+             * multiples of 10 milliseconds.
+             *
+             * If no LTO parameter is transmitted or if the LTO
+             * parameter value is zero, the default link timeout
+             * value of 100 milliseconds SHALL be used.
+             */
+            if (l == 1) {
+                value->lto = v[0] ? (10 * (guint)v[0]) :
+                    NFC_LLC_LTO_DEFAULT;
+                ok = TRUE;
+            }
+            break;
+        /* 4.5.5 Receive Window Size, RW */
+        case NFC_LLC_PARAM_RW:
+            if (l == 1) {
+                value->rw = (v[0] & 0x0f);
+                ok = TRUE;
+            }
+            break;
+        /* 4.5.6 Service Name, SN */
+        case NFC_LLC_PARAM_SN:
+            memcpy(iter->str, v, l);
+            iter->str[l] = 0;
+            value->sn = iter->str;
+            ok = TRUE;
+            break;
+        /* 4.5.7 Option, OPT */
+        case NFC_LLC_PARAM_OPT:
+            if (l == 1) {
+                value->opt = v[0];
+                ok = TRUE;
+            }
+            break;
+        /* 4.5.8 Service Discovery Request, SDREQ */
+        case NFC_LLC_PARAM_SDREQ:
+            if (l >= 1) {
+                memcpy(iter->str, v + 1, l - 1);
+                iter->str[l - 1] = 0;
+                value->sdreq.tid = v[0];
+                value->sdreq.uri = iter->str;
+                ok = TRUE;
+            }
+            break;
+        /* 4.5.9 Service Discovery Response, SDRES */
+        case NFC_LLC_PARAM_SDRES:
+            if (l == 2) {
+                value->sdres.tid = v[0];
+                value->sdres.sap = (v[1] & 0x3f);
+                ok = TRUE;
+            }
+            break;
+        }
+        if (ok) {
+            param->type = t;
+            return param;
+        }
+    }
+    return NULL;
+}
+
+const NfcLlcParam*
+nfc_llc_param_iter_find(
+    NfcLlcParamIter* iter,
+    NFC_LLC_PARAM_TYPE type)
+{
+    const NfcLlcParam* param;
+
+    while ((param = nfc_llc_param_iter_next(iter)) != NULL) {
+        if (param->type == type) {
+            return param;
+        }
+    }
+    return NULL;
+}
+
 NfcLlcParam**
 nfc_llc_param_decode(
     const GUtilData* tlvs)
@@ -158,104 +290,36 @@ nfc_llc_param_decode(
     NfcLlcParam** params = NULL;
 
     if (tlvs) {
-        const guint8* ptr = tlvs->bytes;
-        const guint8* end = ptr + tlvs->size;
         GPtrArray* list = g_ptr_array_new();
+        const NfcLlcParam* param;
+        NfcLlcParamIter iter;
 
-        while (ptr + 1 < end && ptr + (ptr[1] + 1) < end) {
-            const guint t = ptr[0];
-            const guint l = ptr[1];
-            const guint8* v = ptr + 2;
-            NfcLlcParam* param = NULL;
-            char* buf;
+        nfc_llc_param_iter_init(&iter, tlvs->bytes, tlvs->size);
+        while ((param = nfc_llc_param_iter_next(&iter)) != NULL) {
+            NfcLlcParam* copy;
+            const char* str;
 
-            switch (t) {
-            /* 4.5.1 Version Number, VERSION */
-            case NFC_LLC_PARAM_VERSION:
-                if (l == 1) {
-                    param = g_new0(NfcLlcParam, 1);
-                    param->value.version = v[0];
-                }
-                break;
-            /* 4.5.2 Maximum Information Unit Extension, MIUX */
-            case NFC_LLC_PARAM_MIUX:
-                if (l == 2) {
-                    const guint miux = (((((guint)v[0]) << 8) | v[1]) & 0x7ff);
-
-                    param = g_new0(NfcLlcParam, 1);
-                    param->value.miu = miux + NFC_LLC_MIU_MIN;
-                }
-                break;
-            /* 4.5.3 Well-Known Service List, WKS */
-            case NFC_LLC_PARAM_WKS:
-                if (l == 2) {
-                    param = g_new0(NfcLlcParam, 1);
-                    param->value.wks = ((((guint)v[0]) << 8) | v[1]);
-                }
-                break;
-            /* 4.5.4 Link Timeout, LTO */
-            case NFC_LLC_PARAM_LTO:
-                /*
-                 * The LTO parameter value SHALL be an 8-bit unsigned
-                 * integer that specifies the link timeout value in
-                 * multiples of 10 milliseconds.
-                 *
-                 * If no LTO parameter is transmitted or if the LTO
-                 * parameter value is zero, the default link timeout
-                 * value of 100 milliseconds SHALL be used.
-                 */
-                if (l == 1) {
-                    param = g_new0(NfcLlcParam, 1);
-                    param->value.lto = v[0] ? (10 * (guint)v[0]) :
-                        NFC_LLC_LTO_DEFAULT;
-                }
-                break;
-            /* 4.5.5 Receive Window Size, RW */
-            case NFC_LLC_PARAM_RW:
-                if (l == 1) {
-                    param = g_new0(NfcLlcParam, 1);
-                    param->value.rw = (v[0] & 0x0f);
-                }
-                break;
-            /* 4.5.6 Service Name, SN */
+            switch (param->type) {
             case NFC_LLC_PARAM_SN:
-                param = g_malloc0(G_ALIGN8(sizeof(NfcLlcParam)) + l + 1);
-                buf = ((char*)param) + G_ALIGN8(sizeof(NfcLlcParam));
-                param->value.sn = buf;
-                memcpy(buf, v, l);
-                break;
-            /* 4.5.7 Option, OPT */
-            case NFC_LLC_PARAM_OPT:
-                if (l == 1) {
-                    param = g_new0(NfcLlcParam, 1);
-                    param->value.opt = v[0];
-                }
-                break;
-            /* 4.5.8 Service Discovery Request, SDREQ */
             case NFC_LLC_PARAM_SDREQ:
-                if (l >= 1) {
-                    param = g_malloc0(G_ALIGN8(sizeof(NfcLlcParam)) + l);
-                    buf = ((char*)param) + G_ALIGN8(sizeof(NfcLlcParam));
-                    param->value.sdreq.tid = v[0];
-                    param->value.sdreq.uri = buf;
-                    memcpy(buf, v + 1, l - 1);
+                /* The string is allocated together with the parameter */
+                str = iter.str;
+                copy = g_malloc(G_ALIGN8(sizeof(NfcLlcParam)) +
+                    strlen(str) + 1);
+                *copy = *param;
+                str = strcpy(((char*)copy) +
+                    G_ALIGN8(sizeof(NfcLlcParam)), str);
+                if (param->type == NFC_LLC_PARAM_SN) {
+                    copy->value.sn = str;
+                } else {
+                    copy->value.sdreq.uri = str;
                 }
                 break;
-            /* 4.5.9 Service Discovery Response, SDRES */
-            case NFC_LLC_PARAM_SDRES:
-                if (l == 2) {
-                    param = g_new0(NfcLlcParam, 1);
-                    param->value.sdres.tid = v[0];
-                    param->value.sdres.sap = (v[1] & 0x3f);
-                }
+            default:
+                copy = gutil_memdup(param, sizeof(*param));
                 break;
             }
-            if (param) {
-                param->type = t;
-                g_ptr_array_add(list, param);
-            }
-            /* Advance to the next block */
-            ptr += l + 2;
+            g_ptr_array_add(list, copy);
         }
         g_ptr_array_add(list, NULL);
         params = (NfcLlcParam**)g_ptr_array_free(list, FALSE);
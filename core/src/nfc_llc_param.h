@@ -87,6 +87,37 @@ struct nfc_llc_param {
     NfcLlcParamValue value;
 };
 
+/*
+ * Allocation-free iteration over the raw TLVs. The returned parameter
+ * points inside the iterator and remains valid until the next call.
+ * SN and SDREQ URI strings are copied into the iterator's own buffer
+ * so that they are NULL-terminated.
+ */
+typedef struct nfc_llc_param_iter {
+    const guint8* ptr;
+    const guint8* end;
+    NfcLlcParam param;
+    char str[256];
+} NfcLlcParamIter;
+
+void
+nfc_llc_param_iter_init(
+    NfcLlcParamIter* iter,
+    const void* data,
+    guint size)
+    NFCD_INTERNAL;
+
+const NfcLlcParam*
+nfc_llc_param_iter_next(
+    NfcLlcParamIter* iter)
+    NFCD_INTERNAL;
+
+const NfcLlcParam*
+nfc_llc_param_iter_find(
+    NfcLlcParamIter* iter,
+    NFC_LLC_PARAM_TYPE type)
+    NFCD_INTERNAL;
+
 GByteArray*
 nfc_llc_param_encode(
     const NfcLlcParam* const* params,
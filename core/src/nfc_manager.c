@@ -52,6 +52,7 @@ struct nfc_mode_request {
     NfcManager* manager;
     NFC_MODE enable;
     NFC_MODE disable;
+    NFC_TAG_READ_POLICY read_policy;
 };
 
 struct nfc_manager_priv {
@@ -62,7 +63,9 @@ struct nfc_manager_priv {
     guint next_adapter_index;
     gboolean requested_power;
     NFC_MODE default_mode;
+    NFC_TAG_READ_POLICY default_read_policy;
     NfcModeRequest* mode_requests;
+    NfcTagFilters* tag_filters;
 };
 
 #define THIS(obj) NFC_MANAGER(obj)
@@ -205,13 +208,46 @@ nfc_manager_update_mode(
     }
 }
 
+static
+void
+nfc_manager_update_read_policy(
+    NfcManager* self)
+{
+    NfcManagerPriv* priv = self->priv;
+    const NfcModeRequest* req;
+    NFC_TAG_READ_POLICY policy = priv->default_read_policy;
+
+    /* The most recent request is at the head of the list */
+    for (req = priv->mode_requests; req; req = req->next) {
+        if (req->read_policy != NFC_TAG_READ_DEFAULT) {
+            policy = req->read_policy;
+            break;
+        }
+    }
+    if (self->tag_read_policy != policy) {
+        NfcAdapter** adapters = nfc_manager_ref_adapters(priv);
+
+        GDEBUG("Tag read policy %d", policy);
+        self->tag_read_policy = policy;
+        if (adapters) {
+            NfcAdapter** ptr = adapters;
+
+            while (*ptr) {
+                nfc_adapter_set_tag_read_policy(*ptr++, policy);
+            }
+            nfc_manager_unref_adapters(adapters);
+        }
+    }
+}
+
 static
 NfcModeRequest*
 nfc_manager_mode_request_new_internal(
     NfcManager* self,
     gboolean internal,
     NFC_MODE enable,
-    NFC_MODE disable)
+    NFC_MODE disable,
+    NFC_TAG_READ_POLICY read_policy)
 {
     NfcManagerPriv* priv = self->priv;
     NfcModeRequest* req = g_slice_new0(NfcModeRequest);
@@ -221,11 +257,13 @@ nfc_manager_mode_request_new_internal(
     }
     req->enable = enable;
     req->disable = disable;
+    req->read_policy = read_policy;
     req->next = priv->mode_requests;
     priv->mode_requests = req;
     if (nfc_manager_update_mode(self)) {
         nfc_manager_update_adapter_modes(self);
     }
+    nfc_manager_update_read_policy(self);
     return req;
 }
 
@@ -256,6 +294,7 @@ nfc_manager_mode_request_free_internal(
     if (nfc_manager_update_mode(self)) {
         nfc_manager_update_adapter_modes(self);
     }
+    nfc_manager_update_read_policy(self);
 
     nfc_manager_unref(req->manager); /* Can be NULL */
     req->next = NULL;
@@ -353,6 +392,8 @@ nfc_manager_add_adapter(
             nfc_adapter_set_services(adapter, priv->services);
             nfc_adapter_set_enabled(adapter, self->enabled);
             nfc_adapter_request_mode(adapter, self->mode);
+            nfc_adapter_set_tag_read_policy(adapter, self->tag_read_policy);
+            nfc_adapter_set_tag_filters(adapter, priv->tag_filters);
             nfc_adapter_request_power(adapter, priv->requested_power);
             g_hash_table_insert(priv->adapters, name, nfc_adapter_ref(adapter));
             g_free(self->adapters);
@@ -471,16 +512,25 @@ gboolean
 nfc_manager_register_service(
     NfcManager* self,
     NfcPeerService* service) /* Since 1.1.0 */
+{
+    return nfc_manager_register_service2(self, service, 0);
+}
+
+gboolean
+nfc_manager_register_service2(
+    NfcManager* self,
+    NfcPeerService* service,
+    guint8 sap) /* Since 1.1.19 */
 {
     if (G_LIKELY(self)) {
         NfcManagerPriv* priv = self->priv;
 
-        if (nfc_peer_services_add(priv->services, service)) {
+        if (nfc_peer_services_add2(priv->services, service, sap)) {
             nfc_peer_service_ref(service);
             self->services = priv->services->list;
             if (!priv->p2p_request) {
                 priv->p2p_request = nfc_manager_mode_request_new_internal(self,
-                    TRUE, NFC_MODES_P2P, NFC_MODE_NONE);
+                    TRUE, NFC_MODES_P2P, NFC_MODE_NONE, NFC_TAG_READ_DEFAULT);
             }
             g_signal_emit(self, nfc_manager_signals
                 [SIGNAL_SERVICE_REGISTERED], 0, service);
@@ -608,8 +658,8 @@ nfc_manager_mode_request_new(
     NFC_MODE disable) /* Since 1.1.0 */
 {
     return (G_LIKELY(self) && G_LIKELY(enable || disable)) ?
-        nfc_manager_mode_request_new_internal(self, FALSE, enable, disable) :
-        NULL;
+        nfc_manager_mode_request_new_internal(self, FALSE, enable, disable,
+            NFC_TAG_READ_DEFAULT) : NULL;
 }
 
 void
@@ -621,6 +671,64 @@ nfc_manager_mode_request_free(
     }
 }
 
+void
+nfc_manager_set_tag_read_policy(
+    NfcManager* self,
+    NFC_TAG_READ_POLICY policy) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self)) {
+        NfcManagerPriv* priv = self->priv;
+
+        /* DEFAULT resets it back to NDEF */
+        if (policy == NFC_TAG_READ_DEFAULT) {
+            policy = NFC_TAG_READ_NDEF;
+        }
+        if (priv->default_read_policy != policy) {
+            GDEBUG("Default tag read policy %d", policy);
+            priv->default_read_policy = policy;
+            nfc_manager_update_read_policy(self);
+        }
+    }
+}
+
+NfcModeRequest*
+nfc_manager_mode_request_new2(
+    NfcManager* self,
+    NFC_MODE enable,
+    NFC_MODE disable,
+    NFC_TAG_READ_POLICY read_policy) /* Since 1.1.19 */
+{
+    return (G_LIKELY(self) && G_LIKELY(enable || disable ||
+        read_policy != NFC_TAG_READ_DEFAULT)) ?
+        nfc_manager_mode_request_new_internal(self, FALSE, enable, disable,
+            read_policy) : NULL;
+}
+
+void
+nfc_manager_set_tag_filters(
+    NfcManager* self,
+    const NfcTagFilter* filters,
+    guint count) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self)) {
+        NfcManagerPriv* priv = self->priv;
+        NfcAdapter** adapters = nfc_manager_ref_adapters(priv);
+
+        /* Zero count (or NULL filters) turns the filtering off */
+        GDEBUG("%u tag filter(s)", filters ? count : 0);
+        nfc_tag_filters_unref(priv->tag_filters);
+        priv->tag_filters = nfc_tag_filters_new(filters, count);
+        if (adapters) {
+            NfcAdapter** ptr = adapters;
+
+            while (*ptr) {
+                nfc_adapter_set_tag_filters(*ptr++, priv->tag_filters);
+            }
+            nfc_manager_unref_adapters(adapters);
+        }
+    }
+}
+
 /*==========================================================================*
  * Internal interface
  *==========================================================================*/
@@ -667,6 +775,7 @@ nfc_manager_init(
     self->adapters = g_new0(NfcAdapter*, 1);
     self->enabled = TRUE;
     self->mode = priv->default_mode = NFC_MODE_READER_WRITER;
+    self->tag_read_policy = priv->default_read_policy = NFC_TAG_READ_NDEF;
     self->llcp_version = NFC_LLCP_VERSION_1_1;
     self->services = priv->services->list;
 }
@@ -682,6 +791,7 @@ nfc_manager_finalize(
     nfc_manager_release_p2p_mode_request(self);
     nfc_plugins_free(priv->plugins);
     nfc_peer_services_unref(priv->services);
+    nfc_tag_filters_unref(priv->tag_filters);
     g_hash_table_destroy(priv->adapters);
     g_free(self->adapters);
     G_OBJECT_CLASS(nfc_manager_parent_class)->finalize(object);
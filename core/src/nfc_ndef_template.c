@@ -0,0 +1,451 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) ARISING
+ * IN ANY WAY OUT OF THE USE OR INABILITY TO USE THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "nfc_ndef_p.h"
+#include "nfc_tlv.h"
+#include "nfc_log.h"
+
+#include <gutil_macros.h>
+
+/*
+ * Compiled NDEF template. The whole NDEF Message TLV (followed by the
+ * Terminator TLV) is laid out once, fixed-width variable fields are
+ * then patched in place and the range which needs to be written is
+ * tracked incrementally against the baseline (i.e. what's believed to
+ * be stored on the tag). The TLVs which precede the NDEF Message TLV
+ * in the baseline (Lock Control, Memory Control etc.) are copied to
+ * the beginning of the image, so that the image matches the layout
+ * of the tag's data area.
+ */
+
+typedef struct nfc_ndef_template_field {
+    guint offset;
+    guint size;
+    gboolean changed;   /* Differs from the baseline */
+} NfcNdefTemplateField;
+
+struct nfc_ndef_template {
+    gint refcount;
+    GUtilData data;
+    guint8* image;
+    guint8* baseline;
+    guint prefix;       /* Offset of the NDEF Message TLV */
+    guint header_size;
+    guint diff_start;   /* Fixed part which differs from the baseline */
+    guint diff_end;
+    guint nfields;
+    NfcNdefTemplateField* fields;
+};
+
+static
+gboolean
+nfc_ndef_template_is_field(
+    NfcNdefTemplate* self,
+    guint offset)
+{
+    guint i;
+
+    for (i = 0; i < self->nfields; i++) {
+        const NfcNdefTemplateField* field = self->fields + i;
+
+        if (offset >= field->offset && offset < (field->offset + field->size)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static
+void
+nfc_ndef_template_update_diff(
+    NfcNdefTemplate* self)
+{
+    const guint size = self->data.size;
+    guint start = 0, end = size;
+
+    /* Everything is different if we don't have the baseline */
+    if (self->baseline) {
+        /* Field bytes are tracked separately */
+        while (start < end && (self->image[start] == self->baseline[start] ||
+            nfc_ndef_template_is_field(self, start))) {
+            start++;
+        }
+        while (end > start && (self->image[end - 1] ==
+            self->baseline[end - 1] ||
+            nfc_ndef_template_is_field(self, end - 1))) {
+            end--;
+        }
+    }
+    self->diff_start = start;
+    self->diff_end = end;
+}
+
+static
+void
+nfc_ndef_template_update_field(
+    NfcNdefTemplate* self,
+    NfcNdefTemplateField* field)
+{
+    field->changed = !self->baseline || memcmp(self->image + field->offset,
+        self->baseline + field->offset, field->size);
+}
+
+static
+guint
+nfc_ndef_template_prefix_size(
+    const GUtilData* data)
+{
+    GUtilData buf = *data;
+    guint size = 0;
+
+    /* Everything preceding the NDEF or the end of the last TLV */
+    while (buf.size > 0) {
+        const guint type = buf.bytes[0];
+
+        if (type == TLV_NULL) {
+            buf.bytes++;
+            buf.size--;
+        } else if (type == TLV_NDEF_MESSAGE) {
+            /* Keep the padding in front of the existing NDEF */
+            size = buf.bytes - data->bytes;
+            break;
+        } else if (type == TLV_TERMINATOR) {
+            break;
+        } else {
+            GUtilData value;
+
+            if (!nfc_tlv_next(&buf, &value)) {
+                /* Broken TLV, it's going to be overwritten */
+                break;
+            }
+            size = buf.bytes - data->bytes;
+        }
+    }
+    return size;
+}
+
+static
+void
+nfc_ndef_template_set_prefix(
+    NfcNdefTemplate* self,
+    const GUtilData* data)
+{
+    const guint prefix = nfc_ndef_template_prefix_size(data);
+
+    if (self->prefix != prefix ||
+        memcmp(self->image, data->bytes, prefix)) {
+        const guint tlv_size = self->data.size - self->prefix;
+        guint8* image = g_malloc(prefix + tlv_size);
+        guint i;
+
+        memcpy(image, data->bytes, prefix);
+        memcpy(image + prefix, self->image + self->prefix, tlv_size);
+        for (i = 0; i < self->nfields; i++) {
+            NfcNdefTemplateField* field = self->fields + i;
+
+            field->offset = field->offset - self->prefix + prefix;
+        }
+        g_free(self->image);
+        self->data.bytes = self->image = image;
+        self->data.size = prefix + tlv_size;
+        self->prefix = prefix;
+    }
+}
+
+static
+void
+nfc_ndef_template_free(
+    NfcNdefTemplate* self)
+{
+    g_free(self->image);
+    g_free(self->baseline);
+    g_free(self->fields);
+    g_slice_free(NfcNdefTemplate, self);
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+NfcNdefTemplate*
+nfc_ndef_template_new(
+    NfcNdefRec* first) /* Since 1.1.19 */
+{
+    NfcNdefRec* rec;
+    gsize msg_size = 0;
+
+    for (rec = first; rec; rec = rec->next) {
+        msg_size += rec->raw.size;
+    }
+
+    /* TLV length field is at most 16 bits long */
+    if (G_LIKELY(first) && msg_size < 0xffff) {
+        NfcNdefTemplate* self = g_slice_new0(NfcNdefTemplate);
+        const guint header_size = (msg_size < 0xff) ? 2 : 4;
+        guint8* ptr;
+
+        g_atomic_int_set(&self->refcount, 1);
+        self->header_size = header_size;
+        self->data.size = header_size + msg_size + 1;
+        self->data.bytes = self->image = ptr = g_malloc(self->data.size);
+
+        /* TLV type and length */
+        *ptr++ = TLV_NDEF_MESSAGE;
+        if (header_size == 2) {
+            *ptr++ = (guint8)msg_size;
+        } else {
+            *ptr++ = 0xff;
+            *ptr++ = (guint8)(msg_size >> 8);
+            *ptr++ = (guint8)msg_size;
+        }
+
+        /* Records with MB and ME bits adjusted */
+        for (rec = first; rec; rec = rec->next) {
+            if (rec->raw.size) {
+                memcpy(ptr, rec->raw.bytes, rec->raw.size);
+                ptr[0] &= ~(NFC_NDEF_HDR_MB | NFC_NDEF_HDR_ME);
+                if (rec == first) {
+                    ptr[0] |= NFC_NDEF_HDR_MB;
+                }
+                if (!rec->next) {
+                    ptr[0] |= NFC_NDEF_HDR_ME;
+                }
+                ptr += rec->raw.size;
+            }
+        }
+
+        *ptr++ = TLV_TERMINATOR;
+        GASSERT(ptr == self->image + self->data.size);
+        nfc_ndef_template_update_diff(self);
+        return self;
+    }
+    return NULL;
+}
+
+NfcNdefTemplate*
+nfc_ndef_template_ref(
+    NfcNdefTemplate* self) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self)) {
+        g_atomic_int_inc(&self->refcount);
+    }
+    return self;
+}
+
+void
+nfc_ndef_template_unref(
+    NfcNdefTemplate* self) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self)) {
+        if (g_atomic_int_dec_and_test(&self->refcount)) {
+            nfc_ndef_template_free(self);
+        }
+    }
+}
+
+guint
+nfc_ndef_template_add_field(
+    NfcNdefTemplate* self,
+    const void* placeholder,
+    guint size) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self) && G_LIKELY(placeholder) && size) {
+        /* Placeholders can only be found inside the NDEF message */
+        const guint end = self->data.size - 1;
+        guint offset = self->prefix + self->header_size;
+
+        while ((offset + size) <= end) {
+            const guint8* ptr = memchr(self->image + offset,
+                *(const guint8*)placeholder, end - offset - size + 1);
+
+            if (!ptr) {
+                break;
+            }
+            offset = ptr - self->image;
+            if (!memcmp(ptr, placeholder, size) &&
+                !nfc_ndef_template_is_field(self, offset) &&
+                !nfc_ndef_template_is_field(self, offset + size - 1)) {
+                NfcNdefTemplateField* field;
+
+                self->fields = g_renew(NfcNdefTemplateField, self->fields,
+                    self->nfields + 1);
+                field = self->fields + (self->nfields++);
+                field->offset = offset;
+                field->size = size;
+                nfc_ndef_template_update_field(self, field);
+                nfc_ndef_template_update_diff(self);
+                return self->nfields;
+            }
+            offset++;
+        }
+    }
+    return 0;
+}
+
+gboolean
+nfc_ndef_template_set_field(
+    NfcNdefTemplate* self,
+    guint id,
+    const void* value,
+    guint size) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self) && id > 0 && id <= self->nfields) {
+        NfcNdefTemplateField* field = self->fields + (id - 1);
+
+        if (size == field->size && (value || !size)) {
+            memcpy(self->image + field->offset, value, size);
+            nfc_ndef_template_update_field(self, field);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+const GUtilData*
+nfc_ndef_template_data(
+    NfcNdefTemplate* self) /* Since 1.1.19 */
+{
+    return G_LIKELY(self) ? &self->data : NULL;
+}
+
+void
+nfc_ndef_template_set_baseline(
+    NfcNdefTemplate* self,
+    const GUtilData* data) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self)) {
+        guint i;
+
+        g_free(self->baseline);
+        if (data) {
+            guint size;
+
+            nfc_ndef_template_set_prefix(self, data);
+            size = self->data.size;
+
+            /* Bytes beyond the end of the tag data are assumed to differ */
+            self->baseline = g_malloc(size);
+            if (data->size >= size) {
+                memcpy(self->baseline, data->bytes, size);
+            } else {
+                memcpy(self->baseline, data->bytes, data->size);
+                for (i = data->size; i < size; i++) {
+                    self->baseline[i] = ~self->image[i];
+                }
+            }
+        } else {
+            self->baseline = NULL;
+        }
+        for (i = 0; i < self->nfields; i++) {
+            nfc_ndef_template_update_field(self, self->fields + i);
+        }
+        nfc_ndef_template_update_diff(self);
+    }
+}
+
+void
+nfc_ndef_template_commit(
+    NfcNdefTemplate* self) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self)) {
+        guint i;
+
+        if (!self->baseline) {
+            self->baseline = g_malloc(self->data.size);
+        }
+        memcpy(self->baseline, self->image, self->data.size);
+        for (i = 0; i < self->nfields; i++) {
+            self->fields[i].changed = FALSE;
+        }
+        self->diff_start = self->diff_end = 0;
+    }
+}
+
+gboolean
+nfc_ndef_template_diff(
+    NfcNdefTemplate* self,
+    guint align,
+    guint* offset,
+    GUtilData* data) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self)) {
+        guint i, start = self->diff_start, end = self->diff_end;
+
+        for (i = 0; i < self->nfields; i++) {
+            const NfcNdefTemplateField* field = self->fields + i;
+
+            if (field->changed) {
+                if (start == end) {
+                    start = field->offset;
+                    end = field->offset + field->size;
+                } else {
+                    start = MIN(start, field->offset);
+                    end = MAX(end, field->offset + field->size);
+                }
+            }
+        }
+
+        if (start < end) {
+            /* Round the range to the block boundaries */
+            if (align > 1) {
+                start -= start % align;
+                end = MIN(end + (align - end % align) % align,
+                    self->data.size);
+            }
+            if (offset) {
+                *offset = start;
+            }
+            if (data) {
+                data->bytes = self->image + start;
+                data->size = end - start;
+            }
+            return TRUE;
+        }
+    }
+    if (offset) {
+        *offset = 0;
+    }
+    if (data) {
+        memset(data, 0, sizeof(*data));
+    }
+    return FALSE;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -32,7 +32,6 @@
 
 #include "nfc_peer_p.h"
 #include "nfc_llc.h"
-#include "nfc_llc_param.h"
 #include "nfc_peer_services.h"
 #include "nfc_snep_server.h"
 #include "nfc_ndef.h"
@@ -474,7 +473,6 @@ nfc_peer_init_base(
        !memcmp(gb->bytes, LLCP_MAGIC, sizeof(LLCP_MAGIC))) {
         NfcPeerPriv* priv = self->priv;
         GUtilData tlvs;
-        NfcLlcParam** params;
         NfcLlc* llc;
 
         GDEBUG("NFC-DEP %s", (flags & NFC_PEER_FLAG_INITIATOR) ?
@@ -486,17 +484,14 @@ nfc_peer_init_base(
 
         tlvs.bytes = gb->bytes + sizeof(LLCP_MAGIC);
         tlvs.size = gb->size - sizeof(LLCP_MAGIC);
-        params = nfc_llc_param_decode(&tlvs);
         nfc_peer_services_add(priv->services, NFC_PEER_SERVICE(priv->snep));
-        priv->llc = llc = nfc_llc_new(llc_io, priv->services,
-            nfc_llc_param_constify(params));
+        priv->llc = llc = nfc_llc_new_tlvs(llc_io, priv->services, &tlvs);
         priv->llc_event_id[LLC_EVENT_STATE] =
             nfc_llc_add_state_changed_handler(llc,
                 nfc_peer_llc_state_changed, self);
         priv->llc_event_id[LLC_EVENT_WKS] =
             nfc_llc_add_wks_changed_handler(llc,
                 nfc_peer_wks_changed, self);
-        nfc_llc_param_free(params);
         self->wks = llc->wks;
         self->technology = technology;
         self->flags = flags;
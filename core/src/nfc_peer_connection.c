@@ -386,42 +386,63 @@ nfc_peer_connection_ps(
     return &self->priv->ps;
 }
 
+void
+nfc_peer_connection_apply_remote_param(
+    NfcPeerConnection* self,
+    const NfcLlcParam* param)
+{
+    NfcPeerConnectionLlcpState* ps = &self->priv->ps;
+
+    switch (param->type) {
+    case NFC_LLC_PARAM_MIUX:
+        ps->rmiu = param->value.miu;
+        GDEBUG("  MIU(R): %u bytes", ps->rmiu);
+        break;
+    case NFC_LLC_PARAM_RW:
+        ps->rwr = param->value.rw;
+        GDEBUG("  RW(R): %u", ps->rwr);
+        /* The rest is irrelevant */
+        /* fallthrough */
+    case NFC_LLC_PARAM_VERSION:
+    case NFC_LLC_PARAM_WKS:
+    case NFC_LLC_PARAM_LTO:
+    case NFC_LLC_PARAM_SN:
+    case NFC_LLC_PARAM_OPT:
+    case NFC_LLC_PARAM_SDREQ:
+    case NFC_LLC_PARAM_SDRES:
+        break;
+    }
+}
+
 void
 nfc_peer_connection_apply_remote_params(
     NfcPeerConnection* self,
     const NfcLlcParam* const* params)
 {
     if (G_LIKELY(params)) {
-        NfcPeerConnectionPriv* priv = self->priv;
-        NfcPeerConnectionLlcpState* ps = &priv->ps;
         const NfcLlcParam* const* ptr = params;
 
         while (*ptr) {
-            const NfcLlcParam* param = *ptr++;
-
-            switch (param->type) {
-            case NFC_LLC_PARAM_MIUX:
-                ps->rmiu = param->value.miu;
-                GDEBUG("  MIU(R): %u bytes", ps->rmiu);
-                break;
-            case NFC_LLC_PARAM_RW:
-                ps->rwr = param->value.rw;
-                GDEBUG("  RW(R): %u", ps->rwr);
-                /* The rest is irrelevant */
-                /* fallthrough */
-            case NFC_LLC_PARAM_VERSION:
-            case NFC_LLC_PARAM_WKS:
-            case NFC_LLC_PARAM_LTO:
-            case NFC_LLC_PARAM_SN:
-            case NFC_LLC_PARAM_OPT:
-            case NFC_LLC_PARAM_SDREQ:
-            case NFC_LLC_PARAM_SDRES:
-                break;
-            }
+            nfc_peer_connection_apply_remote_param(self, *ptr++);
         }
     }
 }
 
+void
+nfc_peer_connection_apply_remote_tlvs(
+    NfcPeerConnection* self,
+    const void* tlvs,
+    guint size)
+{
+    const NfcLlcParam* param;
+    NfcLlcParamIter iter;
+
+    nfc_llc_param_iter_init(&iter, tlvs, size);
+    while ((param = nfc_llc_param_iter_next(&iter)) != NULL) {
+        nfc_peer_connection_apply_remote_param(self, param);
+    }
+}
+
 void
 nfc_peer_connection_accept(
     NfcPeerConnection* self)
@@ -80,12 +80,25 @@ nfc_peer_connection_ps(
     NfcPeerConnection* pc)
     NFCD_INTERNAL;
 
+void
+nfc_peer_connection_apply_remote_param(
+    NfcPeerConnection* pc,
+    const NfcLlcParam* param)
+    NFCD_INTERNAL;
+
 void
 nfc_peer_connection_apply_remote_params(
     NfcPeerConnection* pc,
     const NfcLlcParam* const* params)
     NFCD_INTERNAL;
 
+void
+nfc_peer_connection_apply_remote_tlvs(
+    NfcPeerConnection* pc,
+    const void* tlvs,
+    guint size)
+    NFCD_INTERNAL;
+
 void
 nfc_peer_connection_set_state(
     NfcPeerConnection* pc,
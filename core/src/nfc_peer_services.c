@@ -261,6 +261,15 @@ gboolean
 nfc_peer_services_add(
     NfcPeerServices* services,
     NfcPeerService* ps)
+{
+    return nfc_peer_services_add2(services, ps, 0);
+}
+
+gboolean
+nfc_peer_services_add2(
+    NfcPeerServices* services,
+    NfcPeerService* ps,
+    guint8 want_sap)
 {
     NfcPeerServicesObject* self = nfc_peer_services_cast(services);
 
@@ -299,9 +308,19 @@ nfc_peer_services_add(
             sap_max = NFC_LLC_SAP_MAX;
         }
 
-        for (sap = sap_min;
-             sap <= sap_max && (self->sap_mask & SAP_BIT(sap));
-             sap++);
+        if (want_sap) {
+            /* Specific SAP must be in the right range and not taken */
+            if (want_sap >= sap_min && want_sap <= sap_max &&
+                !(self->sap_mask & SAP_BIT(want_sap))) {
+                sap = want_sap;
+            } else {
+                return FALSE;
+            }
+        } else {
+            for (sap = sap_min;
+                 sap <= sap_max && (self->sap_mask & SAP_BIT(sap));
+                 sap++);
+        }
 
         if (sap <= sap_max) {
             ps->sap = sap;
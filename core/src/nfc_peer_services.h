@@ -77,6 +77,14 @@ nfc_peer_services_add(
     NfcPeerService* service)
     NFCD_INTERNAL;
 
+/* Zero SAP means any available one, same as nfc_peer_services_add() */
+gboolean
+nfc_peer_services_add2(
+    NfcPeerServices* services,
+    NfcPeerService* service,
+    guint8 sap)
+    NFCD_INTERNAL;
+
 gboolean
 nfc_peer_services_remove(
     NfcPeerServices* services,
@@ -0,0 +1,399 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "nfc_program.h"
+#include "nfc_tag_t4_p.h"
+#include "nfc_target_p.h"
+#include "nfc_log.h"
+
+#define NFC_PROGRAM_STEP_NAME(step) ((step)->name ? (step)->name : "Step")
+
+/*==========================================================================*
+ * Implementation
+ *==========================================================================*/
+
+static
+void
+nfc_program_exec(
+    NfcProgram* prog);
+
+static
+guint
+nfc_program_src(
+    NfcProgram* prog,
+    const NfcProgramStep* step)
+{
+    return (step->b && step->b < NFC_PROGRAM_VAR_COUNT) ?
+        prog->var[step->b] : step->imm;
+}
+
+static
+guint
+nfc_program_dest(
+    NfcProgram* prog,
+    const NfcProgramStep* step)
+{
+    return (step->a && step->a <= NFC_PROGRAM_VARS) ? prog->var[step->a] : 0;
+}
+
+static
+void
+nfc_program_set(
+    NfcProgram* prog,
+    guint var,
+    guint value)
+{
+    /* Variables past NFC_PROGRAM_VARS are read-only */
+    if (var && var <= NFC_PROGRAM_VARS) {
+        prog->var[var] = value;
+    } else {
+        GWARN("Invalid program variable %u", var);
+    }
+}
+
+static
+gboolean
+nfc_program_patch(
+    NfcProgram* prog,
+    GByteArray* cmd,
+    const NfcProgramField* field)
+{
+    if (field->size) {
+        if (field->size <= 4 && field->offset + field->size <= cmd->len &&
+            field->var && field->var < NFC_PROGRAM_VAR_COUNT) {
+            guint value = prog->var[field->var];
+            guint8* ptr = cmd->data + field->offset + field->size;
+            guint i;
+
+            for (i = 0; i < field->size; i++) {
+                *(--ptr) = (guint8)value;
+                value >>= 8;
+            }
+        } else {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static
+gboolean
+nfc_program_capture(
+    NfcProgram* prog,
+    const guint8* data,
+    guint len,
+    const NfcProgramField* field)
+{
+    if (field->size) {
+        if (field->size <= 4 && field->offset + field->size <= len) {
+            const guint8* ptr = data + field->offset;
+            guint value = 0;
+            guint i;
+
+            for (i = 0; i < field->size; i++) {
+                value = (value << 8) | ptr[i];
+            }
+            nfc_program_set(prog, field->var, value);
+        } else {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static
+gboolean
+nfc_program_match(
+    NfcProgram* prog,
+    const NfcProgramStep* step,
+    guint sw,
+    const guint8* data,
+    guint len)
+{
+    const char* name = NFC_PROGRAM_STEP_NAME(step);
+
+    if (step->op == NFC_PROGRAM_OP_APDU &&
+        sw != (step->sw ? step->sw : ISO_SW_OK)) {
+        GDEBUG("%s error %04X", name, sw);
+    } else if (len < step->min_len || (step->max_len && len > step->max_len)) {
+        GDEBUG("%s: unexpected response length %u", name, len);
+    } else if (!nfc_program_capture(prog, data, len, step->capture + 0) ||
+        !nfc_program_capture(prog, data, len, step->capture + 1)) {
+        GDEBUG("%s: response too short (%u)", name, len);
+    } else {
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static
+void
+nfc_program_resp(
+    NfcTarget* target,
+    NFC_TRANSMIT_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data)
+{
+    NfcProgram* prog = user_data;
+    const NfcProgramStep* step = prog->steps + prog->pc;
+    const char* name = NFC_PROGRAM_STEP_NAME(step);
+
+    prog->tx_id = 0;
+    prog->var[NFC_PROGRAM_VAR_SW] = ISO_SW_IO_ERR;
+    prog->var[NFC_PROGRAM_VAR_LEN] = 0;
+    if (status == NFC_TRANSMIT_STATUS_OK) {
+        guint sw = ISO_SW_IO_ERR;
+
+        if (step->op == NFC_PROGRAM_OP_APDU) {
+            if (len >= 2) {
+                const guint8* sw_bytes = ((guint8*)data) + len - 2;
+
+                sw = (((guint)sw_bytes[0]) << 8) | sw_bytes[1];
+                len -= 2;
+            } else {
+                GWARN("%s: response too short, %u bytes(s)", name, len);
+                status = NFC_TRANSMIT_STATUS_ERROR;
+            }
+        }
+        if (status == NFC_TRANSMIT_STATUS_OK) {
+            prog->var[NFC_PROGRAM_VAR_SW] = sw;
+            prog->var[NFC_PROGRAM_VAR_LEN] = len;
+            prog->resp = data;
+            if (step->alt_sw && sw == step->alt_sw) {
+                GDEBUG("%s status %04X", name, sw);
+                prog->pc = step->alt;
+            } else if (nfc_program_match(prog, step, sw, data, len)) {
+                if (step->flags & NFC_PROGRAM_FLAG_APPEND) {
+                    g_byte_array_append(prog->data, data, len);
+                }
+                prog->pc++;
+            } else {
+                prog->pc = step->fail;
+            }
+        }
+    }
+    if (status != NFC_TRANSMIT_STATUS_OK) {
+        GDEBUG("%s I/O error", name);
+        prog->pc = step->fail;
+    }
+    nfc_program_exec(prog);
+}
+
+static
+gboolean
+nfc_program_transmit(
+    NfcProgram* prog,
+    const NfcProgramStep* step)
+{
+    GByteArray* cmd = prog->cmd;
+
+    g_byte_array_set_size(cmd, 0);
+    g_byte_array_append(cmd, step->cmd.bytes, step->cmd.size);
+    if (nfc_program_patch(prog, cmd, step->patch + 0) &&
+        nfc_program_patch(prog, cmd, step->patch + 1)) {
+        GByteArray* buf = cmd;
+
+        if (step->op == NFC_PROGRAM_OP_APDU) {
+            const guint8* apdu = cmd->data;
+
+            /* The template starts with CLA INS P1 P2 followed by data */
+            buf = prog->apdu;
+            if (cmd->len < 4 || !nfc_tag_t4_build_apdu(buf, apdu[0],
+                apdu[1], apdu[2], apdu[3], cmd->len - 4, apdu + 4,
+                nfc_program_src(prog, step))) {
+                return FALSE;
+            }
+        }
+        prog->tx_id = nfc_target_transmit(prog->target, buf->data, buf->len,
+            prog->seq, nfc_program_resp, NULL, prog);
+        return prog->tx_id != 0;
+    }
+    return FALSE;
+}
+
+static
+void
+nfc_program_finish(
+    NfcProgram* prog,
+    guint result)
+{
+    /* The program may get deinitialized by the callback */
+    prog->resp = NULL;
+    prog->pc = prog->count;
+    prog->done(prog, result, prog->user_data);
+}
+
+static
+void
+nfc_program_exec(
+    NfcProgram* prog)
+{
+    while (prog->pc < prog->count) {
+        const NfcProgramStep* step = prog->steps + prog->pc;
+
+        switch (step->op) {
+        case NFC_PROGRAM_OP_EXIT:
+            nfc_program_finish(prog, step->imm);
+            return;
+        case NFC_PROGRAM_OP_TRANSMIT:
+        case NFC_PROGRAM_OP_APDU:
+            prog->resp = NULL;
+            if (nfc_program_transmit(prog, step)) {
+                return;
+            }
+            GDEBUG("%s failed to transmit", NFC_PROGRAM_STEP_NAME(step));
+            prog->var[NFC_PROGRAM_VAR_SW] = ISO_SW_IO_ERR;
+            prog->var[NFC_PROGRAM_VAR_LEN] = 0;
+            prog->pc = step->fail;
+            break;
+        case NFC_PROGRAM_OP_SET:
+            nfc_program_set(prog, step->a, nfc_program_src(prog, step));
+            prog->pc++;
+            break;
+        case NFC_PROGRAM_OP_ADD:
+            nfc_program_set(prog, step->a, nfc_program_dest(prog, step) +
+                nfc_program_src(prog, step));
+            prog->pc++;
+            break;
+        case NFC_PROGRAM_OP_SUB:
+            {
+                const guint a = nfc_program_dest(prog, step);
+                const guint b = nfc_program_src(prog, step);
+
+                nfc_program_set(prog, step->a, (a > b) ? (a - b) : 0);
+                prog->pc++;
+            }
+            break;
+        case NFC_PROGRAM_OP_MIN:
+            nfc_program_set(prog, step->a, MIN(nfc_program_dest(prog, step),
+                nfc_program_src(prog, step)));
+            prog->pc++;
+            break;
+        case NFC_PROGRAM_OP_GOTO:
+            prog->pc = step->fail;
+            break;
+        case NFC_PROGRAM_OP_JZ:
+            if (nfc_program_dest(prog, step)) {
+                prog->pc++;
+            } else {
+                prog->pc = step->fail;
+            }
+            break;
+        case NFC_PROGRAM_OP_JLT:
+            if (nfc_program_dest(prog, step) < nfc_program_src(prog, step)) {
+                prog->pc = step->fail;
+            } else {
+                prog->pc++;
+            }
+            break;
+        case NFC_PROGRAM_OP_CALL:
+            if (prog->hook && prog->hook(prog, step->imm, prog->user_data)) {
+                prog->pc++;
+            } else {
+                prog->pc = step->fail;
+            }
+            break;
+        default:
+            GWARN("Invalid program step %u", prog->pc);
+            prog->pc = prog->count;
+            break;
+        }
+    }
+
+    /* Running past the last step is the same as EXIT with zero result */
+    nfc_program_finish(prog, 0);
+}
+
+/*==========================================================================*
+ * Internal interface
+ *==========================================================================*/
+
+void
+nfc_program_init(
+    NfcProgram* prog,
+    const NfcProgramStep* steps,
+    guint count,
+    NfcProgramHookFunc hook,
+    void* user_data)
+{
+    memset(prog, 0, sizeof(*prog));
+    prog->steps = steps;
+    prog->count = count;
+    prog->hook = hook;
+    prog->user_data = user_data;
+    prog->data = g_byte_array_new();
+    prog->cmd = g_byte_array_sized_new(16);
+    prog->apdu = g_byte_array_sized_new(16);
+}
+
+void
+nfc_program_deinit(
+    NfcProgram* prog)
+{
+    if (prog->tx_id) {
+        nfc_target_cancel_transmit(prog->target, prog->tx_id);
+        prog->tx_id = 0;
+    }
+    if (prog->data) {
+        g_byte_array_free(prog->data, TRUE);
+        g_byte_array_free(prog->cmd, TRUE);
+        g_byte_array_free(prog->apdu, TRUE);
+    }
+    memset(prog, 0, sizeof(*prog));
+}
+
+void
+nfc_program_run(
+    NfcProgram* prog,
+    NfcTarget* target,
+    NfcTargetSequence* seq,
+    NfcProgramDoneFunc done)
+{
+    GASSERT(!prog->tx_id);
+    GASSERT(done);
+    memset(prog->var, 0, sizeof(prog->var));
+    g_byte_array_set_size(prog->data, 0);
+    prog->target = target;
+    prog->seq = seq;
+    prog->done = done;
+    prog->pc = 0;
+    nfc_program_exec(prog);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
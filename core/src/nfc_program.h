@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef NFC_PROGRAM_H
+#define NFC_PROGRAM_H
+
+#include "nfc_types_p.h"
+
+/*
+ * A small engine running multi-step card dialogues described by a
+ * static array of steps. All steps run inside one NfcTargetSequence.
+ * Command templates can be patched with variables before sending,
+ * responses can be checked (status word and length), captured into
+ * variables and appended to the data buffer. Jumps give branches and
+ * loops. The engine reuses its buffers, nothing is allocated per step.
+ *
+ * Variables are numbered from 1 to NFC_PROGRAM_VARS. Zero in place of
+ * a source variable means that the immediate value is used instead.
+ * Two more read-only variables hold the length (sans status word) and
+ * the status word of the last response.
+ */
+
+#define NFC_PROGRAM_VARS (12)
+#define NFC_PROGRAM_VAR_LEN (NFC_PROGRAM_VARS + 1)
+#define NFC_PROGRAM_VAR_SW (NFC_PROGRAM_VARS + 2)
+#define NFC_PROGRAM_VAR_COUNT (NFC_PROGRAM_VARS + 3)
+
+typedef enum nfc_program_op {
+    NFC_PROGRAM_OP_EXIT,      /* Complete with imm as the result */
+    NFC_PROGRAM_OP_TRANSMIT,  /* Send cmd as is, after patching */
+    NFC_PROGRAM_OP_APDU,      /* Send cmd (CLA INS P1 P2 data) as APDU */
+    NFC_PROGRAM_OP_SET,       /* var[a] = src */
+    NFC_PROGRAM_OP_ADD,       /* var[a] += src */
+    NFC_PROGRAM_OP_SUB,       /* var[a] -= src (not below zero) */
+    NFC_PROGRAM_OP_MIN,       /* var[a] = MIN(var[a], src) */
+    NFC_PROGRAM_OP_GOTO,      /* Jump to step fail */
+    NFC_PROGRAM_OP_JZ,        /* Jump to step fail if var[a] is zero */
+    NFC_PROGRAM_OP_JLT,       /* Jump to step fail if var[a] < src */
+    NFC_PROGRAM_OP_CALL       /* Jump to step fail if hook(imm) fails */
+} NFC_PROGRAM_OP;
+
+typedef enum nfc_program_flags {
+    NFC_PROGRAM_FLAGS_NONE = 0x00,
+    NFC_PROGRAM_FLAG_APPEND = 0x01  /* Append response to data buffer */
+} NFC_PROGRAM_FLAGS;
+
+typedef struct nfc_program_field {
+    guint8 offset;  /* Offset in the command or response */
+    guint8 size;    /* Big-endian, 1 to 4 bytes, zero if unused */
+    guint8 var;     /* Variable number */
+} NfcProgramField;
+
+/*
+ * TRANSMIT and APDU steps continue with the next step if the response
+ * matches (status word equals sw or 9000 if sw is zero, length is
+ * within min_len..max_len, max_len of zero meaning no limit). If the
+ * status word equals alt_sw (if non-zero), the program continues at
+ * step alt. Otherwise (including I/O errors) it jumps to step fail.
+ * Le of an APDU is taken from src. TRANSMIT steps never get a status
+ * word, their responses only have to match the length.
+ */
+typedef struct nfc_program_step {
+    NFC_PROGRAM_OP op;
+    const char* name;           /* For diagnostics, may be NULL */
+    GUtilData cmd;              /* Command template */
+    NfcProgramField patch[2];   /* Applied to the command */
+    NfcProgramField capture[2]; /* Extracted from the response */
+    guint8 a;                   /* Destination variable */
+    guint8 b;                   /* Source variable, zero for imm */
+    guint imm;                  /* Immediate operand */
+    guint sw;                   /* Expected status word */
+    guint alt_sw;               /* Alternative status word */
+    guint alt;                  /* Step to run on alt_sw */
+    guint fail;                 /* Step to run on mismatch */
+    guint min_len;
+    guint max_len;
+    NFC_PROGRAM_FLAGS flags;
+} NfcProgramStep;
+
+typedef struct nfc_program NfcProgram;
+
+/* Returns FALSE to make CALL jump to its fail step */
+typedef
+gboolean
+(*NfcProgramHookFunc)(
+    NfcProgram* prog,
+    guint id,
+    void* user_data);
+
+typedef
+void
+(*NfcProgramDoneFunc)(
+    NfcProgram* prog,
+    guint result,
+    void* user_data);
+
+/* Usually embedded into something else, hence not opaque */
+struct nfc_program {
+    const NfcProgramStep* steps;
+    guint count;
+    guint pc;
+    guint var[NFC_PROGRAM_VAR_COUNT];
+    const guint8* resp;     /* Last response, valid during hooks */
+    GByteArray* data;       /* Appended responses */
+    GByteArray* cmd;
+    GByteArray* apdu;
+    NfcTarget* target;
+    NfcTargetSequence* seq;
+    guint tx_id;
+    NfcProgramHookFunc hook;
+    NfcProgramDoneFunc done;
+    void* user_data;
+};
+
+void
+nfc_program_init(
+    NfcProgram* prog,
+    const NfcProgramStep* steps,
+    guint count,
+    NfcProgramHookFunc hook,
+    void* user_data)
+    NFCD_INTERNAL;
+
+/* Safe to call on a zeroed structure, cancels the pending transmission */
+void
+nfc_program_deinit(
+    NfcProgram* prog)
+    NFCD_INTERNAL;
+
+/*
+ * Runs the program from the first step. The done callback may be
+ * invoked before this returns. The program is not touched after the
+ * done callback has been invoked, so it's OK to deinit it there.
+ */
+void
+nfc_program_run(
+    NfcProgram* prog,
+    NfcTarget* target,
+    NfcTargetSequence* seq,
+    NfcProgramDoneFunc done)
+    NFCD_INTERNAL;
+
+#endif /* NFC_PROGRAM_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -37,6 +37,7 @@
 #include "nfc_peer_service_p.h"
 #include "nfc_ndef.h"
 #include "nfc_llc.h"
+#include "nfc_timer.h"
 
 #define GLOG_MODULE_NAME NFC_SNEP_LOG_MODULE
 #include <gutil_log.h>
@@ -73,10 +74,20 @@ typedef enum snep_response_code {
 #define SNEP_MAJOR_VERSION (1)
 #define SNEP_VERSION (0x10) /* (MAJOR << 4) | MINOR */
 
+/*
+ * The connection is kept open after a successful Put, in case if the
+ * client has more to send. If nothing arrives within this time, we
+ * disconnect.
+ */
+#define SNEP_IDLE_TIMEOUT_MS (1000)
+#define SNEP_IDLE_TIMEOUT_SLACK_MS (100)
+
 typedef struct nfc_snep_server_connection {
     NfcPeerConnection connection;
-    GByteArray* buf;
+    GByteArray* buf;            /* Reused by subsequent requests */
+    gboolean receiving;         /* Waiting for more fragments */
     guint ndef_length;
+    guint idle_timer;
 } NfcSnepServerConnection;
 
 typedef NfcPeerConnectionClass NfcSnepServerConnectionClass;
@@ -167,6 +178,43 @@ nfc_snep_server_update_connection_count(
  * Connection
  *==========================================================================*/
 
+static
+gboolean
+nfc_snep_server_connection_idle_timeout(
+    gpointer user_data)
+{
+    NfcSnepServerConnection* self = NFC_SNEP_SERVER_CONNECTION(user_data);
+
+    GDEBUG("SNEP connection idle, disconnecting");
+    self->idle_timer = 0;
+    nfc_peer_connection_disconnect(&self->connection);
+    return G_SOURCE_REMOVE;
+}
+
+static
+void
+nfc_snep_server_connection_stop_idle_timer(
+    NfcSnepServerConnection* self)
+{
+    if (self->idle_timer) {
+        nfc_timer_remove(self->idle_timer);
+        self->idle_timer = 0;
+    }
+}
+
+static
+void
+nfc_snep_server_connection_start_idle_timer(
+    NfcSnepServerConnection* self)
+{
+    nfc_snep_server_connection_stop_idle_timer(self);
+    if (self->connection.state == NFC_LLC_CO_ACTIVE) {
+        self->idle_timer = nfc_timer_add(SNEP_IDLE_TIMEOUT_MS,
+            SNEP_IDLE_TIMEOUT_SLACK_MS,
+            nfc_snep_server_connection_idle_timeout, self);
+    }
+}
+
 static
 void
 nfc_snep_server_connection_receive_ndef(
@@ -202,8 +250,19 @@ nfc_snep_server_connection_receive_ndef(
             }
             nfc_ndef_rec_unref(prev_ndef);
 
-            /* Done, terminate the connection */
-            nfc_peer_connection_disconnect(conn);
+            /*
+             * NFCForum-TS-SNEP_1.0
+             * 5.2. Success
+             *
+             * The server successfully processed a client request.
+             *
+             * Keep the connection (and the buffer) for the next
+             * request, the client disconnects when it's done.
+             */
+            g_byte_array_set_size(buf, 0);
+            self->receiving = FALSE;
+            nfc_snep_server_response(conn, SNEP_RESPONSE_SUCCESS);
+            nfc_snep_server_connection_start_idle_timer(self);
         }
     }
 }
@@ -217,7 +276,8 @@ nfc_snep_server_connection_data_received(
 {
     NfcSnepServerConnection* self = NFC_SNEP_SERVER_CONNECTION(conn);
 
-    if (self->buf) {
+    nfc_snep_server_connection_stop_idle_timer(self);
+    if (self->receiving) {
         /* Receiving fragmented message */
         nfc_snep_server_connection_receive_ndef(self, data, len);
     } else if (len >= 6) {
@@ -270,9 +330,14 @@ nfc_snep_server_connection_data_received(
                 (((guint32)pkt[4]) << 8) |
                 ((guint32)pkt[5]);
             GDEBUG("NDEF Put %u bytes", self->ndef_length);
-            self->buf = g_byte_array_sized_new(self->ndef_length);
+            if (self->buf) {
+                g_byte_array_set_size(self->buf, 0);
+            } else {
+                self->buf = g_byte_array_sized_new(self->ndef_length);
+            }
+            self->receiving = TRUE;
             nfc_snep_server_connection_receive_ndef(self, pkt + 6, len - 6);
-            if (self->buf->len < self->ndef_length) {
+            if (self->receiving) {
                 /*
                  * 5.1. Continue
                  *
@@ -294,6 +359,23 @@ nfc_snep_server_connection_data_received(
     }
 }
 
+static
+void
+nfc_snep_server_connection_state_changed(
+    NfcPeerConnection* conn)
+{
+    NfcSnepServerConnection* self = NFC_SNEP_SERVER_CONNECTION(conn);
+
+    if (conn->state == NFC_LLC_CO_ACTIVE) {
+        /* Wait for the first request */
+        nfc_snep_server_connection_start_idle_timer(self);
+    } else {
+        nfc_snep_server_connection_stop_idle_timer(self);
+    }
+    NFC_PEER_CONNECTION_CLASS(nfc_snep_server_connection_parent_class)->
+        state_changed(conn);
+}
+
 static
 void
 nfc_snep_server_connection_init(
@@ -309,6 +391,7 @@ nfc_snep_server_connection_finalize(
     NfcSnepServerConnection* self = NFC_SNEP_SERVER_CONNECTION(object);
     NfcSnepServer* snep = NFC_SNEP_SERVER(self->connection.service);
 
+    nfc_snep_server_connection_stop_idle_timer(self);
     nfc_snep_server_update_connection_count(snep, -1);
     if (self->buf) {
         g_byte_array_free(self->buf, TRUE);
@@ -321,6 +404,7 @@ void
 nfc_snep_server_connection_class_init(
     NfcSnepServerConnectionClass* klass)
 {
+    klass->state_changed = nfc_snep_server_connection_state_changed;
     klass->data_received = nfc_snep_server_connection_data_received;
     G_OBJECT_CLASS(klass)->finalize = nfc_snep_server_connection_finalize;
 }
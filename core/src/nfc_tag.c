@@ -130,6 +130,13 @@ nfc_tag_deactivate(
     }
 }
 
+guint
+nfc_tag_cache_size(
+    NfcTag* self) /* Since 1.1.19 */
+{
+    return G_LIKELY(self) ? GET_THIS_CLASS(self)->cache_size(self) : 0;
+}
+
 gulong
 nfc_tag_add_initialized_handler(
     NfcTag* self,
@@ -275,6 +282,15 @@ nfc_tag_default_gone(
     g_signal_emit(self, nfc_tag_signals[SIGNAL_GONE], 0);
 }
 
+static
+guint
+nfc_tag_default_cache_size(
+    NfcTag* self)
+{
+    /* Generic tags don't cache anything */
+    return 0;
+}
+
 /*==========================================================================*
  * Internals
  *==========================================================================*/
@@ -310,6 +326,7 @@ nfc_tag_class_init(
 {
     g_type_class_add_private(klass, sizeof(NfcTagPriv));
     klass->gone = nfc_tag_default_gone;
+    klass->cache_size = nfc_tag_default_cache_size;
     G_OBJECT_CLASS(klass)->finalize = nfc_tag_finalize;
     nfc_tag_signals[SIGNAL_INITIALIZED] =
         g_signal_new(SIGNAL_INITIALIZED_NAME, G_OBJECT_CLASS_TYPE(klass),
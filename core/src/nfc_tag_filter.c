@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "nfc_tag_filter.h"
+#include "nfc_log.h"
+
+#include <gutil_misc.h>
+
+struct nfc_tag_filters {
+    gint refcount;
+    guint count;
+    NfcTagFilter* list;
+    guint8* uids;       /* Storage for all UID prefixes */
+};
+
+/*==========================================================================*
+ * Implementation
+ *==========================================================================*/
+
+static
+gboolean
+nfc_tag_filter_match(
+    const NfcTagFilter* filter,
+    NFC_TECHNOLOGY technology,
+    NFC_PROTOCOL protocol,
+    const GUtilData* uid,
+    const guint8* sel_res)
+{
+    const guint8 mask = filter->sel_res_mask;
+    const GUtilData* prefix = &filter->uid_prefix;
+
+    return (!filter->technology || (filter->technology & technology)) &&
+        (!filter->protocol || (filter->protocol & protocol)) &&
+        (!mask || (sel_res && (*sel_res & mask) == (filter->sel_res & mask)))
+        && (!prefix->size || (uid && uid->size >= prefix->size &&
+        !memcmp(uid->bytes, prefix->bytes, prefix->size)));
+}
+
+/*==========================================================================*
+ * Internal interface
+ *==========================================================================*/
+
+NfcTagFilters*
+nfc_tag_filters_new(
+    const NfcTagFilter* filters,
+    guint count)
+{
+    if (filters && count) {
+        NfcTagFilters* self = g_slice_new0(NfcTagFilters);
+        gsize total = 0;
+        guint8* ptr;
+        guint i;
+
+        g_atomic_int_set(&self->refcount, 1);
+        self->count = count;
+        self->list = gutil_memdup(filters, sizeof(filters[0]) * count);
+        for (i = 0; i < count; i++) {
+            total += filters[i].uid_prefix.size;
+        }
+
+        /* Deep copy of the prefixes, all in one block */
+        ptr = self->uids = total ? g_malloc(total) : NULL;
+        for (i = 0; i < count; i++) {
+            GUtilData* prefix = &self->list[i].uid_prefix;
+
+            if (prefix->size) {
+                memcpy(ptr, prefix->bytes, prefix->size);
+                prefix->bytes = ptr;
+                ptr += prefix->size;
+            } else {
+                prefix->bytes = NULL;
+            }
+        }
+        return self;
+    }
+    return NULL;
+}
+
+NfcTagFilters*
+nfc_tag_filters_ref(
+    NfcTagFilters* self)
+{
+    if (G_LIKELY(self)) {
+        GASSERT(self->refcount > 0);
+        g_atomic_int_inc(&self->refcount);
+    }
+    return self;
+}
+
+void
+nfc_tag_filters_unref(
+    NfcTagFilters* self)
+{
+    if (G_LIKELY(self)) {
+        GASSERT(self->refcount > 0);
+        if (g_atomic_int_dec_and_test(&self->refcount)) {
+            g_free(self->list);
+            g_free(self->uids);
+            g_slice_free(NfcTagFilters, self);
+        }
+    }
+}
+
+NFC_TAG_FILTER_ACTION
+nfc_tag_filters_check(
+    const NfcTagFilters* self,
+    NFC_TECHNOLOGY technology,
+    NFC_PROTOCOL protocol,
+    const NfcParamPoll* poll)
+{
+    if (self) {
+        const GUtilData* uid = NULL;
+        const guint8* sel_res = NULL;
+        guint i;
+
+        /* UID and SAK, if the poll parameters have them */
+        if (poll) {
+            switch (technology) {
+            case NFC_TECHNOLOGY_A:
+                uid = &poll->a.nfcid1;
+                sel_res = &poll->a.sel_res;
+                break;
+            case NFC_TECHNOLOGY_B:
+                uid = &poll->b.nfcid0;
+                break;
+            case NFC_TECHNOLOGY_F:
+                uid = &poll->f.nfcid2;
+                break;
+            case NFC_TECHNOLOGY_UNKNOWN:
+                break;
+            }
+        }
+
+        /* The first match wins */
+        for (i = 0; i < self->count; i++) {
+            const NfcTagFilter* filter = self->list + i;
+
+            if (nfc_tag_filter_match(filter, technology, protocol, uid,
+                sel_res)) {
+                return filter->action;
+            }
+        }
+    }
+    return NFC_TAG_FILTER_ACCEPT;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
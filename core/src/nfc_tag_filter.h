@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef NFC_TAG_FILTER_H
+#define NFC_TAG_FILTER_H
+
+#include "nfc_types_p.h"
+
+/*
+ * Immutable reference counted copy of the tag filter list. It's
+ * shared by the manager and the adapters and replaced as a whole
+ * when the configuration changes. NULL means no filtering.
+ */
+
+typedef struct nfc_tag_filters NfcTagFilters;
+
+NfcTagFilters*
+nfc_tag_filters_new(
+    const NfcTagFilter* filters,
+    guint count)
+    NFCD_INTERNAL;
+
+NfcTagFilters*
+nfc_tag_filters_ref(
+    NfcTagFilters* filters)
+    NFCD_INTERNAL;
+
+void
+nfc_tag_filters_unref(
+    NfcTagFilters* filters)
+    NFCD_INTERNAL;
+
+NFC_TAG_FILTER_ACTION
+nfc_tag_filters_check(
+    const NfcTagFilters* filters,
+    NFC_TECHNOLOGY technology,
+    NFC_PROTOCOL protocol,
+    const NfcParamPoll* poll)
+    NFCD_INTERNAL;
+
+#endif /* NFC_TAG_FILTER_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -40,6 +40,7 @@
 typedef struct nfc_tag_class {
     GObjectClass parent;
     void (*gone)(NfcTag* tag);
+    guint (*cache_size)(NfcTag* tag);
 } NfcTagClass;
 
 #define NFC_TAG_CLASS(klass) G_TYPE_CHECK_CLASS_CAST((klass), \
@@ -51,12 +52,26 @@ nfc_tag_new(
     const NfcParamPoll* poll)
     NFCD_INTERNAL;
 
+NfcTagType1*
+nfc_tag_t1_new(
+    NfcTarget* target,
+    const NfcParamPollA* poll_a,
+    NFC_TAG_READ_POLICY policy)
+    NFCD_INTERNAL;
+
 NfcTagType2*
 nfc_tag_t2_new(
     NfcTarget* target,
     const NfcParamPollA* poll_a)
     NFCD_INTERNAL;
 
+NfcTagType2*
+nfc_tag_t2_new2(
+    NfcTarget* target,
+    const NfcParamPollA* poll_a,
+    NFC_TAG_READ_POLICY policy)
+    NFCD_INTERNAL;
+
 void
 nfc_tag_init_base(
     NfcTag* tag,
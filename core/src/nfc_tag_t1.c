@@ -0,0 +1,751 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "nfc_tag_p.h"
+#include "nfc_tag_t1.h"
+#include "nfc_target_p.h"
+#include "nfc_ndef.h"
+#include "nfc_util.h"
+#include "nfc_tlv.h"
+#include "nfc_log.h"
+
+/*
+ * NFCForum-TS-Type-1-Tag_1.2
+ * Section 2 "Memory Structure and Management"
+ */
+#define NFC_TAG_T1_BLOCK_SIZE (8)
+#define NFC_TAG_T1_SEGMENT_BLOCKS (16)
+#define NFC_TAG_T1_STATIC_BLOCKS (15)   /* Blocks 00h..0Eh, read by RALL */
+#define NFC_TAG_T1_STATIC_SIZE (NFC_TAG_T1_STATIC_BLOCKS * \
+        NFC_TAG_T1_BLOCK_SIZE)
+#define NFC_TAG_T1_CC (8)               /* Bytes 8..11 */
+#define NFC_TAG_T1_DATA_START (12)
+#define NFC_TAG_T1_RESERVED_START (104) /* Blocks 0Dh..0Fh */
+#define NFC_TAG_T1_RESERVED_END (128)
+
+#define NFC_TAG_T1_CC_NFC_FORUM_MAGIC (0xe1)
+#define NFC_TAG_T1_CC_MAJOR_VERSION (0x10)
+#define NFC_TAG_T1_CC_MAJOR_VERSION_MASK (0xf0)
+
+#define NFC_TAG_T1_HR0_NDEF (0x10)
+#define NFC_TAG_T1_HR0_NDEF_MASK (0xf0)
+#define NFC_TAG_T1_HR0_STATIC (0x11)
+
+/*
+ * Command set.
+ *
+ * NFCForum-TS-DigitalProtocol-1.0
+ * Section 8 "Type 1 Tag Platform"
+ */
+#define NFC_TAG_T1_CMD_RALL (0x00)
+#define NFC_TAG_T1_CMD_READ8 (0x02)
+#define NFC_TAG_T1_CMD_RSEG (0x10)
+#define NFC_TAG_T1_CMD_RID (0x78)
+
+#define NFC_TAG_T1_HR_LEN (2)   /* HR0 and HR1 */
+#define NFC_TAG_T1_UID_LEN (4)  /* UID0..UID3 */
+
+typedef struct nfc_tag_t1_cache {
+    guint size;             /* Number of bytes in the tag memory */
+    guint8* bytes;          /* Memory contents (not necessarily valid) */
+    guint8* valid;          /* One bit per block, 1 = cached */
+    guint8* reserved;       /* One bit per byte, 1 = not in the data area */
+} NfcTagType1Cache;
+
+struct nfc_tag_t1_priv {
+    NfcTargetSequence* init_seq;
+    NfcTagType1Cache cache;
+    GByteArray* data;       /* Contiguous cached part of the data area */
+    NFC_TAG_READ_POLICY read_policy;
+    guint8 uid[NFC_TAG_T1_UID_LEN];
+    guint8 read_cmd;        /* RSEG or READ8 being executed */
+    guint8 read_addr;       /* ADDS or ADD8 */
+    guint init_id;
+};
+
+typedef struct nfc_tag_t1_class {
+    NfcTagClass parent;
+} NfcTagType1Class;
+
+#define THIS(obj) NFC_TAG_T1(obj)
+#define THIS_TYPE NFC_TYPE_TAG_T1
+#define PARENT_TYPE NFC_TYPE_TAG
+#define PARENT_CLASS nfc_tag_t1_parent_class
+
+G_DEFINE_TYPE(NfcTagType1, nfc_tag_t1, PARENT_TYPE)
+
+/*==========================================================================*
+ * Cache
+ *==========================================================================*/
+
+static
+void
+nfc_tag_t1_cache_init(
+    NfcTagType1Cache* cache,
+    guint size)
+{
+    /* The whole thing is at most 2K, allocate it upfront */
+    cache->size = size;
+    cache->bytes = g_malloc0(size);
+    cache->valid = g_malloc0((size / NFC_TAG_T1_BLOCK_SIZE + 7) / 8);
+    cache->reserved = g_malloc0((size + 7) / 8);
+}
+
+static
+void
+nfc_tag_t1_cache_deinit(
+    NfcTagType1Cache* cache)
+{
+    g_free(cache->bytes);
+    g_free(cache->valid);
+    g_free(cache->reserved);
+}
+
+static
+gboolean
+nfc_tag_t1_cache_valid(
+    const NfcTagType1Cache* cache,
+    guint block)
+{
+    return (cache->valid[block / 8] & (1 << (block % 8))) != 0;
+}
+
+static
+gboolean
+nfc_tag_t1_cache_reserved(
+    const NfcTagType1Cache* cache,
+    guint addr)
+{
+    return (cache->reserved[addr / 8] & (1 << (addr % 8))) != 0;
+}
+
+static
+void
+nfc_tag_t1_cache_set_blocks(
+    NfcTagType1Cache* cache,
+    guint block,
+    const guint8* data,
+    guint count)
+{
+    const guint total = cache->size / NFC_TAG_T1_BLOCK_SIZE;
+
+    /* Ignore blocks beyond the end of memory */
+    if (block < total) {
+        guint i;
+
+        count = MIN(count, total - block);
+        memcpy(cache->bytes + block * NFC_TAG_T1_BLOCK_SIZE, data,
+            count * NFC_TAG_T1_BLOCK_SIZE);
+        for (i = block; i < block + count; i++) {
+            cache->valid[i / 8] |= (1 << (i % 8));
+        }
+    }
+}
+
+static
+void
+nfc_tag_t1_cache_reserve(
+    NfcTagType1Cache* cache,
+    guint addr,
+    guint nbytes)
+{
+    const guint end = MIN(addr + nbytes, cache->size);
+    guint i;
+
+    for (i = addr; i < end; i++) {
+        cache->reserved[i / 8] |= (1 << (i % 8));
+    }
+}
+
+static
+guint
+nfc_tag_t1_cache_data_addr(
+    const NfcTagType1Cache* cache,
+    guint offset)
+{
+    /* Maps data area offset to the memory address, size if none */
+    guint addr;
+
+    for (addr = 0; addr < cache->size; addr++) {
+        if (!nfc_tag_t1_cache_reserved(cache, addr) && !(offset--)) {
+            break;
+        }
+    }
+    return addr;
+}
+
+static
+guint
+nfc_tag_t1_cache_data_size(
+    const NfcTagType1Cache* cache)
+{
+    guint addr, size = 0;
+
+    for (addr = 0; addr < cache->size; addr++) {
+        if (!nfc_tag_t1_cache_reserved(cache, addr)) {
+            size++;
+        }
+    }
+    return size;
+}
+
+static
+void
+nfc_tag_t1_cache_data(
+    const NfcTagType1Cache* cache,
+    GByteArray* out)
+{
+    /* Collects the data area up to the first block not yet read */
+    guint addr;
+
+    g_byte_array_set_size(out, 0);
+    for (addr = 0; addr < cache->size; addr++) {
+        if (!nfc_tag_t1_cache_reserved(cache, addr)) {
+            if (!nfc_tag_t1_cache_valid(cache, addr / NFC_TAG_T1_BLOCK_SIZE)) {
+                break;
+            }
+            g_byte_array_append(out, cache->bytes + addr, 1);
+        }
+    }
+}
+
+/*==========================================================================*
+ * TLV
+ *==========================================================================*/
+
+static
+guint
+nfc_tag_t1_tlv_missing(
+    const GUtilData* data)
+{
+    /*
+     * Returns the minimum number of bytes missing from the end of
+     * the TLV sequence, zero if TLV_TERMINATOR has been found.
+     */
+    GUtilData buf = *data;
+    GUtilData value;
+
+    while (nfc_tlv_next(&buf, &value) > 0);
+    if (buf.bytes > data->bytes && buf.bytes[-1] == TLV_TERMINATOR) {
+        return 0;
+    } else if (buf.size < 2) {
+        /* Terminator or the L field */
+        return 1;
+    } else if (buf.bytes[1] == 0xff && buf.size < 4) {
+        /* Three-byte L field */
+        return 4 - buf.size;
+    } else {
+        const guint lsize = (buf.bytes[1] == 0xff) ? 3 : 1;
+        const guint len = (lsize == 3) ?
+            ((((guint)buf.bytes[2]) << 8) | buf.bytes[3]) : buf.bytes[1];
+
+        /* The rest of the V field followed by the terminator */
+        return 1 + lsize + len - buf.size + 1;
+    }
+}
+
+static
+void
+nfc_tag_t1_control_tlv_reserve(
+    NfcTagType1Cache* cache,
+    guint type,
+    const GUtilData* value)
+{
+    /*
+     * NFCForum-TS-Type-1-Tag_1.2
+     * Section 2.3.1 "Lock Control TLV" and 2.3.2 "Memory Control TLV"
+     *
+     * Byte 0: PageAddr (bits 7..4) and ByteOffset (bits 3..0)
+     * Byte 1: Size (number of lock bits or reserved bytes, 0 means 256)
+     * Byte 2: BytesLockedPerLockBit (bits 7..4), BytesPerPage (bits 3..0)
+     */
+    if (value->size == 3) {
+        const guint8* v = value->bytes;
+        const guint addr = (v[0] >> 4) * (1 << (v[2] & 0x0f)) + (v[0] & 0x0f);
+        const guint size = v[1] ? v[1] : 256;
+        const guint nbytes = (type == TLV_LOCK_CONTROL) ?
+            ((size + 7) / 8) : size;
+
+        GDEBUG("%s area: %u byte(s) at %u", (type == TLV_LOCK_CONTROL) ?
+            "Lock" : "Reserved", nbytes, addr);
+        nfc_tag_t1_cache_reserve(cache, addr, nbytes);
+    }
+}
+
+/*==========================================================================*
+ * Initialization
+ *==========================================================================*/
+
+static
+void
+nfc_tag_t1_initialized(
+    NfcTagType1* self)
+{
+    NfcTagType1Priv* priv = self->priv;
+    NfcTag* tag = &self->tag;
+
+    if (priv->init_seq) {
+        nfc_target_sequence_unref(priv->init_seq);
+        priv->init_seq = NULL;
+    }
+    nfc_tag_set_initialized(tag);
+}
+
+static
+guint
+nfc_tag_t1_init_cmd(
+    NfcTagType1* self,
+    guint8 cmd,
+    guint8 addr,
+    guint datalen,
+    NfcTargetTransmitFunc resp)
+{
+    NfcTagType1Priv* priv = self->priv;
+    guint8 buf[2 + NFC_TAG_T1_BLOCK_SIZE + NFC_TAG_T1_UID_LEN];
+
+    /*
+     * NFCForum-TS-DigitalProtocol-1.0
+     * Section 8.6 "Command Set"
+     *
+     * CMD | ADD | DATA (1 or 8 bytes, zeros for reads) | UID0..UID3
+     *
+     * UID is zero for RID (it's not known yet).
+     */
+    buf[0] = cmd;
+    buf[1] = addr;
+    memset(buf + 2, 0, datalen);
+    memcpy(buf + 2 + datalen, priv->uid, NFC_TAG_T1_UID_LEN);
+    return nfc_target_transmit(self->tag.target, buf,
+        2 + datalen + NFC_TAG_T1_UID_LEN, priv->init_seq, resp, NULL, self);
+}
+
+static
+void
+nfc_tag_t1_init_read_resp(
+    NfcTarget* target,
+    NFC_TRANSMIT_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data);
+
+static
+void
+nfc_tag_t1_init_read(
+    NfcTagType1* self,
+    guint first,
+    guint last)
+{
+    NfcTagType1Priv* priv = self->priv;
+
+    /*
+     * READ8 reads one block, RSEG reads the whole 128-byte segment.
+     * Either way it's one exchange, but there's no point in fetching
+     * 128 bytes when we only need a few.
+     */
+    if (first == last) {
+        GDEBUG("Reading block %u", first);
+        priv->read_cmd = NFC_TAG_T1_CMD_READ8;
+        priv->read_addr = first;
+    } else {
+        GDEBUG("Reading segment %u", first / NFC_TAG_T1_SEGMENT_BLOCKS);
+        priv->read_cmd = NFC_TAG_T1_CMD_RSEG;
+        priv->read_addr = (first / NFC_TAG_T1_SEGMENT_BLOCKS) << 4;
+    }
+    priv->init_id = nfc_tag_t1_init_cmd(self, priv->read_cmd, priv->read_addr,
+        NFC_TAG_T1_BLOCK_SIZE, nfc_tag_t1_init_read_resp);
+}
+
+static
+void
+nfc_tag_t1_init_next(
+    NfcTagType1* self)
+{
+    NfcTagType1Priv* priv = self->priv;
+    NfcTagType1Cache* cache = &priv->cache;
+    const guint total = cache->size / NFC_TAG_T1_BLOCK_SIZE;
+    GUtilData data;
+
+    nfc_tag_t1_cache_data(cache, priv->data);
+    data.bytes = priv->data->data;
+    data.size = priv->data->len;
+
+    if (priv->read_policy == NFC_TAG_READ_FULL) {
+        guint first;
+
+        /* Fetch the first segment which hasn't been entirely read */
+        for (first = 0; first < total &&
+             nfc_tag_t1_cache_valid(cache, first); first++);
+        if (first < total) {
+            const guint end = MIN(total, (first / NFC_TAG_T1_SEGMENT_BLOCKS
+                + 1) * NFC_TAG_T1_SEGMENT_BLOCKS);
+            guint last = first, i;
+
+            for (i = first + 1; i < end; i++) {
+                if (!nfc_tag_t1_cache_valid(cache, i)) {
+                    last = i;
+                }
+            }
+            nfc_tag_t1_init_read(self, first, last);
+        }
+    } else {
+        const guint missing = nfc_tag_t1_tlv_missing(&data);
+
+        /* Stop reading when we have fetched the entire TLV sequence */
+        if (missing) {
+            const guint start = nfc_tag_t1_cache_data_addr(cache, data.size);
+
+            if (start < cache->size) {
+                const guint end = nfc_tag_t1_cache_data_addr(cache,
+                    data.size + missing - 1);
+
+                nfc_tag_t1_init_read(self, start / NFC_TAG_T1_BLOCK_SIZE,
+                    MIN(end, cache->size - 1) / NFC_TAG_T1_BLOCK_SIZE);
+            }
+        }
+    }
+
+    if (!priv->init_id) {
+        NfcTag* tag = &self->tag;
+
+        GDEBUG("Tag data:");
+        nfc_hexdump_data(&data);
+        tag->ndef = nfc_ndef_rec_new_tlv(&data);
+        nfc_tag_t1_initialized(self);
+    }
+}
+
+static
+void
+nfc_tag_t1_init_read_resp(
+    NfcTarget* target,
+    NFC_TRANSMIT_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data)
+{
+    NfcTagType1* self = THIS(user_data);
+    NfcTagType1Priv* priv = self->priv;
+    const guint8* bytes = data;
+    const guint count = (priv->read_cmd == NFC_TAG_T1_CMD_RSEG) ?
+        NFC_TAG_T1_SEGMENT_BLOCKS : 1;
+
+    /* Response is ADDS or ADD8 followed by the data */
+    priv->init_id = 0;
+    if (status == NFC_TRANSMIT_STATUS_OK &&
+        len == (1 + count * NFC_TAG_T1_BLOCK_SIZE) &&
+        bytes[0] == priv->read_addr) {
+        const guint block = (count == 1) ? priv->read_addr :
+            ((priv->read_addr >> 4) * NFC_TAG_T1_SEGMENT_BLOCKS);
+
+        nfc_tag_t1_cache_set_blocks(&priv->cache, block, bytes + 1, count);
+        nfc_tag_t1_init_next(self);
+    } else {
+        GDEBUG("Failed to read Type 1 tag, giving up");
+        nfc_tag_t1_initialized(self);
+    }
+}
+
+static
+void
+nfc_tag_t1_init_rall_resp(
+    NfcTarget* target,
+    NFC_TRANSMIT_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data)
+{
+    NfcTagType1* self = THIS(user_data);
+    NfcTagType1Priv* priv = self->priv;
+
+    priv->init_id = 0;
+    if (status == NFC_TRANSMIT_STATUS_OK &&
+        len == (NFC_TAG_T1_HR_LEN + NFC_TAG_T1_STATIC_SIZE)) {
+        const guint8* bytes = data;
+        const guint8* mem = bytes + NFC_TAG_T1_HR_LEN;
+        const guint8* cc = mem + NFC_TAG_T1_CC;
+
+        /*
+         * RALL response:
+         *
+         * Bytes 0..1   - HR0 and HR1
+         * Bytes 2..121 - Blocks 00h..0Eh
+         */
+        self->hr0 = bytes[0];
+        self->hr1 = bytes[1];
+        GDEBUG("HR0 %02X HR1 %02X", self->hr0, self->hr1);
+        GDEBUG("Internal data:");
+        nfc_hexdump(mem, NFC_TAG_T1_DATA_START);
+
+        if ((self->hr0 & NFC_TAG_T1_HR0_NDEF_MASK) == NFC_TAG_T1_HR0_NDEF &&
+            cc[0] == NFC_TAG_T1_CC_NFC_FORUM_MAGIC &&
+            (cc[1] & NFC_TAG_T1_CC_MAJOR_VERSION_MASK) ==
+            NFC_TAG_T1_CC_MAJOR_VERSION) {
+            NfcTagType1Cache* cache = &priv->cache;
+            GUtilData buf, value;
+            guint type, size = NFC_TAG_T1_STATIC_SIZE;
+
+            if (self->hr0 != NFC_TAG_T1_HR0_STATIC) {
+                /* TMS is the memory size in blocks minus one */
+                size = MAX((cc[2] + 1) * NFC_TAG_T1_BLOCK_SIZE, size);
+                self->t1flags |= NFC_TAG_T1_FLAG_DYNAMIC_MEMORY;
+            }
+
+            GDEBUG("Memory size: %u bytes", size);
+            nfc_tag_t1_cache_init(cache, size);
+            nfc_tag_t1_cache_set_blocks(cache, 0, mem,
+                NFC_TAG_T1_STATIC_BLOCKS);
+            nfc_tag_t1_cache_reserve(cache, 0, NFC_TAG_T1_DATA_START);
+            nfc_tag_t1_cache_reserve(cache, NFC_TAG_T1_RESERVED_START,
+                NFC_TAG_T1_RESERVED_END - NFC_TAG_T1_RESERVED_START);
+
+            /* Control TLVs (if any) precede NDEF */
+            nfc_tag_t1_cache_data(cache, priv->data);
+            buf.bytes = priv->data->data;
+            buf.size = priv->data->len;
+            while ((type = nfc_tlv_next(&buf, &value)) > 0 &&
+                type != TLV_NDEF_MESSAGE) {
+                if (type == TLV_LOCK_CONTROL || type == TLV_MEMORY_CONTROL) {
+                    nfc_tag_t1_control_tlv_reserve(cache, type, &value);
+                }
+            }
+
+            self->data_size = nfc_tag_t1_cache_data_size(cache);
+            self->t1flags |= NFC_TAG_T1_FLAG_NFC_FORUM_COMPATIBLE;
+            GDEBUG("Data size: %u bytes", self->data_size);
+            nfc_tag_t1_init_next(self);
+        } else {
+            GDEBUG("Tag is not NFC Forum compatible");
+            nfc_tag_t1_initialized(self);
+        }
+    } else {
+        GDEBUG("Failed to read Type 1 tag memory, giving up");
+        nfc_tag_t1_initialized(self);
+    }
+}
+
+static
+void
+nfc_tag_t1_init_rid_resp(
+    NfcTarget* target,
+    NFC_TRANSMIT_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data)
+{
+    NfcTagType1* self = THIS(user_data);
+    NfcTagType1Priv* priv = self->priv;
+
+    /* RID response: HR0, HR1 and UID0..UID3 */
+    priv->init_id = 0;
+    if (status == NFC_TRANSMIT_STATUS_OK &&
+        len == (NFC_TAG_T1_HR_LEN + NFC_TAG_T1_UID_LEN)) {
+        const guint8* bytes = data;
+
+        memcpy(priv->uid, bytes + NFC_TAG_T1_HR_LEN, NFC_TAG_T1_UID_LEN);
+        self->uid.bytes = priv->uid;
+        self->uid.size = NFC_TAG_T1_UID_LEN;
+        priv->init_id = nfc_tag_t1_init_cmd(self, NFC_TAG_T1_CMD_RALL, 0, 1,
+            nfc_tag_t1_init_rall_resp);
+    } else {
+        GDEBUG("Failed to read Type 1 tag id, giving up");
+    }
+    if (!priv->init_id) {
+        nfc_tag_t1_initialized(self);
+    }
+}
+
+/*==========================================================================*
+ * Internal interface
+ *==========================================================================*/
+
+NfcTagType1*
+nfc_tag_t1_new(
+    NfcTarget* target,
+    const NfcParamPollA* poll_a,
+    NFC_TAG_READ_POLICY policy)
+{
+    if (G_LIKELY(target)) {
+        NfcTagType1* self = g_object_new(THIS_TYPE, NULL);
+        NfcTagType1Priv* priv = self->priv;
+        NfcTag* tag = &self->tag;
+
+        GDEBUG("Type 1 tag");
+        if (poll_a) {
+            NfcParamPoll poll;
+
+            memset(&poll, 0, sizeof(poll));
+            poll.a = *poll_a;
+            nfc_tag_init_base(tag, target, &poll);
+
+            /* NFCID1 of a Type 1 Tag is UID0..UID3 */
+            if (poll_a->nfcid1.size >= NFC_TAG_T1_UID_LEN) {
+                memcpy(priv->uid, poll_a->nfcid1.bytes, NFC_TAG_T1_UID_LEN);
+                self->uid.bytes = priv->uid;
+                self->uid.size = NFC_TAG_T1_UID_LEN;
+            }
+        } else {
+            nfc_tag_init_base(tag, target, NULL);
+        }
+
+        priv->init_seq = nfc_target_sequence_new(target);
+        priv->read_policy = (policy == NFC_TAG_READ_DEFAULT) ?
+            NFC_TAG_READ_NDEF : policy;
+        if (priv->read_policy == NFC_TAG_READ_NONE) {
+            GDEBUG("Not reading the tag");
+        } else if (self->uid.size) {
+            /* RALL is supported by both static and dynamic tags */
+            priv->init_id = nfc_tag_t1_init_cmd(self, NFC_TAG_T1_CMD_RALL,
+                0, 1, nfc_tag_t1_init_rall_resp);
+        } else {
+            /* RALL needs UID */
+            priv->init_id = nfc_tag_t1_init_cmd(self, NFC_TAG_T1_CMD_RID,
+                0, 1, nfc_tag_t1_init_rid_resp);
+        }
+        if (!priv->init_id) {
+            nfc_tag_t1_initialized(self);
+        }
+        return self;
+    }
+    return NULL;
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+NFC_TAG_T1_IO_STATUS
+nfc_tag_t1_read_data_sync(
+    NfcTagType1* self,
+    guint offset,
+    guint nbytes,
+    void* buffer) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self) && (self->tag.flags & NFC_TAG_FLAG_INITIALIZED) &&
+        self->data_size) {
+        const NfcTagType1Cache* cache = &self->priv->cache;
+
+        if (offset > self->data_size || nbytes > self->data_size - offset) {
+            return NFC_TAG_T1_IO_STATUS_BAD_SIZE;
+        } else {
+            const guint start = nfc_tag_t1_cache_data_addr(cache, offset);
+            guint8* out = buffer;
+            guint addr, n;
+
+            /* Check the range first, then copy */
+            for (addr = start, n = nbytes; n > 0; addr++) {
+                if (!nfc_tag_t1_cache_reserved(cache, addr)) {
+                    if (!nfc_tag_t1_cache_valid(cache, addr /
+                        NFC_TAG_T1_BLOCK_SIZE)) {
+                        return NFC_TAG_T1_IO_STATUS_NOT_CACHED;
+                    }
+                    n--;
+                }
+            }
+            if (out) {
+                for (addr = start, n = nbytes; n > 0; addr++) {
+                    if (!nfc_tag_t1_cache_reserved(cache, addr)) {
+                        *out++ = cache->bytes[addr];
+                        n--;
+                    }
+                }
+            }
+            return NFC_TAG_T1_IO_STATUS_OK;
+        }
+    }
+    return NFC_TAG_T1_IO_STATUS_FAILURE;
+}
+
+/*==========================================================================*
+ * Methods
+ *==========================================================================*/
+
+static
+guint
+nfc_tag_t1_cache_size(
+    NfcTag* tag)
+{
+    const NfcTagType1Cache* cache = &THIS(tag)->priv->cache;
+
+    /* Contents plus valid and reserved bitmaps */
+    return cache->bytes ? (cache->size +
+        (cache->size / NFC_TAG_T1_BLOCK_SIZE + 7) / 8 +
+        (cache->size + 7) / 8) : 0;
+}
+
+/*==========================================================================*
+ * Internals
+ *==========================================================================*/
+
+static
+void
+nfc_tag_t1_init(
+    NfcTagType1* self)
+{
+    NfcTagType1Priv* priv = G_TYPE_INSTANCE_GET_PRIVATE(self, THIS_TYPE,
+        NfcTagType1Priv);
+
+    self->priv = priv;
+    priv->data = g_byte_array_new();
+}
+
+static
+void
+nfc_tag_t1_finalize(
+    GObject* object)
+{
+    NfcTagType1* self = THIS(object);
+    NfcTagType1Priv* priv = self->priv;
+
+    nfc_target_cancel_transmit(self->tag.target, priv->init_id);
+    nfc_target_sequence_unref(priv->init_seq);
+    nfc_tag_t1_cache_deinit(&priv->cache);
+    g_byte_array_free(priv->data, TRUE);
+    G_OBJECT_CLASS(PARENT_CLASS)->finalize(object);
+}
+
+static
+void
+nfc_tag_t1_class_init(
+    NfcTagType1Class* klass)
+{
+    g_type_class_add_private(klass, sizeof(NfcTagType1Priv));
+    NFC_TAG_CLASS(klass)->cache_size = nfc_tag_t1_cache_size;
+    G_OBJECT_CLASS(klass)->finalize = nfc_tag_t1_finalize;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
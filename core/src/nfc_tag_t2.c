@@ -49,6 +49,18 @@
 
 #define NFC_TAG_T2_CC_NFC_FORUM_MAGIC (0xe1)
 #define NFC_TAG_T2_CC_MIN_VERSION (0x10)
+#define NFC_TAG_T2_CC_WRITE_ACCESS_MASK (0x0f)
+
+/*
+ * NFCForum-TS-Type-2-Tag_1.1
+ * Section 2.2.1 "Static Lock Bytes" and 2.2.2 "Dynamic Lock Bytes"
+ */
+#define NFC_TAG_T2_STATIC_LOCK0 (10)
+#define NFC_TAG_T2_STATIC_LOCK1 (11)
+#define NFC_TAG_T2_STATIC_LOCK_CC (0x08)
+#define NFC_TAG_T2_STATIC_LOCK_END (64) /* Bytes 16..63 */
+#define NFC_TAG_T2_DEFAULT_BYTES_PER_LOCK_BIT (8)
+#define NFC_TAG_T2_CACHE_PAGE (64) /* Sector cache allocation unit */
 
 #define NXP_MANUFACTURER_ID (0x04)
 
@@ -83,16 +95,51 @@ typedef struct nfc_tag_t2_read_data {
     void* user_data;
 } NfcTagType2ReadData;
 
+typedef enum nfc_tag_t2_tx_step_type {
+    NFC_TAG_T2_TX_STEP_ZERO,    /* Zero (part of) NDEF length */
+    NFC_TAG_T2_TX_STEP_DATA,    /* Write a data block */
+    NFC_TAG_T2_TX_STEP_COMMIT   /* Write (part of) the final NDEF length */
+} NFC_TAG_T2_TX_STEP_TYPE;
+
+typedef struct nfc_tag_t2_tx_step {
+    NFC_TAG_T2_TX_STEP_TYPE type;
+    guint index;            /* Block index within the image */
+} NfcTagType2TxStep;
+
+typedef struct nfc_tag_t2_tx {
+    GBytes* uid;            /* Journal key */
+    guint len_pos;          /* Position of NDEF length in the image */
+    guint len_size;         /* 1 or 3 bytes */
+    GArray* steps;          /* NfcTagType2TxStep */
+    guint step;
+} NfcTagType2Tx;
+
+typedef struct nfc_tag_t2_journal_entry {
+    GBytes* image;          /* What's being written */
+    guint8* pending;        /* One bit per image block, 1 = not written */
+    gboolean zeroed;        /* NDEF length has been zeroed */
+} NfcTagType2JournalEntry;
+
+/* UID => NfcTagType2JournalEntry, survives the tag objects */
+static GHashTable* nfc_tag_t2_journal = NULL;
+#define NFC_TAG_T2_JOURNAL_MAX_ENTRIES (8)
+
 typedef struct nfc_tag_t2_write_data {
     NfcTagType2* t2;
+    NfcTagType2Tx* tx;
     GBytes* bytes;
     guint sector_number;
     guint offset;
     guint written;
+    guint verified;
     guint cmd_id;
     guint seq_id;
     gulong start_id;
     NfcTargetSequence* seq;
+    NFC_TAG_T2_WRITE_FLAGS flags;
+    void (*start)(struct nfc_tag_t2_write_data* write);
+    guint8* lock_bytes;     /* Dynamic lock bytes being fetched */
+    guint lock_fetched;     /* Number of lock bytes fetched */
     union nfc_tag_t2_write_data_complete {
         GCallback cb;
         NfcTagType2WriteFunc write_cb;
@@ -104,11 +151,27 @@ typedef struct nfc_tag_t2_write_data {
 
 typedef struct nfc_tag_t2_sector {
     guint size;             /* Number of bytes in the sector */
+    guint alloc;            /* Number of bytes allocated (whole pages) */
     guint8* bytes;          /* Sector's contents (not necessarily valid) */
     guint8* valid;          /* One bit per block, 1 = cached, 0 = dirty */
+    guint8* locked;         /* One bit per block, 1 = write protected */
+    guint8* reserved;       /* One bit per block, 1 = lock/reserved bytes */
     GUtilData data;         /* Data portion of the sector */
 } NfcTagType2Sector;
 
+/*
+ * Dynamic lock bits (NFCForum-TS-Type-2-Tag_1.1, section 2.2.2)
+ * live outside of the data area, typically right after it. Unless
+ * they happen to be cached, they get fetched before the first data
+ * write rather than at initialization.
+ */
+typedef struct nfc_tag_t2_dyn_lock {
+    guint addr;             /* Byte address of the first lock byte */
+    guint bits;             /* Number of lock bits */
+    guint bytes_per_bit;    /* Number of bytes locked by one bit */
+    gboolean pending;       /* Lock bits haven't been fetched yet */
+} NfcTagType2DynLock;
+
 struct nfc_tag_t2_priv {
     NfcTargetSequence* init_seq;
     GHashTable* reads;
@@ -116,6 +179,8 @@ struct nfc_tag_t2_priv {
     GByteArray* cached_blocks;
     guint sector_count;
     NfcTagType2Sector* sectors;
+    NfcTagType2DynLock dyn_lock;
+    NFC_TAG_READ_POLICY read_policy;
     guint init_id;
 };
 
@@ -178,13 +243,52 @@ nfc_tag_t2_sector_init(
 {
     const guint total_blocks = header_blocks + data_blocks + trailer_blocks;
 
+    /*
+     * Only the first page of the cache is allocated upfront, the rest
+     * grows as the data gets read. Typically only the NDEF is.
+     */
     sector->size = total_blocks * block_size;
-    sector->bytes = g_malloc0(sector->size);
+    sector->alloc = MIN(sector->size, NFC_TAG_T2_CACHE_PAGE);
+    sector->bytes = g_malloc0(sector->alloc);
     sector->valid = g_malloc0((total_blocks + 7) / 8);
+    sector->locked = g_malloc0((total_blocks + 7) / 8);
+    sector->reserved = g_malloc0((total_blocks + 7) / 8);
     sector->data.bytes = sector->bytes + (header_blocks * block_size);
     sector->data.size = data_blocks * block_size;
 }
 
+static
+void
+nfc_tag_t2_sector_reserve(
+    NfcTagType2Sector* sector,
+    guint end)
+{
+    /* Makes sure that bytes [0..end) are allocated, zeros the new pages */
+    if (end > sector->alloc) {
+        const guint header = sector->data.bytes - sector->bytes;
+        const guint alloc = MIN(sector->size, (end + NFC_TAG_T2_CACHE_PAGE -
+            1) / NFC_TAG_T2_CACHE_PAGE * NFC_TAG_T2_CACHE_PAGE);
+
+        sector->bytes = g_realloc(sector->bytes, alloc);
+        memset(sector->bytes + sector->alloc, 0, alloc - sector->alloc);
+        sector->alloc = alloc;
+        sector->data.bytes = sector->bytes + header;
+    }
+}
+
+static
+void
+nfc_tag_t2_sector_cached_data(
+    const NfcTagType2Sector* sector,
+    GUtilData* data)
+{
+    /* The allocated part of the data area, the rest is known to be zero */
+    const guint header = sector->data.bytes - sector->bytes;
+
+    data->bytes = sector->data.bytes;
+    data->size = MIN(sector->data.size, sector->alloc - header);
+}
+
 static
 void
 nfc_tag_t2_sector_deinit(
@@ -192,6 +296,92 @@ nfc_tag_t2_sector_deinit(
 {
     g_free(sector->bytes);
     g_free(sector->valid);
+    g_free(sector->locked);
+    g_free(sector->reserved);
+}
+
+static
+void
+nfc_tag_t2_sector_mark_blocks(
+    NfcTagType2Sector* sector,
+    guint8* bits,
+    guint block_size,
+    guint offset,
+    guint nbytes)
+{
+    /* Marks the blocks overlapping with the range of bytes */
+    if (nbytes && offset < sector->size) {
+        const guint last = (MIN(offset + nbytes, sector->size) - 1) /
+            block_size;
+        guint i;
+
+        for (i = offset / block_size; i <= last; i++) {
+            bits[i / 8] |= (1 << (i % 8));
+        }
+    }
+}
+
+static
+gboolean
+nfc_tag_t2_sector_check_blocks(
+    const guint8* bits,
+    guint block,
+    guint num_blocks)
+{
+    /* Returns TRUE if any of the blocks is marked */
+    guint i;
+
+    for (i = block; i < block + num_blocks; i++) {
+        if (bits[i / 8] & (1 << (i % 8))) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static
+gboolean
+nfc_tag_t2_write_protected(
+    NfcTagType2Sector* sector,
+    guint block_size,
+    guint block,
+    guint num_blocks,
+    gboolean data)
+{
+    const guint total_blocks = sector->size / block_size;
+
+    if (block < total_blocks) {
+        if (block + num_blocks > total_blocks) {
+            num_blocks = total_blocks - block;
+        }
+        /* Lock bytes and reserved areas are only protected from data
+         * writes, primitive writes are allowed to touch those. */
+        if (nfc_tag_t2_sector_check_blocks(sector->locked, block,
+            num_blocks) || (data && nfc_tag_t2_sector_check_blocks(
+            sector->reserved, block, num_blocks))) {
+            GDEBUG("Block(s) %u..%u are write protected", block,
+                block + num_blocks - 1);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static
+gboolean
+nfc_tag_t2_data_write_protected(
+    NfcTagType2* self,
+    guint offset,
+    guint nbytes)
+{
+    const guint block_size = self->block_size;
+    guint block;
+    NfcTagType2Sector* sector = nfc_tag_t2_data_block_to_sector(self,
+        offset / block_size, &block, NULL);
+
+    return sector && nbytes && nfc_tag_t2_write_protected(sector, block_size,
+        block, (offset % block_size + nbytes + block_size - 1) / block_size,
+        TRUE);
 }
 
 static
@@ -212,6 +402,7 @@ nfc_tag_t2_sector_set_data(
             num_blocks = total_blocks - block;
         }
 
+        nfc_tag_t2_sector_reserve(sector, (block + num_blocks) * block_size);
         memcpy(sector->bytes + block * block_size, bytes,
             num_blocks * block_size);
 
@@ -240,7 +431,8 @@ nfc_tag_t2_sector_invalidate(
             num_blocks = total_blocks - block;
         }
 
-        memset(sector->bytes + block, 0, num_blocks * block_size);
+        nfc_tag_t2_sector_reserve(sector, (block + num_blocks) * block_size);
+        memset(sector->bytes + block * block_size, 0, num_blocks * block_size);
 
         /* Mark blocks as invalid */
         for (i = 0; i < num_blocks; i++) {
@@ -508,6 +700,18 @@ nfc_tag_t2_write_data_free(
     if (write->destroy) {
         write->destroy(write->user_data);
     }
+    if (write->tx) {
+        NfcTagType2Tx* tx = write->tx;
+
+        if (tx->steps) {
+            g_array_free(tx->steps, TRUE);
+        }
+        if (tx->uid) {
+            g_bytes_unref(tx->uid);
+        }
+        g_slice_free(NfcTagType2Tx, tx);
+    }
+    g_free(write->lock_bytes);
     g_bytes_unref(write->bytes);
     g_slice_free(NfcTagType2WriteData, write);
 }
@@ -548,23 +752,33 @@ nfc_tag_t2_write_data_new(
 
 static
 void
-nfc_tag_t2_write_data_error(
-    NfcTagType2WriteData* write)
+nfc_tag_t2_write_data_done(
+    NfcTagType2WriteData* write,
+    NFC_TAG_T2_IO_STATUS status,
+    guint written)
 {
     NfcTagType2* t2 = write->t2;
     NfcTagType2Priv* priv = t2->priv;
     NfcTagType2WriteDataFunc complete = write->complete.write_data_cb;
 
-    GDEBUG("Wrote %u bytes out of %u", write->written, (guint)
-        g_bytes_get_size(write->bytes));
     if (complete) {
         write->complete.write_cb = NULL;
-        complete(write->t2, NFC_TAG_T2_IO_STATUS_IO_ERROR, write->written,
-            write->user_data);
+        complete(write->t2, status, written, write->user_data);
     }
     g_hash_table_remove(priv->writes, GUINT_TO_POINTER(write->seq_id));
 }
 
+static
+void
+nfc_tag_t2_write_data_error(
+    NfcTagType2WriteData* write)
+{
+    GDEBUG("Wrote %u bytes out of %u", write->written, (guint)
+        g_bytes_get_size(write->bytes));
+    nfc_tag_t2_write_data_done(write, NFC_TAG_T2_IO_STATUS_IO_ERROR,
+        write->written);
+}
+
 static
 void
 nfc_tag_t2_write_resp(
@@ -685,6 +899,92 @@ nfc_tag_t2_write_data_fetch_resp(
     nfc_tag_unref(tag);
 }
 
+static
+void
+nfc_tag_t2_write_data_verify_resp(
+    NfcTagType2* t2,
+    NFC_TRANSMIT_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data);
+
+static
+guint
+nfc_tag_t2_write_data_verify_next(
+    NfcTagType2WriteData* write)
+{
+    NfcTagType2* t2 = write->t2;
+    guint block;
+
+    /* Each READ returns 4 blocks, the next one starts where we stopped */
+    nfc_tag_t2_data_block_to_sector(t2, (write->offset + write->verified) /
+        t2->block_size, &block, NULL);
+    return nfc_tag_t2_cmd_read(t2, block, write->seq,
+        nfc_tag_t2_write_data_verify_resp, NULL, write);
+}
+
+static
+void
+nfc_tag_t2_write_data_verify_resp(
+    NfcTagType2* t2,
+    NFC_TRANSMIT_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data)
+{
+    NfcTagType2WriteData* write = user_data;
+    NfcTag* tag = &t2->tag;
+    const guint block_size = t2->block_size;
+
+    write->cmd_id = 0;
+    nfc_tag_ref(tag);
+    if (status == NFC_TRANSMIT_STATUS_OK && len >= block_size) {
+        gsize total_size;
+        const guint8* expected = g_bytes_get_data(write->bytes, &total_size);
+        const guint8* bytes = data;
+        const guint pos = write->offset + write->verified;
+        const guint block_offset = pos % block_size;
+        guint i, n, block;
+        NfcTagType2Sector* sector = nfc_tag_t2_data_block_to_sector(t2,
+            pos / block_size, &block, NULL);
+
+        /* That's what the tag actually holds */
+        nfc_tag_t2_sector_set_data(sector, block_size, bytes, block,
+            len / block_size);
+
+        /* Compare the part which overlaps with the written range */
+        n = MIN(len - len % block_size - block_offset,
+            total_size - write->verified);
+        bytes += block_offset;
+        expected += write->verified;
+        for (i = 0; i < n && bytes[i] == expected[i]; i++);
+        write->verified += i;
+
+        if (i < n) {
+            GDEBUG("Verification failed at offset %u", write->offset +
+                write->verified);
+            nfc_tag_t2_write_data_done(write,
+                NFC_TAG_T2_IO_STATUS_VERIFY_FAILED, write->verified);
+        } else if (write->verified < total_size) {
+            write->cmd_id = nfc_tag_t2_write_data_verify_next(write);
+            if (!write->cmd_id) {
+                nfc_tag_t2_write_data_done(write,
+                    NFC_TAG_T2_IO_STATUS_VERIFY_FAILED, write->verified);
+            }
+        } else {
+            GDEBUG("Verified %u byte(s)", write->verified);
+            nfc_tag_t2_write_data_done(write, NFC_TAG_T2_IO_STATUS_OK,
+                write->verified);
+        }
+    } else {
+        /* The data has been written, it just can't be confirmed */
+        GDEBUG("Oops, verification read failed!");
+        nfc_tag_t2_write_data_done(write, NFC_TAG_T2_IO_STATUS_VERIFY_FAILED,
+            write->verified);
+    }
+    nfc_tag_unref(tag);
+}
+
 static
 void
 nfc_tag_t2_write_data_resp(
@@ -695,7 +995,6 @@ nfc_tag_t2_write_data_resp(
     void* user_data)
 {
     NfcTagType2WriteData* write = user_data;
-    NfcTagType2Priv* priv = t2->priv;
     NfcTag* tag = &t2->tag;
     gsize total_size = 0;
     const guint8* data = g_bytes_get_data(write->bytes, &total_size);
@@ -711,7 +1010,6 @@ nfc_tag_t2_write_data_resp(
     } else if ((write->written + written) >= total_size) {
         /* Last write succeeded */
         guint total = write->written + written;
-        NfcTagType2WriteDataFunc complete = write->complete.write_data_cb;
 
         if (total > total_size) {
             /* Don't report more bytes written than requested (even
@@ -721,12 +1019,17 @@ nfc_tag_t2_write_data_resp(
         }
 
         GDEBUG("Wrote %u byte(s)", total);
-        if (complete) {
-            write->complete.write_cb = NULL;
-            complete(write->t2, NFC_TAG_T2_IO_STATUS_OK, total,
-                write->user_data);
+        if (write->flags & NFC_TAG_T2_WRITE_FLAG_VERIFY) {
+            /* Read it back within the same sequence */
+            write->written = total;
+            write->cmd_id = nfc_tag_t2_write_data_verify_next(write);
+            if (!write->cmd_id) {
+                nfc_tag_t2_write_data_done(write,
+                    NFC_TAG_T2_IO_STATUS_VERIFY_FAILED, 0);
+            }
+        } else {
+            nfc_tag_t2_write_data_done(write, NFC_TAG_T2_IO_STATUS_OK, total);
         }
-        g_hash_table_remove(priv->writes, GUINT_TO_POINTER(write->seq_id));
     } else {
         /* Write the next block */
         guint remaining;
@@ -819,6 +1122,512 @@ nfc_tag_t2_write_data_unaligned_wait(
     }
 }
 
+static
+void
+nfc_tag_t2_write_data_aligned_start(
+    NfcTagType2WriteData* write)
+{
+    NfcTagType2* t2 = write->t2;
+    const guint block_size = t2->block_size;
+    guint start_block;
+    NfcTagType2Sector* sector = nfc_tag_t2_data_block_to_sector(t2,
+        write->offset / block_size, &start_block, NULL);
+
+    nfc_tag_t2_sector_invalidate(sector, block_size, start_block, 1);
+    write->cmd_id = nfc_tag_t2_cmd_write(t2, start_block,
+        g_bytes_get_data(write->bytes, NULL), write->seq,
+        nfc_tag_t2_write_data_resp, NULL, write);
+}
+
+/*==========================================================================*
+ * Transactional TLV write
+ *
+ * The tag remains valid at every point. First, NDEF length is set to
+ * zero, then the changed blocks are written and finally the block
+ * containing the actual NDEF length. Progress is journaled per UID,
+ * so that an interrupted transaction can be resumed on the next tap
+ * by writing only the remaining blocks.
+ *==========================================================================*/
+
+static
+void
+nfc_tag_t2_journal_entry_free(
+    gpointer data)
+{
+    NfcTagType2JournalEntry* entry = data;
+
+    g_bytes_unref(entry->image);
+    g_free(entry->pending);
+    g_slice_free(NfcTagType2JournalEntry, entry);
+}
+
+static
+NfcTagType2JournalEntry*
+nfc_tag_t2_journal_lookup(
+    GBytes* uid)
+{
+    return (uid && nfc_tag_t2_journal) ?
+        g_hash_table_lookup(nfc_tag_t2_journal, uid) : NULL;
+}
+
+static
+NfcTagType2JournalEntry*
+nfc_tag_t2_journal_add(
+    GBytes* uid,
+    GBytes* image,
+    guint nblocks)
+{
+    NfcTagType2JournalEntry* entry = g_slice_new0(NfcTagType2JournalEntry);
+
+    entry->image = g_bytes_ref(image);
+    entry->pending = g_malloc0((nblocks + 7) / 8);
+    if (!nfc_tag_t2_journal) {
+        nfc_tag_t2_journal = g_hash_table_new_full(g_bytes_hash,
+            g_bytes_equal, (GDestroyNotify) g_bytes_unref,
+            nfc_tag_t2_journal_entry_free);
+    } else if (g_hash_table_size(nfc_tag_t2_journal) >=
+        NFC_TAG_T2_JOURNAL_MAX_ENTRIES) {
+        GHashTableIter it;
+
+        /* Drop an arbitrary entry to keep the journal bounded */
+        g_hash_table_iter_init(&it, nfc_tag_t2_journal);
+        if (g_hash_table_iter_next(&it, NULL, NULL)) {
+            g_hash_table_iter_remove(&it);
+        }
+    }
+    g_hash_table_insert(nfc_tag_t2_journal, g_bytes_ref(uid), entry);
+    return entry;
+}
+
+static
+void
+nfc_tag_t2_journal_remove(
+    GBytes* uid)
+{
+    if (uid && nfc_tag_t2_journal) {
+        g_hash_table_remove(nfc_tag_t2_journal, uid);
+        if (!g_hash_table_size(nfc_tag_t2_journal)) {
+            g_hash_table_destroy(nfc_tag_t2_journal);
+            nfc_tag_t2_journal = NULL;
+        }
+    }
+}
+
+static
+gboolean
+nfc_tag_t2_find_ndef_tlv(
+    const GUtilData* data,
+    guint* len_pos)
+{
+    GUtilData buf = *data;
+    GUtilData value;
+
+    while (buf.size > 0) {
+        if (buf.bytes[0] == TLV_NULL) {
+            buf.bytes++;
+            buf.size--;
+        } else {
+            const guint pos = buf.bytes - data->bytes;
+            const guint type = nfc_tlv_next(&buf, &value);
+
+            if (type == TLV_NDEF_MESSAGE) {
+                *len_pos = pos + 1;
+                return TRUE;
+            } else if (!type) {
+                break;
+            }
+        }
+    }
+    return FALSE;
+}
+
+static
+void
+nfc_tag_t2_tx_resp(
+    NfcTagType2* t2,
+    NFC_TRANSMIT_STATUS status,
+    const void* resp,
+    guint len,
+    void* user_data);
+
+static
+void
+nfc_tag_t2_tx_next(
+    NfcTagType2WriteData* write)
+{
+    NfcTagType2* t2 = write->t2;
+    NfcTagType2Tx* tx = write->tx;
+    const NfcTagType2TxStep* step = &g_array_index(tx->steps,
+        NfcTagType2TxStep, tx->step);
+    const guint block_size = t2->block_size;
+    const guint8* image = g_bytes_get_data(write->bytes, NULL);
+    guint8 b[NFC_TAG_T2_MAX_BLOCK_SIZE];
+    guint block;
+    NfcTagType2Sector* sector = nfc_tag_t2_data_block_to_sector(t2,
+        step->index, &block, NULL);
+
+    memcpy(b, image + step->index * block_size, block_size);
+    if (step->type == NFC_TAG_T2_TX_STEP_ZERO) {
+        guint pos;
+
+        /* Zero the part of the length field which lives in this block */
+        for (pos = tx->len_pos; pos < tx->len_pos + tx->len_size; pos++) {
+            if (pos / block_size == step->index) {
+                b[pos % block_size] = 0;
+            }
+        }
+    }
+    nfc_tag_t2_sector_invalidate(sector, block_size, block, 1);
+    write->cmd_id = nfc_tag_t2_cmd_write(t2, block, b, write->seq,
+        nfc_tag_t2_tx_resp, NULL, write);
+}
+
+static
+void
+nfc_tag_t2_tx_committed(
+    NfcTagType2WriteData* write)
+{
+    NfcTagType2* t2 = write->t2;
+    NfcTag* tag = &t2->tag;
+    const guint block_size = t2->block_size;
+    gsize size;
+    const guint8* image = g_bytes_get_data(write->bytes, &size);
+    const guint nblocks = size / block_size;
+    NfcTagType2Sector* sector = NULL;
+    GUtilData cached;
+    guint i;
+
+    /*
+     * The tag now contains the whole image, including the blocks
+     * which were written before the transaction got interrupted
+     * and resumed. Store it in the cache and re-parse NDEF.
+     */
+    for (i = 0; i < nblocks; i++) {
+        guint block;
+
+        sector = nfc_tag_t2_data_block_to_sector(t2, i, &block, NULL);
+        nfc_tag_t2_sector_set_data(sector, block_size, image +
+            i * block_size, block, 1);
+    }
+    if (sector) {
+        nfc_tag_t2_sector_cached_data(sector, &cached);
+        nfc_ndef_rec_unref(tag->ndef);
+        tag->ndef = nfc_ndef_rec_new_tlv(&cached);
+    }
+}
+
+static
+void
+nfc_tag_t2_tx_resp(
+    NfcTagType2* t2,
+    NFC_TRANSMIT_STATUS status,
+    const void* resp,
+    guint len,
+    void* user_data)
+{
+    NfcTagType2WriteData* write = user_data;
+    NfcTagType2Tx* tx = write->tx;
+    NfcTag* tag = &t2->tag;
+
+    write->cmd_id = 0;
+    nfc_tag_ref(tag);
+    if (status == NFC_TRANSMIT_STATUS_OK) {
+        const NfcTagType2TxStep* step = &g_array_index(tx->steps,
+            NfcTagType2TxStep, tx->step);
+        NfcTagType2JournalEntry* entry = nfc_tag_t2_journal_lookup(tx->uid);
+
+        /* Journal the progress */
+        switch (step->type) {
+        case NFC_TAG_T2_TX_STEP_ZERO:
+            /* The length may span two blocks, both must be zeroed */
+            if (entry && (tx->step + 1 >= tx->steps->len ||
+                g_array_index(tx->steps, NfcTagType2TxStep, tx->step + 1).
+                type != NFC_TAG_T2_TX_STEP_ZERO)) {
+                entry->zeroed = TRUE;
+            }
+            break;
+        case NFC_TAG_T2_TX_STEP_DATA:
+            if (entry) {
+                entry->pending[step->index / 8] &= ~(1 << (step->index % 8));
+            }
+            break;
+        case NFC_TAG_T2_TX_STEP_COMMIT:
+            if (tx->step + 1 >= tx->steps->len) {
+                nfc_tag_t2_journal_remove(tx->uid);
+            }
+            break;
+        }
+
+        if (++tx->step < tx->steps->len) {
+            nfc_tag_t2_tx_next(write);
+            if (!write->cmd_id) {
+                nfc_tag_t2_write_data_done(write,
+                    NFC_TAG_T2_IO_STATUS_FAILURE, 0);
+            }
+        } else {
+            const guint total = g_bytes_get_size(write->bytes);
+
+            GDEBUG("Transaction #%u committed, %u byte(s)", write->seq_id,
+                total);
+            nfc_tag_t2_tx_committed(write);
+            nfc_tag_t2_write_data_done(write, NFC_TAG_T2_IO_STATUS_OK, total);
+        }
+    } else {
+        GDEBUG("Transaction #%u interrupted at step %u", write->seq_id,
+            tx->step);
+        nfc_tag_t2_write_data_done(write, NFC_TAG_T2_IO_STATUS_IO_ERROR, 0);
+    }
+    nfc_tag_unref(tag);
+}
+
+static
+void
+nfc_tag_t2_tx_start(
+    NfcTagType2WriteData* write)
+{
+    NfcTagType2* t2 = write->t2;
+    NfcTagType2Tx* tx = write->tx;
+    const guint block_size = t2->block_size;
+    gsize size;
+    const guint8* image = g_bytes_get_data(write->bytes, &size);
+    const guint nblocks = size / block_size;
+    const guint first = tx->len_pos / block_size;
+    const guint last = (tx->len_pos + tx->len_size - 1) / block_size;
+    NfcTagType2JournalEntry* entry = nfc_tag_t2_journal_lookup(tx->uid);
+    NfcTagType2TxStep step;
+    gboolean zeroed = FALSE;
+    guint8* pending;
+    guint i;
+
+    if (entry && !g_bytes_equal(entry->image, write->bytes)) {
+        GDEBUG("Discarding unfinished transaction");
+        nfc_tag_t2_journal_remove(tx->uid);
+        entry = NULL;
+    }
+
+    if (entry) {
+        GDEBUG("Resuming transaction");
+        pending = gutil_memdup(entry->pending, (nblocks + 7) / 8);
+        zeroed = entry->zeroed;
+    } else {
+        pending = g_malloc0((nblocks + 7) / 8);
+
+        /* Only the blocks which differ from the cache have to be written */
+        for (i = 0; i < nblocks; i++) {
+            NfcTagType2Sector* sector;
+            gboolean cached;
+
+            sector = nfc_tag_t2_data_block_to_sector(t2, i, NULL, &cached);
+            if ((i >= first && i <= last) || !cached ||
+                memcmp(sector->data.bytes + i * block_size,
+                image + i * block_size, block_size)) {
+                pending[i / 8] |= (1 << (i % 8));
+            }
+        }
+        if (tx->uid) {
+            entry = nfc_tag_t2_journal_add(tx->uid, write->bytes, nblocks);
+            memcpy(entry->pending, pending, (nblocks + 7) / 8);
+        }
+    }
+
+    /*
+     * Data blocks in ascending order, NDEF length blocks last. The
+     * block containing the first byte of the length field is written
+     * at the very end, until then the length remains zero.
+     */
+    tx->steps = g_array_sized_new(FALSE, FALSE, sizeof(step), nblocks + 2);
+    step.type = NFC_TAG_T2_TX_STEP_DATA;
+    for (i = 0; i < nblocks; i++) {
+        if ((i < first || i > last) && (pending[i / 8] & (1 << (i % 8)))) {
+            step.index = i;
+            g_array_append_val(tx->steps, step);
+        }
+    }
+    if (tx->steps->len && !zeroed) {
+        /* Invalidate NDEF before touching anything else */
+        step.type = NFC_TAG_T2_TX_STEP_ZERO;
+        for (i = last + 1; i > first; i--) {
+            step.index = i - 1;
+            g_array_prepend_val(tx->steps, step);
+        }
+    }
+    step.type = NFC_TAG_T2_TX_STEP_COMMIT;
+    for (i = last + 1; i > first; i--) {
+        step.index = i - 1;
+        g_array_append_val(tx->steps, step);
+    }
+    g_free(pending);
+
+    GDEBUG("Transaction #%u: %u write(s)", write->seq_id, tx->steps->len);
+    tx->step = 0;
+    nfc_tag_t2_tx_next(write);
+}
+
+static
+void
+nfc_tag_t2_tx_wait(
+    NfcTarget* target,
+    void* user_data)
+{
+    NfcTagType2WriteData* write = user_data;
+
+    if (target->sequence == write->seq) {
+        GDEBUG("Starting transaction #%u", write->seq_id);
+        nfc_target_remove_handler(target, write->start_id);
+        write->start_id = 0;
+        nfc_tag_t2_tx_start(write);
+        if (!write->cmd_id) {
+            nfc_tag_t2_write_data_done(write, NFC_TAG_T2_IO_STATUS_FAILURE, 0);
+        }
+    }
+}
+
+/*==========================================================================*
+ * Dynamic lock bits
+ *==========================================================================*/
+
+static
+void
+nfc_tag_t2_dyn_lock_apply(
+    NfcTagType2* self,
+    const guint8* bytes)
+{
+    NfcTagType2Priv* priv = self->priv;
+    NfcTagType2DynLock* lock = &priv->dyn_lock;
+    NfcTagType2Sector* sector = priv->sectors; /* sector 0 */
+    guint i;
+
+    /*
+     * Each dynamic lock bit locks bytes_per_bit bytes starting right
+     * after the area covered by the static lock bits.
+     */
+    GDEBUG("Dynamic lock bits:");
+    nfc_hexdump(bytes, (lock->bits + 7) / 8);
+    for (i = 0; i < lock->bits; i++) {
+        if (bytes[i / 8] & (1 << (i % 8))) {
+            nfc_tag_t2_sector_mark_blocks(sector, sector->locked,
+                self->block_size, NFC_TAG_T2_STATIC_LOCK_END +
+                i * lock->bytes_per_bit, lock->bytes_per_bit);
+        }
+    }
+    lock->pending = FALSE;
+}
+
+static
+gboolean
+nfc_tag_t2_dyn_lock_cached(
+    NfcTagType2* self)
+{
+    NfcTagType2Priv* priv = self->priv;
+    const NfcTagType2DynLock* lock = &priv->dyn_lock;
+    const NfcTagType2Sector* sector = priv->sectors; /* sector 0 */
+    const guint block_size = self->block_size;
+    const guint end = lock->addr + (lock->bits + 7) / 8;
+    guint i;
+
+    /* Not in the sector (e.g. the default lock area), can't be cached */
+    if (end > sector->size) {
+        return FALSE;
+    }
+    for (i = lock->addr / block_size; i * block_size < end; i++) {
+        if (!(sector->valid[i / 8] & (1 << (i % 8)))) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static
+void
+nfc_tag_t2_dyn_lock_read_resp(
+    NfcTagType2* t2,
+    NFC_TRANSMIT_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data);
+
+static
+guint
+nfc_tag_t2_dyn_lock_read(
+    NfcTagType2WriteData* write)
+{
+    NfcTagType2* t2 = write->t2;
+    const NfcTagType2DynLock* lock = &t2->priv->dyn_lock;
+
+    return nfc_tag_t2_cmd_read(t2, (lock->addr + write->lock_fetched) /
+        t2->block_size, write->seq, nfc_tag_t2_dyn_lock_read_resp, NULL,
+        write);
+}
+
+static
+void
+nfc_tag_t2_dyn_lock_read_resp(
+    NfcTagType2* t2,
+    NFC_TRANSMIT_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data)
+{
+    NfcTagType2WriteData* write = user_data;
+    NfcTagType2DynLock* lock = &t2->priv->dyn_lock;
+    NfcTag* tag = &t2->tag;
+    const guint nbytes = (lock->bits + 7) / 8;
+    const guint skip = (lock->addr + write->lock_fetched) % t2->block_size;
+
+    write->cmd_id = 0;
+    if (status == NFC_TRANSMIT_STATUS_OK && len > skip) {
+        const guint n = MIN(len - skip, nbytes - write->lock_fetched);
+
+        memcpy(write->lock_bytes + write->lock_fetched,
+            (const guint8*)data + skip, n);
+        write->lock_fetched += n;
+        if (write->lock_fetched < nbytes) {
+            write->cmd_id = nfc_tag_t2_dyn_lock_read(write);
+            if (write->cmd_id) {
+                return;
+            }
+        } else {
+            nfc_tag_t2_dyn_lock_apply(t2, write->lock_bytes);
+        }
+    }
+    if (lock->pending) {
+        /* Proceed as if there were no dynamic lock bits */
+        GDEBUG("Failed to read dynamic lock bytes");
+        lock->pending = FALSE;
+    }
+    g_free(write->lock_bytes);
+    write->lock_bytes = NULL;
+
+    nfc_tag_ref(tag);
+    if (nfc_tag_t2_data_write_protected(t2, write->offset,
+        g_bytes_get_size(write->bytes))) {
+        nfc_tag_t2_write_data_done(write, NFC_TAG_T2_IO_STATUS_FAILURE, 0);
+    } else {
+        /* Our sequence is running, the write can start right away */
+        write->start(write);
+        if (!write->cmd_id) {
+            nfc_tag_t2_write_data_done(write, NFC_TAG_T2_IO_STATUS_FAILURE, 0);
+        }
+    }
+    nfc_tag_unref(tag);
+}
+
+static
+void
+nfc_tag_t2_dyn_lock_fetch(
+    NfcTagType2WriteData* write,
+    void (*start)(NfcTagType2WriteData* write))
+{
+    const NfcTagType2DynLock* lock = &write->t2->priv->dyn_lock;
+
+    /* The write gets started (or rejected) when the lock bits arrive */
+    GDEBUG("Fetching dynamic lock bits for write #%u", write->seq_id);
+    write->start = start;
+    write->lock_bytes = g_malloc0((lock->bits + 7) / 8);
+    write->lock_fetched = 0;
+    write->cmd_id = nfc_tag_t2_dyn_lock_read(write);
+}
+
 /*==========================================================================*
  * Initialization
  *==========================================================================*/
@@ -838,6 +1647,124 @@ nfc_tag_t2_initialized(
     nfc_tag_set_initialized(tag);
 }
 
+static
+guint
+nfc_tag_t2_control_tlv_parse(
+    const GUtilData* value,
+    guint* size,
+    guint* bytes_per_bit)
+{
+    /*
+     * NFCForum-TS-Type-2-Tag_1.1
+     * Section 2.3.2 "Lock Control TLV" and 2.3.3 "Memory Control TLV"
+     *
+     * Byte 0: PageAddr (bits 7..4) and ByteOffset (bits 3..0)
+     * Byte 1: Size (number of lock bits or reserved bytes, 0 means 256)
+     * Byte 2: BytesLockedPerLockBit (bits 7..4), BytesPerPage (bits 3..0)
+     *
+     * Returns the byte address of the area.
+     */
+    const guint8* v = value->bytes;
+
+    *size = v[1] ? v[1] : 256;
+    *bytes_per_bit = 1 << (v[2] >> 4);
+    return (v[0] >> 4) * (1 << (v[2] & 0x0f)) + (v[0] & 0x0f);
+}
+
+static
+void
+nfc_tag_t2_init_locks(
+    NfcTagType2* self,
+    const GUtilData* tlvs)
+{
+    NfcTagType2Priv* priv = self->priv;
+    NfcTagType2DynLock* lock = &priv->dyn_lock;
+    NfcTagType2Sector* sector = priv->sectors; /* sector 0 */
+    const guint block_size = self->block_size;
+    const guint8 lock0 = sector->bytes[NFC_TAG_T2_STATIC_LOCK0];
+    const guint8 lock1 = sector->bytes[NFC_TAG_T2_STATIC_LOCK1];
+    const guint8* cc = sector->bytes + 12;
+    gboolean lock_tlv = FALSE;
+    GUtilData buf = *tlvs;
+    GUtilData value;
+    guint type, i;
+
+    if (cc[3] & NFC_TAG_T2_CC_WRITE_ACCESS_MASK) {
+        GDEBUG("Tag is read-only");
+        nfc_tag_t2_sector_mark_blocks(sector, sector->locked, block_size,
+            sector->data.bytes - sector->bytes, sector->data.size);
+    }
+
+    /*
+     * Static lock bits (one bit per block):
+     *
+     * Byte 10, bit 3      - CC (block 3)
+     * Byte 10, bits 4..7  - Blocks 4..7
+     * Byte 11, bits 0..7  - Blocks 8..15
+     */
+    if (lock0 & NFC_TAG_T2_STATIC_LOCK_CC) {
+        nfc_tag_t2_sector_mark_blocks(sector, sector->locked, block_size,
+            3 * block_size, block_size);
+    }
+    for (i = 4; i < 8; i++) {
+        if (lock0 & (1 << i)) {
+            nfc_tag_t2_sector_mark_blocks(sector, sector->locked,
+                block_size, i * block_size, block_size);
+        }
+    }
+    for (i = 0; i < 8; i++) {
+        if (lock1 & (1 << i)) {
+            nfc_tag_t2_sector_mark_blocks(sector, sector->locked,
+                block_size, (8 + i) * block_size, block_size);
+        }
+    }
+
+    /* Lock and Memory Control TLVs precede the NDEF Message TLV */
+    while ((type = nfc_tlv_next(&buf, &value)) > 0) {
+        if ((type == TLV_LOCK_CONTROL || type == TLV_MEMORY_CONTROL) &&
+            value.size == 3) {
+            guint size, bytes_per_bit;
+            const guint addr = nfc_tag_t2_control_tlv_parse(&value,
+                &size, &bytes_per_bit);
+
+            if (type == TLV_LOCK_CONTROL) {
+                lock_tlv = TRUE;
+                lock->addr = addr;
+                lock->bits = size;
+                lock->bytes_per_bit = bytes_per_bit;
+                size = (size + 7) / 8;
+            }
+            GDEBUG("%s area at %u, %u byte(s)", (type == TLV_LOCK_CONTROL) ?
+                "Lock" : "Reserved", addr, size);
+            nfc_tag_t2_sector_mark_blocks(sector, sector->reserved,
+                block_size, addr, size);
+        }
+    }
+
+    /* Default dynamic lock area immediately follows the data area */
+    if (!lock_tlv && sector->data.size > (NFC_TAG_T2_STATIC_LOCK_END -
+        NFC_TAG_T2_DATA_BLOCK0 * block_size)) {
+        const guint dynamic_size = sector->data.size -
+            (NFC_TAG_T2_STATIC_LOCK_END - NFC_TAG_T2_DATA_BLOCK0 * block_size);
+
+        lock->addr = (sector->data.bytes - sector->bytes) + sector->data.size;
+        lock->bits = (dynamic_size + NFC_TAG_T2_DEFAULT_BYTES_PER_LOCK_BIT -
+            1) / NFC_TAG_T2_DEFAULT_BYTES_PER_LOCK_BIT;
+        lock->bytes_per_bit = NFC_TAG_T2_DEFAULT_BYTES_PER_LOCK_BIT;
+    }
+
+    if (lock->bits) {
+        if (nfc_tag_t2_dyn_lock_cached(self)) {
+            nfc_tag_t2_dyn_lock_apply(self, sector->bytes + lock->addr);
+        } else {
+            /* Don't spend another READ on it until something gets written */
+            GDEBUG("Dynamic lock bits will be fetched on demand");
+            lock->pending = TRUE;
+        }
+    }
+    nfc_tag_t2_initialized(self);
+}
+
 static
 void
 nfc_tag_t2_init_read_resp(
@@ -870,14 +1797,17 @@ nfc_tag_t2_init_read_resp(
 
         /* Stop reading when we have fetched the entire TLV sequence.
          * That should be enough to parse the NDEF (if there's any)
-         * which all we really need in most cases. */
-        if ((block * block_size) < sector->size &&
-            len >= block_size && !nfc_tlv_check(&data)) {
+         * which all we really need in most cases. NFC_TAG_READ_FULL
+         * keeps going until the whole sector is cached. */
+        if ((block * block_size) < sector->size && len >= block_size &&
+            (priv->read_policy == NFC_TAG_READ_FULL ||
+            !nfc_tlv_check(&data))) {
             /* Continue reading the data */
             priv->init_id = nfc_tag_t2_cmd_read(self, block, priv->init_seq,
                 nfc_tag_t2_init_read_resp, NULL, GUINT_TO_POINTER(block));
         } else {
             NfcTag* tag = &self->tag;
+            GUtilData cached;
 
             GDEBUG("Tag data:");
             nfc_hexdump_data(&data);
@@ -888,8 +1818,11 @@ nfc_tag_t2_init_read_resp(
             }
 
             /* Find NDEF */
-            tag->ndef = nfc_ndef_rec_new_tlv(&sector->data);
-            nfc_tag_t2_initialized(self);
+            nfc_tag_t2_sector_cached_data(sector, &cached);
+            tag->ndef = nfc_ndef_rec_new_tlv(&cached);
+
+            /* Figure out which blocks are writable */
+            nfc_tag_t2_init_locks(self, &data);
         }
     } else {
         GDEBUG("Failed to read data block %u, giving up", block);
@@ -991,6 +1924,15 @@ NfcTagType2*
 nfc_tag_t2_new(
     NfcTarget* target,
     const NfcParamPollA* param)
+{
+    return nfc_tag_t2_new2(target, param, NFC_TAG_READ_NDEF);
+}
+
+NfcTagType2*
+nfc_tag_t2_new2(
+    NfcTarget* target,
+    const NfcParamPollA* param,
+    NFC_TAG_READ_POLICY policy)
 {
     if (G_LIKELY(target) && G_LIKELY(param)) {
         NfcTagType2* self = g_object_new(THIS_TYPE, NULL);
@@ -1047,10 +1989,18 @@ nfc_tag_t2_new(
 
         GDEBUG("Type 2 tag%s", desc);
         nfc_tag_t2_init2(self, target, param);
+        priv->read_policy = (policy == NFC_TAG_READ_DEFAULT) ?
+            NFC_TAG_READ_NDEF : policy;
 
-        /* Start initialization by reading first blocks of sector 0 */
-        priv->init_id = nfc_tag_t2_cmd_read(self, 0, priv->init_seq,
-            nfc_tag_t2_control_area_read_resp, NULL, NULL);
+        if (priv->read_policy == NFC_TAG_READ_NONE) {
+            /* Nothing is known about the memory layout */
+            GDEBUG("Not reading the tag");
+            nfc_tag_t2_initialized(self);
+        } else {
+            /* Start initialization by reading first blocks of sector 0 */
+            priv->init_id = nfc_tag_t2_cmd_read(self, 0, priv->init_seq,
+                nfc_tag_t2_control_area_read_resp, NULL, NULL);
+        }
         return self;
     }
     return NULL;
@@ -1100,7 +2050,12 @@ nfc_tag_t2_read_data_seq(
     void* user_data) /* Since 1.0.17 */
 {
 #pragma message("TODO: Support more than one sector and cross-sector reads")
-    if (G_LIKELY(self) && (self->tag.flags & NFC_TAG_FLAG_INITIALIZED)) {
+    /*
+     * Sectors are only allocated for NFC Forum compatible tags which
+     * have been read at least partially, i.e. not for NFC_TAG_READ_NONE.
+     */
+    if (G_LIKELY(self) && (self->tag.flags & NFC_TAG_FLAG_INITIALIZED) &&
+        self->priv->sectors) {
         NfcTagType2Priv* priv = self->priv;
         NfcTagType2Sector* sector = priv->sectors;
         const GUtilData* data = &sector->data;
@@ -1275,11 +2230,14 @@ nfc_tag_t2_write_seq(
         gsize offset = block * block_size;
         const guint8* data = g_bytes_get_data(bytes, &size);
         NfcTagType2Priv* priv = self->priv;
-        NfcTagType2Sector* sector = priv->sectors + sector_number;
+        NfcTagType2Sector* sector = priv->sectors ?
+            (priv->sectors + sector_number) : NULL;
 
         /* Round total size down to the nearest block boundary */
         size -= size % block_size;
-        if (sector && size > 0 && (offset + size) <= sector->size) {
+        if (sector && size > 0 && (offset + size) <= sector->size &&
+            !nfc_tag_t2_write_protected(sector, block_size, block,
+            size / block_size, FALSE)) {
             NfcTagType2WriteData* write = nfc_tag_t2_write_data_new(self,
                 sector_number, offset, bytes, seq, G_CALLBACK(complete),
                 destroy, user_data);
@@ -1323,29 +2281,51 @@ nfc_tag_t2_write_data_seq(
     NfcTagType2WriteDataFunc complete,
     GDestroyNotify destroy,
     void* user_data) /* Since 1.0.17 */
+{
+    return nfc_tag_t2_write_data_seq2(self, offset, bytes, seq,
+        NFC_TAG_T2_WRITE_FLAGS_NONE, complete, destroy, user_data);
+}
+
+guint
+nfc_tag_t2_write_data_seq2(
+    NfcTagType2* self,
+    guint offset,
+    GBytes* bytes,
+    NfcTargetSequence* seq,
+    NFC_TAG_T2_WRITE_FLAGS flags,
+    NfcTagType2WriteDataFunc complete,
+    GDestroyNotify destroy,
+    void* user_data) /* Since 1.1.19 */
 {
     if (G_LIKELY(self) && bytes &&
        (self->tag.flags & NFC_TAG_FLAG_INITIALIZED)) {
-        gsize size;
+        const gsize size = g_bytes_get_size(bytes);
         const guint block_size = self->block_size;
-        const guint8* data = g_bytes_get_data(bytes, &size);
         NfcTagType2Priv* priv = self->priv;
-        guint start_block;
-        gboolean start_block_cached;
         NfcTagType2Sector* sector = nfc_tag_t2_data_block_to_sector(self,
-            offset / block_size, &start_block, &start_block_cached);
+            offset / block_size, NULL, NULL);
 
 #pragma message("TODO: Support more than one sector and cross-sector writes")
-        if (sector && size > 0 && (offset + size) <= sector->size) {
+        if (sector && size > 0 && (offset + size) <= sector->size &&
+            !nfc_tag_t2_data_write_protected(self, offset, size)) {
             const guint block_offset = offset % block_size;
             NfcTagType2WriteData* write = nfc_tag_t2_write_data_new(self,
                 sector - priv->sectors, offset, bytes, seq,
                 G_CALLBACK(complete), destroy, user_data);
 
-            GDEBUG("Writing %u data byte(s) starting at offset %u",
-                (guint)size, offset);
+            write->flags = flags;
+            GDEBUG("Writing %u data byte(s) starting at offset %u%s",
+                (guint)size, offset, (flags & NFC_TAG_T2_WRITE_FLAG_VERIFY) ?
+                " (verify)" : "");
 
-            if (block_offset) {
+            if (priv->dyn_lock.pending) {
+                nfc_tag_t2_dyn_lock_fetch(write, block_offset ?
+                    nfc_tag_t2_write_data_unaligned_start :
+                    nfc_tag_t2_write_data_aligned_start);
+                if (write->cmd_id) {
+                    return write->seq_id;
+                }
+            } else if (block_offset) {
                 NfcTarget* target = self->tag.target;
 
                 if (target->sequence == write->seq) {
@@ -1365,10 +2345,7 @@ nfc_tag_t2_write_data_seq(
                     return write->seq_id;
                 }
             } else {
-                nfc_tag_t2_sector_invalidate(sector, block_size,
-                    start_block, 1);
-                write->cmd_id = nfc_tag_t2_cmd_write(self, start_block,
-                    data, write->seq, nfc_tag_t2_write_data_resp, NULL, write);
+                nfc_tag_t2_write_data_aligned_start(write);
                 if (write->cmd_id) {
                     return write->seq_id;
                 }
@@ -1382,6 +2359,148 @@ nfc_tag_t2_write_data_seq(
     return 0;
 }
 
+guint
+nfc_tag_t2_write_tlv_seq(
+    NfcTagType2* self,
+    GBytes* tlv,
+    NfcTargetSequence* seq,
+    NfcTagType2WriteDataFunc complete,
+    GDestroyNotify destroy,
+    void* user_data) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self) && tlv &&
+        (self->tag.flags & NFC_TAG_FLAG_INITIALIZED)) {
+        NfcTagType2Priv* priv = self->priv;
+        NfcTagType2Sector* sector = priv->sectors; /* sector 0 */
+        const guint block_size = self->block_size;
+        GUtilData data;
+        guint len_pos;
+        gsize size;
+
+        data.bytes = g_bytes_get_data(tlv, &size);
+        data.size = size;
+        if (sector && size > 0 && size <= sector->data.size &&
+            nfc_tag_t2_find_ndef_tlv(&data, &len_pos) &&
+            !nfc_tag_t2_data_write_protected(self, 0, size)) {
+            const guint tail = size % block_size;
+            NfcTarget* target = self->tag.target;
+            NfcTagType2WriteData* write;
+            GBytes* image;
+
+            if (tail) {
+                const guint padded = size + block_size - tail;
+                guint8* buf = g_malloc(padded);
+                gboolean cached;
+
+                /* Preserve the rest of the last block if we know it */
+                memcpy(buf, data.bytes, size);
+                nfc_tag_t2_data_block_to_sector(self, size / block_size,
+                    NULL, &cached);
+                if (cached) {
+                    memcpy(buf + size, sector->data.bytes + size,
+                        padded - size);
+                } else {
+                    memset(buf + size, 0, padded - size);
+                }
+                image = g_bytes_new_take(buf, padded);
+            } else {
+                image = g_bytes_ref(tlv);
+            }
+
+            write = nfc_tag_t2_write_data_new(self, 0, 0, image, seq,
+                G_CALLBACK(complete), destroy, user_data);
+            write->tx = g_slice_new0(NfcTagType2Tx);
+            write->tx->len_pos = len_pos;
+            write->tx->len_size = (data.bytes[len_pos] == 0xff) ? 3 : 1;
+            if (self->nfcid1.size) {
+                write->tx->uid = g_bytes_new(self->nfcid1.bytes,
+                    self->nfcid1.size);
+            }
+            g_bytes_unref(image);
+            GDEBUG("Writing %u byte(s) of TLV data (transaction #%u)",
+                (guint)size, write->seq_id);
+
+            if (priv->dyn_lock.pending) {
+                nfc_tag_t2_dyn_lock_fetch(write, nfc_tag_t2_tx_start);
+                if (write->cmd_id) {
+                    return write->seq_id;
+                }
+            } else if (target->sequence == write->seq) {
+                nfc_tag_t2_tx_start(write);
+                if (write->cmd_id) {
+                    return write->seq_id;
+                }
+            } else {
+                /* The plan depends on the cache, wait for our turn */
+                write->start_id = nfc_target_add_sequence_handler(target,
+                    nfc_tag_t2_tx_wait, write);
+                return write->seq_id;
+            }
+
+            /* Write failed */
+            write->destroy = NULL;
+            g_hash_table_remove(priv->writes, GUINT_TO_POINTER(write->seq_id));
+        }
+    }
+    return 0;
+}
+
+gboolean
+nfc_tag_t2_write_tlv_pending(
+    NfcTagType2* self) /* Since 1.1.19 */
+{
+    gboolean pending = FALSE;
+
+    if (G_LIKELY(self) && self->nfcid1.size) {
+        GBytes* uid = g_bytes_new(self->nfcid1.bytes, self->nfcid1.size);
+
+        pending = (nfc_tag_t2_journal_lookup(uid) != NULL);
+        g_bytes_unref(uid);
+    }
+    return pending;
+}
+
+gboolean
+nfc_tag_t2_data_locked(
+    NfcTagType2* self,
+    guint offset,
+    guint nbytes) /* Since 1.1.19 */
+{
+    return G_LIKELY(self) && (self->tag.flags & NFC_TAG_FLAG_INITIALIZED) &&
+        nfc_tag_t2_data_write_protected(self, offset, nbytes);
+}
+
+guint
+nfc_tag_t2_cache_size(
+    NfcTagType2* self) /* Since 1.1.19 */
+{
+    return G_LIKELY(self) ? nfc_tag_cache_size(&self->tag) : 0;
+}
+
+/*==========================================================================*
+ * Methods
+ *==========================================================================*/
+
+static
+guint
+nfc_tag_t2_cache_size_impl(
+    NfcTag* tag)
+{
+    NfcTagType2* self = THIS(tag);
+    NfcTagType2Priv* priv = self->priv;
+    guint size = 0;
+    guint i;
+
+    for (i = 0; i < priv->sector_count; i++) {
+        const NfcTagType2Sector* sector = priv->sectors + i;
+        const guint map_size = (sector->size / self->block_size + 7) / 8;
+
+        /* Contents plus valid, locked and reserved bitmaps */
+        size += sizeof(*sector) + sector->alloc + 3 * map_size;
+    }
+    return size;
+}
+
 /*==========================================================================*
  * Internals
  *==========================================================================*/
@@ -1428,6 +2547,7 @@ nfc_tag_t2_class_init(
     NfcTagType2Class* klass)
 {
     g_type_class_add_private(klass, sizeof(NfcTagType2Priv));
+    NFC_TAG_CLASS(klass)->cache_size = nfc_tag_t2_cache_size_impl;
     G_OBJECT_CLASS(klass)->finalize = nfc_tag_t2_finalize;
 }
 
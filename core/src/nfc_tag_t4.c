@@ -36,6 +36,7 @@
 
 #include "nfc_tag_p.h"
 #include "nfc_tag_t4_p.h"
+#include "nfc_program.h"
 #include "nfc_target_p.h"
 #include "nfc_ndef.h"
 #include "nfc_util.h"
@@ -50,20 +51,11 @@ typedef struct nfc_isodep_tx {
     void* user_data;
 } NfcIsoDepTx;
 
-typedef struct nfc_iso_dep_ndef_read {
-    NfcTagType4* t4;
-    guint8 fid[2];
-    guint data_len;
-    guint max_read;
-    GByteArray* data;
-} NfcIsoDepNdefRead;
-
 struct nfc_tag_t4_priv {
     guint mtu;  /* FSC (Type 4A) or FSD (Type 4B) */
     GByteArray* buf;
     NfcTargetSequence* init_seq;
-    NfcIsoDepNdefRead* init_read;
-    guint init_id;
+    NfcProgram init_prog;
     NfcParamIsoDep* iso_dep; /* Since 1.0.39 */
 };
 
@@ -86,14 +78,11 @@ G_DEFINE_ABSTRACT_TYPE(NfcTagType4, nfc_tag_t4, PARENT_TYPE)
  * Section 5.4.2. NDEF Tag Application Select Procedure
  */
 
-static const guint8 ndef_aid[] = { 0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01 };
-static const guint8 ndef_cc_ef[] = { 0xE1, 0x03 };
-static const GUtilData ndef_aid_data = { ndef_aid, sizeof(ndef_aid) };
-static const GUtilData ndef_cc_ef_data = { ndef_cc_ef, sizeof(ndef_cc_ef) };
-
 #define ISO_SW_NDEF_NOT_FOUND (0x6a82)
 #define NDEF_CC_LEN (15)
 #define NDEF_DATA_OFFSET (2)
+#define ENDEF_DATA_OFFSET (4) /* NFCForum-TS-Type-4-Tag_3.0 */
+#define ENDEF_MAX_LEN (0x800000) /* Sanity limit, we keep it in memory */
 
 /* ISO/IEC 7816-4 */
 
@@ -102,10 +91,19 @@ static const GUtilData ndef_cc_ef_data = { ndef_cc_ef, sizeof(ndef_cc_ef) };
 #define ISO_CLA (0x00) /* Basic channel */
 
 #define ISO_SHORT_FID_MASK (0x1f) /* Short File ID mask */
+#define ISO_P1_READ_SFI (0x80)    /* READ BINARY P1 with short EF id */
+#define NDEF_CC_SFI (0x03)        /* Implied by the CC file id E103 */
 
 /* Instruction byte */
 #define ISO_INS_SELECT (0xA4)
 #define ISO_INS_READ_BINARY (0xB0)
+#define ISO_INS_READ_BINARY_ODO (0xB1) /* With offset data object */
+
+/* READ BINARY */
+#define ISO_MAX_READ_OFFSET (0x7FFF)   /* Max offset in P1-P2 */
+#define ISO_TAG_OFFSET_DATA (0x54)     /* Offset data object */
+#define ISO_TAG_DISCRETIONARY_DATA (0x53)
+#define ISO_DDO_MAX_HDR (4)            /* Tag and up to 3 length bytes */
 
 /* Selection by file identifier */
 #define ISO_P1_SELECT_BY_ID (0x00)      /* Select MF, DF or EF */
@@ -129,6 +127,79 @@ static const GUtilData ndef_cc_ef_data = { ndef_cc_ef, sizeof(ndef_cc_ef) };
 #define ISO_P2_RESPONSE_FMD (0x08)      /* Return FMD template */
 #define ISO_P2_RESPONSE_NONE (0x0C)     /* No response data */
 
+/* NDEF read program */
+
+typedef enum nfc_tag_t4_init_var {
+    T4_VAR_FID = 1,     /* NDEF file id */
+    T4_VAR_MLE,         /* Max read */
+    T4_VAR_HDR,         /* Size of NLEN or ENLEN */
+    T4_VAR_NLEN,        /* NDEF length */
+    T4_VAR_OFFSET,      /* Current offset in the NDEF file */
+    T4_VAR_END,         /* End of NDEF in the NDEF file */
+    T4_VAR_LE,          /* Expected length */
+    T4_VAR_CHUNK,       /* Number of NDEF bytes received */
+    T4_VAR_SFI_P1,      /* READ BINARY P1 for the NDEF file, zero if none */
+    T4_VAR_MAX_SIZE     /* Max NDEF file size from the CC */
+} NFC_TAG_T4_INIT_VAR;
+
+typedef enum nfc_tag_t4_init_hook {
+    T4_HOOK_PARSE_CC,
+    T4_HOOK_PARSE_CC_SFI,
+    T4_HOOK_PARSE_CC_TLV,
+    T4_HOOK_CHECK_NLEN,
+    T4_HOOK_CHECK_NLEN_SFI,
+    T4_HOOK_RESET_SFI,
+    T4_HOOK_UNWRAP_ODO,
+    T4_HOOK_PARSE_NDEF
+} NFC_TAG_T4_INIT_HOOK;
+
+typedef enum nfc_tag_t4_init_result {
+    T4_INIT_RESULT_READ,    /* Reactivation is needed */
+    T4_INIT_RESULT_NO_APP   /* Nothing has been selected */
+} NFC_TAG_T4_INIT_RESULT;
+
+typedef enum nfc_tag_t4_init_step {
+    T4_INIT_SELECT_APP,
+    T4_INIT_READ_CC_SFI,
+    T4_INIT_PARSE_CC_SFI,
+    T4_INIT_SKIP_SELECT_CC,
+    T4_INIT_SELECT_CC,
+    T4_INIT_READ_CC,
+    T4_INIT_PARSE_CC,
+    T4_INIT_CHECK_ENDEF,
+    T4_INIT_READ_CC_TLV,
+    T4_INIT_PARSE_CC_TLV,
+    T4_INIT_CHECK_SFI,
+    T4_INIT_READ_NLEN_SFI,
+    T4_INIT_CHECK_NLEN_SFI,
+    T4_INIT_SKIP_SELECT_NDEF,
+    T4_INIT_SELECT_NDEF,
+    T4_INIT_READ_NLEN,
+    T4_INIT_CHECK_NLEN,
+    T4_INIT_SET_OFFSET,
+    T4_INIT_SET_END,
+    T4_INIT_ADD_END,
+    T4_INIT_SET_LE,
+    T4_INIT_SUB_LE,
+    T4_INIT_CHECK_ODO,
+    T4_INIT_ADD_LE_ODO,
+    T4_INIT_MIN_LE_ODO,
+    T4_INIT_READ_ODO,
+    T4_INIT_UNWRAP_ODO,
+    T4_INIT_SKIP_READ,
+    T4_INIT_MIN_LE,
+    T4_INIT_READ_DATA,
+    T4_INIT_SET_CHUNK,
+    T4_INIT_ADD_OFFSET,
+    T4_INIT_READ_MORE,
+    T4_INIT_PARSE_NDEF,
+    T4_INIT_DONE,
+    T4_INIT_NO_APP,
+    T4_INIT_READ_FAILED,
+    T4_INIT_RESET_SFI,
+    T4_INIT_RESELECT_NDEF
+} NFC_TAG_T4_INIT_STEP;
+
 /*==========================================================================*
  * Implementation
  *==========================================================================*/
@@ -159,13 +230,16 @@ nfc_tag_t4_build_apdu(
      * LC must not be 0x00 and LC1|LC2 must not be 0x00|0x00
      */
     if (len <= 0xffff && exp <= 0x10000) {
+        /* Short and extended length fields can't be mixed */
+        const gboolean extended = (len > 0xff || exp > 0x100);
+
         g_byte_array_set_size(buf, 4);
         buf->data[0] = cla;
         buf->data[1] = ins;
         buf->data[2] = p1;
         buf->data[3] = p2;
         if (len > 0) {
-            if (len <= 0xff) {
+            if (!extended) {
                 /* Cases 3s and 4s */
                 guint8 lc = (guint8)len;
 
@@ -182,7 +256,7 @@ nfc_tag_t4_build_apdu(
             g_byte_array_append(buf, data, len);
         }
         if (exp > 0) {
-            if (exp <= 0x100 && len <= 0xff) {
+            if (!extended) {
                 /* Cases 2s and 4s */
                 guint8 le = (exp == 0x100) ? 0 : ((guint8)exp);
 
@@ -313,19 +387,27 @@ nfc_isodep_submit(
 }
 
 static
-NfcIsoDepNdefRead*
-nfc_iso_dep_ndef_read_new(
-    NfcTagType4* self,
+gboolean
+nfc_tag_t4_init_parse_cc(
+    NfcProgram* prog,
     const guint8* cc /* At least 15 bytes */)
 {
+    const guint version = cc[2] >> 4;
+
     /* See Table 4: Data Structure of the Capability Container File */
     /* And Section 5.1.2.1 NDEF File Control TLV */
-    if ((cc[2] >> 4) == 2 /* We expect Version 2 of the spec */ &&
-        cc[7] == 4 && cc[8] == 6 /* File Control TLV, T = 4, L = 6 */) {
+    /* Version 3 may have ENDEF File Control TLV (T = 6, L = 8) instead */
+    if ((version == 2 || version == 3) &&
+        ((cc[7] == 4 && cc[8] == 6) /* File Control TLV, T = 4, L = 6 */ ||
+         (version == 3 && cc[7] == 6 && cc[8] == 8))) {
         const guint8* v = cc + 9; /* V part of File Control TLV */
+        const gboolean endef = (cc[7] == 6);
 
-        /* Check NDEF file read access condition */
-        if (v[4] == 0 /* read access granted */) {
+        /*
+         * Check NDEF file read access condition. For ENDEF file it's
+         * the 16th byte of the CC, which we haven't read yet.
+         */
+        if (endef || v[4] == 0 /* read access granted */) {
             /*
              * 5.1.2.1 NDEF File Control TLV
              *
@@ -346,15 +428,18 @@ nfc_iso_dep_ndef_read_new(
 
                 /* The valid values for MLe are 000Fh-FFFFh */
                 if (max_read >= 0x000f) {
-                    NfcIsoDepNdefRead* read = g_slice_new0(NfcIsoDepNdefRead);
-
-                    read->max_read = max_read;
-                    read->fid[0] = v[0];
-                    read->fid[1] = v[1];
-                    read->t4 = self;
-                    GDEBUG("NDEF file: %04X", fid);
-                    GVERBOSE("Max read: %u bytes", read->max_read);
-                    return read;
+                    /* Maximum (E)NDEF file size, 2 or 4 bytes */
+                    prog->var[T4_VAR_MAX_SIZE] = endef ?
+                        ((((guint)(v[2])) << 24) | (((guint)(v[3])) << 16) |
+                         (((guint)(v[4])) << 8) | v[5]) :
+                        ((((guint)(v[2])) << 8) | v[3]);
+                    prog->var[T4_VAR_FID] = fid;
+                    prog->var[T4_VAR_MLE] = max_read;
+                    prog->var[T4_VAR_HDR] = endef ?
+                        ENDEF_DATA_OFFSET : NDEF_DATA_OFFSET;
+                    GDEBUG("%s file: %04X", endef ? "ENDEF" : "NDEF", fid);
+                    GVERBOSE("Max read: %u bytes", max_read);
+                    return TRUE;
                 } else {
                     GDEBUG("MLe too small (%u)", max_read);
                 }
@@ -367,20 +452,7 @@ nfc_iso_dep_ndef_read_new(
     } else {
         GDEBUG("Unexpected structure of NDEF Capability Container");
     }
-    return NULL;
-}
-
-static
-void
-nfc_iso_dep_ndef_read_free(
-    NfcIsoDepNdefRead* read)
-{
-    if (read) {
-        if (read->data) {
-            g_byte_array_free(read->data, TRUE);
-        }
-        g_slice_free1(sizeof(*read), read);
-    }
+    return FALSE;
 }
 
 static
@@ -391,12 +463,11 @@ nfc_tag_t4_initialized(
     NfcTagType4Priv* priv = self->priv;
     NfcTag* tag = &self->tag;
 
-    GASSERT(!priv->init_id);
+    GASSERT(!priv->init_prog.tx_id);
     g_object_ref(self);
     nfc_target_sequence_unref(priv->init_seq);
-    nfc_iso_dep_ndef_read_free(priv->init_read);
+    nfc_program_deinit(&priv->init_prog);
     priv->init_seq = NULL;
-    priv->init_read = NULL;
     nfc_tag_set_initialized(tag);
     g_object_unref(self);
 }
@@ -441,259 +512,498 @@ nfc_tag_t4_ndef_read_done(
 }
 
 static
-guint
-nfc_isodep_init_read_binary(
-    NfcTagType4* self,
-    guint offset,
-    guint le,
-    NfcTagType4ResponseFunc resp)
-{
-    return nfc_isodep_submit(self, ISO_CLA, ISO_INS_READ_BINARY,
-        (guint8)(offset >> 8), (guint8)offset, NULL, le,
-        self->priv->init_seq, resp, NULL, NULL);
-}
-
-static
-void
-nfc_tag_t4_init_read_ndef_data_resp(
-    NfcTagType4* self,
-    guint sw,
-    const void* data,
-    guint len,
-    void* user_data)
+gboolean
+nfc_tag_t4_init_unwrap_odo(
+    NfcProgram* prog)
 {
-    NfcTagType4Priv* priv = self->priv;
+    const guint8* resp = prog->resp;
+    const guint len = prog->var[NFC_PROGRAM_VAR_LEN];
 
-    if (sw == ISO_SW_OK) {
-        if (len > 0) {
-            NfcIsoDepNdefRead* read = priv->init_read;
-            GByteArray* buf = read->data;
+    /*
+     * READ BINARY with odd INS returns the data wrapped into
+     * the discretionary data object, with BER-TLV length.
+     */
+    if (len >= 2 && resp[0] == ISO_TAG_DISCRETIONARY_DATA) {
+        guint hdr = 2, size = resp[1];
 
-            g_byte_array_append(buf, data, len);
-            if (buf->len < read->data_len) {
-                const guint remaining = read->data_len - buf->len;
-
-                if ((priv->init_id = nfc_isodep_init_read_binary(self,
-                    buf->len + NDEF_DATA_OFFSET,
-                    MIN(remaining, read->max_read),
-                    nfc_tag_t4_init_read_ndef_data_resp)) != 0) {
-                    return;
-                }
-            } else {
-                GUtilData ndef;
+        if (size > 0x80 && size <= 0x83) {
+            const guint n = size - 0x80;
+            guint i;
 
-                /* Parse the NDEF */
-                ndef.bytes = buf->data;
-                ndef.size = buf->len;
-                self->tag.ndef = nfc_ndef_rec_new(&ndef);
+            hdr += n;
+            for (i = 0, size = 0; i < n && hdr <= len; i++) {
+                size = (size << 8) | resp[2 + i];
+            }
+        } else if (size >= 0x80) {
+            hdr = len + 1;
+        }
+        if (hdr <= len && size <= len - hdr) {
+            if (size > 0) {
+                g_byte_array_append(prog->data, resp + hdr, size);
+                prog->var[T4_VAR_CHUNK] = size;
+                return TRUE;
             }
-        } else {
             GDEBUG("Empty NDEF read");
+            return FALSE;
         }
-    } else if (sw != ISO_SW_IO_ERR) {
-        GDEBUG("NDEF read error %04X", sw);
-    } else {
-        GDEBUG("NDEF read I/O error");
     }
-    priv->init_id = 0;
-    nfc_tag_t4_ndef_read_done(self);
+    GDEBUG("Unexpected NDEF read response");
+    return FALSE;
 }
 
 static
-void
-nfc_tag_t4_init_read_ndef_len_resp(
-    NfcTagType4* self,
-    guint sw,
-    const void* data,
-    guint len,
-    void* user_data)
+gboolean
+nfc_tag_t4_init_check_nlen(
+    NfcProgram* prog)
 {
-    NfcTagType4Priv* priv = self->priv;
+    if (prog->var[NFC_PROGRAM_VAR_LEN] == prog->var[T4_VAR_HDR]) {
+        const guint8* bytes = prog->resp;
+        guint nlen = 0, i;
 
-    if (sw == ISO_SW_OK) {
-        if (len == NDEF_DATA_OFFSET) {
-            NfcIsoDepNdefRead* read = priv->init_read;
-            const guint8* bytes = data;
-
-            read->data_len = ((((guint)(bytes[0])) << 8) | bytes[1]);
-            if (read->data_len > 0) {
-                GDEBUG("Reading %u bytes of NDEF data", read->data_len);
-                read->data = g_byte_array_sized_new(read->data_len);
-                if ((priv->init_id = nfc_isodep_init_read_binary(self,
-                    NDEF_DATA_OFFSET, MIN(read->data_len, read->max_read),
-                    nfc_tag_t4_init_read_ndef_data_resp)) != 0) {
-                    return;
-                }
-            } else {
-                GDEBUG("NDEF is empty");
-            }
+        for (i = 0; i < prog->var[T4_VAR_HDR]; i++) {
+            nlen = (nlen << 8) | bytes[i];
+        }
+        prog->var[T4_VAR_NLEN] = nlen;
+        if (nlen > ENDEF_MAX_LEN) {
+            GDEBUG("NDEF is too large (%u bytes)", nlen);
+        } else if (nlen > 0) {
+            GDEBUG("Reading %u bytes of NDEF data", nlen);
+            /* Allocate the whole thing upfront */
+            g_byte_array_set_size(prog->data, nlen);
+            g_byte_array_set_size(prog->data, 0);
+            return TRUE;
         } else {
-            GDEBUG("Unexpected number of bytes from NDEF file (%u)", len);
+            GDEBUG("NDEF is empty");
         }
-    } else if (sw != ISO_SW_IO_ERR) {
-        GDEBUG("NDEF read error %04X", sw);
     } else {
-        GDEBUG("NDEF read I/O error");
+        GDEBUG("Unexpected number of bytes from NDEF file (%u)",
+            prog->var[NFC_PROGRAM_VAR_LEN]);
     }
-    priv->init_id = 0;
-    nfc_tag_t4_ndef_read_done(self);
+    return FALSE;
 }
 
 static
-void
-nfc_tag_t4_init_select_ndef_resp(
-    NfcTagType4* self,
-    guint sw,
-    const void* data,
-    guint len,
-    void* user_data)
+gboolean
+nfc_tag_t4_init_check_nlen_sfi(
+    NfcProgram* prog)
 {
-    NfcTagType4Priv* priv = self->priv;
-
-    if (sw == ISO_SW_OK) {
-        NfcIsoDepNdefRead* read = priv->init_read;
+    /*
+     * The short EF identifier of the NDEF file is assumed rather than
+     * known, so we may have read some other file. NLEN must fit into
+     * the NDEF file as declared by the CC. An empty NDEF is confirmed
+     * by SELECT too, a zero-filled file would look exactly the same.
+     */
+    if (prog->var[NFC_PROGRAM_VAR_LEN] == prog->var[T4_VAR_HDR]) {
+        const guint8* bytes = prog->resp;
+        guint nlen = 0, i;
 
-        GDEBUG("Selected %02X%02X", read->fid[0], read->fid[1]);
-        /* Read first 2 bytes of the NDEF file (record size) */
-        if ((priv->init_id = nfc_isodep_init_read_binary(self, 0,
-            NDEF_DATA_OFFSET, nfc_tag_t4_init_read_ndef_len_resp)) != 0) {
-            return;
+        for (i = 0; i < prog->var[T4_VAR_HDR]; i++) {
+            nlen = (nlen << 8) | bytes[i];
         }
-    } else if (sw != ISO_SW_IO_ERR) {
-        GDEBUG("NDEF file selection error %04X", sw);
-    } else {
-        GDEBUG("NDEF file selection I/O error");
+        if (nlen > 0 && nlen <= prog->var[T4_VAR_MAX_SIZE] &&
+            prog->var[T4_VAR_MAX_SIZE] - nlen >= prog->var[T4_VAR_HDR]) {
+            return nfc_tag_t4_init_check_nlen(prog);
+        }
+        GDEBUG("NLEN %u doesn't match the NDEF file (%u bytes)", nlen,
+            prog->var[T4_VAR_MAX_SIZE]);
     }
-    priv->init_id = 0;
-    nfc_tag_t4_ndef_read_done(self);
+    return FALSE;
 }
 
 static
-void
-nfc_tag_t4_init_read_ndef_cc_resp(
-    NfcTagType4* self,
-    guint sw,
-    const void* data,
-    guint len,
+gboolean
+nfc_tag_t4_init_hook(
+    NfcProgram* prog,
+    guint id,
     void* user_data)
 {
-    NfcTagType4Priv* priv = self->priv;
-
-    if (sw == ISO_SW_OK) {
-        if (len < NDEF_CC_LEN) {
-            GDEBUG("Not enough data for NDEF Capability Container");
-        } else {
-            GDEBUG("NDEF Capability Container");
-            nfc_hexdump(data, len);
-            priv->init_read = nfc_iso_dep_ndef_read_new(self, data);
-            if (priv->init_read) {
-                GUtilData fid;
+    NfcTagType4* self = THIS(user_data);
+
+    switch ((NFC_TAG_T4_INIT_HOOK)id) {
+    case T4_HOOK_PARSE_CC:
+        GDEBUG("NDEF Capability Container");
+        nfc_hexdump(prog->resp, prog->var[NFC_PROGRAM_VAR_LEN]);
+        return nfc_tag_t4_init_parse_cc(prog, prog->resp);
+    case T4_HOOK_PARSE_CC_SFI:
+        GDEBUG("NDEF Capability Container (short EF id)");
+        nfc_hexdump(prog->resp, prog->var[NFC_PROGRAM_VAR_LEN]);
+        if (nfc_tag_t4_init_parse_cc(prog, prog->resp)) {
+            /*
+             * The CC doesn't tell the short EF identifier of the NDEF
+             * file, only its FCP would, and that takes a SELECT. Unless
+             * the FCP says otherwise, ISO/IEC 7816-4 implies the last 5
+             * bits of the file id, which is what this card has just
+             * done for the CC file (E103 => 03). So we assume the same
+             * for the NDEF file, unless it maps onto 00, 1F (can't be
+             * short EF identifiers) or the CC file itself. Since that's
+             * still an assumption, whatever is read that way gets
+             * verified and anything unexpected falls back to SELECT.
+             */
+            const guint sfi = prog->var[T4_VAR_FID] & ISO_SHORT_FID_MASK;
 
-                /*
-                 * Table 18: NDEF Select Command C-APDU
-                 * 00A4000C02xxxx
-                 */
-                fid.bytes = priv->init_read->fid;
-                fid.size = 2;
-                if ((priv->init_id = nfc_isodep_submit(self, ISO_CLA,
-                    ISO_INS_SELECT, ISO_P1_SELECT_BY_ID,
-                    ISO_P2_SELECT_FILE_FIRST | ISO_P2_RESPONSE_NONE,
-                    &fid, 0, priv->init_seq,
-                    nfc_tag_t4_init_select_ndef_resp, NULL, NULL)) != 0) {
-                    return;
-                }
+            if (sfi && sfi != ISO_SHORT_FID_MASK && sfi != NDEF_CC_SFI) {
+                prog->var[T4_VAR_SFI_P1] = ISO_P1_READ_SFI | sfi;
+            } else {
+                GDEBUG("No short EF id for NDEF file %04X",
+                    prog->var[T4_VAR_FID]);
+                prog->var[T4_VAR_SFI_P1] = 0;
             }
+            return TRUE;
         }
-    } else if (sw != ISO_SW_IO_ERR) {
-        GDEBUG("NDEF Capability Container read error %04X", sw);
-    } else {
-        GDEBUG("NDEF Capability Container read I/O error");
+        break;
+    case T4_HOOK_PARSE_CC_TLV:
+        /* Read access condition of ENDEF File Control TLV */
+        if (prog->resp[0] == 0) {
+            return TRUE;
+        }
+        GDEBUG("NDEF read not allowed");
+        break;
+    case T4_HOOK_CHECK_NLEN:
+        return nfc_tag_t4_init_check_nlen(prog);
+    case T4_HOOK_CHECK_NLEN_SFI:
+        return nfc_tag_t4_init_check_nlen_sfi(prog);
+    case T4_HOOK_RESET_SFI:
+        GDEBUG("Falling back to NDEF file selection");
+        prog->var[T4_VAR_SFI_P1] = 0;
+        g_byte_array_set_size(prog->data, 0);
+        return TRUE;
+    case T4_HOOK_UNWRAP_ODO:
+        return nfc_tag_t4_init_unwrap_odo(prog);
+    case T4_HOOK_PARSE_NDEF:
+        {
+            GUtilData ndef;
+
+            /* Ignore whatever may follow NDEF in the last chunk */
+            ndef.bytes = prog->data->data;
+            ndef.size = MIN(prog->data->len, prog->var[T4_VAR_NLEN]);
+            self->tag.ndef = nfc_ndef_rec_new(&ndef);
+        }
+        return TRUE;
     }
-    priv->init_id = 0;
-    nfc_tag_t4_ndef_read_done(self);
+    return FALSE;
 }
 
 static
 void
-nfc_tag_t4_init_select_ndef_cc_resp(
-    NfcTagType4* self,
-    guint sw,
-    const void* data,
-    guint len,
+nfc_tag_t4_init_prog_done(
+    NfcProgram* prog,
+    guint result,
     void* user_data)
 {
-    NfcTagType4Priv* priv = self->priv;
+    NfcTagType4* self = THIS(user_data);
 
-    /*
-     * NFCForum-TS-Type-4-Tag_2.0
-     * Table 14: Capability Container Select Command -
-     *           Detailed R-APDU Field Description
-     *
-     * 90h 00h   Command completed
-     * 6Ah 82h   Capability container not found
-     */
-    if (sw == ISO_SW_OK) {
-        GVERBOSE("NDEF Capability Container selected");
-        /* Read first 15 bytes of CC */
-        if ((priv->init_id = nfc_isodep_init_read_binary(self, 0, NDEF_CC_LEN,
-            nfc_tag_t4_init_read_ndef_cc_resp)) != 0) {
-            return;
-        }
-    } else if (sw == ISO_SW_NDEF_NOT_FOUND) {
-        GDEBUG("NDEF Capability Container not found");
-    } else if (sw != ISO_SW_IO_ERR) {
-        GDEBUG("NDEF Capability Container selection error %04X", sw);
+    if (result == T4_INIT_RESULT_NO_APP) {
+        /* No need to reinitialize the tag in this case */
+        nfc_tag_t4_initialized(self);
     } else {
-        GDEBUG("NDEF Capability Container selection I/O error");
+        nfc_tag_t4_ndef_read_done(self);
     }
-    priv->init_id = 0;
-    nfc_tag_t4_ndef_read_done(self);
 }
 
-static
-void
-nfc_tag_t4_init_select_ndef_app_resp(
-    NfcTagType4* self,
-    guint sw,
-    const void* data,
-    guint len,
-    void* user_data)
-{
-    NfcTagType4Priv* priv = self->priv;
+/*
+ * NFCForum-TS-Type-4-Tag_2.0
+ * Section 5.4.2. NDEF Tag Application Select Procedure
+ *
+ * Each command below is CLA INS P1 P2 followed by the command data.
+ */
 
-    /*
-     * NFCForum-TS-Type-4-Tag_2.0
-     * Table 11: NDEF Tag Application Select -
-     *           Detailed R-APDU Field Description
-     *
-     * 90h 00h   Command completed
-     * 6Ah 82h   NDEF Tag Application not found
-     */
-    if (sw == ISO_SW_OK) {
-        GDEBUG("Found NDEF Tag Application");
-        /*
-         * Table 12: Capability Container Select Command C-APDU
-         * 00A4000C02E103
-         */
-        if ((priv->init_id = nfc_isodep_submit(self, ISO_CLA,
-            ISO_INS_SELECT, ISO_P1_SELECT_BY_ID,
-            ISO_P2_SELECT_FILE_FIRST | ISO_P2_RESPONSE_NONE,
-            &ndef_cc_ef_data, 0, priv->init_seq,
-            nfc_tag_t4_init_select_ndef_cc_resp, NULL, NULL)) != 0) {
-            return;
-        }
-    } else if (sw == ISO_SW_NDEF_NOT_FOUND) {
-        GDEBUG("NDEF Tag Application not found");
-    } else if (sw != ISO_SW_IO_ERR) {
-        GDEBUG("NDEF Tag Application selection error %04X", sw);
-    } else {
-        GDEBUG("NDEF Tag Application selection I/O error");
-    }
+/* Table 9: NDEF Tag Application Select C-APDU 00A4040007D276000085010100 */
+static const guint8 t4_select_ndef_app[] = {
+    ISO_CLA, ISO_INS_SELECT, ISO_P1_SELECT_DF_BY_NAME, ISO_P2_SELECT_FILE_FIRST,
+    0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01
+};
 
-    /* No need to reinitialize the tag in this case */
-    priv->init_id = 0;
-    nfc_tag_t4_initialized(self);
-}
+/* Table 12: Capability Container Select Command C-APDU 00A4000C02E103 */
+static const guint8 t4_select_ndef_cc[] = {
+    ISO_CLA, ISO_INS_SELECT, ISO_P1_SELECT_BY_ID,
+    ISO_P2_SELECT_FILE_FIRST | ISO_P2_RESPONSE_NONE,
+    0xE1, 0x03
+};
+
+/* Table 18: NDEF Select Command C-APDU 00A4000C02xxxx */
+static const guint8 t4_select_ndef[] = {
+    ISO_CLA, ISO_INS_SELECT, ISO_P1_SELECT_BY_ID,
+    ISO_P2_SELECT_FILE_FIRST | ISO_P2_RESPONSE_NONE,
+    0x00, 0x00 /* File id */
+};
+
+/* P1 and P2 contain the offset */
+static const guint8 t4_read_binary[] = {
+    ISO_CLA, ISO_INS_READ_BINARY, 0x00, 0x00
+};
+
+/* READ BINARY from offset zero of EF E103 by its short EF id */
+static const guint8 t4_read_cc_sfi[] = {
+    ISO_CLA, ISO_INS_READ_BINARY, ISO_P1_READ_SFI | NDEF_CC_SFI, 0x00
+};
+
+/* READ BINARY from offset 15 of the CC file (the rest of ENDEF TLV) */
+static const guint8 t4_read_cc_tlv[] = {
+    ISO_CLA, ISO_INS_READ_BINARY, 0x00, NDEF_CC_LEN
+};
+
+/* READ BINARY with odd INS, the offset data object contains the offset */
+static const guint8 t4_read_binary_odo[] = {
+    ISO_CLA, ISO_INS_READ_BINARY_ODO, 0x00, 0x00,
+    ISO_TAG_OFFSET_DATA, 0x03, 0x00, 0x00, 0x00
+};
+
+#define T4_CMD(cmd) { cmd, sizeof(cmd) }
+
+/*
+ * 90h 00h is the expected status word by default, 6Ah 82h means that
+ * the NDEF Tag Application or the Capability Container is not found.
+ * Any failure after the NDEF Tag Application has been selected makes
+ * us reactivate the tag.
+ *
+ * READ BINARY with a short EF identifier in P1 (ISO/IEC 7816-4) both
+ * selects the file and reads it, saving a SELECT round trip for the
+ * CC file and then for the NDEF file. Support for that is optional,
+ * so any failure falls back to explicit SELECT. The NDEF file is only
+ * read that way if the CC file could be. Its short EF identifier is an
+ * assumption, so NLEN is checked against the maximum NDEF file size
+ * from the CC and any mismatch or failure to read the NDEF file that
+ * way restarts from SELECT by file identifier.
+ *
+ * NFCForum-TS-Type-4-Tag_3.0 adds ENDEF files with 4-byte ENLEN. Even
+ * extended READ BINARY can't address data beyond offset 7FFFh, there
+ * it has to be READ BINARY with odd INS and the offset data object.
+ */
+static const NfcProgramStep nfc_tag_t4_init_prog[] = {
+    [T4_INIT_SELECT_APP] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "NDEF Tag Application selection",
+        .cmd = T4_CMD(t4_select_ndef_app),
+        .imm = 0x100,
+        .alt_sw = ISO_SW_NDEF_NOT_FOUND,
+        .alt = T4_INIT_NO_APP,
+        .fail = T4_INIT_NO_APP
+    },
+    [T4_INIT_READ_CC_SFI] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "NDEF Capability Container read (short EF id)",
+        .cmd = T4_CMD(t4_read_cc_sfi),
+        .imm = NDEF_CC_LEN,
+        .min_len = NDEF_CC_LEN,
+        .fail = T4_INIT_SELECT_CC
+    },
+    [T4_INIT_PARSE_CC_SFI] = {
+        .op = NFC_PROGRAM_OP_CALL,
+        .imm = T4_HOOK_PARSE_CC_SFI,
+        .fail = T4_INIT_SELECT_CC
+    },
+    [T4_INIT_SKIP_SELECT_CC] = {
+        .op = NFC_PROGRAM_OP_GOTO,
+        .fail = T4_INIT_CHECK_ENDEF
+    },
+    [T4_INIT_SELECT_CC] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "NDEF Capability Container selection",
+        .cmd = T4_CMD(t4_select_ndef_cc),
+        .alt_sw = ISO_SW_NDEF_NOT_FOUND,
+        .alt = T4_INIT_DONE,
+        .fail = T4_INIT_DONE
+    },
+    [T4_INIT_READ_CC] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "NDEF Capability Container read",
+        .cmd = T4_CMD(t4_read_binary),
+        .imm = NDEF_CC_LEN,
+        .min_len = NDEF_CC_LEN,
+        .fail = T4_INIT_DONE
+    },
+    [T4_INIT_PARSE_CC] = {
+        .op = NFC_PROGRAM_OP_CALL,
+        .imm = T4_HOOK_PARSE_CC,
+        .fail = T4_INIT_DONE
+    },
+    [T4_INIT_CHECK_ENDEF] = {
+        .op = NFC_PROGRAM_OP_JLT,
+        .a = T4_VAR_HDR,
+        .imm = ENDEF_DATA_OFFSET,
+        .fail = T4_INIT_CHECK_SFI
+    },
+    /* The CC file is the current EF either way */
+    [T4_INIT_READ_CC_TLV] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "ENDEF File Control TLV read",
+        .cmd = T4_CMD(t4_read_cc_tlv),
+        .imm = 2,
+        .min_len = 1,
+        .fail = T4_INIT_DONE
+    },
+    [T4_INIT_PARSE_CC_TLV] = {
+        .op = NFC_PROGRAM_OP_CALL,
+        .imm = T4_HOOK_PARSE_CC_TLV,
+        .fail = T4_INIT_DONE
+    },
+    [T4_INIT_CHECK_SFI] = {
+        .op = NFC_PROGRAM_OP_JZ,
+        .a = T4_VAR_SFI_P1,
+        .fail = T4_INIT_SELECT_NDEF
+    },
+    [T4_INIT_READ_NLEN_SFI] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "NDEF length read (short EF id)",
+        .cmd = T4_CMD(t4_read_binary),
+        .patch = {{ 2, 1, T4_VAR_SFI_P1 }},
+        .b = T4_VAR_HDR,
+        .min_len = NDEF_DATA_OFFSET,
+        .max_len = ENDEF_DATA_OFFSET,
+        .fail = T4_INIT_RESET_SFI
+    },
+    [T4_INIT_CHECK_NLEN_SFI] = {
+        .op = NFC_PROGRAM_OP_CALL,
+        .imm = T4_HOOK_CHECK_NLEN_SFI,
+        .fail = T4_INIT_RESET_SFI
+    },
+    [T4_INIT_SKIP_SELECT_NDEF] = {
+        .op = NFC_PROGRAM_OP_GOTO,
+        .fail = T4_INIT_SET_OFFSET
+    },
+    [T4_INIT_SELECT_NDEF] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "NDEF file selection",
+        .cmd = T4_CMD(t4_select_ndef),
+        .patch = {{ 4, 2, T4_VAR_FID }},
+        .fail = T4_INIT_DONE
+    },
+    /* Read first 2 (or 4) bytes of the NDEF file (record size) */
+    [T4_INIT_READ_NLEN] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "NDEF length read",
+        .cmd = T4_CMD(t4_read_binary),
+        .b = T4_VAR_HDR,
+        .min_len = NDEF_DATA_OFFSET,
+        .max_len = ENDEF_DATA_OFFSET,
+        .fail = T4_INIT_DONE
+    },
+    [T4_INIT_CHECK_NLEN] = {
+        .op = NFC_PROGRAM_OP_CALL,
+        .imm = T4_HOOK_CHECK_NLEN,
+        .fail = T4_INIT_DONE
+    },
+    [T4_INIT_SET_OFFSET] = {
+        .op = NFC_PROGRAM_OP_SET,
+        .a = T4_VAR_OFFSET,
+        .b = T4_VAR_HDR
+    },
+    [T4_INIT_SET_END] = {
+        .op = NFC_PROGRAM_OP_SET,
+        .a = T4_VAR_END,
+        .b = T4_VAR_NLEN
+    },
+    [T4_INIT_ADD_END] = {
+        .op = NFC_PROGRAM_OP_ADD,
+        .a = T4_VAR_END,
+        .b = T4_VAR_HDR
+    },
+    /* Le = MIN(END - OFFSET, MLe) */
+    [T4_INIT_SET_LE] = {
+        .op = NFC_PROGRAM_OP_SET,
+        .a = T4_VAR_LE,
+        .b = T4_VAR_END
+    },
+    [T4_INIT_SUB_LE] = {
+        .op = NFC_PROGRAM_OP_SUB,
+        .a = T4_VAR_LE,
+        .b = T4_VAR_OFFSET
+    },
+    [T4_INIT_CHECK_ODO] = {
+        .op = NFC_PROGRAM_OP_JLT,
+        .a = T4_VAR_OFFSET,
+        .imm = ISO_MAX_READ_OFFSET + 1,
+        .fail = T4_INIT_MIN_LE
+    },
+    /* Leave room for the discretionary data object header */
+    [T4_INIT_ADD_LE_ODO] = {
+        .op = NFC_PROGRAM_OP_ADD,
+        .a = T4_VAR_LE,
+        .imm = ISO_DDO_MAX_HDR
+    },
+    [T4_INIT_MIN_LE_ODO] = {
+        .op = NFC_PROGRAM_OP_MIN,
+        .a = T4_VAR_LE,
+        .b = T4_VAR_MLE
+    },
+    [T4_INIT_READ_ODO] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "NDEF read",
+        .cmd = T4_CMD(t4_read_binary_odo),
+        .patch = {{ 6, 3, T4_VAR_OFFSET }},
+        .b = T4_VAR_LE,
+        .min_len = 2,
+        .fail = T4_INIT_READ_FAILED
+    },
+    [T4_INIT_UNWRAP_ODO] = {
+        .op = NFC_PROGRAM_OP_CALL,
+        .imm = T4_HOOK_UNWRAP_ODO,
+        .fail = T4_INIT_READ_FAILED
+    },
+    [T4_INIT_SKIP_READ] = {
+        .op = NFC_PROGRAM_OP_GOTO,
+        .fail = T4_INIT_ADD_OFFSET
+    },
+    [T4_INIT_MIN_LE] = {
+        .op = NFC_PROGRAM_OP_MIN,
+        .a = T4_VAR_LE,
+        .b = T4_VAR_MLE
+    },
+    [T4_INIT_READ_DATA] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "NDEF read",
+        .cmd = T4_CMD(t4_read_binary),
+        .patch = {{ 2, 2, T4_VAR_OFFSET }},
+        .b = T4_VAR_LE,
+        .min_len = 1,
+        .flags = NFC_PROGRAM_FLAG_APPEND,
+        .fail = T4_INIT_READ_FAILED
+    },
+    [T4_INIT_SET_CHUNK] = {
+        .op = NFC_PROGRAM_OP_SET,
+        .a = T4_VAR_CHUNK,
+        .b = NFC_PROGRAM_VAR_LEN
+    },
+    [T4_INIT_ADD_OFFSET] = {
+        .op = NFC_PROGRAM_OP_ADD,
+        .a = T4_VAR_OFFSET,
+        .b = T4_VAR_CHUNK
+    },
+    [T4_INIT_READ_MORE] = {
+        .op = NFC_PROGRAM_OP_JLT,
+        .a = T4_VAR_OFFSET,
+        .b = T4_VAR_END,
+        .fail = T4_INIT_SET_LE
+    },
+    [T4_INIT_PARSE_NDEF] = {
+        .op = NFC_PROGRAM_OP_CALL,
+        .imm = T4_HOOK_PARSE_NDEF,
+        .fail = T4_INIT_DONE
+    },
+    [T4_INIT_DONE] = {
+        .op = NFC_PROGRAM_OP_EXIT,
+        .imm = T4_INIT_RESULT_READ
+    },
+    [T4_INIT_NO_APP] = {
+        .op = NFC_PROGRAM_OP_EXIT,
+        .imm = T4_INIT_RESULT_NO_APP
+    },
+    /* NDEF read has failed, give up unless it was selected by SFI */
+    [T4_INIT_READ_FAILED] = {
+        .op = NFC_PROGRAM_OP_JZ,
+        .a = T4_VAR_SFI_P1,
+        .fail = T4_INIT_DONE
+    },
+    [T4_INIT_RESET_SFI] = {
+        .op = NFC_PROGRAM_OP_CALL,
+        .imm = T4_HOOK_RESET_SFI,
+        .fail = T4_INIT_DONE
+    },
+    [T4_INIT_RESELECT_NDEF] = {
+        .op = NFC_PROGRAM_OP_GOTO,
+        .fail = T4_INIT_SELECT_NDEF
+    }
+};
 
 static
 void
@@ -743,7 +1053,8 @@ nfc_tag_t4_init_base(
     NfcTarget* target,
     guint mtu,
     const NfcParamPoll* poll,
-    const NfcParamIsoDep* iso_dep)
+    const NfcParamIsoDep* iso_dep,
+    NFC_TAG_READ_POLICY policy)
 {
     NfcTag* tag = &self->tag;
     NfcTagType4Priv* priv = self->priv;
@@ -803,25 +1114,21 @@ nfc_tag_t4_init_base(
      * application is to reinitialize the card from scratch. Besides,
      * selection of a non-default application may be an irreversible
      * action (which of course depends on how the card is programmed).
+     *
+     * NFC_TAG_READ_NONE skips the whole thing. The NDEF file is all we
+     * ever read from Type 4 tags, so NFC_TAG_READ_FULL is the same as
+     * NFC_TAG_READ_NDEF.
      */
-    if (nfc_target_can_reactivate(tag->target)) {
+    if (policy != NFC_TAG_READ_NONE &&
+        nfc_target_can_reactivate(tag->target)) {
         priv->init_seq = nfc_target_sequence_new(target);
-
-        /*
-         * NFCForum-TS-Type-4-Tag_2.0
-         * Section 5.4.2. NDEF Tag Application Select Procedure
-         *
-         * Table 9: NDEF Tag Application Select C-APDU
-         * 00A4040007D276000085010100
-         */
-        if ((priv->init_id = nfc_isodep_submit(self, ISO_CLA, ISO_INS_SELECT,
-            ISO_P1_SELECT_DF_BY_NAME, ISO_P2_SELECT_FILE_FIRST, &ndef_aid_data,
-            0x100, priv->init_seq, nfc_tag_t4_init_select_ndef_app_resp,
-            NULL, NULL)) != 0) {
-            return;
-        }
+        nfc_program_init(&priv->init_prog, nfc_tag_t4_init_prog,
+            G_N_ELEMENTS(nfc_tag_t4_init_prog), nfc_tag_t4_init_hook, self);
+        nfc_program_run(&priv->init_prog, target, priv->init_seq,
+            nfc_tag_t4_init_prog_done);
+    } else {
+        nfc_tag_t4_initialized(self);
     }
-    nfc_tag_t4_initialized(self);
 }
 
 /*==========================================================================*
@@ -907,9 +1214,8 @@ nfc_tag_t4_finalize(
     NfcTagType4* self = THIS(object);
     NfcTagType4Priv* priv = self->priv;
 
-    nfc_target_cancel_transmit(self->tag.target, priv->init_id);
+    nfc_program_deinit(&priv->init_prog);
     nfc_target_sequence_unref(priv->init_seq);
-    nfc_iso_dep_ndef_read_free(priv->init_read);
     g_byte_array_free(priv->buf, TRUE);
     g_free(priv->iso_dep);
     G_OBJECT_CLASS(PARENT_CLASS)->finalize(object);
@@ -55,13 +55,30 @@ nfc_tag_t4b_new(
     const NfcParamIsoDepPollB* iso_dep_param)
     NFCD_INTERNAL;
 
+NfcTagType4a*
+nfc_tag_t4a_new2(
+    NfcTarget* target,
+    const NfcParamPollA* poll_a,
+    const NfcParamIsoDepPollA* iso_dep_param,
+    NFC_TAG_READ_POLICY policy)
+    NFCD_INTERNAL;
+
+NfcTagType4b*
+nfc_tag_t4b_new2(
+    NfcTarget* target,
+    const NfcParamPollB* poll_b,
+    const NfcParamIsoDepPollB* iso_dep_param,
+    NFC_TAG_READ_POLICY policy)
+    NFCD_INTERNAL;
+
 void
 nfc_tag_t4_init_base(
     NfcTagType4* tag,
     NfcTarget* target,
     guint mtu,
     const NfcParamPoll* poll,
-    const NfcParamIsoDep* iso_dep)
+    const NfcParamIsoDep* iso_dep,
+    NFC_TAG_READ_POLICY policy)
     NFCD_INTERNAL;
 
 /* For unit tests */
@@ -54,6 +54,16 @@ nfc_tag_t4a_new(
     NfcTarget* target,
     const NfcParamPollA* poll_a,
     const NfcParamIsoDepPollA* iso_dep_a)
+{
+    return nfc_tag_t4a_new2(target, poll_a, iso_dep_a, NFC_TAG_READ_NDEF);
+}
+
+NfcTagType4a*
+nfc_tag_t4a_new2(
+    NfcTarget* target,
+    const NfcParamPollA* poll_a,
+    const NfcParamIsoDepPollA* iso_dep_a,
+    NFC_TAG_READ_POLICY policy)
 {
     if (G_LIKELY(iso_dep_a)) {
         NfcTagType4a* self = g_object_new(NFC_TYPE_TAG_T4A, NULL);
@@ -69,9 +79,11 @@ nfc_tag_t4a_new(
 
             memset(&poll, 0, sizeof(poll));
             poll.a = *poll_a;
-            nfc_tag_t4_init_base(t4, target, iso_dep_a->fsc, &poll, &iso_dep);
+            nfc_tag_t4_init_base(t4, target, iso_dep_a->fsc, &poll, &iso_dep,
+                policy);
         } else {
-            nfc_tag_t4_init_base(t4, target, iso_dep_a->fsc, NULL, &iso_dep);
+            nfc_tag_t4_init_base(t4, target, iso_dep_a->fsc, NULL, &iso_dep,
+                policy);
         }
         return self;
     }
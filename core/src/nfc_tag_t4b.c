@@ -54,6 +54,16 @@ nfc_tag_t4b_new(
     NfcTarget* target,
     const NfcParamPollB* poll_b,
     const NfcParamIsoDepPollB* iso_dep_b)
+{
+    return nfc_tag_t4b_new2(target, poll_b, iso_dep_b, NFC_TAG_READ_NDEF);
+}
+
+NfcTagType4b*
+nfc_tag_t4b_new2(
+    NfcTarget* target,
+    const NfcParamPollB* poll_b,
+    const NfcParamIsoDepPollB* iso_dep_b,
+    NFC_TAG_READ_POLICY policy)
 {
     if (G_LIKELY(poll_b)) {
         NfcTagType4b* self = g_object_new(NFC_TYPE_TAG_T4B, NULL);
@@ -69,9 +79,11 @@ nfc_tag_t4b_new(
 
             memset(&iso_dep, 0, sizeof(iso_dep));
             iso_dep.b = *iso_dep_b;
-            nfc_tag_t4_init_base(t4, target, poll_b->fsc, &poll, &iso_dep);
+            nfc_tag_t4_init_base(t4, target, poll_b->fsc, &poll, &iso_dep,
+                policy);
         } else {
-            nfc_tag_t4_init_base(t4, target, poll_b->fsc, &poll, NULL);
+            nfc_tag_t4_init_base(t4, target, poll_b->fsc, &poll, NULL,
+                policy);
         }
         return self;
     }
@@ -36,6 +36,7 @@
 
 #include "nfc_target_p.h"
 #include "nfc_target_impl.h"
+#include "nfc_timer.h"
 #include "nfc_log.h"
 
 #include <gutil_macros.h>
@@ -43,6 +44,7 @@
 
 #define DEFAULT_TRANSMIT_TIMEOUT_MS (500)
 #define DEFAULT_REACTIVATION_TIMEOUT_MS (1500)
+#define TIMER_SLACK(ms) ((ms)/16) /* Timeouts may fire a bit late */
 
 typedef struct nfc_target_request NfcTargetRequest;
 typedef struct nfc_target_request_type {
@@ -64,6 +66,8 @@ struct nfc_target_request {
     NfcTargetSequence* seq;
     const NfcTargetRequestType* type;
     NfcTarget* target;
+    NFC_TARGET_PRIORITY priority;
+    gint64 deadline; /* Monotonic time, zero if none */
     guint id;
     guint timeout;
     GDestroyNotify destroy;
@@ -93,6 +97,11 @@ struct nfc_target_sequence {
     gint refcount;
     NfcTarget* target;
     NFC_SEQUENCE_FLAGS flags;
+    guint max_idle_ms;
+    guint max_hold_ms;
+    guint idle_timer;
+    guint hold_timer;
+    gboolean expired;
 };
 
 typedef struct nfc_target_sequence_queue {
@@ -104,6 +113,7 @@ struct nfc_target_priv {
     guint last_req_id;
     guint continue_id;
     NfcTargetRequest* req_active;
+    NfcTargetSequence* yielded;
     NfcTargetSequenceQueue seq_queue;
     NfcTargetRequestQueue req_queue;
     guint tx_timeout_ms;
@@ -123,11 +133,13 @@ G_DEFINE_ABSTRACT_TYPE(NfcTarget, nfc_target, PARENT_TYPE)
 enum nfc_target_signal {
     SIGNAL_SEQUENCE,
     SIGNAL_GONE,
+    SIGNAL_LEASE_EXPIRED,
     SIGNAL_COUNT
 };
 
-#define SIGNAL_SEQUENCE_NAME    "nfc-target-sequence"
-#define SIGNAL_GONE_NAME        "nfc-target-gone"
+#define SIGNAL_SEQUENCE_NAME      "nfc-target-sequence"
+#define SIGNAL_GONE_NAME          "nfc-target-gone"
+#define SIGNAL_LEASE_EXPIRED_NAME "nfc-target-lease-expired"
 
 static guint nfc_target_signals[SIGNAL_COUNT] = { 0 };
 
@@ -142,6 +154,24 @@ nfc_target_set_sequence(
     NfcTarget* self,
     NfcTargetSequence* seq);
 
+static
+NFC_TARGET_PRIORITY
+nfc_target_sequence_priority(
+    NfcTargetSequence* seq);
+
+static
+NfcTargetRequest*
+nfc_target_next_request(
+    NfcTargetRequestQueue* queue,
+    NfcTargetSequence* seq,
+    NfcTargetSequence* skip,
+    NfcTargetRequest** prev);
+
+static
+void
+nfc_target_check_lease(
+    NfcTarget* self);
+
 /*==========================================================================*
  * Transmit request
  *==========================================================================*/
@@ -240,6 +270,8 @@ nfc_target_transmit_request_new(
     const void* data,
     guint len,
     NfcTargetSequence* seq,
+    NFC_TARGET_PRIORITY priority,
+    guint deadline_ms,
     NfcTargetTransmitFunc complete,
     GDestroyNotify destroy,
     void* user_data)
@@ -268,6 +300,12 @@ nfc_target_transmit_request_new(
     req->id = nfc_target_generate_id(target);
     req->type = &transmit_request_type;
     req->target = target;
+    req->priority = (priority == NFC_TARGET_PRIORITY_DEFAULT) ?
+        nfc_target_sequence_priority(req->seq) : priority;
+    if (deadline_ms) {
+        req->deadline = g_get_monotonic_time() +
+            (gint64)deadline_ms * 1000;
+    }
     req->destroy = destroy;
     req->user_data = user_data;
     tx->data = data;
@@ -431,6 +469,7 @@ nfc_target_reactivate_request_new(
     req->id = nfc_target_generate_id(target);
     req->type = &reactivate_request_type;
     req->target = target;
+    req->priority = nfc_target_sequence_priority(req->seq);
     req->destroy = destroy;
     req->user_data = user_data;
     re->callback = cb;
@@ -441,6 +480,118 @@ nfc_target_reactivate_request_new(
  * Sequence
  *==========================================================================*/
 
+static
+void
+nfc_target_sequence_stop_idle_timer(
+    NfcTargetSequence* self)
+{
+    if (self->idle_timer) {
+        nfc_timer_remove(self->idle_timer);
+        self->idle_timer = 0;
+    }
+}
+
+static
+void
+nfc_target_sequence_stop_lease(
+    NfcTargetSequence* self)
+{
+    nfc_target_sequence_stop_idle_timer(self);
+    if (self->hold_timer) {
+        nfc_timer_remove(self->hold_timer);
+        self->hold_timer = 0;
+    }
+}
+
+static
+void
+nfc_target_sequence_lease_expired(
+    NfcTargetSequence* self)
+{
+    NfcTarget* target = nfc_target_ref(self->target);
+
+    GDEBUG("Sequence %p lease expired", self);
+    nfc_target_sequence_stop_lease(self);
+    self->expired = TRUE;
+
+    /* The handler may renew the lease (or drop the sequence) */
+    nfc_target_sequence_ref(self);
+    g_signal_emit(target, nfc_target_signals[SIGNAL_LEASE_EXPIRED], 0, self);
+    nfc_target_sequence_unref(self);
+    nfc_target_check_lease(target);
+    nfc_target_unref(target);
+}
+
+static
+gboolean
+nfc_target_sequence_idle_timeout(
+    gpointer user_data)
+{
+    NfcTargetSequence* self = user_data;
+
+    self->idle_timer = 0;
+    nfc_target_sequence_lease_expired(self);
+    return G_SOURCE_REMOVE;
+}
+
+static
+gboolean
+nfc_target_sequence_hold_timeout(
+    gpointer user_data)
+{
+    NfcTargetSequence* self = user_data;
+
+    self->hold_timer = 0;
+    nfc_target_sequence_lease_expired(self);
+    return G_SOURCE_REMOVE;
+}
+
+static
+void
+nfc_target_sequence_start_idle_timer(
+    NfcTargetSequence* self)
+{
+    if (self->max_idle_ms && !self->idle_timer && !self->expired) {
+        self->idle_timer = nfc_timer_add(self->max_idle_ms,
+            TIMER_SLACK(self->max_idle_ms), nfc_target_sequence_idle_timeout,
+            self);
+    }
+}
+
+static
+void
+nfc_target_sequence_start_lease(
+    NfcTargetSequence* self)
+{
+    nfc_target_sequence_stop_lease(self);
+    self->expired = FALSE;
+    if (self->max_hold_ms) {
+        self->hold_timer = nfc_timer_add(self->max_hold_ms,
+            TIMER_SLACK(self->max_hold_ms), nfc_target_sequence_hold_timeout,
+            self);
+    }
+    nfc_target_sequence_start_idle_timer(self);
+}
+
+static
+gboolean
+nfc_target_sequence_others_waiting(
+    NfcTargetSequence* self)
+{
+    NfcTargetPriv* priv = self->target->priv;
+    NfcTargetSequence* seq;
+
+    if (nfc_target_next_request(&priv->req_queue, NULL, self, NULL)) {
+        return TRUE;
+    }
+    for (seq = priv->seq_queue.first; seq; seq = seq->next) {
+        if (seq != self) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 static
 void
 nfc_target_sequence_dealloc(
@@ -448,10 +599,14 @@ nfc_target_sequence_dealloc(
 {
     NfcTarget* target = self->target;
 
+    nfc_target_sequence_stop_lease(self);
     if (target) {
         NfcTargetPriv* priv = target->priv;
         NfcTargetSequenceQueue* queue = &priv->seq_queue;
 
+        if (priv->yielded == self) {
+            priv->yielded = NULL;
+        }
         if (queue->first == self) {
             /* Typically sequences are being deallocated in the order
              * they were created and that's optimal */
@@ -472,17 +627,18 @@ nfc_target_sequence_dealloc(
             }
         }
         if (target->sequence == self) {
-            NfcTargetRequest* req = priv->req_queue.first;
+            NfcTargetRequest* req = nfc_target_next_request(&priv->req_queue,
+                NULL, NULL, NULL);
 
             /*
              * The last reference to the current sequence is gone.
              * We need to clear the pointer to it.
              *
              * Also, we need to ensure that requests are processed
-             * in the order they were submitted. If the next request
-             * doesn't belong to a sequence, then we will clear the
-             * current sequence and submit the request anyway (even
-             * though there may be some sequences in the queue).
+             * in the right order (see nfc_target_next_request). If the
+             * next request doesn't belong to a sequence, then we will
+             * clear the current sequence and submit the request anyway
+             * (even though there may be some sequences in the queue).
              */
             nfc_target_set_sequence(target, req ? req->seq : queue->first);
 
@@ -523,6 +679,17 @@ nfc_target_set_sequence(
     NfcTargetSequence* seq)
 {
     if (self->sequence != seq) {
+        NfcTargetPriv* priv = self->priv;
+
+        if (self->sequence) {
+            nfc_target_sequence_stop_lease(self->sequence);
+        }
+        if (seq) {
+            if (priv->yielded == seq) {
+                priv->yielded = NULL;
+            }
+            nfc_target_sequence_start_lease(seq);
+        }
         self->sequence = seq;
         nfc_target_sequence_ref(seq);
         GET_THIS_CLASS(self)->sequence_changed(self);
@@ -565,6 +732,9 @@ nfc_target_sequence_new2(
          * associated with it */
         if (!target->sequence) {
             nfc_target_set_sequence(target, self);
+        } else {
+            /* The current one may have to yield */
+            nfc_target_check_lease(target);
         }
         return self;
     }
@@ -585,6 +755,65 @@ nfc_target_sequence_flags(
     return G_LIKELY(self) ? self->flags : NFC_SEQUENCE_FLAGS_NONE;
 }
 
+void
+nfc_target_sequence_set_lease(
+    NfcTargetSequence* self,
+    guint max_idle_ms,
+    guint max_hold_ms) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self)) {
+        NfcTarget* target = self->target;
+
+        self->max_idle_ms = max_idle_ms;
+        self->max_hold_ms = max_hold_ms;
+        if (target && target->sequence == self) {
+            nfc_target_sequence_start_lease(self);
+            if (target->priv->req_active) {
+                /* The idle timer starts when nothing is going on */
+                nfc_target_sequence_stop_idle_timer(self);
+            }
+        }
+    }
+}
+
+gboolean
+nfc_target_sequence_renew(
+    NfcTargetSequence* self) /* Since 1.1.19 */
+{
+    if (G_LIKELY(self)) {
+        NfcTarget* target = self->target;
+
+        /*
+         * Expired lease can't be renewed if someone else is waiting,
+         * otherwise renewing would defeat the whole purpose of leases.
+         */
+        if (target && target->sequence == self &&
+            (!self->expired || !nfc_target_sequence_others_waiting(self))) {
+            GDEBUG("Sequence %p lease renewed", self);
+            nfc_target_sequence_start_lease(self);
+            if (target->priv->req_active) {
+                nfc_target_sequence_stop_idle_timer(self);
+            }
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static
+NFC_TARGET_PRIORITY
+nfc_target_sequence_priority(
+    NfcTargetSequence* self)
+{
+    const NFC_SEQUENCE_FLAGS flags = nfc_target_sequence_flags(self);
+
+    return (flags & NFC_SEQUENCE_FLAG_INTERACTIVE) ?
+        NFC_TARGET_PRIORITY_INTERACTIVE :
+        (flags & NFC_SEQUENCE_FLAG_BACKGROUND) ?
+        NFC_TARGET_PRIORITY_BACKGROUND :
+        NFC_TARGET_PRIORITY_NORMAL;
+}
+
 /*==========================================================================*
  * Implementation
  *==========================================================================*/
@@ -598,7 +827,7 @@ nfc_target_free_request(
 
     nfc_target_sequence_unref(req->seq);
     if (req->timeout) {
-        g_source_remove(req->timeout);
+        nfc_timer_remove(req->timeout);
     }
     if (req->destroy) {
         req->destroy(req->user_data);
@@ -656,6 +885,71 @@ nfc_target_transmit_queue_req(
     queue->last = req;
 }
 
+static
+gboolean
+nfc_target_request_before(
+    const NfcTargetRequest* req,
+    const NfcTargetRequest* other)
+{
+    if (req->priority != other->priority) {
+        return req->priority < other->priority;
+    } else {
+        /* Earliest deadline first, then no deadline, then FIFO */
+        return req->deadline && (!other->deadline ||
+            req->deadline < other->deadline);
+    }
+}
+
+static
+gboolean
+nfc_target_request_blocked(
+    const NfcTargetRequestQueue* queue,
+    const NfcTargetRequest* req)
+{
+    /*
+     * Requests belonging to the same sequence are served in FIFO order,
+     * priorities and deadlines only reorder requests across sequences.
+     * Requests without a sequence aren't bound to each other.
+     */
+    if (req->seq) {
+        const NfcTargetRequest* r;
+
+        for (r = queue->first; r != req; r = r->next) {
+            if (r->seq == req->seq) {
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+}
+
+static
+NfcTargetRequest*
+nfc_target_next_request(
+    NfcTargetRequestQueue* queue,
+    NfcTargetSequence* seq, /* NULL if any */
+    NfcTargetSequence* skip, /* Requests to ignore (NULL if none) */
+    NfcTargetRequest** prev_out)
+{
+    NfcTargetRequest* best = NULL;
+    NfcTargetRequest* best_prev = NULL;
+    NfcTargetRequest* prev = NULL;
+    NfcTargetRequest* req;
+
+    for (req = queue->first; req; prev = req, req = req->next) {
+        if ((!seq || req->seq == seq) && (!skip || req->seq != skip) &&
+            (!best || nfc_target_request_before(req, best)) &&
+            !nfc_target_request_blocked(queue, req)) {
+            best = req;
+            best_prev = prev;
+        }
+    }
+    if (prev_out) {
+        *prev_out = best_prev;
+    }
+    return best;
+}
+
 static
 NfcTargetRequest*
 nfc_target_transmit_dequeue_req(
@@ -663,34 +957,76 @@ nfc_target_transmit_dequeue_req(
 {
     NfcTargetPriv* priv = self->priv;
     NfcTargetRequestQueue* queue = &priv->req_queue;
-    NfcTargetRequest* req = queue->first;
     NfcTargetSequence* seq = self->sequence;
+    NfcTargetRequest* prev;
+    NfcTargetRequest* req = NULL;
 
+    /* Whoever has yielded goes last */
+    if (!seq && priv->yielded) {
+        req = nfc_target_next_request(queue, NULL, priv->yielded, &prev);
+    }
+    if (!req) {
+        req = nfc_target_next_request(queue, seq, NULL, &prev);
+    }
     if (req) {
-        if (!seq || req->seq == seq) {
-            if (!(queue->first = req->next)) {
-                queue->last = NULL;
+        if (prev) {
+            prev->next = req->next;
+        } else {
+            queue->first = req->next;
+        }
+        if (queue->last == req) {
+            queue->last = prev;
+        }
+        req->next = NULL;
+    }
+    return req;
+}
+
+static
+void
+nfc_target_drop_expired_requests(
+    NfcTarget* self)
+{
+    NfcTargetPriv* priv = self->priv;
+    NfcTargetRequestQueue* queue = &priv->req_queue;
+    NfcTargetRequestQueue expired = { NULL, NULL };
+    NfcTargetRequest* prev = NULL;
+    NfcTargetRequest* req = queue->first;
+    const gint64 now = g_get_monotonic_time();
+
+    while (req) {
+        NfcTargetRequest* next = req->next;
+
+        if (req->priority == NFC_TARGET_PRIORITY_BACKGROUND &&
+            req->deadline && req->deadline <= now) {
+            if (prev) {
+                prev->next = next;
+            } else {
+                queue->first = next;
+            }
+            if (queue->last == req) {
+                queue->last = prev;
             }
             req->next = NULL;
+            nfc_target_transmit_queue_req(&expired, req);
         } else {
-            NfcTargetRequest* prev = req;
-
-            /* Scan the queue */
-            req = req->next;
-            while (req) {
-                if (!seq || req->seq == seq) {
-                    if (!(prev->next = req->next)) {
-                        queue->last = prev;
-                    }
-                    req->next = NULL;
-                    break;
-                }
-                prev = req;
-                req = req->next;
-            }
+            prev = req;
         }
+        req = next;
+    }
+
+    /* Callbacks may touch the queue, it's been fixed up by now */
+    while (expired.first) {
+        const NfcTargetRequestType* rt;
+
+        req = expired.first;
+        rt = req->type;
+        expired.first = req->next;
+        req->next = NULL;
+        GDEBUG("%s request %u expired", rt->name, req->id);
+        rt->timed_out(req);
+        nfc_target_free_request(req);
     }
-    return req;
 }
 
 static
@@ -706,6 +1042,9 @@ nfc_target_submit_request(
     if (!self->sequence && req->seq) {
         nfc_target_set_sequence(self, req->seq);
     }
+    if (self->sequence) {
+        nfc_target_sequence_stop_idle_timer(self->sequence);
+    }
     if (rt->submit(req)) {
         /*
          * If the target goes away during submission of the request, the
@@ -717,7 +1056,7 @@ nfc_target_submit_request(
 
             if (ms) {
                 GASSERT(!req->timeout);
-                req->timeout = g_timeout_add(ms,
+                req->timeout = nfc_timer_add(ms, TIMER_SLACK(ms),
                     nfc_target_request_timeout, req);
             }
         }
@@ -736,9 +1075,12 @@ nfc_target_submit_next_request(
     NfcTargetPriv* priv = self->priv;
 
     if (!priv->req_active) {
-        NfcTargetRequest* req = nfc_target_transmit_dequeue_req(self);
+        NfcTargetRequest* req;
 
         nfc_target_ref(self);
+        nfc_target_drop_expired_requests(self);
+        nfc_target_check_lease(self);
+        req = priv->req_active ? NULL : nfc_target_transmit_dequeue_req(self);
         while (req) {
             if (nfc_target_submit_request(self, req)) {
                 /* Request submitted, wait for completion */
@@ -765,6 +1107,36 @@ nfc_target_next_transmit(
     return G_SOURCE_REMOVE;
 }
 
+static
+void
+nfc_target_check_lease(
+    NfcTarget* self)
+{
+    NfcTargetPriv* priv = self->priv;
+    NfcTargetSequence* seq = self->sequence;
+
+    /*
+     * The sequence with expired lease yields to whoever is waiting,
+     * but not in the middle of a transmission. Its requests remain
+     * queued and it becomes current again when it gets its turn.
+     */
+    if (seq && seq->expired && !priv->req_active &&
+        nfc_target_sequence_others_waiting(seq)) {
+        NfcTargetRequest* req = nfc_target_next_request(&priv->req_queue,
+            NULL, seq, NULL);
+        NfcTargetSequence* next = req ? req->seq : priv->seq_queue.first;
+
+        if (next == seq) {
+            next = seq->next;
+        }
+        GDEBUG("Sequence %p yields to %p", seq, next);
+        seq->expired = FALSE;
+        priv->yielded = seq;
+        nfc_target_set_sequence(self, next);
+        nfc_target_schedule_next_request(self);
+    }
+}
+
 static
 void
 nfc_target_schedule_next_request(
@@ -772,6 +1144,10 @@ nfc_target_schedule_next_request(
 {
     NfcTargetPriv* priv = self->priv;
 
+    if (self->sequence && !priv->req_active) {
+        /* Nothing is going on, the idle gap begins */
+        nfc_target_sequence_start_idle_timer(self->sequence);
+    }
     if (priv->req_queue.first && !priv->continue_id) {
         priv->continue_id = g_idle_add(nfc_target_next_transmit, self);
     }
@@ -859,20 +1235,47 @@ nfc_target_transmit(
     NfcTargetTransmitFunc complete,
     GDestroyNotify destroy,
     void* user_data)
+{
+    return nfc_target_transmit2(self, data, len, seq,
+        NFC_TARGET_PRIORITY_DEFAULT, 0, complete, destroy, user_data);
+}
+
+guint
+nfc_target_transmit2(
+    NfcTarget* self,
+    const void* data,
+    guint len,
+    NfcTargetSequence* seq,
+    NFC_TARGET_PRIORITY priority,
+    guint deadline_ms,
+    NfcTargetTransmitFunc complete,
+    GDestroyNotify destroy,
+    void* user_data) /* Since 1.1.19 */
 {
     guint id = 0;
 
     if (G_LIKELY(self)) {
         NfcTargetPriv* priv = self->priv;
         NfcTargetTransmitRequest* tx = nfc_target_transmit_request_new(self,
-            data, len, seq, complete, destroy, user_data);
+            data, len, seq, priority, deadline_ms, complete, destroy,
+            user_data);
         NfcTargetRequest* req = &tx->request;
+        NfcTargetRequest* next;
 
         /* Request id to return */
         id = req->id;
 
-        /* Check if the request can be submitted right away */
-        if (!priv->req_active && (req->seq == self->sequence)) {
+        /* The current sequence may have to yield first */
+        nfc_target_check_lease(self);
+
+        /*
+         * Check if the request can be submitted right away, i.e. nothing
+         * is going on and there's nothing more urgent in the queue.
+         */
+        if (!priv->req_active && (req->seq == self->sequence) &&
+            (!(next = nfc_target_next_request(&priv->req_queue,
+            self->sequence, NULL, NULL)) || (!req->seq &&
+            !nfc_target_request_before(next, req)))) {
             /*
              * The data will be copied by the transmit method, no need
              * to make another copy and attach it to the request.
@@ -890,6 +1293,9 @@ nfc_target_transmit(
              */
             tx->data = tx->copied_data = gutil_memdup(data, len);
             nfc_target_transmit_queue_req(&priv->req_queue, req);
+            if (!priv->req_active) {
+                nfc_target_schedule_next_request(self);
+            }
         }
     }
     return id;
@@ -1036,6 +1442,16 @@ nfc_target_add_sequence_handler(
         SIGNAL_SEQUENCE_NAME, G_CALLBACK(func), user_data) : 0;
 }
 
+gulong
+nfc_target_add_lease_expired_handler(
+    NfcTarget* self,
+    NfcTargetSequenceFunc func,
+    void* user_data) /* Since 1.1.19 */
+{
+    return (G_LIKELY(self) && G_LIKELY(func)) ? g_signal_connect(self,
+        SIGNAL_LEASE_EXPIRED_NAME, G_CALLBACK(func), user_data) : 0;
+}
+
 gulong
 nfc_target_add_gone_handler(
     NfcTarget* self,
@@ -1212,6 +1628,7 @@ nfc_target_finalize(
     while (seq) {
         NfcTargetSequence* next = seq->next;
 
+        nfc_target_sequence_stop_lease(seq);
         seq->target = NULL;
         seq->next = NULL;
         seq = next;
@@ -1241,6 +1658,10 @@ nfc_target_class_init(
     nfc_target_signals[SIGNAL_SEQUENCE] =
         g_signal_new(SIGNAL_SEQUENCE_NAME, G_OBJECT_CLASS_TYPE(klass),
             G_SIGNAL_RUN_FIRST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
+    nfc_target_signals[SIGNAL_LEASE_EXPIRED] =
+        g_signal_new(SIGNAL_LEASE_EXPIRED_NAME, G_OBJECT_CLASS_TYPE(klass),
+            G_SIGNAL_RUN_FIRST, 0, NULL, NULL, NULL, G_TYPE_NONE,
+            1, G_TYPE_POINTER);
 }
 
 /*
@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "nfc_timer.h"
+#include "nfc_log.h"
+
+typedef struct nfc_timer_wheel NfcTimerWheel;
+
+typedef struct nfc_timer {
+    guint id;
+    NfcTimerWheel* wheel;
+    gint64 deadline;  /* Monotonic time, microseconds */
+    gint64 interval;
+    gint64 slack;
+    GSourceFunc func; /* NULL if removed while being dispatched */
+    gpointer user_data;
+} NfcTimer;
+
+struct nfc_timer_wheel {
+    GMainContext* context;
+    GSource* source;  /* Timeout source, NULL if not armed */
+    gint64 ready;     /* When the source fires, -1 if not armed */
+    GList* timers;    /* Sorted by deadline */
+    GList* due;       /* Waiting to be dispatched */
+    NfcTimer* running;
+    gboolean dispatching;
+};
+
+#define WAKEUP_BUCKETS (60) /* One per second */
+#define WAKEUP_REPORT_INTERVAL (60) /* Seconds */
+
+typedef struct nfc_timer_stats {
+    guint total;
+    guint count[WAKEUP_BUCKETS];
+    gint64 second[WAKEUP_BUCKETS];
+    gint64 reported_second;
+    guint reported_per_minute;
+} NfcTimerStats;
+
+/* Timers are only touched from the threads owning their contexts */
+static GHashTable* nfc_timer_ids = NULL;    /* id => NfcTimer */
+static GHashTable* nfc_timer_wheels = NULL; /* GMainContext => wheel */
+static guint nfc_timer_last_id = 0;
+static NfcTimerStats nfc_timer_stats;
+
+/*==========================================================================*
+ * Implementation
+ *==========================================================================*/
+
+static
+gint
+nfc_timer_compare(
+    gconstpointer a,
+    gconstpointer b)
+{
+    const NfcTimer* t1 = a;
+    const NfcTimer* t2 = b;
+
+    return (t1->deadline < t2->deadline) ? -1 :
+        (t1->deadline > t2->deadline) ? 1 : 0;
+}
+
+static
+guint
+nfc_timer_stats_per_minute(
+    const NfcTimerStats* stats,
+    gint64 sec)
+{
+    guint i, count = 0;
+
+    for (i = 0; i < WAKEUP_BUCKETS; i++) {
+        if (stats->count[i] && (sec - stats->second[i]) < WAKEUP_BUCKETS) {
+            count += stats->count[i];
+        }
+    }
+    return count;
+}
+
+static
+void
+nfc_timer_count_wakeup(
+    gint64 now)
+{
+    NfcTimerStats* stats = &nfc_timer_stats;
+    const gint64 sec = now / G_USEC_PER_SEC;
+    const guint i = (guint)(sec % WAKEUP_BUCKETS);
+
+    stats->total++;
+    if (stats->second[i] != sec) {
+        stats->second[i] = sec;
+        stats->count[i] = 0;
+    }
+    stats->count[i]++;
+
+    /* Report the rate at most once a minute and only if it changes */
+    if ((sec - stats->reported_second) >= WAKEUP_REPORT_INTERVAL) {
+        const guint per_minute = nfc_timer_stats_per_minute(stats, sec);
+
+        stats->reported_second = sec;
+        if (stats->reported_per_minute != per_minute) {
+            stats->reported_per_minute = per_minute;
+            GDEBUG("%u timer wakeup(s) per minute, %u total", per_minute,
+                stats->total);
+        }
+    }
+}
+
+static
+gboolean
+nfc_timer_wheel_dispatch(
+    gpointer data);
+
+static
+void
+nfc_timer_wheel_disarm(
+    NfcTimerWheel* wheel)
+{
+    if (wheel->source) {
+        g_source_destroy(wheel->source);
+        wheel->source = NULL;
+    }
+    wheel->ready = -1;
+}
+
+static
+void
+nfc_timer_wheel_update(
+    NfcTimerWheel* wheel)
+{
+    gint64 ready = -1;
+    GList* l;
+
+    /*
+     * The wheel wakes up at the earliest deadline + slack. Everything
+     * whose deadline has passed by then gets dispatched at once.
+     */
+    for (l = wheel->timers; l; l = l->next) {
+        const NfcTimer* timer = l->data;
+
+        if (ready >= 0 && timer->deadline >= ready) {
+            /* The rest is sorted, nothing can fire any earlier */
+            break;
+        } else {
+            const gint64 t = timer->deadline + timer->slack;
+
+            if (ready < 0 || t < ready) {
+                ready = t;
+            }
+        }
+    }
+
+    /*
+     * The timeout source gets re-armed whenever the ready time changes.
+     * Its granularity is one millisecond, so the delay is rounded up.
+     */
+    if (wheel->ready != ready) {
+        nfc_timer_wheel_disarm(wheel);
+        if (ready >= 0) {
+            const gint64 now = g_get_monotonic_time();
+            const gint64 ms = (ready > now) ? ((ready - now + 999) / 1000) : 0;
+            GSource* source = g_timeout_source_new((guint)MIN(ms, G_MAXUINT));
+
+            g_source_set_callback(source, nfc_timer_wheel_dispatch, wheel,
+                NULL);
+            g_source_attach(source, wheel->context);
+            g_source_unref(source); /* The context keeps the reference */
+            wheel->source = source;
+            wheel->ready = ready;
+        }
+    }
+}
+
+static
+void
+nfc_timer_wheel_drop(
+    NfcTimerWheel* wheel)
+{
+    GDEBUG("No more timers");
+    g_hash_table_remove(nfc_timer_wheels, wheel->context);
+    if (!g_hash_table_size(nfc_timer_wheels)) {
+        g_hash_table_destroy(nfc_timer_wheels);
+        nfc_timer_wheels = NULL;
+    }
+    GASSERT(!wheel->timers);
+    GASSERT(!wheel->due);
+    nfc_timer_wheel_disarm(wheel);
+    g_main_context_unref(wheel->context);
+    g_slice_free(NfcTimerWheel, wheel);
+}
+
+static
+void
+nfc_timer_wheel_check(
+    NfcTimerWheel* wheel)
+{
+    if (!wheel->dispatching) {
+        if (wheel->timers) {
+            nfc_timer_wheel_update(wheel);
+        } else {
+            nfc_timer_wheel_drop(wheel);
+        }
+    }
+}
+
+static
+void
+nfc_timer_unregister(
+    NfcTimer* timer)
+{
+    g_hash_table_remove(nfc_timer_ids, GUINT_TO_POINTER(timer->id));
+    if (!g_hash_table_size(nfc_timer_ids)) {
+        g_hash_table_destroy(nfc_timer_ids);
+        nfc_timer_ids = NULL;
+    }
+}
+
+static
+gboolean
+nfc_timer_wheel_dispatch(
+    gpointer data)
+{
+    NfcTimerWheel* wheel = data;
+    const gint64 now = g_get_monotonic_time();
+
+    /* The timeout source is gone after we return */
+    wheel->source = NULL;
+    wheel->ready = -1;
+    nfc_timer_count_wakeup(now);
+    while (wheel->timers) {
+        GList* link = wheel->timers;
+        const NfcTimer* timer = link->data;
+
+        if (timer->deadline <= now) {
+            wheel->timers = g_list_remove_link(wheel->timers, link);
+            wheel->due = g_list_concat(wheel->due, link);
+        } else {
+            break;
+        }
+    }
+
+    GVERBOSE("Wakeup #%u, %u timer(s) due", nfc_timer_stats.total,
+        g_list_length(wheel->due));
+    wheel->dispatching = TRUE;
+    while (wheel->due) {
+        NfcTimer* timer = wheel->due->data;
+
+        wheel->due = g_list_delete_link(wheel->due, wheel->due);
+        wheel->running = timer;
+        if (timer->func(timer->user_data) == G_SOURCE_CONTINUE &&
+            timer->func) {
+            timer->deadline = now + timer->interval;
+            wheel->timers = g_list_insert_sorted(wheel->timers, timer,
+                nfc_timer_compare);
+        } else {
+            if (timer->func) {
+                nfc_timer_unregister(timer);
+            }
+            g_slice_free(NfcTimer, timer);
+        }
+        wheel->running = NULL;
+    }
+    wheel->dispatching = FALSE;
+    nfc_timer_wheel_check(wheel);
+    return G_SOURCE_REMOVE;
+}
+
+static
+NfcTimerWheel*
+nfc_timer_wheel_get(
+    void)
+{
+    GMainContext* context = g_main_context_ref_thread_default();
+    NfcTimerWheel* wheel = nfc_timer_wheels ?
+        g_hash_table_lookup(nfc_timer_wheels, context) : NULL;
+
+    if (wheel) {
+        g_main_context_unref(context);
+    } else {
+        wheel = g_slice_new0(NfcTimerWheel);
+        wheel->context = context; /* Keeps the reference */
+        wheel->ready = -1;
+        if (!nfc_timer_wheels) {
+            nfc_timer_wheels = g_hash_table_new(g_direct_hash,
+                g_direct_equal);
+        }
+        g_hash_table_insert(nfc_timer_wheels, context, wheel);
+    }
+    return wheel;
+}
+
+/*==========================================================================*
+ * Internal interface
+ *==========================================================================*/
+
+guint
+nfc_timer_add(
+    guint ms,
+    guint slack_ms,
+    GSourceFunc func,
+    gpointer user_data)
+{
+    if (G_LIKELY(func)) {
+        NfcTimerWheel* wheel = nfc_timer_wheel_get();
+        NfcTimer* timer = g_slice_new(NfcTimer);
+
+        if (!nfc_timer_ids) {
+            nfc_timer_ids = g_hash_table_new(g_direct_hash, g_direct_equal);
+        }
+        do {
+            timer->id = ++nfc_timer_last_id;
+        } while (!timer->id || g_hash_table_contains(nfc_timer_ids,
+            GUINT_TO_POINTER(timer->id)));
+
+        timer->wheel = wheel;
+        timer->interval = (gint64)ms * 1000;
+        timer->slack = (gint64)slack_ms * 1000;
+        timer->deadline = g_get_monotonic_time() + timer->interval;
+        timer->func = func;
+        timer->user_data = user_data;
+        g_hash_table_insert(nfc_timer_ids, GUINT_TO_POINTER(timer->id), timer);
+        wheel->timers = g_list_insert_sorted(wheel->timers, timer,
+            nfc_timer_compare);
+        nfc_timer_wheel_check(wheel);
+        return timer->id;
+    }
+    return 0;
+}
+
+void
+nfc_timer_remove(
+    guint id)
+{
+    NfcTimer* timer = (id && nfc_timer_ids) ?
+        g_hash_table_lookup(nfc_timer_ids, GUINT_TO_POINTER(id)) : NULL;
+
+    if (timer) {
+        NfcTimerWheel* wheel = timer->wheel;
+
+        nfc_timer_unregister(timer);
+        if (wheel->running == timer) {
+            /* The dispatcher will free it */
+            timer->func = NULL;
+        } else {
+            GList* link = g_list_find(wheel->timers, timer);
+
+            if (link) {
+                wheel->timers = g_list_delete_link(wheel->timers, link);
+            } else {
+                wheel->due = g_list_remove(wheel->due, timer);
+            }
+            g_slice_free(NfcTimer, timer);
+        }
+        nfc_timer_wheel_check(wheel);
+    }
+}
+
+guint
+nfc_timer_wakeups(
+    void)
+{
+    return nfc_timer_stats.total;
+}
+
+guint
+nfc_timer_wakeups_per_minute(
+    void)
+{
+    return nfc_timer_stats_per_minute(&nfc_timer_stats,
+        g_get_monotonic_time() / G_USEC_PER_SEC);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef NFC_TIMER_H
+#define NFC_TIMER_H
+
+#include "nfc_types_p.h"
+
+/*
+ * Coalesced timers. All timers added on the same thread share a single
+ * timeout source attached to the thread-default main context, which is
+ * re-armed for the earliest deadline as timers come and go. Each timer has
+ * a slack, i.e. it may fire up to slack_ms later than requested, which
+ * allows nearby deadlines to be served by a single wakeup. The source
+ * is destroyed when the last timer is gone, so an idle process has no
+ * armed timers at all.
+ *
+ * The callback returns G_SOURCE_CONTINUE to re-arm the timer with the
+ * same interval or G_SOURCE_REMOVE to drop it. Ids are never zero.
+ * Like the rest of the core, these are not thread-safe.
+ */
+
+guint
+nfc_timer_add(
+    guint ms,
+    guint slack_ms,
+    GSourceFunc func,
+    gpointer user_data)
+    NFCD_INTERNAL;
+
+void
+nfc_timer_remove(
+    guint id)
+    NFCD_INTERNAL;
+
+/*
+ * Instrumentation. The wakeup rate also gets logged (at debug level)
+ * at most once a minute, whenever it changes.
+ */
+
+guint
+nfc_timer_wakeups(
+    void)
+    NFCD_INTERNAL;
+
+guint
+nfc_timer_wakeups_per_minute(
+    void)
+    NFCD_INTERNAL;
+
+#endif /* NFC_TIMER_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
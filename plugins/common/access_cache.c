@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "access_cache.h"
+
+#ifdef HAVE_DBUSACCESS
+
+#include <gutil_log.h>
+#include <gutil_macros.h>
+
+typedef struct access_cache_peer {
+    GHashTable* actions;    /* action => DA_ACCESS + 1 */
+    GHashTable* args;       /* "action:arg" => DA_ACCESS + 1 */
+    GDBusConnection* connection;
+    guint name_owner_changed_id;
+} AccessCachePeer;
+
+struct access_cache {
+    DA_BUS bus;
+    DAPolicy* policy;
+    GHashTable* peers;      /* name => AccessCachePeer */
+    GDBusConnection* connection;
+};
+
+#define DBUS_SERVICE    "org.freedesktop.DBus"
+#define DBUS_PATH       "/org/freedesktop/DBus"
+#define DBUS_INTERFACE  "org.freedesktop.DBus"
+
+/* Decision values are shifted by one to tell them apart from NULL */
+#define ACCESS_CACHE_VALUE(access) GINT_TO_POINTER((int)(access) + 1)
+#define ACCESS_CACHE_ACCESS(value) ((DA_ACCESS)(GPOINTER_TO_INT(value) - 1))
+
+static
+void
+access_cache_peer_free(
+    gpointer data)
+{
+    AccessCachePeer* peer = data;
+
+    if (peer->actions) {
+        g_hash_table_destroy(peer->actions);
+    }
+    if (peer->args) {
+        g_hash_table_destroy(peer->args);
+    }
+    if (peer->connection) {
+        g_dbus_connection_signal_unsubscribe(peer->connection,
+            peer->name_owner_changed_id);
+        g_object_unref(peer->connection);
+    }
+    gutil_slice_free(peer);
+}
+
+static
+void
+access_cache_name_owner_changed(
+    GDBusConnection* connection,
+    const char* sender,
+    const char* path,
+    const char* iface,
+    const char* signal,
+    GVariant* args,
+    gpointer user_data)
+{
+    AccessCache* self = user_data;
+    const char* name = NULL;
+    const char* old_owner = NULL;
+    const char* new_owner = NULL;
+
+    if (g_variant_is_of_type(args, G_VARIANT_TYPE("(sss)"))) {
+        g_variant_get(args, "(&s&s&s)", &name, &old_owner, &new_owner);
+        if (!new_owner[0]) {
+            access_cache_drop_peer(self, name);
+        }
+    }
+}
+
+static
+AccessCachePeer*
+access_cache_peer_new(
+    AccessCache* self,
+    const char* name)
+{
+    AccessCachePeer* peer = g_slice_new0(AccessCachePeer);
+    GDBusConnection* connection = self->connection;
+
+    if (connection) {
+        /*
+         * Only NameOwnerChanged signals for this particular name (arg0)
+         * are of interest. Sender can only be matched on a message bus
+         * connection. A fake signal would merely drop some cache entries.
+         */
+        g_object_ref(peer->connection = connection);
+        peer->name_owner_changed_id =
+            g_dbus_connection_signal_subscribe(connection,
+                g_dbus_connection_get_unique_name(connection) ?
+                DBUS_SERVICE : NULL, DBUS_INTERFACE, "NameOwnerChanged",
+                DBUS_PATH, name, G_DBUS_SIGNAL_FLAGS_NONE,
+                access_cache_name_owner_changed, self, NULL);
+    }
+    g_hash_table_insert(self->peers, g_strdup(name), peer);
+    return peer;
+}
+
+AccessCache*
+access_cache_new(
+    DA_BUS bus,
+    const char* spec,
+    const DA_ACTION* actions)
+{
+    AccessCache* self = g_slice_new0(AccessCache);
+
+    self->bus = bus;
+    self->policy = da_policy_new_full(spec, actions);
+    self->peers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+        access_cache_peer_free);
+    return self;
+}
+
+void
+access_cache_free(
+    AccessCache* self)
+{
+    if (self) {
+        g_hash_table_destroy(self->peers);
+        if (self->connection) {
+            g_object_unref(self->connection);
+        }
+        da_policy_unref(self->policy);
+        gutil_slice_free(self);
+    }
+}
+
+void
+access_cache_set_connection(
+    AccessCache* self,
+    GDBusConnection* connection)
+{
+    if (self && self->connection != connection) {
+        /* Peers are watched on the connection they were added with */
+        g_hash_table_remove_all(self->peers);
+        if (self->connection) {
+            g_object_unref(self->connection);
+        }
+        self->connection = connection;
+        if (connection) {
+            g_object_ref(connection);
+        }
+    }
+}
+
+void
+access_cache_set_policy(
+    AccessCache* self,
+    DAPolicy* policy)
+{
+    if (self && self->policy != policy) {
+        da_policy_unref(self->policy);
+        self->policy = da_policy_ref(policy);
+        g_hash_table_remove_all(self->peers);
+    }
+}
+
+void
+access_cache_drop_peer(
+    AccessCache* self,
+    const char* name)
+{
+    if (self && name && g_hash_table_remove(self->peers, name)) {
+        GDEBUG("Dropped cached access decisions for %s", name);
+    }
+}
+
+DA_ACCESS
+access_cache_check(
+    AccessCache* self,
+    const char* name,
+    guint action,
+    const char* arg,
+    DA_ACCESS def)
+{
+    AccessCachePeer* peer = g_hash_table_lookup(self->peers, name);
+    char* arg_key = arg ? g_strdup_printf("%u:%s", action, arg) : NULL;
+    DAPeer* da_peer;
+    DA_ACCESS access;
+
+    if (peer) {
+        GHashTable* table = arg ? peer->args : peer->actions;
+        gpointer value = table ? (arg ?
+            g_hash_table_lookup(table, arg_key) :
+            g_hash_table_lookup(table, GUINT_TO_POINTER(action))) : NULL;
+
+        if (value) {
+            g_free(arg_key);
+            return ACCESS_CACHE_ACCESS(value);
+        }
+    }
+
+    /*
+     * Start watching the name before querying the peer information,
+     * so that its disappearance can't slip through the cracks.
+     */
+    if (!peer) {
+        peer = access_cache_peer_new(self, name);
+    }
+
+    /*
+     * If we get no peer information from dbus-daemon, it means that
+     * the peer is gone. Nothing gets cached in that case.
+     */
+    da_peer = da_peer_get(self->bus, name);
+    if (!da_peer) {
+        g_hash_table_remove(self->peers, name);
+        g_free(arg_key);
+        return DA_ACCESS_DENY;
+    }
+
+    access = da_policy_check(self->policy, &da_peer->cred, action, arg, def);
+    if (arg) {
+        if (!peer->args) {
+            peer->args = g_hash_table_new_full(g_str_hash, g_str_equal,
+                g_free, NULL);
+        }
+        g_hash_table_insert(peer->args, arg_key, ACCESS_CACHE_VALUE(access));
+    } else {
+        if (!peer->actions) {
+            peer->actions = g_hash_table_new(g_direct_hash, g_direct_equal);
+        }
+        g_hash_table_insert(peer->actions, GUINT_TO_POINTER(action),
+            ACCESS_CACHE_VALUE(access));
+    }
+    return access;
+}
+
+DA_ACCESS
+access_cache_check_cred(
+    AccessCache* self,
+    const DACred* cred,
+    guint action,
+    const char* arg,
+    DA_ACCESS def)
+{
+    return da_policy_check(self->policy, cred, action, arg, def);
+}
+
+#endif /* HAVE_DBUSACCESS */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ACCESS_CACHE_H
+#define ACCESS_CACHE_H
+
+/*
+ * Caches dbusaccess policy decisions per (sender, action, arg).
+ * Sender is expected to be a unique bus name. Such names are never
+ * reused, so the entries remain valid until the policy changes. They
+ * are dropped when the name disappears from the bus (if the bus
+ * connection is provided, each cached name is watched individually)
+ * and all at once when the policy or the connection gets replaced.
+ * The default access must be the same for all checks of the same
+ * action.
+ *
+ * Peers without a bus name (e.g. on the other end of a peer-to-peer
+ * connection) are checked against the current policy directly, by
+ * their credentials. Those decisions aren't cached.
+ */
+
+#ifdef HAVE_DBUSACCESS
+
+#include <dbusaccess_policy.h>
+#include <dbusaccess_peer.h>
+
+#include <gio/gio.h>
+
+typedef struct access_cache AccessCache;
+
+AccessCache*
+access_cache_new(
+    DA_BUS bus,
+    const char* spec,
+    const DA_ACTION* actions);
+
+void
+access_cache_free(
+    AccessCache* cache);
+
+void
+access_cache_set_connection(
+    AccessCache* cache,
+    GDBusConnection* connection);
+
+void
+access_cache_set_policy(
+    AccessCache* cache,
+    DAPolicy* policy);
+
+void
+access_cache_drop_peer(
+    AccessCache* cache,
+    const char* name);
+
+DA_ACCESS
+access_cache_check(
+    AccessCache* cache,
+    const char* name,
+    guint action,
+    const char* arg,
+    DA_ACCESS def);
+
+DA_ACCESS
+access_cache_check_cred(
+    AccessCache* cache,
+    const DACred* cred,
+    guint action,
+    const char* arg,
+    DA_ACCESS def);
+
+#endif /* HAVE_DBUSACCESS */
+
+#endif /* ACCESS_CACHE_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -39,12 +39,27 @@ typedef struct dbus_handlers_run {
     DBusHandlers* handlers;
     DBusHandlersConfig* config;
     DBusHandlerConfig* handler;
+    DBusHandlerConfig* tried; /* Cached handler, called first */
     DBusHandlerCall* handler_call;
     DBusHandlerCall* listener_calls;
     GCancellable* cancellable;
+    char* key;
+    guint chain;
     gboolean handled;
 } DBusHandlersRun;
 
+/*
+ * Outcome cache remembers which handler has accepted the NDEF last
+ * time, so that the same NDEF goes straight to that handler. If the
+ * handler refuses it, the rest of the chain is walked as usual. The
+ * entry is ignored if the chain (as loaded from the config files)
+ * has changed since then.
+ */
+typedef struct dbus_handlers_outcome {
+    guint chain;    /* Hash of the handler chain */
+    guint index;    /* Position of the accepting handler in the chain */
+} DBusHandlersOutcome;
+
 struct dbus_handler_call {
     DBusHandlerCall* next;
     DBusHandlersRun* run;
@@ -54,11 +69,20 @@ struct dbus_handlers {
     char* dir;
     DBusHandlersRun* run;
     GDBusConnection* connection;
+    GHashTable* outcomes;   /* NDEF key => DBusHandlersOutcome */
+    GQueue outcome_keys;    /* Oldest first, owned by the hash table */
+    GCancellable* pings;
+    GStrV* prewarm;         /* Services to ping, read once */
 };
 
 #define NDEF_NOT_HANDLED (0)
 #define NDEF_HANDLED (1)
 
+#define DBUS_HANDLERS_MAX_OUTCOMES (64)
+
+#define DBUS_PEER_INTERFACE "org.freedesktop.DBus.Peer"
+#define DBUS_PEER_METHOD_PING "Ping"
+
 static
 void
 dbus_handlers_run_free(
@@ -69,6 +93,160 @@ void
 dbus_handlers_run_next(
     DBusHandlersRun* run);
 
+/*==========================================================================*
+ * Outcome cache
+ *==========================================================================*/
+
+static
+char*
+dbus_handlers_ndef_key(
+    NfcNdefRec* ndef)
+{
+    /* Type of the first record followed by the content hash */
+    GChecksum* sha1 = g_checksum_new(G_CHECKSUM_SHA1);
+    GString* key = g_string_new(NULL);
+    NfcNdefRec* rec;
+    gsize i;
+
+    g_string_append_printf(key, "%d:", ndef->tnf);
+    for (i = 0; i < ndef->type.size; i++) {
+        g_string_append_printf(key, "%02x", ndef->type.bytes[i]);
+    }
+    for (rec = ndef; rec; rec = rec->next) {
+        g_checksum_update(sha1, rec->raw.bytes, rec->raw.size);
+    }
+    g_string_append_c(key, ':');
+    g_string_append(key, g_checksum_get_string(sha1));
+    g_checksum_free(sha1);
+    return g_string_free(key, FALSE);
+}
+
+static
+guint
+dbus_handlers_chain_hash(
+    const DBusHandlerConfig* handler)
+{
+    guint hash = 1;
+
+    for (; handler; handler = handler->next) {
+        const DBusConfig* dbus = &handler->dbus;
+
+        hash = hash * 31 + g_str_hash(handler->type->name);
+        hash = hash * 31 + g_str_hash(dbus->service);
+        hash = hash * 31 + g_str_hash(dbus->path);
+        hash = hash * 31 + g_str_hash(dbus->iface);
+        hash = hash * 31 + g_str_hash(dbus->method);
+    }
+    return hash;
+}
+
+static
+DBusHandlerConfig*
+dbus_handlers_cached_handler(
+    DBusHandlers* self,
+    DBusHandlersRun* run)
+{
+    const DBusHandlersOutcome* outcome = g_hash_table_lookup(self->outcomes,
+        run->key);
+
+    if (outcome && outcome->chain == run->chain) {
+        DBusHandlerConfig* handler = run->config->handlers;
+        guint i;
+
+        for (i = 0; i < outcome->index && handler; i++) {
+            handler = handler->next;
+        }
+        return handler;
+    }
+    return NULL;
+}
+
+static
+void
+dbus_handlers_forget_outcome(
+    DBusHandlers* self,
+    const char* key)
+{
+    gpointer orig_key;
+
+    if (g_hash_table_lookup_extended(self->outcomes, key, &orig_key, NULL)) {
+        g_queue_remove(&self->outcome_keys, orig_key);
+        g_hash_table_remove(self->outcomes, key);
+    }
+}
+
+static
+void
+dbus_handlers_remember_outcome(
+    DBusHandlers* self,
+    DBusHandlersRun* run)
+{
+    DBusHandlersOutcome* outcome = g_hash_table_lookup(self->outcomes,
+        run->key);
+    const DBusHandlerConfig* handler = run->config->handlers;
+    guint index = 0;
+
+    while (handler != run->handler) {
+        handler = handler->next;
+        index++;
+    }
+
+    if (!outcome) {
+        char* key = g_strdup(run->key);
+
+        /* Drop the oldest entry if there are too many */
+        if (g_hash_table_size(self->outcomes) >= DBUS_HANDLERS_MAX_OUTCOMES) {
+            g_hash_table_remove(self->outcomes,
+                g_queue_pop_head(&self->outcome_keys));
+        }
+        outcome = g_slice_new(DBusHandlersOutcome);
+        g_hash_table_insert(self->outcomes, key, outcome);
+        g_queue_push_tail(&self->outcome_keys, key);
+    }
+    outcome->chain = run->chain;
+    outcome->index = index;
+}
+
+static
+void
+dbus_handlers_outcome_free(
+    gpointer outcome)
+{
+    g_slice_free(DBusHandlersOutcome, outcome);
+}
+
+/*==========================================================================*
+ * Prewarm
+ *==========================================================================*/
+
+static
+void
+dbus_handlers_ping_done(
+    GObject* connection,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    GError* error = NULL;
+    GVariant* out = g_dbus_connection_call_finish
+        (G_DBUS_CONNECTION(connection), result, &error);
+    char* service = user_data;
+
+    if (out) {
+        GDEBUG("%s is up", service);
+        g_variant_unref(out);
+    } else {
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            GWARN("%s", GERRMSG(error));
+        }
+        g_error_free(error);
+    }
+    g_free(service);
+}
+
+/*==========================================================================*
+ * Run
+ *==========================================================================*/
+
 static
 DBusHandlerCall*
 dbus_handler_call_new(
@@ -88,6 +266,16 @@ dbus_handler_call_free(
     g_slice_free(DBusHandlerCall, call);
 }
 
+static
+DBusHandlerConfig*
+dbus_handlers_run_skip_tried(
+    DBusHandlersRun* run,
+    DBusHandlerConfig* handler)
+{
+    /* The cached handler isn't called twice */
+    return (handler && handler == run->tried) ? handler->next : handler;
+}
+
 static
 void
 dbus_handlers_run_handler_call_done(
@@ -132,8 +320,21 @@ dbus_handlers_run_handler_call_done(
     }
     dbus_handler_call_free(call);
     if (run) {
+        DBusHandlers* handlers = run->handlers;
+
         run->handler_call = NULL;
-        run->handler = (run->handled ? NULL : run->handler->next);
+        if (run->handled) {
+            dbus_handlers_remember_outcome(handlers, run);
+            run->handler = NULL;
+        } else {
+            /* If the cached handler has refused, start from the top */
+            run->handler = dbus_handlers_run_skip_tried(run,
+                (run->handler == run->tried) ? run->config->handlers :
+                run->handler->next);
+            if (!run->handler) {
+                dbus_handlers_forget_outcome(handlers, run->key);
+            }
+        }
         dbus_handlers_run_next(run);
     }
 }
@@ -278,7 +479,15 @@ dbus_handlers_run_new(
         run->config = conf;
         run->handlers = handlers;
         run->ndef = nfc_ndef_rec_ref(ndef);
-        run->handler = conf->handlers;
+        run->key = dbus_handlers_ndef_key(ndef);
+        run->chain = dbus_handlers_chain_hash(conf->handlers);
+        run->tried = dbus_handlers_cached_handler(handlers, run);
+        if (run->tried) {
+            GDEBUG("Trying %s first", run->tried->dbus.service);
+            run->handler = run->tried;
+        } else {
+            run->handler = conf->handlers;
+        }
         dbus_handlers_run_next(run);
         return run;
     }
@@ -297,6 +506,7 @@ dbus_handlers_run_free(
         dbus_handlers_run_cancelled(run->listener_calls);
         dbus_handlers_config_free(run->config);
         nfc_ndef_rec_unref(run->ndef);
+        g_free(run->key);
         g_slice_free(DBusHandlersRun, run);
     }
 }
@@ -321,6 +531,29 @@ dbus_handlers_run(
     }
 }
 
+void
+dbus_handlers_prewarm(
+    DBusHandlers* self)
+{
+    if (self && self->prewarm) {
+        const GStrV* ptr = self->prewarm;
+
+        /*
+         * Peer.Ping is handled by GDBus (and libdbus) itself.
+         * If the service isn't running, the call gets it started.
+         */
+        while (*ptr) {
+            const char* service = *ptr++;
+
+            GDEBUG("Pinging %s", service);
+            g_dbus_connection_call(self->connection, service, "/",
+                DBUS_PEER_INTERFACE, DBUS_PEER_METHOD_PING, NULL, NULL,
+                G_DBUS_CALL_FLAGS_NONE, -1, self->pings,
+                dbus_handlers_ping_done, g_strdup(service));
+        }
+    }
+}
+
 DBusHandlers*
 dbus_handlers_new(
     GDBusConnection* connection,
@@ -331,6 +564,16 @@ dbus_handlers_new(
 
         g_object_ref(self->connection = connection);
         self->dir = g_strdup(config_dir);
+        self->outcomes = g_hash_table_new_full(g_str_hash, g_str_equal,
+            g_free, dbus_handlers_outcome_free);
+        g_queue_init(&self->outcome_keys);
+        self->pings = g_cancellable_new();
+        /*
+         * Unlike the handlers, which are looked up for each NDEF, the
+         * list of services to prewarm is read once. Otherwise every tag
+         * and every power-up would be reading all the config files.
+         */
+        self->prewarm = dbus_handlers_config_load_prewarm(config_dir);
         GDEBUG("Config dir %s", config_dir);
         return self;
     }
@@ -343,6 +586,11 @@ dbus_handlers_free(
 {
     if (self) {
         dbus_handlers_run_free(self->run);
+        g_cancellable_cancel(self->pings);
+        g_object_unref(self->pings);
+        g_strfreev(self->prewarm);
+        g_queue_clear(&self->outcome_keys);
+        g_hash_table_destroy(self->outcomes);
         g_object_unref(self->connection);
         g_free(self->dir);
         g_free(self);
@@ -122,6 +122,10 @@ void
 dbus_handlers_config_free(
     DBusHandlersConfig* config);
 
+GStrV*
+dbus_handlers_config_load_prewarm(
+    const char* config_dir);
+
 gboolean
 dbus_handlers_config_parse_dbus(
     DBusConfig* config,
@@ -164,6 +168,10 @@ dbus_handlers_run(
     DBusHandlers* handlers,
     NfcNdefRec* ndef);
 
+void
+dbus_handlers_prewarm(
+    DBusHandlers* handlers);
+
 void
 dbus_handlers_free(
     DBusHandlers* handlers);
@@ -38,6 +38,7 @@
 enum {
     EVENT_TAG_ADDED,
     EVENT_TAG_REMOVED,
+    EVENT_POWERED,
     EVENT_COUNT
 };
 
@@ -92,6 +93,19 @@ dbus_handlers_adapter_tag_removed(
     g_hash_table_remove(self->tags, (void*)tag->name);
 }
 
+static
+void
+dbus_handlers_adapter_powered_changed(
+    NfcAdapter* adapter,
+    void* user_data)
+{
+    if (adapter->powered) {
+        DBusHandlersAdapter* self = user_data;
+
+        dbus_handlers_prewarm(self->handlers);
+    }
+}
+
 /*==========================================================================*
  * Interface
  *==========================================================================*/
@@ -123,7 +137,13 @@ dbus_handlers_adapter_new(
     self->event_id[EVENT_TAG_REMOVED] =
         nfc_adapter_add_tag_removed_handler(adapter,
             dbus_handlers_adapter_tag_removed, self);
+    self->event_id[EVENT_POWERED] =
+        nfc_adapter_add_powered_changed_handler(adapter,
+            dbus_handlers_adapter_powered_changed, self);
 
+    if (adapter->powered) {
+        dbus_handlers_prewarm(handlers);
+    }
     return self;
 }
 
@@ -41,6 +41,7 @@ static const char config_section_common[] = "Common";
 static const char config_key_service[] = "Service";
 static const char config_key_method[] = "Method";
 static const char config_key_path[] = "Path";
+static const char config_key_prewarm[] = "Prewarm";
 static const char config_default_path[] = "/";
 
 typedef struct dbus_handler_config_list {
@@ -460,6 +461,69 @@ dbus_handlers_config_load(
     return config;
 }
 
+static
+gboolean
+dbus_handlers_config_prewarm(
+    GKeyFile* file,
+    const char* group)
+{
+    GError* error = NULL;
+    gboolean value = g_key_file_get_boolean(file, group, config_key_prewarm,
+        &error);
+
+    if (error) {
+        g_error_free(error);
+        value = g_key_file_get_boolean(file, config_section_common,
+            config_key_prewarm, NULL);
+    }
+    return value;
+}
+
+GStrV*
+dbus_handlers_config_load_prewarm(
+    const char* dir)
+{
+    GStrV* services = NULL;
+    GStrV* files = dir ? dbus_handlers_config_files(dir) : NULL;
+
+    if (files) {
+        char** ptr = files;
+        GString* path = g_string_new(dir);
+        const guint baselen = path->len + 1;
+
+        g_string_append_c(path, G_DIR_SEPARATOR);
+        while (*ptr) {
+            const char* fname = *ptr++;
+            GKeyFile* kf = g_key_file_new();
+
+            g_string_set_size(path, baselen);
+            g_string_append(path, fname);
+            if (g_key_file_load_from_file(kf, path->str, 0, NULL)) {
+                GStrV* groups = g_key_file_get_groups(kf, NULL);
+                char** group;
+
+                for (group = groups; *group; group++) {
+                    if (dbus_handlers_config_prewarm(kf, *group)) {
+                        char* service = dbus_handlers_config_get_string(kf,
+                            *group, config_key_service);
+
+                        if (service && g_dbus_is_name(service) &&
+                            !gutil_strv_contains(services, service)) {
+                            services = gutil_strv_add(services, service);
+                        }
+                        g_free(service);
+                    }
+                }
+                g_strfreev(groups);
+            }
+            g_key_file_unref(kf);
+        }
+        g_strfreev(files);
+        g_string_free(path, TRUE);
+    }
+    return services;
+}
+
 void
 dbus_handlers_config_free(
     DBusHandlersConfig* self)
@@ -83,6 +83,8 @@ dbus_handlers_tag_new(
     if (tag->flags & NFC_TAG_FLAG_INITIALIZED) {
         dbus_handlers_tag_initialized(self);
     } else {
+        /* Wake up the handlers while the tag is being read */
+        dbus_handlers_prewarm(handlers);
         self->init_id = nfc_tag_add_initialized_handler(tag,
             dbus_handlers_tag_initialized_event, self);
     }
@@ -36,8 +36,7 @@
 #include <nfc_config.h>
 
 #ifdef HAVE_DBUSACCESS
-#include <dbusaccess_policy.h>
-#include <dbusaccess_peer.h>
+#include "common/access_cache.h"
 #endif
 
 #include <gutil_macros.h>
@@ -61,7 +60,7 @@ typedef struct dbus_neard_settings {
     NfcConfigurable* config;
     gulong change_id;
 #ifdef HAVE_DBUSACCESS
-    DAPolicy* policy;
+    AccessCache* access;
 #endif
 } DBusNeardSettings;
 
@@ -108,14 +107,9 @@ dbus_neard_settings_access_check(
     DA_ACCESS def)
 {
     const char* sender = g_dbus_method_invocation_get_sender(call);
-    DAPeer* peer = da_peer_get(DBUS_NEARD_DA_BUS, sender);
 
-    /*
-     * If we get no peer information from dbus-daemon, it means that
-     * the peer is gone so it doesn't really matter what we do in this
-     * case - the reply will be dropped anyway.
-     */
-    if (peer && da_policy_check(self->policy, &peer->cred, action, 0, def) ==
+    /* Decisions are cached per sender, see access_cache.h */
+    if (access_cache_check(self->access, sender, action, NULL, def) ==
         DA_ACCESS_ALLOW) {
         return TRUE;
     }
@@ -325,8 +319,10 @@ dbus_neard_settings_new(
     }
 
 #ifdef HAVE_DBUSACCESS
-    self->policy = da_policy_new_full(dbus_neard_settings_default_policy,
+    self->access = access_cache_new(DBUS_NEARD_DA_BUS,
+        dbus_neard_settings_default_policy,
         dbus_neard_settings_policy_actions);
+    access_cache_set_connection(self->access, bus);
 #endif
 
     return self;
@@ -340,7 +336,7 @@ dbus_neard_settings_free(
         nfc_config_remove_handler(self->config, self->change_id);
         dbus_neard_settings_unexport(self);
 #ifdef HAVE_DBUSACCESS
-        da_policy_unref(self->policy);
+        access_cache_free(self->access);
 #endif
         if (self->bus) {
             g_object_unref(self->bus);
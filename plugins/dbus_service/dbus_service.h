@@ -42,6 +42,7 @@
 #include <gutil_log.h>
 
 #include <nfc_peer_service.h>
+#include <nfc_plugin_impl.h>
 
 #include <gio/gio.h>
 
@@ -79,6 +80,58 @@ dbus_service_plugin_find_peer(
     DBusServicePlugin* plugin,
     NfcPeer* peer);
 
+/*
+ * Event stream (Daemon.SubscribeEvents). The log is attached to the
+ * bus connection, posting events is a no-op if there's none. Each
+ * record starts with DBusServiceEventHeader (native byte order) and
+ * is followed by NULL-terminated object path. The size field includes
+ * the header and the path.
+ */
+
+typedef enum dbus_service_event {
+    DBUS_SERVICE_EVENT_ADAPTER_ADDED = 1,
+    DBUS_SERVICE_EVENT_ADAPTER_REMOVED,
+    DBUS_SERVICE_EVENT_TAG_ADDED,
+    DBUS_SERVICE_EVENT_TAG_INITIALIZED,     /* value: NDEF record count */
+    DBUS_SERVICE_EVENT_TAG_REMOVED,
+    DBUS_SERVICE_EVENT_PEER_ADDED,
+    DBUS_SERVICE_EVENT_PEER_REMOVED,
+    DBUS_SERVICE_EVENT_TARGET_PRESENCE,     /* value: 0 or 1 */
+    DBUS_SERVICE_EVENT_MODE_CHANGED         /* value: mode */
+} DBUS_SERVICE_EVENT;
+
+typedef struct dbus_service_event_header {
+    guint32 size;
+    guint16 type;       /* DBUS_SERVICE_EVENT */
+    guint16 reserved;
+    guint64 seq;
+    guint32 value;
+    guint32 reserved2;
+} DBusServiceEventHeader;
+
+#define DBUS_SERVICE_EVENTS_REPLAY (256)
+
+void
+dbus_service_events_attach(
+    GDBusConnection* bus);
+
+void
+dbus_service_events_detach(
+    GDBusConnection* bus);
+
+void
+dbus_service_events_post(
+    GDBusConnection* bus,
+    DBUS_SERVICE_EVENT type,
+    const char* path,
+    guint32 value);
+
+int
+dbus_service_events_subscribe(
+    GDBusConnection* bus,
+    guint64 since,
+    guint64* seq);
+
 /* org.sailfishos.nfc.LocalService */
 
 typedef struct dbus_service_local {
@@ -95,6 +148,25 @@ dbus_service_local_new(
     const char* llc_name,
     const char* dbus_name);
 
+/* SNEP server for NDEF published with Daemon.PublishNdef */
+
+#define DBUS_SERVICE_SNEP_DEFAULT_SN "urn:nfc:xsn:sailfishos.org:snep-get"
+
+typedef struct dbus_service_snep {
+    NfcPeerService service;
+    DBusServicePlugin* plugin;
+} DBusServiceSnep;
+
+DBusServiceSnep*
+dbus_service_snep_new(
+    const char* sn,
+    GBytes* ndef);
+
+void
+dbus_service_snep_set_ndef(
+    DBusServiceSnep* snep,
+    GBytes* ndef);
+
 /* org.sailfishos.nfc.Adapter */
 
 DBusServiceAdapter*
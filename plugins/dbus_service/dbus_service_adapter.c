@@ -31,9 +31,11 @@
  */
 
 #include "dbus_service.h"
+#include "dbus_service_util.h"
 #include "dbus_service/org.sailfishos.nfc.Adapter.h"
 
 #include <nfc_adapter.h>
+#include <nfc_ndef.h>
 #include <nfc_peer.h>
 #include <nfc_tag.h>
 
@@ -80,7 +82,7 @@ struct dbus_service_adapter {
     gulong call_id[CALL_COUNT];
 };
 
-#define NFC_DBUS_ADAPTER_INTERFACE_VERSION  (2)
+#define NFC_DBUS_ADAPTER_INTERFACE_VERSION  (3)
 
 static
 int
@@ -190,8 +192,10 @@ void
 dbus_service_adapter_tags_changed(
     DBusServiceAdapter* self)
 {
-    org_sailfishos_nfc_adapter_emit_tags_changed(self->iface,
-        dbus_service_adapter_get_tag_paths(self));
+    const char* const* paths = dbus_service_adapter_get_tag_paths(self);
+
+    org_sailfishos_nfc_adapter_set_tags(self->iface, paths);
+    org_sailfishos_nfc_adapter_emit_tags_changed(self->iface, paths);
 }
 
 static
@@ -199,8 +203,10 @@ void
 dbus_service_adapter_peers_changed(
     DBusServiceAdapter* self)
 {
-    org_sailfishos_nfc_adapter_emit_peers_changed(self->iface,
-        dbus_service_adapter_get_peer_paths(self));
+    const char* const* paths = dbus_service_adapter_get_peer_paths(self);
+
+    org_sailfishos_nfc_adapter_set_peers(self->iface, paths);
+    org_sailfishos_nfc_adapter_emit_peers_changed(self->iface, paths);
 }
 
 /*==========================================================================*
@@ -215,8 +221,9 @@ dbus_service_adapter_enabled_changed(
 {
     DBusServiceAdapter* self = user_data;
 
+    org_sailfishos_nfc_adapter_set_enabled(self->iface, adapter->enabled);
     org_sailfishos_nfc_adapter_emit_enabled_changed(self->iface,
-        self->adapter->enabled);
+        adapter->enabled);
 }
 
 static
@@ -227,8 +234,9 @@ dbus_service_adapter_powered_changed(
 {
     DBusServiceAdapter* self = user_data;
 
+    org_sailfishos_nfc_adapter_set_powered(self->iface, adapter->powered);
     org_sailfishos_nfc_adapter_emit_powered_changed(self->iface,
-        self->adapter->powered);
+        adapter->powered);
 }
 
 static
@@ -239,8 +247,8 @@ dbus_service_adapter_mode_changed(
 {
     DBusServiceAdapter* self = user_data;
 
-    org_sailfishos_nfc_adapter_emit_mode_changed(self->iface,
-        self->adapter->mode);
+    org_sailfishos_nfc_adapter_set_mode(self->iface, adapter->mode);
+    org_sailfishos_nfc_adapter_emit_mode_changed(self->iface, adapter->mode);
 }
 
 static
@@ -251,8 +259,13 @@ dbus_service_adapter_target_present_changed(
 {
     DBusServiceAdapter* self = user_data;
 
+    dbus_service_events_post(self->connection,
+        DBUS_SERVICE_EVENT_TARGET_PRESENCE, self->path,
+        adapter->target_present);
+    org_sailfishos_nfc_adapter_set_target_present(self->iface,
+        adapter->target_present);
     org_sailfishos_nfc_adapter_emit_target_present_changed(self->iface,
-        self->adapter->target_present);
+        adapter->target_present);
 }
 
 static
@@ -265,6 +278,20 @@ dbus_service_adapter_tag_added(
     DBusServiceAdapter* self = user_data;
 
     if (dbus_service_adapter_create_tag(self, tag)) {
+        DBusServiceTag* dbus = g_hash_table_lookup(self->tags, tag->name);
+
+        dbus_service_events_post(self->connection,
+            DBUS_SERVICE_EVENT_TAG_ADDED, dbus->path, 0);
+        if (tag->flags & NFC_TAG_FLAG_INITIALIZED) {
+            NfcNdefRec* rec;
+            guint n = 0;
+
+            for (rec = tag->ndef; rec; rec = rec->next) {
+                n++;
+            }
+            dbus_service_events_post(self->connection,
+                DBUS_SERVICE_EVENT_TAG_INITIALIZED, dbus->path, n);
+        }
         dbus_service_adapter_tags_changed(self);
     }
 }
@@ -277,8 +304,12 @@ dbus_service_adapter_tag_removed(
     void* user_data)
 {
     DBusServiceAdapter* self = user_data;
+    DBusServiceTag* dbus = g_hash_table_lookup(self->tags, tag->name);
 
-    if (g_hash_table_remove(self->tags, (void*)tag->name)) {
+    if (dbus) {
+        dbus_service_events_post(self->connection,
+            DBUS_SERVICE_EVENT_TAG_REMOVED, dbus->path, 0);
+        g_hash_table_remove(self->tags, tag->name);
         dbus_service_adapter_tags_changed(self);
     }
 }
@@ -293,6 +324,10 @@ dbus_service_adapter_peer_added(
     DBusServiceAdapter* self = user_data;
 
     if (dbus_service_adapter_create_peer(self, peer)) {
+        DBusServicePeer* dbus = g_hash_table_lookup(self->peers, peer->name);
+
+        dbus_service_events_post(self->connection,
+            DBUS_SERVICE_EVENT_PEER_ADDED, dbus->path, 0);
         dbus_service_adapter_peers_changed(self);
     }
 }
@@ -305,8 +340,12 @@ dbus_service_adapter_peer_removed(
     void* user_data)
 {
     DBusServiceAdapter* self = user_data;
+    DBusServicePeer* dbus = g_hash_table_lookup(self->peers, peer->name);
 
-    if (g_hash_table_remove(self->peers, (void*)peer->name)) {
+    if (dbus) {
+        dbus_service_events_post(self->connection,
+            DBUS_SERVICE_EVENT_PEER_REMOVED, dbus->path, 0);
+        g_hash_table_remove(self->peers, peer->name);
         dbus_service_adapter_peers_changed(self);
     }
 }
@@ -605,9 +644,29 @@ dbus_service_adapter_new(
         dbus_service_adapter_create_peer(self, *peers);
     }
 
+    /*
+     * Initial property values. Setting them before the object is
+     * exported doesn't keep them quiet: the skeleton queues every
+     * value which differs from the default and flushes the queue from
+     * an idle callback, which runs after the object has been exported.
+     * So the export is followed by one PropertiesChanged carrying the
+     * initial values (those which aren't FALSE, zero or empty).
+     */
+    org_sailfishos_nfc_adapter_set_enabled(self->iface, adapter->enabled);
+    org_sailfishos_nfc_adapter_set_powered(self->iface, adapter->powered);
+    org_sailfishos_nfc_adapter_set_supported_modes(self->iface,
+        adapter->supported_modes);
+    org_sailfishos_nfc_adapter_set_mode(self->iface, adapter->mode);
+    org_sailfishos_nfc_adapter_set_target_present(self->iface,
+        adapter->target_present);
+    org_sailfishos_nfc_adapter_set_tags(self->iface,
+        dbus_service_adapter_get_tag_paths(self));
+    org_sailfishos_nfc_adapter_set_peers(self->iface,
+        dbus_service_adapter_get_peer_paths(self));
+
     /* Export the interface */
-    if (g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON
-        (self->iface), connection, self->path, &error)) {
+    if (dbus_service_export(G_DBUS_INTERFACE_SKELETON(self->iface),
+        connection, self->path, &error)) {
         GDEBUG("Created D-Bus object %s", self->path);
         return self;
     } else {
@@ -624,8 +683,8 @@ dbus_service_adapter_free(
 {
     if (self) {
         GDEBUG("Removing D-Bus object %s", self->path);
-        g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON
-            (self->iface));
+        dbus_service_unexport(G_DBUS_INTERFACE_SKELETON(self->iface),
+            self->connection);
         dbus_service_adapter_free_unexported(self);
     }
 }
@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dbus_service.h"
+
+#include <gutil_macros.h>
+
+#include <sys/socket.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Events are kept in a ring buffer, so that a client can resume from
+ * the last sequence number it has seen. Each subscriber gets its own
+ * SOCK_SEQPACKET socket, one record per packet. A subscriber which
+ * falls behind by more than the size of the ring buffer is dropped,
+ * it can resubscribe and get the events it missed from the log.
+ */
+
+typedef struct dbus_service_events DBusServiceEvents;
+
+typedef struct dbus_service_events_client {
+    DBusServiceEvents* events;
+    GIOChannel* io;
+    int fd;
+    guint write_watch_id;
+    guint hup_watch_id;
+    GQueue queue; /* GBytes */
+} DBusServiceEventsClient;
+
+struct dbus_service_events {
+    guint64 seq; /* Last assigned sequence number */
+    GBytes* log[DBUS_SERVICE_EVENTS_REPLAY];
+    guint log_start;
+    guint log_count;
+    GSList* clients;
+};
+
+#define DBUS_SERVICE_EVENTS_KEY "dbus-service-events"
+
+G_STATIC_ASSERT(sizeof(DBusServiceEventHeader) == 24);
+
+static
+void
+dbus_service_events_client_free(
+    DBusServiceEventsClient* client)
+{
+    GBytes* bytes;
+
+    if (client->write_watch_id) {
+        g_source_remove(client->write_watch_id);
+    }
+    if (client->hup_watch_id) {
+        g_source_remove(client->hup_watch_id);
+    }
+    g_io_channel_shutdown(client->io, FALSE, NULL);
+    g_io_channel_unref(client->io);
+    while ((bytes = g_queue_pop_head(&client->queue)) != NULL) {
+        g_bytes_unref(bytes);
+    }
+    gutil_slice_free(client);
+}
+
+static
+void
+dbus_service_events_client_drop(
+    DBusServiceEventsClient* client)
+{
+    DBusServiceEvents* events = client->events;
+
+    events->clients = g_slist_remove(events->clients, client);
+    dbus_service_events_client_free(client);
+}
+
+static
+gboolean
+dbus_service_events_client_flush(
+    DBusServiceEventsClient* client)
+{
+    GBytes* bytes;
+
+    while ((bytes = g_queue_peek_head(&client->queue)) != NULL) {
+        gsize size;
+        const void* data = g_bytes_get_data(bytes, &size);
+
+        if (send(client->fd, data, size, MSG_DONTWAIT | MSG_NOSIGNAL) >= 0) {
+            g_bytes_unref(g_queue_pop_head(&client->queue));
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            /* Wait for G_IO_OUT */
+            break;
+        } else if (errno != EINTR) {
+            GDEBUG("Event subscriber %d: %s", client->fd, strerror(errno));
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static
+gboolean
+dbus_service_events_client_write(
+    GIOChannel* source,
+    GIOCondition condition,
+    gpointer user_data)
+{
+    DBusServiceEventsClient* client = user_data;
+
+    if ((condition & G_IO_OUT) && dbus_service_events_client_flush(client)) {
+        if (!g_queue_is_empty(&client->queue)) {
+            return G_SOURCE_CONTINUE;
+        }
+        client->write_watch_id = 0;
+    } else {
+        client->write_watch_id = 0;
+        dbus_service_events_client_drop(client);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+static
+gboolean
+dbus_service_events_client_hup(
+    GIOChannel* source,
+    GIOCondition condition,
+    gpointer user_data)
+{
+    DBusServiceEventsClient* client = user_data;
+
+    /* Subscribers aren't supposed to write anything */
+    GDEBUG("Event subscriber %d is gone", client->fd);
+    client->hup_watch_id = 0;
+    dbus_service_events_client_drop(client);
+    return G_SOURCE_REMOVE;
+}
+
+static
+gboolean
+dbus_service_events_client_send(
+    DBusServiceEventsClient* client,
+    GBytes* bytes)
+{
+    if (g_queue_get_length(&client->queue) >= DBUS_SERVICE_EVENTS_REPLAY) {
+        GWARN("Event subscriber %d is too slow", client->fd);
+        return FALSE;
+    }
+    g_queue_push_tail(&client->queue, g_bytes_ref(bytes));
+    if (!client->write_watch_id) {
+        if (!dbus_service_events_client_flush(client)) {
+            return FALSE;
+        } else if (!g_queue_is_empty(&client->queue)) {
+            client->write_watch_id = g_io_add_watch(client->io,
+                G_IO_OUT | G_IO_ERR, dbus_service_events_client_write,
+                client);
+        }
+    }
+    return TRUE;
+}
+
+static
+void
+dbus_service_events_free(
+    gpointer data)
+{
+    DBusServiceEvents* events = data;
+    guint i;
+
+    while (events->clients) {
+        dbus_service_events_client_drop(events->clients->data);
+    }
+    for (i = 0; i < events->log_count; i++) {
+        g_bytes_unref(events->log[(events->log_start + i) %
+            DBUS_SERVICE_EVENTS_REPLAY]);
+    }
+    gutil_slice_free(events);
+}
+
+void
+dbus_service_events_attach(
+    GDBusConnection* bus)
+{
+    g_object_set_data_full(G_OBJECT(bus), DBUS_SERVICE_EVENTS_KEY,
+        g_slice_new0(DBusServiceEvents), dbus_service_events_free);
+}
+
+void
+dbus_service_events_detach(
+    GDBusConnection* bus)
+{
+    g_object_set_data(G_OBJECT(bus), DBUS_SERVICE_EVENTS_KEY, NULL);
+}
+
+void
+dbus_service_events_post(
+    GDBusConnection* bus,
+    DBUS_SERVICE_EVENT type,
+    const char* path,
+    guint32 value)
+{
+    DBusServiceEvents* events = g_object_get_data(G_OBJECT(bus),
+        DBUS_SERVICE_EVENTS_KEY);
+
+    if (events) {
+        const gsize path_size = strlen(path) + 1;
+        const gsize size = sizeof(DBusServiceEventHeader) + path_size;
+        DBusServiceEventHeader* event = g_malloc0(size);
+        GBytes* bytes;
+        GSList* l;
+
+        event->size = size;
+        event->type = type;
+        event->seq = ++events->seq;
+        event->value = value;
+        memcpy(event + 1, path, path_size);
+        bytes = g_bytes_new_take(event, size);
+
+        /* Append the event to the log */
+        if (events->log_count == DBUS_SERVICE_EVENTS_REPLAY) {
+            g_bytes_unref(events->log[events->log_start]);
+            events->log[events->log_start] = bytes;
+            events->log_start = (events->log_start + 1) %
+                DBUS_SERVICE_EVENTS_REPLAY;
+        } else {
+            events->log[(events->log_start + events->log_count++) %
+                DBUS_SERVICE_EVENTS_REPLAY] = bytes;
+        }
+
+        /* And deliver it to the subscribers */
+        for (l = events->clients; l;) {
+            DBusServiceEventsClient* client = l->data;
+
+            l = l->next;
+            if (!dbus_service_events_client_send(client, bytes)) {
+                dbus_service_events_client_drop(client);
+            }
+        }
+    }
+}
+
+int
+dbus_service_events_subscribe(
+    GDBusConnection* bus,
+    guint64 since,
+    guint64* seq)
+{
+    DBusServiceEvents* events = g_object_get_data(G_OBJECT(bus),
+        DBUS_SERVICE_EVENTS_KEY);
+    int fd[2];
+
+    if (!events) {
+        errno = ENOTCONN;
+    } else if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0,
+        fd) == 0) {
+        DBusServiceEventsClient* client =
+            g_slice_new0(DBusServiceEventsClient);
+        const guint64 first = events->seq - events->log_count + 1;
+        guint64 i;
+
+        client->events = events;
+        client->fd = fd[0];
+        client->io = g_io_channel_unix_new(fd[0]);
+        g_io_channel_set_encoding(client->io, NULL, NULL);
+        g_io_channel_set_buffered(client->io, FALSE);
+        g_io_channel_set_close_on_unref(client->io, TRUE);
+        client->hup_watch_id = g_io_add_watch(client->io,
+            G_IO_IN | G_IO_HUP | G_IO_ERR, dbus_service_events_client_hup,
+            client);
+        events->clients = g_slist_append(events->clients, client);
+
+        /* Replay what the client has missed (and what we still have) */
+        if (since < events->seq) {
+            for (i = MAX(since + 1, first); i <= events->seq; i++) {
+                g_queue_push_tail(&client->queue, g_bytes_ref(events->log
+                    [(events->log_start + (guint)(i - first)) %
+                    DBUS_SERVICE_EVENTS_REPLAY]));
+            }
+        }
+        if (!dbus_service_events_client_flush(client)) {
+            dbus_service_events_client_drop(client);
+            close(fd[1]);
+            return -1;
+        } else if (!g_queue_is_empty(&client->queue)) {
+            client->write_watch_id = g_io_add_watch(client->io,
+                G_IO_OUT | G_IO_ERR, dbus_service_events_client_write,
+                client);
+        }
+        GDEBUG("Event subscriber %d since %" G_GUINT64_FORMAT, fd[0], since);
+        *seq = events->seq;
+        return fd[1];
+    }
+    return -1;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -180,9 +180,12 @@ dbus_service_isodep_handle_transmit(
     DBusServiceIsoDep* self)
 {
     GUtilData data;
-    DBusServiceIsoDepAsyncCall* async =
-        dbus_service_isodep_async_call_new(iface, call);
+    DBusServiceIsoDepAsyncCall* async;
 
+    if (!dbus_service_access_allowed(call, DBUS_SERVICE_ACTION_TRANSMIT)) {
+        return TRUE;
+    }
+    async = dbus_service_isodep_async_call_new(iface, call);
     data.size = g_variant_get_size(data_var);
     data.bytes = g_variant_get_data(data_var);
     GDEBUG("%02X %02X %02X %02X (%u bytes) %02X", cla, ins, p1, p2, (guint)
@@ -368,8 +371,8 @@ dbus_service_isodep_new(
         g_signal_connect(self->iface, "handle-reset",
         G_CALLBACK(dbus_service_isodep_handle_reset), self);
 
-    if (g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON
-        (self->iface), owner->connection, owner->path, &error)) {
+    if (dbus_service_export(G_DBUS_INTERFACE_SKELETON(self->iface),
+        owner->connection, owner->path, &error)) {
         GDEBUG("Created D-Bus object %s (ISO-DEP)", owner->path);
         return self;
     } else {
@@ -386,8 +389,8 @@ dbus_service_isodep_free(
 {
     if (self) {
         GDEBUG("Removing D-Bus object %s (ISO-DEP)", self->owner->path);
-        g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON
-            (self->iface));
+        dbus_service_unexport(G_DBUS_INTERFACE_SKELETON(self->iface),
+            self->owner->connection);
         dbus_service_isodep_free_unexported(self);
     }
 }
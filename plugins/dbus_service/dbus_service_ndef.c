@@ -31,6 +31,7 @@
  */
 
 #include "dbus_service.h"
+#include "dbus_service_util.h"
 #include "dbus_service/org.sailfishos.nfc.NDEF.h"
 
 #include <nfc_ndef.h>
@@ -60,7 +61,7 @@ struct dbus_service_ndef {
 };
 
 #define NFC_DBUS_NDEF_INTERFACE "org.sailfishos.nfc.NDEF"
-#define NFC_DBUS_NDEF_INTERFACE_VERSION  (1)
+#define NFC_DBUS_NDEF_INTERFACE_VERSION  (2)
 
 static const char* const dbus_service_ndef_default_interfaces[] = {
     NFC_DBUS_NDEF_INTERFACE, NULL
@@ -101,12 +102,13 @@ dbus_service_ndef_handle_get_all(
 {
     NfcNdefRec* ndef = self->rec;
 
+    /* Share the variants with the properties rather than making new ones */
     org_sailfishos_nfc_ndef_complete_get_all(iface, call,
         NFC_DBUS_NDEF_INTERFACE_VERSION, ndef->flags, ndef->tnf,
         dbus_service_ndef_default_interfaces,
-        dbus_service_ndef_bytes_as_variant(self, &ndef->type),
-        dbus_service_ndef_bytes_as_variant(self, &ndef->id),
-        dbus_service_ndef_bytes_as_variant(self, &ndef->payload));
+        org_sailfishos_nfc_ndef_get_record_type(iface),
+        org_sailfishos_nfc_ndef_get_id(iface),
+        org_sailfishos_nfc_ndef_get_payload(iface));
     return TRUE;
 }
 
@@ -164,10 +166,8 @@ dbus_service_ndef_handle_get_type(
     GDBusMethodInvocation* call,
     DBusServiceNdef* self)
 {
-    NfcNdefRec* ndef = self->rec;
-
     org_sailfishos_nfc_ndef_complete_get_type(iface, call,
-        dbus_service_ndef_bytes_as_variant(self, &ndef->type));
+        org_sailfishos_nfc_ndef_get_record_type(iface));
     return TRUE;
 }
 
@@ -178,10 +178,8 @@ dbus_service_ndef_handle_get_id(
     GDBusMethodInvocation* call,
     DBusServiceNdef* self)
 {
-    NfcNdefRec* ndef = self->rec;
-
     org_sailfishos_nfc_ndef_complete_get_id(iface, call,
-        dbus_service_ndef_bytes_as_variant(self, &ndef->id));
+        org_sailfishos_nfc_ndef_get_id(iface));
     return TRUE;
 }
 
@@ -192,10 +190,8 @@ dbus_service_ndef_handle_get_payload(
     GDBusMethodInvocation* call,
     DBusServiceNdef* self)
 {
-    NfcNdefRec* ndef = self->rec;
-
     org_sailfishos_nfc_ndef_complete_get_payload(iface, call,
-        dbus_service_ndef_bytes_as_variant(self, &ndef->payload));
+        org_sailfishos_nfc_ndef_get_payload(iface));
     return TRUE;
 }
 
@@ -284,9 +280,21 @@ dbus_service_ndef_new(
         g_signal_connect(self->iface, "handle-get-raw-data",
         G_CALLBACK(dbus_service_ndef_handle_get_raw_data), self);
 
+    /* Properties */
+    org_sailfishos_nfc_ndef_set_flags(self->iface, rec->flags);
+    org_sailfishos_nfc_ndef_set_type_name_format(self->iface, rec->tnf);
+    org_sailfishos_nfc_ndef_set_interfaces(self->iface,
+        dbus_service_ndef_default_interfaces);
+    org_sailfishos_nfc_ndef_set_record_type(self->iface,
+        dbus_service_ndef_bytes_as_variant(self, &rec->type));
+    org_sailfishos_nfc_ndef_set_id(self->iface,
+        dbus_service_ndef_bytes_as_variant(self, &rec->id));
+    org_sailfishos_nfc_ndef_set_payload(self->iface,
+        dbus_service_ndef_bytes_as_variant(self, &rec->payload));
+
     /* Export the interface */
-    if (g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON
-        (self->iface), connection, self->path, &error)) {
+    if (dbus_service_export(G_DBUS_INTERFACE_SKELETON(self->iface),
+        connection, self->path, &error)) {
         GDEBUG("Created D-Bus object %s", self->path);
         return self;
     } else {
@@ -303,8 +311,8 @@ dbus_service_ndef_free(
 {
     if (self) {
         GDEBUG("Removing D-Bus object %s", self->path);
-        g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON
-            (self->iface));
+        dbus_service_unexport(G_DBUS_INTERFACE_SKELETON(self->iface),
+            self->connection);
         dbus_service_ndef_free_unexported(self);
     }
 }
@@ -34,6 +34,7 @@
  */
 
 #include "dbus_service.h"
+#include "dbus_service_util.h"
 #include "dbus_service/org.sailfishos.nfc.Peer.h"
 
 #include <nfc_peer.h>
@@ -48,6 +49,7 @@
 enum {
     PEER_INITIALIZED,
     PEER_WELL_KNOWN_SERVICES_CHANGED,
+    PEER_GONE,
     PEER_EVENT_COUNT
 };
 
@@ -110,7 +112,7 @@ struct dbus_service_peer_priv {
 };
 
 #define NFC_DBUS_PEER_INTERFACE "org.sailfishos.nfc.Peer"
-#define NFC_DBUS_PEER_INTERFACE_VERSION  (1)
+#define NFC_DBUS_PEER_INTERFACE_VERSION  (2)
 
 static const char* const dbus_service_peer_default_interfaces[] = {
     NFC_DBUS_PEER_INTERFACE, NULL
@@ -266,6 +268,7 @@ dbus_service_peer_well_known_services_changed(
 {
     DBusServicePeerPriv* self = user_data;
 
+    org_sailfishos_nfc_peer_set_well_known_services(self->iface, peer->wks);
     org_sailfishos_nfc_peer_emit_well_known_services_changed
         (self->iface, peer->wks);
 }
@@ -280,11 +283,23 @@ dbus_service_peer_initialized(
 
     nfc_peer_remove_handlers(peer, self->peer_event_id + PEER_INITIALIZED, 1);
     dbus_service_peer_complete_pending_calls(self);
+    org_sailfishos_nfc_peer_set_well_known_services(self->iface, peer->wks);
     self->peer_event_id[PEER_WELL_KNOWN_SERVICES_CHANGED] =
         nfc_peer_add_wks_changed_handler(peer,
             dbus_service_peer_well_known_services_changed, self);
 }
 
+static
+void
+dbus_service_peer_gone(
+    NfcPeer* peer,
+    void* user_data)
+{
+    DBusServicePeerPriv* self = user_data;
+
+    org_sailfishos_nfc_peer_set_present(self->iface, peer->present);
+}
+
 /*==========================================================================*
  * Async call context
  *==========================================================================*/
@@ -527,9 +542,13 @@ dbus_service_peer_handle_connect_access_point(
     guint rsap,
     DBusServicePeerPriv* self)
 {
-    DBusServicePeerAsyncConnect* connect =
-        dbus_service_peer_async_connect_new(iface, call,
-            org_sailfishos_nfc_peer_complete_connect_access_point);
+    DBusServicePeerAsyncConnect* connect;
+
+    if (!dbus_service_access_allowed(call, DBUS_SERVICE_ACTION_CONNECT)) {
+        return TRUE;
+    }
+    connect = dbus_service_peer_async_connect_new(iface, call,
+        org_sailfishos_nfc_peer_complete_connect_access_point);
 
     GDEBUG("Connecting to SAP %u", rsap);
     connect->connection =
@@ -556,9 +575,13 @@ dbus_service_peer_handle_connect_service_name(
     const char* sn,
     DBusServicePeerPriv* self)
 {
-    DBusServicePeerAsyncConnect* connect =
-        dbus_service_peer_async_connect_new(iface, call,
-            org_sailfishos_nfc_peer_complete_connect_service_name);
+    DBusServicePeerAsyncConnect* connect;
+
+    if (!dbus_service_access_allowed(call, DBUS_SERVICE_ACTION_CONNECT)) {
+        return TRUE;
+    }
+    connect = dbus_service_peer_async_connect_new(iface, call,
+        org_sailfishos_nfc_peer_complete_connect_service_name);
 
     GDEBUG("Connecting to \"%s\"", sn);
     connect->connection =
@@ -648,14 +671,25 @@ dbus_service_peer_new(
         g_signal_connect(self->iface, "handle-connect-service-name",
         G_CALLBACK(dbus_service_peer_handle_connect_service_name), self);
 
+    /* Properties */
+    org_sailfishos_nfc_peer_set_present(self->iface, peer->present);
+    org_sailfishos_nfc_peer_set_technology(self->iface, peer->technology);
+    org_sailfishos_nfc_peer_set_interfaces(self->iface,
+        dbus_service_peer_default_interfaces);
+    self->peer_event_id[PEER_GONE] =
+        nfc_peer_add_gone_handler(peer, dbus_service_peer_gone, self);
+
     if (peer->present && !(peer->flags & NFC_PEER_FLAG_INITIALIZED)) {
         /* Have to wait until the peer is initialized */
         self->peer_event_id[PEER_INITIALIZED] =
             nfc_peer_add_initialized_handler(peer,
                 dbus_service_peer_initialized, self);
+    } else {
+        org_sailfishos_nfc_peer_set_well_known_services(self->iface,
+            peer->wks);
     }
-    if (g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON
-        (self->iface), connection, self->path, &error)) {
+    if (dbus_service_export(G_DBUS_INTERFACE_SKELETON(self->iface),
+        connection, self->path, &error)) {
         GDEBUG("Created D-Bus object %s (Peer)", self->path);
         return pub;
     } else {
@@ -675,8 +709,8 @@ dbus_service_peer_free(
 
         GDEBUG("Removing D-Bus object %s (Peer)", self->path);
         org_sailfishos_nfc_peer_emit_removed(self->iface);
-        g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON
-            (self->iface));
+        dbus_service_unexport(G_DBUS_INTERFACE_SKELETON(self->iface),
+            self->pub.connection);
         dbus_service_peer_free_unexported(self);
     }
 }
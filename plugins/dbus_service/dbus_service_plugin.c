@@ -33,12 +33,14 @@
  * any official policies, either expressed or implied.
  */
 
-#include "dbus_service.h"
+#include "dbus_service_plugin_p.h"
+#include "dbus_service_util.h"
 #include "dbus_service/org.sailfishos.nfc.Daemon.h"
 #include "plugin.h"
 
 #include <nfc_core.h>
 #include <nfc_adapter.h>
+#include <nfc_config.h>
 #include <nfc_manager.h>
 #include <nfc_peer_service.h>
 #include <nfc_plugin_impl.h>
@@ -47,7 +49,14 @@
 #include <gutil_macros.h>
 #include <gutil_misc.h>
 
+#include <gio/gunixfdlist.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <errno.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 GLOG_MODULE_DEFINE("dbus-service");
 
@@ -70,6 +79,11 @@ enum {
     CALL_RELEASE_MODE,
     CALL_REGISTER_LOCAL_SERVICE,
     CALL_UNREGISTER_LOCAL_SERVICE,
+    CALL_REQUEST_MODE2,
+    CALL_OPEN_PRIVATE_CONNECTION,
+    CALL_SUBSCRIBE_EVENTS,
+    CALL_PUBLISH_NDEF,
+    CALL_UNPUBLISH_NDEF,
     CALL_COUNT
 };
 
@@ -78,14 +92,29 @@ typedef struct dbus_service_client {
     guint watch_id;
     DBusServicePlugin* plugin;
     GHashTable* peer_services;  /* objpath => DBusServiceLocal */
-    GHashTable* mode_requests;  /* id => NfcModeRequest */
+    GHashTable* mode_requests;  /* id => DBusServiceModeRequest */
+    GHashTable* published;      /* sn => DBusServiceSnep */
 } DBusServiceClient;
 
-typedef NfcPluginClass DBusServicePluginClass;
+typedef struct dbus_service_mode_request {
+    NfcModeRequest* req;
+    guint enable;
+    guint disable;
+    NFC_TAG_READ_POLICY read_policy;
+} DBusServiceModeRequest;
+
+typedef struct dbus_service_private_auth {
+    gboolean check_uid;
+    uid_t uid;
+} DBusServicePrivateAuth;
+
 struct dbus_service_plugin {
     NfcPlugin parent;
     guint own_name_id;
     guint last_mode_request_id;
+    guint save_state_id;
+    char* state_file;
+    char* access_policy;
     GUtilIdlePool* pool;
     GDBusConnection* connection;
     GHashTable* adapters;
@@ -100,14 +129,58 @@ struct dbus_service_plugin {
 #define PARENT_CLASS dbus_service_plugin_parent_class
 #define THIS_TYPE dbus_service_plugin_get_type()
 #define THIS(obj) G_TYPE_CHECK_INSTANCE_CAST(obj, THIS_TYPE, DBusServicePlugin)
+#define GET_THIS_CLASS(obj) G_TYPE_INSTANCE_GET_CLASS(obj, THIS_TYPE, \
+        DBusServicePluginClass)
 
-G_DEFINE_TYPE(DBusServicePlugin, dbus_service_plugin, PARENT_TYPE)
+static
+void
+dbus_service_plugin_config_init(
+    NfcConfigurableInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(DBusServicePlugin, dbus_service_plugin, PARENT_TYPE,
+G_IMPLEMENT_INTERFACE(NFC_TYPE_CONFIGURABLE, dbus_service_plugin_config_init))
+
+enum dbus_service_plugin_signal {
+    SIGNAL_CONFIG_VALUE_CHANGED,
+    SIGNAL_COUNT
+};
+
+#define SIGNAL_CONFIG_VALUE_CHANGED_NAME "dbus-service-config-value-changed"
+
+static guint dbus_service_plugin_signals[SIGNAL_COUNT] = { 0 };
 
 #define NFC_BUS         G_BUS_TYPE_SYSTEM
 #define NFC_SERVICE     "org.sailfishos.nfc.daemon"
 #define NFC_DAEMON_PATH "/"
 
-#define NFC_DBUS_PLUGIN_INTERFACE_VERSION  (3)
+#define NFC_DBUS_PLUGIN_INTERFACE_VERSION  (7)
+
+#define DBUS_SERVICE_NAME       "org.freedesktop.DBus"
+#define DBUS_SERVICE_PATH       "/org/freedesktop/DBus"
+#define DBUS_SERVICE_INTERFACE  "org.freedesktop.DBus"
+
+#define DBUS_SERVICE_PLUGIN_KEY "dbus-service-plugin"
+
+/* dbusaccess policy spec, the default one allows everything */
+#define DBUS_SERVICE_CONFIG_KEY_ACCESS_POLICY "AccessPolicy"
+
+/*
+ * The state snapshot is only written if the state directory exists.
+ * systemd creates it (RuntimeDirectory=) and keeps it across restarts
+ * (RuntimeDirectoryPreserve=), and /run is wiped on reboot.
+ */
+#define DBUS_SERVICE_STATE_DIR      "/run/nfcd"
+#define DBUS_SERVICE_STATE_FILE     "dbus-service"
+#define DBUS_SERVICE_STATE_GROUP    "Daemon"
+#define DBUS_SERVICE_STATE_LAST_ID  "LastModeRequestId"
+#define DBUS_SERVICE_STATE_MODE     "Mode."
+#define DBUS_SERVICE_STATE_SERVICE  "Service."
+#define DBUS_SERVICE_STATE_MAX_SAP  (63)
+
+static
+void
+dbus_service_plugin_state_changed(
+    DBusServicePlugin* self);
 
 static
 gboolean
@@ -149,6 +222,32 @@ dbus_service_plugin_peer_service_destroy(
     nfc_peer_service_unref(service);
 }
 
+static
+void
+dbus_service_plugin_snep_destroy(
+    gpointer user_data)
+{
+    DBusServiceSnep* snep = user_data;
+    DBusServicePlugin* plugin = snep->plugin;
+    NfcPeerService* service = &snep->service;
+
+    snep->plugin = NULL;
+    nfc_manager_unregister_service(plugin->manager, service);
+    nfc_peer_service_disconnect_all(service);
+    nfc_peer_service_unref(service);
+}
+
+static
+void
+dbus_service_plugin_mode_request_free(
+    gpointer data)
+{
+    DBusServiceModeRequest* mr = data;
+
+    nfc_manager_mode_request_free(mr->req);
+    gutil_slice_free(mr);
+}
+
 static
 void
 dbus_service_plugin_client_destroy(
@@ -162,6 +261,9 @@ dbus_service_plugin_client_destroy(
     if (client->mode_requests) {
         g_hash_table_destroy(client->mode_requests);
     }
+    if (client->published) {
+        g_hash_table_destroy(client->published);
+    }
     g_bus_unwatch_name(client->watch_id);
     g_free(client->dbus_name);
     gutil_slice_free(client);
@@ -218,6 +320,7 @@ dbus_service_plugin_client_gone(
 
     GDEBUG("Name '%s' has disappeared", name);
     g_hash_table_remove(self->clients, name);
+    dbus_service_plugin_state_changed(self);
 }
 
 static
@@ -262,7 +365,8 @@ dbus_service_plugin_register_local_service(
     DBusServicePlugin* self,
     const char* peer_name,
     const char* obj_path,
-    const char* dbus_name)
+    const char* dbus_name,
+    guint8 sap)
 {
     DBusServiceLocal* local = dbus_service_local_new(self->connection,
         obj_path, peer_name, dbus_name);
@@ -270,7 +374,7 @@ dbus_service_plugin_register_local_service(
     if (local) {
         NfcPeerService* service = &local->service;
 
-        if (nfc_manager_register_service(self->manager, service)) {
+        if (nfc_manager_register_service2(self->manager, service, sap)) {
             DBusServiceClient* client = dbus_service_plugin_client_get
                 (self, dbus_name);
 
@@ -304,6 +408,9 @@ dbus_service_plugin_event_adapter_added(
 
     if (self->connection) {
         if (dbus_service_plugin_create_adapter(self, adapter)) {
+            dbus_service_events_post(self->connection,
+                DBUS_SERVICE_EVENT_ADAPTER_ADDED, dbus_service_adapter_path
+                (g_hash_table_lookup(self->adapters, adapter->name)), 0);
             dbus_service_plugin_adapters_changed(self);
         }
     }
@@ -317,8 +424,14 @@ dbus_service_plugin_event_adapter_removed(
     void* plugin)
 {
     DBusServicePlugin* self = THIS(plugin);
+    DBusServiceAdapter* dbus = g_hash_table_lookup(self->adapters,
+        adapter->name);
 
-    if (g_hash_table_remove(self->adapters, (void*)adapter->name)) {
+    if (dbus) {
+        dbus_service_events_post(self->connection,
+            DBUS_SERVICE_EVENT_ADAPTER_REMOVED,
+            dbus_service_adapter_path(dbus), 0);
+        g_hash_table_remove(self->adapters, adapter->name);
         dbus_service_plugin_adapters_changed(self);
     }
 }
@@ -333,6 +446,11 @@ dbus_service_plugin_event_mode_changed(
 
     org_sailfishos_nfc_daemon_emit_mode_changed(self->iface,
         self->manager->mode);
+    if (self->connection) {
+        dbus_service_events_post(self->connection,
+            DBUS_SERVICE_EVENT_MODE_CHANGED, NFC_DAEMON_PATH,
+            self->manager->mode);
+    }
 }
 
 /*==========================================================================*
@@ -434,36 +552,100 @@ dbus_service_plugin_handle_get_mode(
 }
 
 static
-gboolean
-dbus_service_plugin_handle_request_mode(
-    OrgSailfishosNfcDaemon* iface,
-    GDBusMethodInvocation* call,
+void
+dbus_service_plugin_client_add_mode_request(
+    DBusServicePlugin* self,
+    DBusServiceClient* client,
+    guint id,
     guint enable,
     guint disable,
-    DBusServicePlugin* self)
+    NFC_TAG_READ_POLICY read_policy)
 {
-    const char* sender = g_dbus_method_invocation_get_sender(call);
-    DBusServiceClient* client = dbus_service_plugin_client_get(self, sender);
-    NfcModeRequest* req = nfc_manager_mode_request_new(self->manager,
-        enable, disable);
+    DBusServiceModeRequest* mr = g_slice_new(DBusServiceModeRequest);
 
+    mr->req = nfc_manager_mode_request_new2(self->manager, enable, disable,
+        read_policy);
+    mr->enable = enable;
+    mr->disable = disable;
+    mr->read_policy = read_policy;
     if (!client->mode_requests) {
         client->mode_requests = g_hash_table_new_full(g_direct_hash,
-            g_direct_equal, NULL, (GDestroyNotify)
-            nfc_manager_mode_request_free);
+            g_direct_equal, NULL, dbus_service_plugin_mode_request_free);
     }
+    g_hash_table_replace(client->mode_requests, GUINT_TO_POINTER(id), mr);
+    GDEBUG("Mode request 0x%02x/0x%02x/%d => %s/%u", enable, disable,
+        read_policy, client->dbus_name, id);
+}
+
+static
+guint
+dbus_service_plugin_add_mode_request(
+    DBusServicePlugin* self,
+    GDBusMethodInvocation* call,
+    guint enable,
+    guint disable,
+    NFC_TAG_READ_POLICY read_policy)
+{
+    const char* sender = g_dbus_method_invocation_get_sender(call);
+    DBusServiceClient* client = dbus_service_plugin_client_get(self, sender);
+
     self->last_mode_request_id++;
-    while (g_hash_table_contains(client->mode_requests, GUINT_TO_POINTER
-        (self->last_mode_request_id)) || !self->last_mode_request_id) {
+    while ((client->mode_requests &&
+        g_hash_table_contains(client->mode_requests, GUINT_TO_POINTER
+        (self->last_mode_request_id))) || !self->last_mode_request_id) {
         self->last_mode_request_id++;
     }
-    g_hash_table_insert(client->mode_requests,
-        GUINT_TO_POINTER(self->last_mode_request_id), req);
-    GDEBUG("Mode request 0x%02x/0x%02x => %s/%u", enable, disable,
-        sender, self->last_mode_request_id);
+    dbus_service_plugin_client_add_mode_request(self, client,
+        self->last_mode_request_id, enable, disable, read_policy);
+    dbus_service_plugin_state_changed(self);
+    return self->last_mode_request_id;
+}
 
-    org_sailfishos_nfc_daemon_complete_request_mode(iface, call,
-        self->last_mode_request_id);
+static
+gboolean
+dbus_service_plugin_handle_request_mode(
+    OrgSailfishosNfcDaemon* iface,
+    GDBusMethodInvocation* call,
+    guint enable,
+    guint disable,
+    DBusServicePlugin* self)
+{
+    if (!dbus_service_reject_private_call(call) &&
+        dbus_service_access_allowed(call, DBUS_SERVICE_ACTION_REQUEST_MODE)) {
+        org_sailfishos_nfc_daemon_complete_request_mode(iface, call,
+            dbus_service_plugin_add_mode_request(self, call, enable, disable,
+                NFC_TAG_READ_DEFAULT));
+    }
+    return TRUE;
+}
+
+static
+gboolean
+dbus_service_plugin_handle_request_mode2(
+    OrgSailfishosNfcDaemon* iface,
+    GDBusMethodInvocation* call,
+    guint enable,
+    guint disable,
+    guint read_policy,
+    DBusServicePlugin* self)
+{
+    if (dbus_service_reject_private_call(call) ||
+        !dbus_service_access_allowed(call, DBUS_SERVICE_ACTION_REQUEST_MODE)) {
+        return TRUE;
+    }
+    switch ((NFC_TAG_READ_POLICY)read_policy) {
+    case NFC_TAG_READ_DEFAULT:
+    case NFC_TAG_READ_NONE:
+    case NFC_TAG_READ_NDEF:
+    case NFC_TAG_READ_FULL:
+        org_sailfishos_nfc_daemon_complete_request_mode2(iface, call,
+            dbus_service_plugin_add_mode_request(self, call, enable, disable,
+                read_policy));
+        return TRUE;
+    }
+    g_dbus_method_invocation_return_error(call, DBUS_SERVICE_ERROR,
+        DBUS_SERVICE_ERROR_INVALID_ARGS, "Invalid read policy %u",
+        read_policy);
     return TRUE;
 }
 
@@ -478,6 +660,9 @@ dbus_service_plugin_handle_release_mode(
     const char* sender = g_dbus_method_invocation_get_sender(call);
     gboolean released = FALSE;
 
+    if (dbus_service_reject_private_call(call)) {
+        return TRUE;
+    }
     if (self->clients) {
         DBusServiceClient* client = g_hash_table_lookup(self->clients, sender);
 
@@ -486,6 +671,7 @@ dbus_service_plugin_handle_release_mode(
     }
     if (released) {
         GDEBUG("Mode request %s/%u released", sender, id);
+        dbus_service_plugin_state_changed(self);
         org_sailfishos_nfc_daemon_complete_release_mode(iface, call);
     } else {
         GDEBUG("Mode request %s/%u not found", sender, id);
@@ -508,6 +694,11 @@ dbus_service_plugin_handle_register_local_service(
     DBusServiceLocal* local = NULL;
     const char* sender = g_dbus_method_invocation_get_sender(call);
 
+    if (dbus_service_reject_private_call(call) ||
+        !dbus_service_access_allowed(call,
+            DBUS_SERVICE_ACTION_REGISTER_LOCAL_SERVICE)) {
+        return TRUE;
+    }
     if (self->clients) {
         DBusServiceClient* client = g_hash_table_lookup(self->clients, sender);
 
@@ -522,10 +713,11 @@ dbus_service_plugin_handle_register_local_service(
             "Service '%s' already registered", obj_path);
     } else {
         local = dbus_service_plugin_register_local_service(self, sn,
-            obj_path, sender);
+            obj_path, sender, 0);
         if (local) {
             GDEBUG("Registered service %s%s (SAP %u)", sender, obj_path,
                 local->service.sap);
+            dbus_service_plugin_state_changed(self);
             org_sailfishos_nfc_daemon_complete_register_local_service(iface,
                 call, local->service.sap);
         } else {
@@ -548,6 +740,9 @@ dbus_service_plugin_handle_unregister_local_service(
     const char* sender = g_dbus_method_invocation_get_sender(call);
     gboolean removed = FALSE;
 
+    if (dbus_service_reject_private_call(call)) {
+        return TRUE;
+    }
     if (self->clients) {
         DBusServiceClient* client = g_hash_table_lookup(self->clients, sender);
 
@@ -556,6 +751,7 @@ dbus_service_plugin_handle_unregister_local_service(
     }
     if (removed) {
         GDEBUG("Unregistered service %s%s", sender, obj_path);
+        dbus_service_plugin_state_changed(self);
         org_sailfishos_nfc_daemon_complete_unregister_local_service
             (iface, call);
     } else {
@@ -567,6 +763,688 @@ dbus_service_plugin_handle_unregister_local_service(
     return TRUE;
 }
 
+/* Interface version 5 */
+
+/* OpenPrivateConnection */
+
+static
+gboolean
+dbus_service_plugin_private_allow_mechanism(
+    GDBusAuthObserver* observer,
+    const gchar* mechanism,
+    gpointer user_data)
+{
+    /* Credentials are required */
+    return !g_strcmp0(mechanism, "EXTERNAL");
+}
+
+static
+gboolean
+dbus_service_plugin_private_authorize(
+    GDBusAuthObserver* observer,
+    GIOStream* stream,
+    GCredentials* credentials,
+    gpointer user_data)
+{
+    DBusServicePrivateAuth* auth = user_data;
+    GError* error = NULL;
+    const uid_t uid = credentials ?
+        g_credentials_get_unix_user(credentials, &error) : (uid_t)-1;
+
+    if (uid == (uid_t)-1) {
+        GWARN("Private connection without credentials");
+        if (error) g_error_free(error);
+        return FALSE;
+    } else if (auth->check_uid && uid != auth->uid) {
+        GWARN("Private connection uid %u != %u", (guint)uid,
+            (guint)auth->uid);
+        return FALSE;
+    } else {
+        GDEBUG("Private connection authorized for uid %u", (guint)uid);
+        return TRUE;
+    }
+}
+
+static
+void
+dbus_service_plugin_private_auth_free(
+    gpointer data,
+    GClosure* closure)
+{
+    g_slice_free(DBusServicePrivateAuth, data);
+}
+
+static
+void
+dbus_service_plugin_private_connected(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer plugin)
+{
+    DBusServicePlugin* self = THIS(plugin);
+    GError* error = NULL;
+    GDBusConnection* connection = g_dbus_connection_new_finish(result,
+        &error);
+
+    if (connection) {
+        if (self->connection) {
+            GDEBUG("Private connection %p established", connection);
+            dbus_service_access_attach_peer(connection);
+            dbus_service_add_private_connection(self->connection, connection);
+            g_dbus_connection_start_message_processing(connection);
+        } else {
+            /* The plugin has been stopped in the meantime */
+            g_dbus_connection_close(connection, NULL, NULL, NULL);
+        }
+        g_object_unref(connection);
+    } else {
+        GWARN("Private connection failed: %s", GERRMSG(error));
+        g_error_free(error);
+    }
+    g_object_unref(self);
+}
+
+static
+void
+dbus_service_plugin_open_private_connection(
+    DBusServicePlugin* self,
+    GDBusMethodInvocation* call,
+    const uid_t* uid)
+{
+    int fd[2];
+
+    if (!self->connection) {
+        g_dbus_method_invocation_return_error_literal(call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_ABORTED, "Stopped");
+    } else if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fd) == 0) {
+        GError* error = NULL;
+        GSocket* sock = g_socket_new_from_fd(fd[0], &error);
+
+        if (sock) {
+            GSocketConnection* stream =
+                g_socket_connection_factory_create_connection(sock);
+            GDBusAuthObserver* observer = g_dbus_auth_observer_new();
+            DBusServicePrivateAuth* auth =
+                g_slice_new0(DBusServicePrivateAuth);
+            GUnixFDList* fdl = g_unix_fd_list_new_from_array(fd + 1, 1);
+            char* guid = g_dbus_generate_guid();
+
+            /*
+             * Credentials are checked once, when the client connects.
+             * Message processing is delayed until all the objects have
+             * been exported on the new connection.
+             */
+            if (uid) {
+                auth->check_uid = TRUE;
+                auth->uid = *uid;
+            }
+            g_signal_connect(observer, "allow-mechanism",
+                G_CALLBACK(dbus_service_plugin_private_allow_mechanism),
+                NULL);
+            g_signal_connect_data(observer, "authorize-authenticated-peer",
+                G_CALLBACK(dbus_service_plugin_private_authorize), auth,
+                dbus_service_plugin_private_auth_free, 0);
+            g_dbus_connection_new(G_IO_STREAM(stream), guid,
+                G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_SERVER |
+                G_DBUS_CONNECTION_FLAGS_DELAY_MESSAGE_PROCESSING,
+                observer, NULL, dbus_service_plugin_private_connected,
+                g_object_ref(self));
+            org_sailfishos_nfc_daemon_complete_open_private_connection
+                (self->iface, call, fdl, g_variant_new_handle(0));
+            g_free(guid);
+            g_object_unref(fdl);
+            g_object_unref(observer);
+            g_object_unref(stream);
+            g_object_unref(sock);
+        } else {
+            GERR("%s", GERRMSG(error));
+            g_dbus_method_invocation_return_gerror(call, error);
+            g_error_free(error);
+            close(fd[0]);
+            close(fd[1]);
+        }
+    } else {
+        GERR("Failed to create socket pair: %s", strerror(errno));
+        g_dbus_method_invocation_return_error_literal(call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_FAILED,
+            "Failed to create socket pair");
+    }
+}
+
+static
+void
+dbus_service_plugin_open_private_connection_uid(
+    GObject* bus,
+    GAsyncResult* result,
+    gpointer call)
+{
+    GDBusMethodInvocation* invocation = G_DBUS_METHOD_INVOCATION(call);
+    DBusServicePlugin* self = g_object_get_data(G_OBJECT(call),
+        DBUS_SERVICE_PLUGIN_KEY);
+    GError* error = NULL;
+    GVariant* ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(bus),
+        result, &error);
+
+    if (ret) {
+        uid_t uid;
+        guint32 value;
+
+        g_variant_get(ret, "(u)", &value);
+        g_variant_unref(ret);
+        uid = value;
+        dbus_service_plugin_open_private_connection(self, invocation, &uid);
+    } else {
+        GWARN("%s", GERRMSG(error));
+        g_dbus_method_invocation_return_gerror(invocation, error);
+        g_error_free(error);
+    }
+    g_object_unref(invocation);
+}
+
+static
+gboolean
+dbus_service_plugin_handle_open_private_connection(
+    OrgSailfishosNfcDaemon* iface,
+    GDBusMethodInvocation* call,
+    GUnixFDList* fdl,
+    DBusServicePlugin* self)
+{
+    const char* sender = g_dbus_method_invocation_get_sender(call);
+
+    if (dbus_service_private_call(call)) {
+        g_dbus_method_invocation_return_error_literal(call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_NOT_SUPPORTED,
+            "Already a private connection");
+    } else if (!dbus_service_access_allowed(call,
+        DBUS_SERVICE_ACTION_OPEN_PRIVATE_CONNECTION)) {
+        /* dbus_service_access_allowed() has completed the call */
+    } else if (sender) {
+        /* The peer on the other end must have the same uid as the caller */
+        g_object_set_data_full(G_OBJECT(call), DBUS_SERVICE_PLUGIN_KEY,
+            g_object_ref(self), g_object_unref);
+        g_dbus_connection_call(g_dbus_method_invocation_get_connection(call),
+            DBUS_SERVICE_NAME, DBUS_SERVICE_PATH, DBUS_SERVICE_INTERFACE,
+            "GetConnectionUnixUser", g_variant_new("(s)", sender),
+            G_VARIANT_TYPE("(u)"), G_DBUS_CALL_FLAGS_NONE, -1, NULL,
+            dbus_service_plugin_open_private_connection_uid,
+            g_object_ref(call));
+    } else {
+        /* Peer-to-peer connection, any authenticated peer is fine */
+        dbus_service_plugin_open_private_connection(self, call, NULL);
+    }
+    return TRUE;
+}
+
+/* Interface version 6 */
+
+/* SubscribeEvents */
+
+static
+gboolean
+dbus_service_plugin_handle_subscribe_events(
+    OrgSailfishosNfcDaemon* iface,
+    GDBusMethodInvocation* call,
+    GUnixFDList* fdl,
+    guint64 since,
+    DBusServicePlugin* self)
+{
+    guint64 seq = 0;
+    int fd;
+
+    if (dbus_service_reject_private_call(call) ||
+        !dbus_service_access_allowed(call,
+            DBUS_SERVICE_ACTION_SUBSCRIBE_EVENTS)) {
+        return TRUE;
+    }
+
+    fd = self->connection ?
+        dbus_service_events_subscribe(self->connection, since, &seq) : -1;
+    if (fd >= 0) {
+        GUnixFDList* out = g_unix_fd_list_new_from_array(&fd, 1);
+
+        org_sailfishos_nfc_daemon_complete_subscribe_events(iface, call,
+            out, g_variant_new_handle(0), seq);
+        g_object_unref(out);
+    } else {
+        GERR("Failed to subscribe to events: %s", strerror(errno));
+        g_dbus_method_invocation_return_error_literal(call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_FAILED,
+            "Failed to subscribe to events");
+    }
+    return TRUE;
+}
+
+/* Interface version 7 */
+
+/* PublishNdef */
+
+static
+DBusServiceSnep*
+dbus_service_plugin_find_published(
+    DBusServicePlugin* self,
+    const char* sn,
+    DBusServiceClient** owner)
+{
+    if (self->clients) {
+        GHashTableIter it;
+        gpointer value;
+
+        g_hash_table_iter_init(&it, self->clients);
+        while (g_hash_table_iter_next(&it, NULL, &value)) {
+            DBusServiceClient* client = value;
+            DBusServiceSnep* snep = client->published ?
+                g_hash_table_lookup(client->published, sn) : NULL;
+
+            if (snep) {
+                *owner = client;
+                return snep;
+            }
+        }
+    }
+    return NULL;
+}
+
+static
+gboolean
+dbus_service_plugin_handle_publish_ndef(
+    OrgSailfishosNfcDaemon* iface,
+    GDBusMethodInvocation* call,
+    const char* name,
+    GVariant* data,
+    DBusServicePlugin* self)
+{
+    const char* sender = g_dbus_method_invocation_get_sender(call);
+    const char* sn = name[0] ? name : DBUS_SERVICE_SNEP_DEFAULT_SN;
+    DBusServiceClient* owner = NULL;
+    DBusServiceSnep* snep;
+    GBytes* ndef;
+
+    if (dbus_service_reject_private_call(call) ||
+        !dbus_service_access_allowed(call,
+            DBUS_SERVICE_ACTION_REGISTER_LOCAL_SERVICE)) {
+        return TRUE;
+    }
+    if (!strcmp(sn, NFC_LLC_NAME_SNEP) || !strcmp(sn, NFC_LLC_NAME_SDP)) {
+        g_dbus_method_invocation_return_error(call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_INVALID_ARGS,
+            "Can't publish at %s", sn);
+        return TRUE;
+    }
+
+    snep = dbus_service_plugin_find_published(self, sn, &owner);
+    if (snep && strcmp(owner->dbus_name, sender)) {
+        g_dbus_method_invocation_return_error(call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_ALREADY_EXISTS,
+            "%s is owned by %s", sn, owner->dbus_name);
+        return TRUE;
+    }
+
+    ndef = g_bytes_new(g_variant_get_data(data), g_variant_get_size(data));
+    if (snep) {
+        /* Replace the data */
+        GDEBUG("Updated %s (%u bytes)", sn, (guint) g_bytes_get_size(ndef));
+        dbus_service_snep_set_ndef(snep, ndef);
+    } else {
+        snep = dbus_service_snep_new(sn, ndef);
+        if (nfc_manager_register_service(self->manager, &snep->service)) {
+            DBusServiceClient* client = dbus_service_plugin_client_get
+                (self, sender);
+
+            if (!client->published) {
+                client->published = g_hash_table_new_full(g_str_hash,
+                    g_str_equal, NULL, dbus_service_plugin_snep_destroy);
+            }
+            snep->plugin = self;
+            g_hash_table_insert(client->published, (gpointer)
+                snep->service.name, snep);
+            GDEBUG("Published %s (SAP %u, %u bytes)", sn, snep->service.sap,
+                (guint) g_bytes_get_size(ndef));
+        } else {
+            nfc_peer_service_unref(&snep->service);
+            snep = NULL;
+        }
+    }
+    g_bytes_unref(ndef);
+
+    if (snep) {
+        org_sailfishos_nfc_daemon_complete_publish_ndef(iface, call,
+            snep->service.sap);
+    } else {
+        g_dbus_method_invocation_return_error(call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_ALREADY_EXISTS,
+            "Failed to register %s", sn);
+    }
+    return TRUE;
+}
+
+/* UnpublishNdef */
+
+static
+gboolean
+dbus_service_plugin_handle_unpublish_ndef(
+    OrgSailfishosNfcDaemon* iface,
+    GDBusMethodInvocation* call,
+    const char* name,
+    DBusServicePlugin* self)
+{
+    const char* sender = g_dbus_method_invocation_get_sender(call);
+    const char* sn = name[0] ? name : DBUS_SERVICE_SNEP_DEFAULT_SN;
+    DBusServiceClient* client = self->clients ?
+        g_hash_table_lookup(self->clients, sender) : NULL;
+
+    if (dbus_service_reject_private_call(call)) {
+        return TRUE;
+    }
+    if (client && client->published &&
+        g_hash_table_remove(client->published, sn)) {
+        GDEBUG("Unpublished %s", sn);
+        org_sailfishos_nfc_daemon_complete_unpublish_ndef(iface, call);
+    } else {
+        g_dbus_method_invocation_return_error(call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_NOT_FOUND,
+            "Nothing published at %s", sn);
+    }
+    return TRUE;
+}
+
+/*==========================================================================*
+ * State snapshot
+ *
+ * Mode requests and local services survive a restart, provided that the
+ * clients which own them are still there. Each client has a group named
+ * after its D-Bus name, which allows the name watch to drop what belongs
+ * to the clients that have gone while nfcd was down.
+ *==========================================================================*/
+
+static
+gboolean
+dbus_service_plugin_save_client(
+    const DBusServiceClient* client,
+    GKeyFile* state)
+{
+    const char* group = client->dbus_name;
+    gboolean saved = FALSE;
+    GHashTableIter it;
+    gpointer key, value;
+
+    if (client->mode_requests) {
+        g_hash_table_iter_init(&it, client->mode_requests);
+        while (g_hash_table_iter_next(&it, &key, &value)) {
+            const DBusServiceModeRequest* mr = value;
+            char* name = g_strdup_printf(DBUS_SERVICE_STATE_MODE "%u",
+                GPOINTER_TO_UINT(key));
+            gint list[3];
+
+            list[0] = mr->enable;
+            list[1] = mr->disable;
+            list[2] = mr->read_policy;
+            g_key_file_set_integer_list(state, group, name, list,
+                G_N_ELEMENTS(list));
+            g_free(name);
+            saved = TRUE;
+        }
+    }
+    if (client->peer_services) {
+        g_hash_table_iter_init(&it, client->peer_services);
+        while (g_hash_table_iter_next(&it, NULL, &value)) {
+            const DBusServiceLocal* local = value;
+            const NfcPeerService* service = &local->service;
+            char* name = g_strdup_printf(DBUS_SERVICE_STATE_SERVICE "%u",
+                service->sap);
+            const char* list[2];
+
+            list[0] = local->obj_path;
+            list[1] = service->name ? service->name : "";
+            g_key_file_set_string_list(state, group, name, list,
+                G_N_ELEMENTS(list));
+            g_free(name);
+            saved = TRUE;
+        }
+    }
+    return saved;
+}
+
+static
+void
+dbus_service_plugin_save_state(
+    DBusServicePlugin* self)
+{
+    GKeyFile* state = g_key_file_new();
+    gboolean empty = TRUE;
+
+    if (self->clients) {
+        GHashTableIter it;
+        gpointer value;
+
+        g_hash_table_iter_init(&it, self->clients);
+        while (g_hash_table_iter_next(&it, NULL, &value)) {
+            if (dbus_service_plugin_save_client(value, state)) {
+                empty = FALSE;
+            }
+        }
+    }
+    if (!empty) {
+        GError* error = NULL;
+        gsize len;
+        gchar* data;
+
+        g_key_file_set_uint64(state, DBUS_SERVICE_STATE_GROUP,
+            DBUS_SERVICE_STATE_LAST_ID, self->last_mode_request_id);
+        data = g_key_file_to_data(state, &len, NULL);
+        if (g_file_set_contents(self->state_file, data, len, &error)) {
+            GDEBUG("Wrote %s", self->state_file);
+        } else {
+            GWARN("%s", GERRMSG(error));
+            g_error_free(error);
+        }
+        g_free(data);
+    } else if (unlink(self->state_file) == 0) {
+        GDEBUG("Removed %s", self->state_file);
+    }
+    g_key_file_unref(state);
+}
+
+static
+gboolean
+dbus_service_plugin_save_state_cb(
+    gpointer plugin)
+{
+    DBusServicePlugin* self = THIS(plugin);
+
+    self->save_state_id = 0;
+    dbus_service_plugin_save_state(self);
+    return G_SOURCE_REMOVE;
+}
+
+static
+void
+dbus_service_plugin_state_changed(
+    DBusServicePlugin* self)
+{
+    /* Coalesce the changes made within one main loop iteration */
+    if (self->state_file && self->connection && !self->save_state_id) {
+        self->save_state_id = g_idle_add(dbus_service_plugin_save_state_cb,
+            self);
+    }
+}
+
+typedef struct dbus_service_plugin_restore {
+    DBusServicePlugin* plugin;
+    GKeyFile* state;
+    char* dbus_name;
+} DBusServicePluginRestore;
+
+static
+gboolean
+dbus_service_plugin_restore_services(
+    DBusServicePlugin* self,
+    GKeyFile* state,
+    const char* dbus_name)
+{
+    guint sap;
+
+    /* Each service is restored at exactly the same SAP or not at all */
+    for (sap = 0; sap <= DBUS_SERVICE_STATE_MAX_SAP; sap++) {
+        char* key = g_strdup_printf(DBUS_SERVICE_STATE_SERVICE "%u", sap);
+        gsize n = 0;
+        gchar** list = g_key_file_get_string_list(state, dbus_name, key,
+            &n, NULL);
+        gboolean ok = TRUE;
+
+        if (list && n == 2) {
+            const char* path = list[0];
+            const char* sn = list[1][0] ? list[1] : NULL;
+
+            if (sap && dbus_service_plugin_register_local_service(self, sn,
+                path, dbus_name, (guint8)sap)) {
+                GDEBUG("Restored service %s%s (SAP %u)", dbus_name, path,
+                    sap);
+            } else {
+                GWARN("Failed to restore service %s%s at SAP %u",
+                    dbus_name, path, sap);
+                ok = FALSE;
+            }
+        }
+        g_strfreev(list);
+        g_free(key);
+        if (!ok) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static
+void
+dbus_service_plugin_restore_client(
+    DBusServicePlugin* self,
+    GKeyFile* state,
+    const char* dbus_name)
+{
+    DBusServiceClient* client = dbus_service_plugin_client_get(self,
+        dbus_name);
+    gchar** keys;
+
+    /*
+     * SAPs are known to the peers the client has been talking to. If
+     * any of them can't be had, the client is better off with nothing
+     * restored, its services and mode requests are dropped altogether.
+     */
+    if (!dbus_service_plugin_restore_services(self, state, dbus_name)) {
+        GWARN("Not restoring %s", dbus_name);
+        g_hash_table_remove(self->clients, dbus_name);
+        dbus_service_plugin_state_changed(self);
+        return;
+    }
+
+    keys = g_key_file_get_keys(state, dbus_name, NULL, NULL);
+    if (keys) {
+        const gsize prefix_len = strlen(DBUS_SERVICE_STATE_MODE);
+        gchar** ptr;
+
+        for (ptr = keys; *ptr; ptr++) {
+            const char* key = *ptr;
+
+            if (g_str_has_prefix(key, DBUS_SERVICE_STATE_MODE)) {
+                char* end = NULL;
+                const guint64 id = g_ascii_strtoull(key + prefix_len,
+                    &end, 10);
+                gsize n = 0;
+                gint* list = g_key_file_get_integer_list(state, dbus_name,
+                    key, &n, NULL);
+
+                if (id && id <= G_MAXUINT && end && !*end && n == 3) {
+                    dbus_service_plugin_client_add_mode_request(self, client,
+                        (guint)id, list[0], list[1], list[2]);
+                }
+                g_free(list);
+            }
+        }
+        g_strfreev(keys);
+    }
+}
+
+static
+void
+dbus_service_plugin_restore_free(
+    DBusServicePluginRestore* restore)
+{
+    g_object_unref(restore->plugin);
+    g_key_file_unref(restore->state);
+    g_free(restore->dbus_name);
+    gutil_slice_free(restore);
+}
+
+static
+void
+dbus_service_plugin_restore_name_has_owner(
+    GObject* bus,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    DBusServicePluginRestore* restore = user_data;
+    DBusServicePlugin* self = restore->plugin;
+    const char* dbus_name = restore->dbus_name;
+    GError* error = NULL;
+    GVariant* var = g_dbus_connection_call_finish(G_DBUS_CONNECTION(bus),
+        result, &error);
+
+    if (var) {
+        gboolean present = FALSE;
+
+        g_variant_get(var, "(b)", &present);
+        if (!present) {
+            /* Don't re-apply the requests made by the dead */
+            GDEBUG("%s is gone, not restoring", dbus_name);
+        } else if (self->connection) {
+            dbus_service_plugin_restore_client(self, restore->state,
+                dbus_name);
+        }
+        g_variant_unref(var);
+    } else {
+        GWARN("Not restoring %s: %s", dbus_name, GERRMSG(error));
+        g_error_free(error);
+    }
+    dbus_service_plugin_restore_free(restore);
+}
+
+static
+void
+dbus_service_plugin_restore_state(
+    DBusServicePlugin* self)
+{
+    GKeyFile* state = g_key_file_new();
+
+    if (g_key_file_load_from_file(state, self->state_file, 0, NULL)) {
+        gchar** groups = g_key_file_get_groups(state, NULL);
+        gchar** ptr;
+
+        self->last_mode_request_id = (guint)g_key_file_get_uint64(state,
+            DBUS_SERVICE_STATE_GROUP, DBUS_SERVICE_STATE_LAST_ID, NULL);
+        for (ptr = groups; *ptr; ptr++) {
+            const char* dbus_name = *ptr;
+
+            if (strcmp(dbus_name, DBUS_SERVICE_STATE_GROUP)) {
+                DBusServicePluginRestore* restore =
+                    g_slice_new(DBusServicePluginRestore);
+
+                /* Only the clients which are still there get restored */
+                g_object_ref(restore->plugin = self);
+                restore->state = g_key_file_ref(state);
+                restore->dbus_name = g_strdup(dbus_name);
+                g_dbus_connection_call(self->connection, DBUS_SERVICE_NAME,
+                    DBUS_SERVICE_PATH, DBUS_SERVICE_INTERFACE, "NameHasOwner",
+                    g_variant_new("(s)", dbus_name), G_VARIANT_TYPE("(b)"),
+                    G_DBUS_CALL_FLAGS_NONE, -1, NULL,
+                    dbus_service_plugin_restore_name_has_owner, restore);
+            }
+        }
+        g_strfreev(groups);
+        GINFO("Restoring state from %s", self->state_file);
+    }
+    g_key_file_unref(state);
+}
+
 /*==========================================================================*
  * Name watching
  *==========================================================================*/
@@ -581,15 +1459,24 @@ dbus_service_plugin_bus_connected(
     DBusServicePlugin* self = THIS(plugin);
     GError* error = NULL;
 
-    if (g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(self->iface),
+    if (dbus_service_export(G_DBUS_INTERFACE_SKELETON(self->iface),
         connection, NFC_DAEMON_PATH, &error)) {
         NfcAdapter** adapters;
 
         g_object_ref(self->connection = connection);
+        dbus_service_access_attach(connection, self->access_policy);
+        dbus_service_events_attach(connection);
+        if (!dbus_service_export_object_manager(connection, &error)) {
+            GWARN("%s", GERRMSG(error));
+            g_error_free(error);
+        }
         /* Register initial set of adapters (if any) */
         for (adapters = self->manager->adapters; *adapters; adapters++) {
             dbus_service_plugin_create_adapter(self, *adapters);
         }
+        if (self->state_file) {
+            dbus_service_plugin_restore_state(self);
+        }
     } else {
         GERR("%s", GERRMSG(error));
         g_error_free(error);
@@ -633,9 +1520,14 @@ dbus_service_plugin_start(
     NfcManager* manager)
 {
     DBusServicePlugin* self = THIS(plugin);
+    const char* state_dir = GET_THIS_CLASS(self)->state_dir;
 
     GVERBOSE("Starting");
     self->manager = nfc_manager_ref(manager);
+    if (state_dir && g_file_test(state_dir, G_FILE_TEST_IS_DIR)) {
+        self->state_file = g_build_filename(state_dir,
+            DBUS_SERVICE_STATE_FILE, NULL);
+    }
     self->iface = org_sailfishos_nfc_daemon_skeleton_new();
     self->own_name_id = g_bus_own_name(NFC_BUS, NFC_SERVICE,
         G_BUS_NAME_OWNER_FLAGS_REPLACE, dbus_service_plugin_bus_connected,
@@ -687,6 +1579,21 @@ dbus_service_plugin_start(
     self->call_id[CALL_UNREGISTER_LOCAL_SERVICE] =
         g_signal_connect(self->iface, "handle-unregister-local-service",
         G_CALLBACK(dbus_service_plugin_handle_unregister_local_service), self);
+    self->call_id[CALL_REQUEST_MODE2] =
+        g_signal_connect(self->iface, "handle-request-mode2",
+        G_CALLBACK(dbus_service_plugin_handle_request_mode2), self);
+    self->call_id[CALL_OPEN_PRIVATE_CONNECTION] =
+        g_signal_connect(self->iface, "handle-open-private-connection",
+        G_CALLBACK(dbus_service_plugin_handle_open_private_connection), self);
+    self->call_id[CALL_SUBSCRIBE_EVENTS] =
+        g_signal_connect(self->iface, "handle-subscribe-events",
+        G_CALLBACK(dbus_service_plugin_handle_subscribe_events), self);
+    self->call_id[CALL_PUBLISH_NDEF] =
+        g_signal_connect(self->iface, "handle-publish-ndef",
+        G_CALLBACK(dbus_service_plugin_handle_publish_ndef), self);
+    self->call_id[CALL_UNPUBLISH_NDEF] =
+        g_signal_connect(self->iface, "handle-unpublish-ndef",
+        G_CALLBACK(dbus_service_plugin_handle_unpublish_ndef), self);
 
     return TRUE;
 }
@@ -699,12 +1606,22 @@ dbus_service_plugin_stop(
     DBusServicePlugin* self = THIS(plugin);
 
     GVERBOSE("Stopping");
+    if (self->save_state_id) {
+        /* Flush the pending changes */
+        g_source_remove(self->save_state_id);
+        self->save_state_id = 0;
+        dbus_service_plugin_save_state(self);
+    }
     gutil_disconnect_handlers(self->iface, self->call_id, CALL_COUNT);
     g_hash_table_remove_all(self->adapters);
     g_bus_unown_name(self->own_name_id);
     if (self->connection) {
-        g_dbus_interface_skeleton_unexport
-            (G_DBUS_INTERFACE_SKELETON(self->iface));
+        dbus_service_unexport(G_DBUS_INTERFACE_SKELETON(self->iface),
+            self->connection);
+        dbus_service_unexport_object_manager(self->connection);
+        dbus_service_close_private_connections(self->connection);
+        dbus_service_access_detach(self->connection);
+        dbus_service_events_detach(self->connection);
         g_object_unref(self->connection);
         self->connection = NULL;
     }
@@ -733,6 +1650,105 @@ dbus_service_plugin_find_peer(
     return NULL;
 }
 
+/*==========================================================================*
+ * NfcConfigurable
+ *==========================================================================*/
+
+static
+const char* const*
+dbus_service_plugin_config_get_keys(
+    NfcConfigurable* config)
+{
+    static const char* const dbus_service_plugin_keys[] = {
+        DBUS_SERVICE_CONFIG_KEY_ACCESS_POLICY,
+        NULL
+    };
+
+    return dbus_service_plugin_keys;
+}
+
+static
+GVariant*
+dbus_service_plugin_config_get_value(
+    NfcConfigurable* config,
+    const char* key)
+{
+    DBusServicePlugin* self = THIS(config);
+
+    if (!g_strcmp0(key, DBUS_SERVICE_CONFIG_KEY_ACCESS_POLICY) &&
+        self->access_policy) {
+        /* OK to return a floating reference */
+        return g_variant_new_string(self->access_policy);
+    } else {
+        return NULL;
+    }
+}
+
+static
+gboolean
+dbus_service_plugin_config_set_value(
+    NfcConfigurable* config,
+    const char* key,
+    GVariant* value)
+{
+    DBusServicePlugin* self = THIS(config);
+    gboolean ok = FALSE;
+
+    if (!g_strcmp0(key, DBUS_SERVICE_CONFIG_KEY_ACCESS_POLICY)) {
+        const char* spec = NULL;
+
+        if (!value) {
+            ok = TRUE;
+        } else if (g_variant_is_of_type(value, G_VARIANT_TYPE_STRING)) {
+            spec = g_variant_get_string(value, NULL);
+            ok = TRUE;
+        }
+
+        /*
+         * Replacing the policy drops the cached decisions, the new
+         * policy applies to all subsequent calls.
+         */
+        if (ok && g_strcmp0(self->access_policy, spec)) {
+            if (dbus_service_access_set_policy(self->connection, spec)) {
+                GDEBUG("%s %s", key, spec ? spec : "(default)");
+                g_free(self->access_policy);
+                self->access_policy = g_strdup(spec);
+                g_signal_emit(self, dbus_service_plugin_signals
+                    [SIGNAL_CONFIG_VALUE_CHANGED], g_quark_from_string(key),
+                    key, value);
+            } else {
+                ok = FALSE;
+            }
+        }
+    }
+    return ok;
+}
+
+static
+gulong
+dbus_service_plugin_config_add_change_handler(
+    NfcConfigurable* config,
+    const char* key,
+    NfcConfigChangeFunc func,
+    void* user_data)
+{
+    return g_signal_connect_closure_by_id(THIS(config),
+        dbus_service_plugin_signals[SIGNAL_CONFIG_VALUE_CHANGED],
+        key ? g_quark_from_string(key) : 0,
+        g_cclosure_new(G_CALLBACK(func), user_data, NULL), FALSE);
+}
+
+static
+void
+dbus_service_plugin_config_init(
+    NfcConfigurableInterface* iface)
+{
+    iface->get_keys = dbus_service_plugin_config_get_keys;
+    iface->get_value = dbus_service_plugin_config_get_value;
+    iface->set_value = dbus_service_plugin_config_set_value;
+    iface->add_change_handler = dbus_service_plugin_config_add_change_handler;
+}
+
 /*==========================================================================*
  * Internals
  *==========================================================================*/
@@ -754,9 +1770,14 @@ dbus_service_plugin_finalize(
 {
     DBusServicePlugin* self = THIS(plugin);
 
+    if (self->save_state_id) {
+        g_source_remove(self->save_state_id);
+    }
     if (self->clients) {
         g_hash_table_destroy(self->clients);
     }
+    g_free(self->state_file);
+    g_free(self->access_policy);
     g_hash_table_destroy(self->adapters);
     gutil_idle_pool_destroy(self->pool);
     G_OBJECT_CLASS(PARENT_CLASS)->finalize(plugin);
@@ -765,11 +1786,19 @@ dbus_service_plugin_finalize(
 static
 void
 dbus_service_plugin_class_init(
-    NfcPluginClass* klass)
+    DBusServicePluginClass* klass)
 {
+    NfcPluginClass* plugin_class = NFC_PLUGIN_CLASS(klass);
+
     G_OBJECT_CLASS(klass)->finalize = dbus_service_plugin_finalize;
-    klass->start = dbus_service_plugin_start;
-    klass->stop = dbus_service_plugin_stop;
+    plugin_class->start = dbus_service_plugin_start;
+    plugin_class->stop = dbus_service_plugin_stop;
+    klass->state_dir = DBUS_SERVICE_STATE_DIR;
+    dbus_service_plugin_signals[SIGNAL_CONFIG_VALUE_CHANGED] =
+        g_signal_new(SIGNAL_CONFIG_VALUE_CHANGED_NAME,
+            G_OBJECT_CLASS_TYPE(klass), G_SIGNAL_RUN_FIRST |
+            G_SIGNAL_DETAILED, 0, NULL, NULL, NULL, G_TYPE_NONE,
+            2, G_TYPE_STRING, G_TYPE_VARIANT);
 }
 
 static
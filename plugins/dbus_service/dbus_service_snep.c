@@ -0,0 +1,410 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "dbus_service.h"
+
+#include <nfc_peer_connection_impl.h>
+#include <nfc_peer_service_impl.h>
+
+/*
+ * SNEP server which answers Get requests with the NDEF message
+ * published over D-Bus. Everything happens inside nfcd, without
+ * any D-Bus round trips. Put requests are not accepted.
+ *
+ * NFCForum-TS-SNEP_1.0
+ */
+
+typedef enum snep_request_code {
+    SNEP_REQUEST_CONTINUE = 0x00,
+    SNEP_REQUEST_GET = 0x01,
+    SNEP_REQUEST_PUT = 0x02,
+    SNEP_REQUEST_REJECT = 0x7f
+} SNEP_REQUEST_CODE;
+
+typedef enum snep_response_code {
+    SNEP_RESPONSE_CONTINUE = 0x80,
+    SNEP_RESPONSE_SUCCESS = 0x81,
+    SNEP_RESPONSE_NOT_FOUND = 0xc0,
+    SNEP_RESPONSE_EXCESS_DATA = 0xc1,
+    SNEP_RESPONSE_BAD_REQUEST = 0xc2,
+    SNEP_RESPONSE_NOT_IMPLEMENTED = 0xe0,
+    SNEP_RESPONSE_UNSUPPORTED_VERSION = 0xe1
+} SNEP_RESPONSE_CODE;
+
+#define SNEP_MAJOR_VERSION (1)
+#define SNEP_VERSION (0x10) /* (MAJOR << 4) | MINOR */
+#define SNEP_HEADER_SIZE (6)
+#define SNEP_GET_HEADER_SIZE (SNEP_HEADER_SIZE + 4) /* Acceptable Length */
+
+typedef NfcPeerServiceClass DBusServiceSnepObjectClass;
+typedef struct dbus_service_snep_object {
+    DBusServiceSnep pub;
+    GBytes* ndef;
+} DBusServiceSnepObject;
+
+#define DBUS_SERVICE_TYPE_SNEP_OBJECT (dbus_service_snep_object_get_type())
+G_DEFINE_TYPE(DBusServiceSnepObject, dbus_service_snep_object, \
+        NFC_TYPE_PEER_SERVICE)
+#define DBUS_SERVICE_SNEP_OBJECT(obj) (G_TYPE_CHECK_INSTANCE_CAST(obj,\
+        DBUS_SERVICE_TYPE_SNEP_OBJECT, DBusServiceSnepObject))
+
+typedef NfcPeerConnectionClass DBusServiceSnepConnectionClass;
+typedef struct dbus_service_snep_connection {
+    NfcPeerConnection connection;
+    guint request_remaining;    /* Request bytes yet to be received */
+    guint acceptable_length;    /* Zero means no limit */
+    GBytes* response_remaining; /* Waiting for Continue */
+} DBusServiceSnepConnection;
+
+#define DBUS_SERVICE_TYPE_SNEP_CONNECTION \
+        (dbus_service_snep_connection_get_type())
+G_DEFINE_TYPE(DBusServiceSnepConnection, dbus_service_snep_connection, \
+        NFC_TYPE_PEER_CONNECTION)
+#define DBUS_SERVICE_SNEP_CONNECTION(obj) (G_TYPE_CHECK_INSTANCE_CAST(obj,\
+        DBUS_SERVICE_TYPE_SNEP_CONNECTION, DBusServiceSnepConnection))
+
+/*==========================================================================*
+ * Connection
+ *==========================================================================*/
+
+static
+guint32
+dbus_service_snep_get_uint32(
+    const guint8* ptr)
+{
+    return (((guint32)ptr[0]) << 24) |
+        (((guint32)ptr[1]) << 16) |
+        (((guint32)ptr[2]) << 8) |
+        ((guint32)ptr[3]);
+}
+
+static
+void
+dbus_service_snep_put_header(
+    guint8* hdr,
+    SNEP_RESPONSE_CODE code,
+    guint32 length)
+{
+    hdr[0] = SNEP_VERSION;
+    hdr[1] = code;
+    hdr[2] = (guint8)(length >> 24);
+    hdr[3] = (guint8)(length >> 16);
+    hdr[4] = (guint8)(length >> 8);
+    hdr[5] = (guint8)length;
+}
+
+static
+void
+dbus_service_snep_connection_response(
+    DBusServiceSnepConnection* self,
+    SNEP_RESPONSE_CODE code)
+{
+    guint8* data = g_malloc(SNEP_HEADER_SIZE);
+    GBytes* pkt = g_bytes_new_take(data, SNEP_HEADER_SIZE);
+
+    dbus_service_snep_put_header(data, code, 0);
+    nfc_peer_connection_send(&self->connection, pkt);
+    g_bytes_unref(pkt);
+}
+
+static
+void
+dbus_service_snep_connection_error(
+    DBusServiceSnepConnection* self,
+    SNEP_RESPONSE_CODE code)
+{
+    dbus_service_snep_connection_response(self, code);
+    nfc_peer_connection_disconnect(&self->connection);
+}
+
+static
+void
+dbus_service_snep_connection_get(
+    DBusServiceSnepConnection* self)
+{
+    NfcPeerConnection* conn = &self->connection;
+    DBusServiceSnepObject* snep = DBUS_SERVICE_SNEP_OBJECT(conn->service);
+    GBytes* ndef = snep->ndef;
+    const gsize size = ndef ? g_bytes_get_size(ndef) : 0;
+
+    if (!size) {
+        GDEBUG("Nothing published at %s", conn->service->name);
+        dbus_service_snep_connection_response(self, SNEP_RESPONSE_NOT_FOUND);
+    } else if (self->acceptable_length && size > self->acceptable_length) {
+        /*
+         * 4.3. Excess Data
+         *
+         * The server is unable to send the requested data within
+         * the acceptable length.
+         */
+        GDEBUG("NDEF size %u exceeds acceptable length %u", (guint) size,
+            self->acceptable_length);
+        dbus_service_snep_connection_response(self,
+            SNEP_RESPONSE_EXCESS_DATA);
+    } else {
+        /*
+         * The first fragment must fit into a single I-PDU. The rest is
+         * sent after the client sends Continue, the LLC splits it into
+         * MIU-sized I-PDUs.
+         */
+        const guint rmiu = nfc_peer_connection_rmiu(conn);
+        const gsize first = MIN(size, rmiu - SNEP_HEADER_SIZE);
+        const guint8* data = g_bytes_get_data(ndef, NULL);
+        guint8* pkt = g_malloc(SNEP_HEADER_SIZE + first);
+        GBytes* bytes = g_bytes_new_take(pkt, SNEP_HEADER_SIZE + first);
+
+        GDEBUG("NDEF Get %u bytes", (guint) size);
+        dbus_service_snep_put_header(pkt, SNEP_RESPONSE_SUCCESS, size);
+        memcpy(pkt + SNEP_HEADER_SIZE, data, first);
+        nfc_peer_connection_send(conn, bytes);
+        g_bytes_unref(bytes);
+        if (first < size) {
+            self->response_remaining = g_bytes_new_from_bytes(ndef,
+                first, size - first);
+        }
+    }
+}
+
+static
+void
+dbus_service_snep_connection_continue(
+    DBusServiceSnepConnection* self,
+    const guint8* pkt,
+    guint len)
+{
+    GBytes* rest = self->response_remaining;
+
+    self->response_remaining = NULL;
+    if (len >= SNEP_HEADER_SIZE && pkt[1] == SNEP_REQUEST_CONTINUE) {
+        GDEBUG("Sending remaining %u bytes", (guint) g_bytes_get_size(rest));
+        nfc_peer_connection_send(&self->connection, rest);
+    } else if (len >= SNEP_HEADER_SIZE && pkt[1] == SNEP_REQUEST_REJECT) {
+        /*
+         * 3.1.2. Request Field
+         *
+         * Reject: Do not send remaining fragments
+         */
+        GDEBUG("Client rejected the remaining fragments");
+    } else {
+        GDEBUG("Expecting Continue, got something else");
+        dbus_service_snep_connection_error(self, SNEP_RESPONSE_BAD_REQUEST);
+    }
+    g_bytes_unref(rest);
+}
+
+static
+void
+dbus_service_snep_connection_data_received(
+    NfcPeerConnection* conn,
+    const void* data,
+    guint len)
+{
+    DBusServiceSnepConnection* self = DBUS_SERVICE_SNEP_CONNECTION(conn);
+    const guint8* pkt = data;
+
+    if (self->request_remaining) {
+        /* The request NDEF is not used, just skip the fragments */
+        if (len > self->request_remaining) {
+            GWARN("Broken SNEP Request (%u > %u)", len,
+                self->request_remaining);
+            dbus_service_snep_connection_error(self,
+                SNEP_RESPONSE_BAD_REQUEST);
+        } else {
+            self->request_remaining -= len;
+            if (!self->request_remaining) {
+                dbus_service_snep_connection_get(self);
+            }
+        }
+    } else if (self->response_remaining) {
+        dbus_service_snep_connection_continue(self, pkt, len);
+    } else if (len < SNEP_HEADER_SIZE) {
+        GWARN("Not enough bytes for SNEP header (%u)", len);
+        nfc_peer_connection_disconnect(conn);
+    } else if ((pkt[0] >> 4) != SNEP_MAJOR_VERSION) {
+        GDEBUG("Unsupported SNEP Version %u", pkt[0] >> 4);
+        dbus_service_snep_connection_error(self,
+            SNEP_RESPONSE_UNSUPPORTED_VERSION);
+    } else if (pkt[1] == SNEP_REQUEST_PUT) {
+        GDEBUG("NDEF Put not accepted");
+        dbus_service_snep_connection_error(self,
+            SNEP_RESPONSE_NOT_IMPLEMENTED);
+    } else if (pkt[1] != SNEP_REQUEST_GET) {
+        GDEBUG("Unsupported SNEP Request 0x%02x", pkt[1]);
+        dbus_service_snep_connection_error(self, SNEP_RESPONSE_BAD_REQUEST);
+    } else {
+        /*
+         * 4.2. Get Request
+         *
+         * The information field of a Get request consists of
+         * a four octet Acceptable Length field followed by the
+         * NDEF message identifying the requested data.
+         */
+        const guint32 length = dbus_service_snep_get_uint32(pkt + 2);
+        const guint received = len - SNEP_HEADER_SIZE;
+
+        if (len < SNEP_GET_HEADER_SIZE || length < 4 || received > length) {
+            GDEBUG("Invalid Get request");
+            dbus_service_snep_connection_error(self,
+                SNEP_RESPONSE_BAD_REQUEST);
+        } else {
+            self->acceptable_length = dbus_service_snep_get_uint32
+                (pkt + SNEP_HEADER_SIZE);
+            self->request_remaining = length - received;
+            if (self->request_remaining) {
+                /* 5.1. Continue */
+                dbus_service_snep_connection_response(self,
+                    SNEP_RESPONSE_CONTINUE);
+            } else {
+                dbus_service_snep_connection_get(self);
+            }
+        }
+    }
+}
+
+static
+void
+dbus_service_snep_connection_finalize(
+    GObject* object)
+{
+    DBusServiceSnepConnection* self = DBUS_SERVICE_SNEP_CONNECTION(object);
+
+    if (self->response_remaining) {
+        g_bytes_unref(self->response_remaining);
+    }
+    G_OBJECT_CLASS(dbus_service_snep_connection_parent_class)->
+        finalize(object);
+}
+
+static
+void
+dbus_service_snep_connection_init(
+    DBusServiceSnepConnection* self)
+{
+}
+
+static
+void
+dbus_service_snep_connection_class_init(
+    DBusServiceSnepConnectionClass* klass)
+{
+    klass->data_received = dbus_service_snep_connection_data_received;
+    G_OBJECT_CLASS(klass)->finalize = dbus_service_snep_connection_finalize;
+}
+
+/*==========================================================================*
+ * Service
+ *==========================================================================*/
+
+static
+NfcPeerConnection*
+dbus_service_snep_new_accept(
+    NfcPeerService* service,
+    guint8 rsap)
+{
+    DBusServiceSnepConnection* conn = g_object_new
+        (DBUS_SERVICE_TYPE_SNEP_CONNECTION, NULL);
+
+    nfc_peer_connection_init_accept(&conn->connection, service, rsap);
+    return &conn->connection;
+}
+
+static
+void
+dbus_service_snep_finalize(
+    GObject* object)
+{
+    DBusServiceSnepObject* self = DBUS_SERVICE_SNEP_OBJECT(object);
+
+    if (self->ndef) {
+        g_bytes_unref(self->ndef);
+    }
+    G_OBJECT_CLASS(dbus_service_snep_object_parent_class)->finalize(object);
+}
+
+static
+void
+dbus_service_snep_object_init(
+    DBusServiceSnepObject* self)
+{
+}
+
+static
+void
+dbus_service_snep_object_class_init(
+    DBusServiceSnepObjectClass* klass)
+{
+    klass->new_accept = dbus_service_snep_new_accept;
+    G_OBJECT_CLASS(klass)->finalize = dbus_service_snep_finalize;
+}
+
+/*==========================================================================*
+ * Interface
+ *==========================================================================*/
+
+DBusServiceSnep*
+dbus_service_snep_new(
+    const char* sn,
+    GBytes* ndef)
+{
+    DBusServiceSnepObject* self = g_object_new
+        (DBUS_SERVICE_TYPE_SNEP_OBJECT, NULL);
+    DBusServiceSnep* snep = &self->pub;
+
+    nfc_peer_service_init_base(&snep->service, sn);
+    dbus_service_snep_set_ndef(snep, ndef);
+    return snep;
+}
+
+void
+dbus_service_snep_set_ndef(
+    DBusServiceSnep* snep,
+    GBytes* ndef)
+{
+    DBusServiceSnepObject* self = DBUS_SERVICE_SNEP_OBJECT(snep);
+
+    /* Connections which are already sending keep the old data */
+    if (ndef) {
+        g_bytes_ref(ndef);
+    }
+    if (self->ndef) {
+        g_bytes_unref(self->ndef);
+    }
+    self->ndef = ndef;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -47,11 +47,13 @@
 
 enum {
     TARGET_SEQUENCE,
+    TARGET_LEASE_EXPIRED,
     TARGET_EVENT_COUNT
 };
 
 enum {
     TAG_INITIALIZED,
+    TAG_GONE,
     TAG_EVENT_COUNT
 };
 
@@ -72,6 +74,7 @@ enum {
     CALL_TRANSCEIVE,
     CALL_ACQUIRE2,
     CALL_RELEASE2,
+    CALL_ACQUIRE_LEASE,
     CALL_COUNT
 };
 
@@ -138,7 +141,8 @@ struct dbus_service_tag_priv {
 };
 
 #define NFC_DBUS_TAG_INTERFACE "org.sailfishos.nfc.Tag"
-#define NFC_DBUS_TAG_INTERFACE_VERSION  (5)
+#define NFC_DBUS_TAG_INTERFACE_VERSION  (7)
+#define NFC_DBUS_TAG_SIGNAL_LOCK_LOST "LockLost"
 
 static const char* const dbus_service_tag_default_interfaces[] = {
     NFC_DBUS_TAG_INTERFACE, NULL
@@ -378,6 +382,57 @@ dbus_service_tag_lock_peer_vanished(
     dbus_service_tag_lock_free(lock);
 }
 
+static
+void
+dbus_service_tag_target_lease_expired(
+    NfcTarget* target,
+    NfcTargetSequence* seq,
+    void* user_data)
+{
+    DBusServiceTagPriv* self = user_data;
+    DBusServiceTagLock* lock = self->lock;
+
+    if (lock && lock->seq == seq && !nfc_target_sequence_renew(seq)) {
+        DBusServiceTag* pub = &self->pub;
+        GError* error = NULL;
+
+        /* Someone else is waiting, take the lock away and let them in */
+        GDEBUG("Lock held by %s has expired", lock->name);
+        if (!g_dbus_connection_emit_signal(pub->connection, lock->name,
+            self->path, NFC_DBUS_TAG_INTERFACE,
+            NFC_DBUS_TAG_SIGNAL_LOCK_LOST, g_variant_new("(u)",
+            nfc_target_sequence_flags(seq)), &error)) {
+            GWARN("%s", GERRMSG(error));
+            g_error_free(error);
+        }
+
+        /*
+         * Freeing the sequence lets the next one become current,
+         * which gets us to dbus_service_tag_target_sequence_changed()
+         */
+        self->lock = NULL;
+        dbus_service_tag_lock_free(lock);
+    }
+}
+
+static
+const char**
+dbus_service_tag_get_ndef_rec_paths(
+    DBusServiceTagPriv* self)
+{
+    const char** paths = g_new(const char*, g_slist_length(self->ndefs) + 1);
+    GSList* l;
+    int n = 0;
+
+    for (l = self->ndefs; l; l = l->next) {
+        paths[n++] = dbus_service_ndef_path((DBusServiceNdef*)(l->data));
+    }
+    paths[n] = NULL;
+    /* Deallocated by the idle pool (actual strings are owned by records) */
+    gutil_idle_pool_add(self->pool, paths, g_free);
+    return paths;
+}
+
 static
 void
 dbus_service_tag_export_all(
@@ -433,6 +488,9 @@ dbus_service_tag_export_all(
     GASSERT(!self->interfaces);
     g_ptr_array_add(interfaces, NULL);
     self->interfaces = (const char**)g_ptr_array_free(interfaces, FALSE);
+    org_sailfishos_nfc_tag_set_interfaces(self->iface, self->interfaces);
+    org_sailfishos_nfc_tag_set_ndef_records(self->iface,
+        dbus_service_tag_get_ndef_rec_paths(self));
 }
 
 static
@@ -443,24 +501,6 @@ dbus_service_tag_free_ndef_rec(
     dbus_service_ndef_free((DBusServiceNdef*)rec);
 }
 
-static
-const char**
-dbus_service_tag_get_ndef_rec_paths(
-    DBusServiceTagPriv* self)
-{
-    const char** paths = g_new(const char*, g_slist_length(self->ndefs) + 1);
-    GSList* l;
-    int n = 0;
-
-    for (l = self->ndefs; l; l = l->next) {
-        paths[n++] = dbus_service_ndef_path((DBusServiceNdef*)(l->data));
-    }
-    paths[n] = NULL;
-    /* Deallocated by the idle pool (actual strings are owned by records) */
-    gutil_idle_pool_add(self->pool, paths, g_free);
-    return paths;
-}
-
 static
 void
 dbus_service_tag_free_call(
@@ -540,6 +580,8 @@ dbus_service_tag_acquire(
     GDBusMethodInvocation* call,
     gboolean wait,
     NFC_SEQUENCE_FLAGS flags,
+    guint lease_idle_ms,
+    guint lease_hold_ms,
     DBusServiceTagCallCompleteFunc complete)
 {
     DBusServiceTag* pub = &self->pub;
@@ -547,7 +589,11 @@ dbus_service_tag_acquire(
     DBusServiceTagLock* current_lock = self->lock;
     const char* name = g_dbus_method_invocation_get_sender(call);
 
-    if (dbus_service_tag_lock_matches(current_lock, name, flags)) {
+    if (dbus_service_reject_private_call(call) ||
+        !dbus_service_access_allowed(call, DBUS_SERVICE_ACTION_ACQUIRE)) {
+        /* Locks are tied to unique bus names */
+        return;
+    } else if (dbus_service_tag_lock_matches(current_lock, name, flags)) {
         /* This client already has the lock */
         current_lock->count++;
         GDEBUG("Lock request from %s flags 0x%02x (%u)", name, flags,
@@ -574,6 +620,12 @@ dbus_service_tag_acquire(
             lock->name = g_strdup(name);
             lock->seq = nfc_target_sequence_new2(target, flags);
             lock->tag = self;
+            if (lease_idle_ms || lease_hold_ms) {
+                /* Only AcquireLease sets the lease, other locks are held
+                 * for as long as the client wants */
+                nfc_target_sequence_set_lease(lock->seq, lease_idle_ms,
+                    lease_hold_ms);
+            }
             lock->watch_id = g_bus_watch_name_on_connection(pub->connection,
                 name, G_BUS_NAME_WATCHER_FLAGS_NONE, NULL,
                 dbus_service_tag_lock_peer_vanished, lock, NULL);
@@ -612,7 +664,9 @@ dbus_service_tag_release(
     DBusServiceTagLock* current_lock = self->lock;
     const char* name = g_dbus_method_invocation_get_sender(call);
 
-    if (dbus_service_tag_lock_matches(current_lock, name, flags)) {
+    if (dbus_service_reject_private_call(call)) {
+        return;
+    } else if (dbus_service_tag_lock_matches(current_lock, name, flags)) {
         /* Client has the lock */
         GDEBUG("%s released the lock", name);
         complete(self->iface, call);
@@ -665,9 +719,23 @@ dbus_service_tag_initialized(
     DBusServiceTagPriv* self = user_data;
 
     dbus_service_tag_export_all(self);
+    dbus_service_events_post(self->pub.connection,
+        DBUS_SERVICE_EVENT_TAG_INITIALIZED, self->path,
+        g_slist_length(self->ndefs));
     dbus_service_tag_complete_pending_calls(self);
 }
 
+static
+void
+dbus_service_tag_gone(
+    NfcTag* tag,
+    void* user_data)
+{
+    DBusServiceTagPriv* self = user_data;
+
+    org_sailfishos_nfc_tag_set_present(self->iface, tag->present);
+}
+
 /*==========================================================================*
  * D-Bus calls
  *==========================================================================*/
@@ -846,7 +914,7 @@ dbus_service_tag_handle_acquire(
     DBusServiceTagPriv* self)
 {
     dbus_service_tag_acquire(self, call, wait, NFC_SEQUENCE_FLAGS_NONE,
-        org_sailfishos_nfc_tag_complete_acquire);
+        0, 0, org_sailfishos_nfc_tag_complete_acquire);
     return TRUE;
 }
 
@@ -969,8 +1037,12 @@ dbus_service_tag_handle_transceive(
     DBusServiceTag* self)
 {
     NfcTag* tag = self->tag;
-    DBusServiceTagAsyncCall* async = g_slice_new(DBusServiceTagAsyncCall);
+    DBusServiceTagAsyncCall* async;
 
+    if (!dbus_service_access_allowed(call, DBUS_SERVICE_ACTION_TRANSCEIVE)) {
+        return TRUE;
+    }
+    async = g_slice_new(DBusServiceTagAsyncCall);
     g_object_ref(async->iface = iface);
     g_object_ref(async->call = call);
     if (!nfc_target_transmit(tag->target,
@@ -999,7 +1071,7 @@ dbus_service_tag_handle_acquire2(
     DBusServiceTagPriv* self)
 {
     dbus_service_tag_acquire(self, call, wait,
-        NFC_SEQUENCE_FLAG_ALLOW_PRESENCE_CHECK,
+        NFC_SEQUENCE_FLAG_ALLOW_PRESENCE_CHECK, 0, 0,
         org_sailfishos_nfc_tag_complete_acquire2);
     return TRUE;
 }
@@ -1019,6 +1091,39 @@ dbus_service_tag_handle_release2(
     return TRUE;
 }
 
+/* Interface Version 7 */
+
+/* AcquireLease */
+
+static
+gboolean
+dbus_service_tag_handle_acquire_lease(
+    OrgSailfishosNfcTag* iface,
+    GDBusMethodInvocation* call,
+    gboolean wait,
+    gboolean allow_presence_check,
+    guint max_idle_ms,
+    guint max_hold_ms,
+    DBusServiceTagPriv* self)
+{
+    /*
+     * The reply is as empty as the one to Acquire(2), completing it
+     * the same way keeps the waiters for the same lock interchangeable.
+     * The lock is released with Release or Release2, depending on
+     * allow_presence_check.
+     */
+    if (allow_presence_check) {
+        dbus_service_tag_acquire(self, call, wait,
+            NFC_SEQUENCE_FLAG_ALLOW_PRESENCE_CHECK, max_idle_ms,
+            max_hold_ms, org_sailfishos_nfc_tag_complete_acquire2);
+    } else {
+        dbus_service_tag_acquire(self, call, wait, NFC_SEQUENCE_FLAGS_NONE,
+            max_idle_ms, max_hold_ms,
+            org_sailfishos_nfc_tag_complete_acquire);
+    }
+    return TRUE;
+}
+
 /*==========================================================================*
  * Interface
  *==========================================================================*/
@@ -1082,6 +1187,20 @@ dbus_service_tag_new(
     self->target_event_id[TARGET_SEQUENCE] =
         nfc_target_add_sequence_handler(tag->target,
             dbus_service_tag_target_sequence_changed, self);
+    self->target_event_id[TARGET_LEASE_EXPIRED] =
+        nfc_target_add_lease_expired_handler(tag->target,
+            dbus_service_tag_target_lease_expired, self);
+
+    /* Properties which don't depend on initialization */
+    org_sailfishos_nfc_tag_set_present(self->iface, tag->present);
+    org_sailfishos_nfc_tag_set_technology(self->iface,
+        tag->target->technology);
+    org_sailfishos_nfc_tag_set_protocol(self->iface, tag->target->protocol);
+    org_sailfishos_nfc_tag_set_tag_type(self->iface, tag->type);
+    org_sailfishos_nfc_tag_set_poll_parameters(self->iface,
+        dbus_service_tag_get_poll_parameters(tag, nfc_tag_param(tag)));
+    self->tag_event_id[TAG_GONE] =
+        nfc_tag_add_gone_handler(tag, dbus_service_tag_gone, self);
 
     /* D-Bus calls */
     self->call_id[CALL_GET_ALL] =
@@ -1132,6 +1251,9 @@ dbus_service_tag_new(
     self->call_id[CALL_RELEASE2] =
         g_signal_connect(self->iface, "handle-release2",
         G_CALLBACK(dbus_service_tag_handle_release2), self);
+    self->call_id[CALL_ACQUIRE_LEASE] =
+        g_signal_connect(self->iface, "handle-acquire-lease",
+        G_CALLBACK(dbus_service_tag_handle_acquire_lease), self);
 
     if (tag->flags & NFC_TAG_FLAG_INITIALIZED) {
         dbus_service_tag_export_all(self);
@@ -1141,8 +1263,8 @@ dbus_service_tag_new(
             nfc_tag_add_initialized_handler(tag,
                 dbus_service_tag_initialized, self);
     }
-    if (g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON
-        (self->iface), connection, self->path, &error)) {
+    if (dbus_service_export(G_DBUS_INTERFACE_SKELETON(self->iface),
+        connection, self->path, &error)) {
         GDEBUG("Created D-Bus object %s", self->path);
         return pub;
     } else {
@@ -1162,8 +1284,8 @@ dbus_service_tag_free(
 
         GDEBUG("Removing D-Bus object %s", self->path);
         org_sailfishos_nfc_tag_emit_removed(self->iface);
-        g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON
-            (self->iface));
+        dbus_service_unexport(G_DBUS_INTERFACE_SKELETON(self->iface),
+            self->pub.connection);
         dbus_service_tag_free_unexported(self);
     }
 }
@@ -50,6 +50,7 @@ enum {
     CALL_READ_DATA,
     CALL_READ_ALL_DATA,
     CALL_WRITE_DATA,
+    CALL_WRITE_DATA2,
     CALL_COUNT
 };
 
@@ -68,13 +69,21 @@ struct dbus_service_tag_t2 {
     GVariant* serial;
 };
 
-#define NFC_DBUS_TAG_T2_INTERFACE_VERSION  (1)
+#define NFC_DBUS_TAG_T2_INTERFACE_VERSION  (3)
 
 typedef struct dbus_service_tag_t2_async_call {
     OrgSailfishosNfcTagType2* iface;
     GDBusMethodInvocation* call;
+    guint size;
 } DBusServiceTagType2AsyncCall;
 
+/* WriteData2 status */
+typedef enum dbus_service_tag_t2_write_status {
+    DBUS_SERVICE_TAG_T2_WRITE_OK,
+    DBUS_SERVICE_TAG_T2_WRITE_IO_ERROR,
+    DBUS_SERVICE_TAG_T2_WRITE_VERIFY_FAILED
+} DBUS_SERVICE_TAG_T2_WRITE_STATUS;
+
 /* g_variant_get_data_as_bytes() function appeared in glib 2.36 */
 #define g_variant_get_data_as_bytes(data) \
     g_bytes_new_with_free_func(g_variant_get_data(data), \
@@ -110,6 +119,17 @@ dbus_service_tag_t2_get_serial(
     return  self->serial;
 }
 
+static
+void
+dbus_service_tag_t2_update_cache_size(
+    OrgSailfishosNfcTagType2* iface,
+    NfcTagType2* t2)
+{
+    /* Only emits PropertiesChanged if the value has actually changed */
+    org_sailfishos_nfc_tag_type2_set_cache_size(iface,
+        nfc_tag_t2_cache_size(t2));
+}
+
 static
 NfcTargetSequence*
 dbus_service_tag_t2_sequence(
@@ -130,7 +150,7 @@ dbus_service_tag_t2_async_call_new(
     GDBusMethodInvocation* call)
 {
     DBusServiceTagType2AsyncCall* async =
-        g_slice_new(DBusServiceTagType2AsyncCall);
+        g_slice_new0(DBusServiceTagType2AsyncCall);
 
     g_object_ref(async->iface = iface);
     g_object_ref(async->call = call);
@@ -246,6 +266,7 @@ dbus_service_tag_t2_handle_read_done(
 {
     DBusServiceTagType2AsyncCall* read = user_data;
 
+    dbus_service_tag_t2_update_cache_size(read->iface, tag);
     if (status == NFC_TRANSMIT_STATUS_OK) {
         org_sailfishos_nfc_tag_type2_complete_read(read->iface,
             read->call, dbus_service_dup_byte_array_as_variant(data, len));
@@ -297,6 +318,7 @@ dbus_service_tag_t2_handle_write_done(
 {
     DBusServiceTagType2AsyncCall* write = user_data;
 
+    dbus_service_tag_t2_update_cache_size(write->iface, tag);
     if (written > 0 || status == NFC_TRANSMIT_STATUS_OK) {
         org_sailfishos_nfc_tag_type2_complete_write(write->iface,
             write->call, written);
@@ -321,7 +343,8 @@ dbus_service_tag_t2_handle_write(
         g_dbus_method_invocation_return_error_literal(call,
             DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_NOT_SUPPORTED,
             "Only sector 0 is supported");
-    } else {
+    } else if (dbus_service_access_allowed(call,
+        DBUS_SERVICE_ACTION_WRITE)) {
         GBytes* bytes = g_variant_get_data_as_bytes(data);
         DBusServiceTagType2AsyncCall* write =
             dbus_service_tag_t2_async_call_new(iface, call);
@@ -353,6 +376,7 @@ dbus_service_tag_t2_handle_read_data_done(
 {
     DBusServiceTagType2AsyncCall* read = user_data;
 
+    dbus_service_tag_t2_update_cache_size(read->iface, t2);
     if (status == NFC_TAG_T2_IO_STATUS_OK) {
         org_sailfishos_nfc_tag_type2_complete_read_data(read->iface,
             read->call, dbus_service_dup_byte_array_as_variant(data, len));
@@ -411,6 +435,7 @@ dbus_service_tag_t2_handle_read_all_data_done(
 {
     DBusServiceTagType2AsyncCall* read = user_data;
 
+    dbus_service_tag_t2_update_cache_size(read->iface, t2);
     if (status == NFC_TAG_T2_IO_STATUS_OK) {
         org_sailfishos_nfc_tag_type2_complete_read_all_data(read->iface,
             read->call, dbus_service_dup_byte_array_as_variant(data, len));
@@ -456,6 +481,7 @@ dbus_service_tag_t2_handle_write_data_done(
 {
     DBusServiceTagType2AsyncCall* write = user_data;
 
+    dbus_service_tag_t2_update_cache_size(write->iface, tag);
     if (written > 0 || status == NFC_TAG_T2_IO_STATUS_OK) {
         org_sailfishos_nfc_tag_type2_complete_write_data(write->iface,
             write->call, written);
@@ -475,10 +501,14 @@ dbus_service_tag_t2_handle_write_data(
     GVariant* data,
     DBusServiceTagType2* self)
 {
-    GBytes* bytes = g_variant_get_data_as_bytes(data);
-    DBusServiceTagType2AsyncCall* write =
-        dbus_service_tag_t2_async_call_new(iface, call);
+    GBytes* bytes;
+    DBusServiceTagType2AsyncCall* write;
 
+    if (!dbus_service_access_allowed(call, DBUS_SERVICE_ACTION_WRITE)) {
+        return TRUE;
+    }
+    bytes = g_variant_get_data_as_bytes(data);
+    write = dbus_service_tag_t2_async_call_new(iface, call);
     if (!nfc_tag_t2_write_data_seq(self->t2, offset, bytes,
         dbus_service_tag_t2_sequence(self, call),
         dbus_service_tag_t2_handle_write_data_done,
@@ -492,6 +522,71 @@ dbus_service_tag_t2_handle_write_data(
     return TRUE;
 }
 
+/* WriteData2 */
+
+static
+void
+dbus_service_tag_t2_handle_write_data2_done(
+    NfcTagType2* tag,
+    NFC_TAG_T2_IO_STATUS status,
+    guint written,
+    void* user_data)
+{
+    DBusServiceTagType2AsyncCall* write = user_data;
+
+    dbus_service_tag_t2_update_cache_size(write->iface, tag);
+    if (status == NFC_TAG_T2_IO_STATUS_VERIFY_FAILED) {
+        /* Verification starts after everything has been written */
+        GDEBUG("Verified %u byte(s) out of %u", written, write->size);
+        org_sailfishos_nfc_tag_type2_complete_write_data2(write->iface,
+            write->call, write->size,
+            DBUS_SERVICE_TAG_T2_WRITE_VERIFY_FAILED);
+    } else if (status == NFC_TAG_T2_IO_STATUS_OK) {
+        org_sailfishos_nfc_tag_type2_complete_write_data2(write->iface,
+            write->call, written, DBUS_SERVICE_TAG_T2_WRITE_OK);
+    } else if (written > 0) {
+        org_sailfishos_nfc_tag_type2_complete_write_data2(write->iface,
+            write->call, written, DBUS_SERVICE_TAG_T2_WRITE_IO_ERROR);
+    } else {
+        g_dbus_method_invocation_return_error_literal(write->call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_FAILED,
+            "Write failed");
+    }
+}
+
+static
+gboolean
+dbus_service_tag_t2_handle_write_data2(
+    OrgSailfishosNfcTagType2* iface,
+    GDBusMethodInvocation* call,
+    guint offset,
+    GVariant* data,
+    guint flags,
+    DBusServiceTagType2* self)
+{
+    GBytes* bytes;
+    DBusServiceTagType2AsyncCall* write;
+
+    if (!dbus_service_access_allowed(call, DBUS_SERVICE_ACTION_WRITE)) {
+        return TRUE;
+    }
+    bytes = g_variant_get_data_as_bytes(data);
+    write = dbus_service_tag_t2_async_call_new(iface, call);
+    write->size = g_bytes_get_size(bytes);
+    if (!nfc_tag_t2_write_data_seq2(self->t2, offset, bytes,
+        dbus_service_tag_t2_sequence(self, call), (NFC_TAG_T2_WRITE_FLAGS)
+        (flags & NFC_TAG_T2_WRITE_FLAG_VERIFY),
+        dbus_service_tag_t2_handle_write_data2_done,
+        dbus_service_tag_t2_async_call_free, write)) {
+        dbus_service_tag_t2_async_call_free1(write);
+        g_dbus_method_invocation_return_error_literal(call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_FAILED,
+            "Write failed");
+    }
+    g_bytes_unref(bytes);
+    return TRUE;
+}
+
 /*==========================================================================*
  * Interface
  *==========================================================================*/
@@ -555,9 +650,15 @@ dbus_service_tag_t2_new(
     self->call_id[CALL_WRITE_DATA] =
         g_signal_connect(self->iface, "handle-write-data",
         G_CALLBACK(dbus_service_tag_t2_handle_write_data), self);
+    self->call_id[CALL_WRITE_DATA2] =
+        g_signal_connect(self->iface, "handle-write-data2",
+        G_CALLBACK(dbus_service_tag_t2_handle_write_data2), self);
+
+    /* Properties */
+    dbus_service_tag_t2_update_cache_size(self->iface, t2);
 
-    if (g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON
-        (self->iface), owner->connection, owner->path, &error)) {
+    if (dbus_service_export(G_DBUS_INTERFACE_SKELETON(self->iface),
+        owner->connection, owner->path, &error)) {
         GDEBUG("Created D-Bus object %s (Type2)", owner->path);
         return self;
     } else {
@@ -574,8 +675,8 @@ dbus_service_tag_t2_free(
 {
     if (self) {
         GDEBUG("Removing D-Bus object %s (Type2)", self->owner->path);
-        g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON
-            (self->iface));
+        dbus_service_unexport(G_DBUS_INTERFACE_SKELETON(self->iface),
+            self->owner->connection);
         dbus_service_tag_t2_free_unexported(self);
     }
 }
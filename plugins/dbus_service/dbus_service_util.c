@@ -31,7 +31,57 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "dbus_service.h"
 #include "dbus_service_util.h"
+#include "dbus_service/org.freedesktop.DBus.ObjectManager.h"
+
+#ifdef HAVE_DBUSACCESS
+#include "common/access_cache.h"
+
+static const DA_ACTION dbus_service_policy_actions[] = {
+    { "RequestMode", DBUS_SERVICE_ACTION_REQUEST_MODE, 0 },
+    { "RegisterLocalService", DBUS_SERVICE_ACTION_REGISTER_LOCAL_SERVICE, 0 },
+    { "OpenPrivateConnection",
+       DBUS_SERVICE_ACTION_OPEN_PRIVATE_CONNECTION, 0 },
+    { "Acquire", DBUS_SERVICE_ACTION_ACQUIRE, 0 },
+    { "Transceive", DBUS_SERVICE_ACTION_TRANSCEIVE, 0 },
+    { "Transmit", DBUS_SERVICE_ACTION_TRANSMIT, 0 },
+    { "Write", DBUS_SERVICE_ACTION_WRITE, 0 },
+    { "Connect", DBUS_SERVICE_ACTION_CONNECT, 0 },
+    { "SubscribeEvents", DBUS_SERVICE_ACTION_SUBSCRIBE_EVENTS, 0 },
+    { NULL }
+};
+
+/* Everything is allowed by default */
+static const char dbus_service_default_policy[] =
+    DA_POLICY_VERSION ";group(privileged)=allow";
+
+#define DBUS_SERVICE_DA_BUS DA_BUS_SYSTEM
+#define DBUS_SERVICE_DEFAULT_ACCESS DA_ACCESS_ALLOW
+#define DBUS_SERVICE_ACCESS_KEY "dbus-service-access"
+#define DBUS_SERVICE_PEER_CRED_KEY "dbus-service-peer-cred"
+
+typedef struct dbus_service_peer_cred {
+    DACred cred;
+    gid_t* groups;
+} DBusServicePeerCred;
+
+#endif /* HAVE_DBUSACCESS */
+
+typedef struct dbus_service_exports {
+    GDBusConnection* bus;  /* Not referenced, owns the exports */
+    GSList* skeletons;  /* Not referenced */
+    GSList* peers;      /* Referenced GDBusConnection */
+    OrgFreedesktopDBusObjectManager* manager;
+    gulong get_managed_objects_id;
+} DBusServiceExports;
+
+static GQuark dbus_service_exports_quark;
+static GQuark dbus_service_private_quark;
+
+#define DBUS_SERVICE_EXPORTS_KEY "dbus-service-exports"
+#define DBUS_SERVICE_PRIVATE_KEY "dbus-service-private"
+#define DBUS_SERVICE_ROOT_PATH "/"
 
 static
 void
@@ -93,6 +143,607 @@ dbus_service_dict_add_byte_array_data(
         dbus_service_dup_byte_array_data_as_variant(data));
 }
 
+/*==========================================================================*
+ * Exports
+ *==========================================================================*/
+
+static
+gboolean
+dbus_service_exports_managed(
+    DBusServiceExports* exports,
+    const char* path)
+{
+    /* The object manager and everything else at the root isn't managed */
+    return exports->manager && strcmp(path, DBUS_SERVICE_ROOT_PATH);
+}
+
+static
+void
+dbus_service_exports_add_properties(
+    GVariantBuilder* builder,
+    GDBusInterfaceSkeleton* iface)
+{
+    GVariant* props = g_dbus_interface_skeleton_get_properties(iface);
+
+    g_variant_builder_add(builder, "{s@a{sv}}",
+        g_dbus_interface_skeleton_get_info(iface)->name, props);
+    g_variant_unref(props);
+}
+
+static
+void
+dbus_service_exports_interface_added(
+    DBusServiceExports* exports,
+    GDBusInterfaceSkeleton* iface,
+    const char* path)
+{
+    GVariantBuilder builder;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sa{sv}}"));
+    dbus_service_exports_add_properties(&builder, iface);
+    org_freedesktop_dbus_object_manager_emit_interfaces_added(exports->manager,
+        path, g_variant_builder_end(&builder));
+}
+
+static
+void
+dbus_service_exports_interface_removed(
+    DBusServiceExports* exports,
+    GDBusInterfaceSkeleton* iface,
+    const char* path)
+{
+    const char* names[2];
+
+    names[0] = g_dbus_interface_skeleton_get_info(iface)->name;
+    names[1] = NULL;
+    org_freedesktop_dbus_object_manager_emit_interfaces_removed
+        (exports->manager, path, names);
+}
+
+static
+void
+dbus_service_exports_drop_peer(
+    DBusServiceExports* exports,
+    GDBusConnection* peer)
+{
+    GSList* l;
+
+    exports->peers = g_slist_remove(exports->peers, peer);
+    g_signal_handlers_disconnect_by_data(peer, exports);
+    for (l = exports->skeletons; l; l = l->next) {
+        g_dbus_interface_skeleton_unexport_from_connection
+            (G_DBUS_INTERFACE_SKELETON(l->data), peer);
+    }
+    g_object_set_qdata(G_OBJECT(peer), dbus_service_private_quark, NULL);
+    g_object_unref(peer);
+}
+
+static
+void
+dbus_service_exports_peer_closed(
+    GDBusConnection* peer,
+    gboolean remote_peer_vanished,
+    GError* error,
+    gpointer exports)
+{
+    GDEBUG("Private connection %p closed", peer);
+    dbus_service_exports_drop_peer(exports, peer);
+}
+
+static
+void
+dbus_service_exports_close_peers(
+    DBusServiceExports* exports)
+{
+    while (exports->peers) {
+        GDBusConnection* peer = exports->peers->data;
+
+        g_object_ref(peer);
+        dbus_service_exports_drop_peer(exports, peer);
+        g_dbus_connection_close(peer, NULL, NULL, NULL);
+        g_object_unref(peer);
+    }
+}
+
+static
+void
+dbus_service_exports_free(
+    gpointer data)
+{
+    DBusServiceExports* exports = data;
+
+    dbus_service_exports_close_peers(exports);
+    if (exports->manager) {
+        g_signal_handler_disconnect(exports->manager,
+            exports->get_managed_objects_id);
+        g_object_unref(exports->manager);
+    }
+    g_slist_free(exports->skeletons);
+    g_slice_free(DBusServiceExports, exports);
+}
+
+static
+DBusServiceExports*
+dbus_service_exports(
+    GDBusConnection* bus,
+    gboolean create)
+{
+    DBusServiceExports* exports;
+
+    if (!dbus_service_exports_quark) {
+        dbus_service_exports_quark =
+            g_quark_from_static_string(DBUS_SERVICE_EXPORTS_KEY);
+        dbus_service_private_quark =
+            g_quark_from_static_string(DBUS_SERVICE_PRIVATE_KEY);
+    }
+    exports = g_object_get_qdata(G_OBJECT(bus), dbus_service_exports_quark);
+    if (!exports && create) {
+        exports = g_slice_new0(DBusServiceExports);
+        exports->bus = bus;
+        g_object_set_qdata_full(G_OBJECT(bus), dbus_service_exports_quark,
+            exports, dbus_service_exports_free);
+    }
+    return exports;
+}
+
+gboolean
+dbus_service_export(
+    GDBusInterfaceSkeleton* iface,
+    GDBusConnection* bus,
+    const char* path,
+    GError** error)
+{
+    if (g_dbus_interface_skeleton_export(iface, bus, path, error)) {
+        DBusServiceExports* exports = dbus_service_exports(bus, TRUE);
+        GSList* l;
+
+        exports->skeletons = g_slist_prepend(exports->skeletons, iface);
+        for (l = exports->peers; l; l = l->next) {
+            GError* err = NULL;
+
+            if (!g_dbus_interface_skeleton_export(iface, l->data, path,
+                &err)) {
+                GWARN("%s: %s", path, GERRMSG(err));
+                g_error_free(err);
+            }
+        }
+        if (dbus_service_exports_managed(exports, path)) {
+            dbus_service_exports_interface_added(exports, iface, path);
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
+void
+dbus_service_unexport(
+    GDBusInterfaceSkeleton* iface,
+    GDBusConnection* bus)
+{
+    DBusServiceExports* exports = dbus_service_exports(bus, FALSE);
+
+    if (exports) {
+        GSList* l = g_slist_find(exports->skeletons, iface);
+
+        if (l) {
+            const char* path =
+                g_dbus_interface_skeleton_get_object_path(iface);
+
+            exports->skeletons = g_slist_delete_link(exports->skeletons, l);
+            if (dbus_service_exports_managed(exports, path)) {
+                dbus_service_exports_interface_removed(exports, iface, path);
+            }
+        }
+    }
+    /* This unexports the interface from all connections */
+    g_dbus_interface_skeleton_unexport(iface);
+}
+
+void
+dbus_service_add_private_connection(
+    GDBusConnection* bus,
+    GDBusConnection* peer)
+{
+    DBusServiceExports* exports = dbus_service_exports(bus, TRUE);
+    GSList* l;
+
+    exports->peers = g_slist_append(exports->peers, g_object_ref(peer));
+    g_object_set_qdata(G_OBJECT(peer), dbus_service_private_quark, exports);
+    g_signal_connect(peer, "closed",
+        G_CALLBACK(dbus_service_exports_peer_closed), exports);
+    for (l = exports->skeletons; l; l = l->next) {
+        GDBusInterfaceSkeleton* iface = G_DBUS_INTERFACE_SKELETON(l->data);
+        const char* path = g_dbus_interface_skeleton_get_object_path(iface);
+        GError* error = NULL;
+
+        if (!g_dbus_interface_skeleton_export(iface, peer, path, &error)) {
+            GWARN("%s: %s", path, GERRMSG(error));
+            g_error_free(error);
+        }
+    }
+}
+
+void
+dbus_service_close_private_connections(
+    GDBusConnection* bus)
+{
+    DBusServiceExports* exports = dbus_service_exports(bus, FALSE);
+
+    if (exports) {
+        dbus_service_exports_close_peers(exports);
+    }
+}
+
+gboolean
+dbus_service_private_call(
+    GDBusMethodInvocation* call)
+{
+    return dbus_service_private_quark && g_object_get_qdata(G_OBJECT
+        (g_dbus_method_invocation_get_connection(call)),
+        dbus_service_private_quark);
+}
+
+gboolean
+dbus_service_reject_private_call(
+    GDBusMethodInvocation* call)
+{
+    if (dbus_service_private_call(call)) {
+        /* These calls need the caller to have a unique bus name */
+        g_dbus_method_invocation_return_error_literal(call,
+            DBUS_SERVICE_ERROR, DBUS_SERVICE_ERROR_NOT_SUPPORTED,
+            "Not available over private connection");
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/*==========================================================================*
+ * Object manager
+ *==========================================================================*/
+
+static
+void
+dbus_service_exports_free_builder(
+    gpointer builder)
+{
+    g_variant_builder_unref(builder);
+}
+
+static
+gboolean
+dbus_service_exports_handle_get_managed_objects(
+    OrgFreedesktopDBusObjectManager* manager,
+    GDBusMethodInvocation* call,
+    DBusServiceExports* exports)
+{
+    GHashTable* objects = g_hash_table_new_full(g_str_hash, g_str_equal,
+        NULL, dbus_service_exports_free_builder);
+    GVariantBuilder builder;
+    GHashTableIter it;
+    gpointer key, value;
+    GSList* l;
+
+    /* Group interfaces by object path */
+    for (l = exports->skeletons; l; l = l->next) {
+        GDBusInterfaceSkeleton* iface = G_DBUS_INTERFACE_SKELETON(l->data);
+        const char* path = g_dbus_interface_skeleton_get_object_path(iface);
+
+        if (dbus_service_exports_managed(exports, path)) {
+            GVariantBuilder* ifaces = g_hash_table_lookup(objects, path);
+
+            if (!ifaces) {
+                ifaces = g_variant_builder_new(G_VARIANT_TYPE("a{sa{sv}}"));
+                g_hash_table_insert(objects, (gpointer)path, ifaces);
+            }
+            dbus_service_exports_add_properties(ifaces, iface);
+        }
+    }
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{oa{sa{sv}}}"));
+    g_hash_table_iter_init(&it, objects);
+    while (g_hash_table_iter_next(&it, &key, &value)) {
+        g_variant_builder_add(&builder, "{o@a{sa{sv}}}", key,
+            g_variant_builder_end(value));
+    }
+    g_hash_table_destroy(objects);
+    org_freedesktop_dbus_object_manager_complete_get_managed_objects(manager,
+        call, g_variant_builder_end(&builder));
+    return TRUE;
+}
+
+gboolean
+dbus_service_export_object_manager(
+    GDBusConnection* bus,
+    GError** error)
+{
+    DBusServiceExports* exports = dbus_service_exports(bus, TRUE);
+    OrgFreedesktopDBusObjectManager* manager;
+
+    if (exports->manager) {
+        return TRUE;
+    }
+
+    manager = org_freedesktop_dbus_object_manager_skeleton_new();
+    if (dbus_service_export(G_DBUS_INTERFACE_SKELETON(manager), bus,
+        DBUS_SERVICE_ROOT_PATH, error)) {
+        exports->manager = manager;
+        exports->get_managed_objects_id = g_signal_connect(manager,
+            "handle-get-managed-objects",
+            G_CALLBACK(dbus_service_exports_handle_get_managed_objects),
+            exports);
+        return TRUE;
+    }
+    g_object_unref(manager);
+    return FALSE;
+}
+
+void
+dbus_service_unexport_object_manager(
+    GDBusConnection* bus)
+{
+    DBusServiceExports* exports = dbus_service_exports(bus, FALSE);
+
+    if (exports && exports->manager) {
+        OrgFreedesktopDBusObjectManager* manager = exports->manager;
+
+        exports->manager = NULL;
+        g_signal_handler_disconnect(manager, exports->get_managed_objects_id);
+        exports->get_managed_objects_id = 0;
+        dbus_service_unexport(G_DBUS_INTERFACE_SKELETON(manager), bus);
+        g_object_unref(manager);
+    }
+}
+
+/*==========================================================================*
+ * Access control
+ *==========================================================================*/
+
+#ifdef HAVE_DBUSACCESS
+
+void
+dbus_service_access_attach(
+    GDBusConnection* bus,
+    const char* spec)
+{
+    AccessCache* cache = access_cache_new(DBUS_SERVICE_DA_BUS,
+        spec ? spec : dbus_service_default_policy,
+        dbus_service_policy_actions);
+
+    /* The cache holds a reference to the bus, hence no destroy notify */
+    access_cache_set_connection(cache, bus);
+    access_cache_free(g_object_steal_data(G_OBJECT(bus),
+        DBUS_SERVICE_ACCESS_KEY));
+    g_object_set_data(G_OBJECT(bus), DBUS_SERVICE_ACCESS_KEY, cache);
+}
+
+void
+dbus_service_access_detach(
+    GDBusConnection* bus)
+{
+    access_cache_free(g_object_steal_data(G_OBJECT(bus),
+        DBUS_SERVICE_ACCESS_KEY));
+}
+
+gboolean
+dbus_service_access_set_policy(
+    GDBusConnection* bus,
+    const char* spec)
+{
+    DAPolicy* policy = da_policy_new_full(spec ? spec :
+        dbus_service_default_policy, dbus_service_policy_actions);
+
+    if (policy) {
+        /* This drops all cached decisions */
+        if (bus) {
+            access_cache_set_policy(g_object_get_data(G_OBJECT(bus),
+                DBUS_SERVICE_ACCESS_KEY), policy);
+        }
+        da_policy_unref(policy);
+        return TRUE;
+    } else {
+        GWARN("Invalid access policy %s", spec);
+        return FALSE;
+    }
+}
+
+static
+guint64
+dbus_service_access_proc_value(
+    const char* line,
+    guint index,
+    guint base,
+    gboolean* ok)
+{
+    /* Picks the index-th field from "Name:\tfield0\tfield1..." */
+    char** fields = g_strsplit_set(strchr(line, ':') + 1, " \t", -1);
+    char** ptr;
+    guint64 value = 0;
+    guint i = 0;
+
+    *ok = FALSE;
+    for (ptr = fields; *ptr; ptr++) {
+        if (**ptr) {
+            if (i++ == index) {
+                char* end = NULL;
+
+                value = g_ascii_strtoull(*ptr, &end, base);
+                *ok = (end && !*end);
+                break;
+            }
+        }
+    }
+    g_strfreev(fields);
+    return value;
+}
+
+static
+gid_t*
+dbus_service_access_proc_groups(
+    const char* line,
+    guint* count)
+{
+    char** fields = g_strsplit_set(strchr(line, ':') + 1, " \t", -1);
+    gid_t* groups = g_new(gid_t, g_strv_length(fields) + 1);
+    char** ptr;
+    guint n = 0;
+
+    for (ptr = fields; *ptr; ptr++) {
+        if (**ptr) {
+            char* end = NULL;
+            const guint64 gid = g_ascii_strtoull(*ptr, &end, 10);
+
+            if (end && !*end) {
+                groups[n++] = (gid_t)gid;
+            }
+        }
+    }
+    g_strfreev(fields);
+    *count = n;
+    return groups;
+}
+
+static
+void
+dbus_service_access_peer_cred_free(
+    gpointer data)
+{
+    DBusServicePeerCred* peer = data;
+
+    g_free(peer->groups);
+    g_slice_free(DBusServicePeerCred, peer);
+}
+
+static
+DBusServicePeerCred*
+dbus_service_access_peer_cred_new(
+    GCredentials* credentials)
+{
+    DBusServicePeerCred* peer = NULL;
+    GError* error = NULL;
+    const uid_t uid = g_credentials_get_unix_user(credentials, &error);
+    const pid_t pid = (uid == (uid_t)-1) ? -1 :
+        g_credentials_get_unix_pid(credentials, &error);
+
+    if (pid > 0) {
+        /*
+         * The rest of the credentials come from the same place where
+         * libdbusaccess gets them for the bus peers. The effective uid
+         * must match the one which has been authenticated.
+         */
+        char* fname = g_strdup_printf("/proc/%d/status", (int)pid);
+        char* status = NULL;
+
+        if (g_file_get_contents(fname, &status, NULL, NULL)) {
+            char** lines = g_strsplit(status, "\n", -1);
+            char** ptr;
+            gboolean uid_ok = FALSE, gid_ok = FALSE, caps_ok = FALSE;
+            guint64 euid = (guint64)-1, egid = 0, caps = 0;
+            gid_t* groups = NULL;
+            guint ngroups = 0;
+
+            for (ptr = lines; *ptr; ptr++) {
+                const char* line = *ptr;
+
+                if (g_str_has_prefix(line, "Uid:")) {
+                    euid = dbus_service_access_proc_value(line, 1, 10,
+                        &uid_ok);
+                } else if (g_str_has_prefix(line, "Gid:")) {
+                    egid = dbus_service_access_proc_value(line, 1, 10,
+                        &gid_ok);
+                } else if (g_str_has_prefix(line, "CapEff:")) {
+                    caps = dbus_service_access_proc_value(line, 0, 16,
+                        &caps_ok);
+                } else if (g_str_has_prefix(line, "Groups:") && !groups) {
+                    groups = dbus_service_access_proc_groups(line, &ngroups);
+                }
+            }
+            if (uid_ok && gid_ok && caps_ok && euid == uid) {
+                peer = g_slice_new0(DBusServicePeerCred);
+                peer->groups = groups;
+                peer->cred.euid = uid;
+                peer->cred.egid = (gid_t)egid;
+                peer->cred.groups = groups;
+                peer->cred.ngroups = ngroups;
+                peer->cred.caps = caps;
+            } else {
+                GWARN("Unexpected credentials of pid %d", (int)pid);
+                g_free(groups);
+            }
+            g_strfreev(lines);
+            g_free(status);
+        } else {
+            GWARN("Failed to read %s", fname);
+        }
+        g_free(fname);
+    } else if (error) {
+        GWARN("%s", GERRMSG(error));
+        g_error_free(error);
+    }
+    return peer;
+}
+
+void
+dbus_service_access_attach_peer(
+    GDBusConnection* peer)
+{
+    GCredentials* credentials = g_dbus_connection_get_peer_credentials(peer);
+    DBusServicePeerCred* cred = credentials ?
+        dbus_service_access_peer_cred_new(credentials) : NULL;
+
+    /* No credentials, no access (to anything under access control) */
+    if (cred) {
+        g_object_set_data_full(G_OBJECT(peer), DBUS_SERVICE_PEER_CRED_KEY,
+            cred, dbus_service_access_peer_cred_free);
+    } else {
+        GWARN("No credentials for private connection %p", peer);
+        g_object_set_data(G_OBJECT(peer), DBUS_SERVICE_PEER_CRED_KEY, NULL);
+    }
+}
+
+gboolean
+dbus_service_access_allowed(
+    GDBusMethodInvocation* call,
+    DBUS_SERVICE_ACTION action)
+{
+    GDBusConnection* connection =
+        g_dbus_method_invocation_get_connection(call);
+    DBusServiceExports* exports = dbus_service_private_quark ?
+        g_object_get_qdata(G_OBJECT(connection),
+        dbus_service_private_quark) : NULL;
+    DA_ACCESS access = DA_ACCESS_ALLOW;
+
+    if (exports) {
+        /* Private connection, the policy is attached to the bus */
+        const DBusServicePeerCred* peer = g_object_get_data
+            (G_OBJECT(connection), DBUS_SERVICE_PEER_CRED_KEY);
+        AccessCache* cache = g_object_get_data(G_OBJECT(exports->bus),
+            DBUS_SERVICE_ACCESS_KEY);
+
+        if (cache) {
+            access = peer ? access_cache_check_cred(cache, &peer->cred,
+                action, NULL, DBUS_SERVICE_DEFAULT_ACCESS) : DA_ACCESS_DENY;
+        }
+    } else {
+        const char* sender = g_dbus_method_invocation_get_sender(call);
+        AccessCache* cache = sender ? g_object_get_data(G_OBJECT(connection),
+            DBUS_SERVICE_ACCESS_KEY) : NULL;
+
+        if (cache) {
+            access = access_cache_check(cache, sender, action, NULL,
+                DBUS_SERVICE_DEFAULT_ACCESS);
+        }
+    }
+
+    if (access == DA_ACCESS_ALLOW) {
+        return TRUE;
+    }
+    g_dbus_method_invocation_return_error_literal(call, DBUS_SERVICE_ERROR,
+        DBUS_SERVICE_ERROR_ACCESS_DENIED, "D-Bus access denied");
+    return FALSE;
+}
+
+#endif /* HAVE_DBUSACCESS */
+
 /*
  * Local Variables:
  * mode: C
@@ -36,6 +36,8 @@
 
 #include <gutil_types.h>
 
+#include <gio/gio.h>
+
 GVariant*
 dbus_service_dup_byte_array_as_variant(
     const void* data,
@@ -64,6 +66,123 @@ dbus_service_dict_add_byte_array_data(
     const char* name,
     const GUtilData* data);
 
+/*
+ * Besides the bus, objects are exported on private peer-to-peer
+ * connections opened with Daemon.OpenPrivateConnection. The registry
+ * is attached to the bus connection. The objects exported on the bus
+ * appear on the private connections too, including those which are
+ * added later.
+ */
+
+gboolean
+dbus_service_export(
+    GDBusInterfaceSkeleton* iface,
+    GDBusConnection* bus,
+    const char* path,
+    GError** error);
+
+void
+dbus_service_unexport(
+    GDBusInterfaceSkeleton* iface,
+    GDBusConnection* bus);
+
+void
+dbus_service_add_private_connection(
+    GDBusConnection* bus,
+    GDBusConnection* connection);
+
+void
+dbus_service_close_private_connections(
+    GDBusConnection* bus);
+
+/*
+ * org.freedesktop.DBus.ObjectManager at the root path. While it's
+ * exported, objects exported with dbus_service_export() (other than
+ * those at the root path) are returned by GetManagedObjects together
+ * with their properties and announced by InterfacesAdded and
+ * InterfacesRemoved signals.
+ */
+
+gboolean
+dbus_service_export_object_manager(
+    GDBusConnection* bus,
+    GError** error);
+
+void
+dbus_service_unexport_object_manager(
+    GDBusConnection* bus);
+
+gboolean
+dbus_service_private_call(
+    GDBusMethodInvocation* call);
+
+gboolean
+dbus_service_reject_private_call(
+    GDBusMethodInvocation* call);
+
+/*
+ * Access control. Decisions are cached per sender, see access_cache.h
+ * Calls over private connections are checked against the credentials
+ * of the peer, which dbus_service_access_attach_peer() picks up when
+ * the connection gets established. If those are unknown, everything
+ * under access control is denied. Calls without sender over other
+ * peer-to-peer connections are allowed. If the call is not allowed,
+ * it gets completed with AccessDenied error.
+ *
+ * NULL policy spec means the default one (which allows everything).
+ * dbus_service_access_set_policy() returns FALSE if the spec can't be
+ * parsed, in which case the current policy remains in effect. It only
+ * validates the spec if the bus is NULL.
+ */
+
+typedef enum dbus_service_action {
+    DBUS_SERVICE_ACTION_REQUEST_MODE = 1,
+    DBUS_SERVICE_ACTION_REGISTER_LOCAL_SERVICE,
+    DBUS_SERVICE_ACTION_OPEN_PRIVATE_CONNECTION,
+    DBUS_SERVICE_ACTION_ACQUIRE,
+    DBUS_SERVICE_ACTION_TRANSCEIVE,
+    DBUS_SERVICE_ACTION_TRANSMIT,
+    DBUS_SERVICE_ACTION_WRITE,
+    DBUS_SERVICE_ACTION_CONNECT,
+    DBUS_SERVICE_ACTION_SUBSCRIBE_EVENTS
+} DBUS_SERVICE_ACTION;
+
+#ifdef HAVE_DBUSACCESS
+
+void
+dbus_service_access_attach(
+    GDBusConnection* bus,
+    const char* spec);
+
+gboolean
+dbus_service_access_set_policy(
+    GDBusConnection* bus,
+    const char* spec);
+
+void
+dbus_service_access_detach(
+    GDBusConnection* bus);
+
+void
+dbus_service_access_attach_peer(
+    GDBusConnection* peer);
+
+gboolean
+dbus_service_access_allowed(
+    GDBusMethodInvocation* call,
+    DBUS_SERVICE_ACTION action);
+
+#else
+
+/* No access control (other than the one provided by dbus-daemon) */
+#define dbus_service_access_attach(bus,spec) ((void)0)
+#define dbus_service_access_set_policy(bus,spec) (TRUE)
+#define dbus_service_access_detach(bus) ((void)0)
+#define dbus_service_access_attach_peer(peer) ((void)0)
+#define dbus_service_access_allowed(call,action) (TRUE)
+
+#endif /* HAVE_DBUSACCESS */
+
 #endif /* DBUS_SERVICE_UTIL_H */
 
 /*
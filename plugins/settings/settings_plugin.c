@@ -38,8 +38,7 @@
 #include <nfc_manager.h>
 
 #ifdef HAVE_DBUSACCESS
-#include <dbusaccess_policy.h>
-#include <dbusaccess_peer.h>
+#include "common/access_cache.h"
 #endif
 
 #include <gutil_macros.h>
@@ -89,7 +88,7 @@ typedef struct settings_plugin {
     GStrV* order; /* Sorted keys in plugins table */
     OrgSailfishosNfcSettings* iface;
 #ifdef HAVE_DBUSACCESS
-    DAPolicy* policy;
+    AccessCache* access;
 #endif
     GKeyFile* defaults;
     char* storage_file;
@@ -127,6 +126,8 @@ G_DEFINE_TYPE(SettingsPlugin, settings_plugin, NFC_TYPE_PLUGIN)
 #define SETTINGS_GROUP                   "Settings"
 #define SETTINGS_KEY_ENABLED             "Enabled"
 #define SETTINGS_KEY_ALWAYS_ON           "AlwaysOn"
+#define SETTINGS_KEY_TAG_READ_POLICY     "TagReadPolicy"
+#define SETTINGS_KEY_TAG_FILTERS         "TagFilters"
 
 #define SETTINGS_DEFAULT_ENABLED         TRUE
 #define SETTINGS_DEFAULT_ALWAYS_ON       FALSE
@@ -311,6 +312,190 @@ settings_plugin_nfc_always_on(
         SETTINGS_KEY_ALWAYS_ON, SETTINGS_DEFAULT_ALWAYS_ON);
 }
 
+static
+NFC_TAG_READ_POLICY
+settings_plugin_tag_read_policy(
+    SettingsPlugin* self,
+    GKeyFile* config)
+{
+    static const char key[] = SETTINGS_KEY_TAG_READ_POLICY;
+    NFC_TAG_READ_POLICY policy = NFC_TAG_READ_DEFAULT;
+    char* str = g_key_file_get_string(config, SETTINGS_GROUP, key, NULL);
+
+    if (!str) {
+        str = g_key_file_get_string(self->defaults, SETTINGS_GROUP, key, NULL);
+    }
+    if (str) {
+        const char* value = g_strstrip(str);
+
+        if (!g_ascii_strcasecmp(value, "none")) {
+            policy = NFC_TAG_READ_NONE;
+        } else if (!g_ascii_strcasecmp(value, "ndef")) {
+            policy = NFC_TAG_READ_NDEF;
+        } else if (!g_ascii_strcasecmp(value, "full")) {
+            policy = NFC_TAG_READ_FULL;
+        } else {
+            GWARN("Invalid %s value '%s'", key, value);
+        }
+        g_free(str);
+    }
+    return policy;
+}
+
+/*
+ * TagFilters is a list of ACTION[:CONDITION[,CONDITION...]] entries
+ * where ACTION is accept, stub or skip and each condition looks like
+ * technology=AB, protocol=T2, uid=04A1 or sak=08/FF (the mask being
+ * optional). The first matching entry wins, e.g.
+ *
+ * TagFilters=accept:uid=04A1;skip:protocol=T2
+ */
+
+static
+gboolean
+settings_plugin_parse_tag_filter_condition(
+    NfcTagFilter* filter,
+    GPtrArray* uids,
+    const char* name,
+    const char* value)
+{
+    static const struct settings_protocol_name {
+        const char* name;
+        NFC_PROTOCOL protocol;
+    } protocols[] = {
+        { "T1", NFC_PROTOCOL_T1_TAG },
+        { "T2", NFC_PROTOCOL_T2_TAG },
+        { "T3", NFC_PROTOCOL_T3_TAG },
+        { "T4A", NFC_PROTOCOL_T4A_TAG },
+        { "T4B", NFC_PROTOCOL_T4B_TAG }
+    };
+    const gsize len = strlen(value);
+
+    if (!g_ascii_strcasecmp(name, "technology") && len) {
+        const char* ptr;
+
+        for (ptr = value; *ptr; ptr++) {
+            switch (g_ascii_toupper(*ptr)) {
+            case 'A': filter->technology |= NFC_TECHNOLOGY_A; break;
+            case 'B': filter->technology |= NFC_TECHNOLOGY_B; break;
+            case 'F': filter->technology |= NFC_TECHNOLOGY_F; break;
+            default: return FALSE;
+            }
+        }
+        return TRUE;
+    } else if (!g_ascii_strcasecmp(name, "protocol")) {
+        guint i;
+
+        for (i = 0; i < G_N_ELEMENTS(protocols); i++) {
+            if (!g_ascii_strcasecmp(value, protocols[i].name)) {
+                filter->protocol |= protocols[i].protocol;
+                return TRUE;
+            }
+        }
+    } else if (!g_ascii_strcasecmp(name, "uid")) {
+        GBytes* uid = gutil_hex2bytes(value, len);
+
+        if (uid) {
+            gsize size;
+
+            filter->uid_prefix.bytes = g_bytes_get_data(uid, &size);
+            filter->uid_prefix.size = size;
+            g_ptr_array_add(uids, uid);
+            return TRUE;
+        }
+    } else if (!g_ascii_strcasecmp(name, "sak")) {
+        if (len == 2) {
+            filter->sel_res_mask = 0xff;
+            return gutil_hex2bin(value, 2, &filter->sel_res) != NULL;
+        } else if (len == 5 && value[2] == '/') {
+            return gutil_hex2bin(value, 2, &filter->sel_res) &&
+                gutil_hex2bin(value + 3, 2, &filter->sel_res_mask);
+        }
+    }
+    return FALSE;
+}
+
+static
+gboolean
+settings_plugin_parse_tag_filter(
+    NfcTagFilter* filter,
+    GPtrArray* uids,
+    const char* spec)
+{
+    char** parts = g_strsplit(spec, ":", 2);
+    const char* action = g_strstrip(parts[0]);
+    gboolean ok = TRUE;
+
+    memset(filter, 0, sizeof(*filter));
+    if (!g_ascii_strcasecmp(action, "accept")) {
+        filter->action = NFC_TAG_FILTER_ACCEPT;
+    } else if (!g_ascii_strcasecmp(action, "stub")) {
+        filter->action = NFC_TAG_FILTER_STUB;
+    } else if (!g_ascii_strcasecmp(action, "skip")) {
+        filter->action = NFC_TAG_FILTER_SKIP;
+    } else {
+        ok = FALSE;
+    }
+
+    if (ok && parts[1]) {
+        char** conds = g_strsplit(parts[1], ",", -1);
+        char** ptr;
+
+        for (ptr = conds; *ptr && ok; ptr++) {
+            char** kv = g_strsplit(*ptr, "=", 2);
+
+            ok = kv[0] && kv[1] && settings_plugin_parse_tag_filter_condition
+                (filter, uids, g_strstrip(kv[0]), g_strstrip(kv[1]));
+            g_strfreev(kv);
+        }
+        g_strfreev(conds);
+    }
+    g_strfreev(parts);
+    return ok;
+}
+
+static
+void
+settings_plugin_apply_tag_filters(
+    SettingsPlugin* self,
+    GKeyFile* config)
+{
+    static const char key[] = SETTINGS_KEY_TAG_FILTERS;
+    gsize i, n = 0;
+    char** specs = g_key_file_get_string_list(config, SETTINGS_GROUP, key,
+        &n, NULL);
+
+    if (!specs) {
+        specs = g_key_file_get_string_list(self->defaults, SETTINGS_GROUP,
+            key, &n, NULL);
+    }
+    if (specs) {
+        GPtrArray* uids = g_ptr_array_new_with_free_func((GDestroyNotify)
+            g_bytes_unref);
+        NfcTagFilter* filters = g_new(NfcTagFilter, n);
+        guint count = 0;
+
+        for (i = 0; i < n; i++) {
+            const char* spec = g_strstrip(specs[i]);
+
+            if (!spec[0]) {
+                continue;
+            } else if (settings_plugin_parse_tag_filter(filters + count, uids,
+                spec)) {
+                count++;
+            } else {
+                GWARN("Invalid %s entry '%s'", key, spec);
+            }
+        }
+
+        /* The manager makes its own copy of the filters */
+        nfc_manager_set_tag_filters(self->manager, filters, count);
+        g_ptr_array_free(uids, TRUE);
+        g_free(filters);
+        g_strfreev(specs);
+    }
+}
+
 static
 void
 settings_plugin_save_boolean(
@@ -451,12 +636,9 @@ settings_plugin_access_allowed1(
     DA_ACCESS def)
 {
     const char* sender = g_dbus_method_invocation_get_sender(call);
-    DAPeer* peer = da_peer_get(SETTINGS_DA_BUS, sender);
 
-    /* If we get no peer information from dbus-daemon, it means that
-     * the peer is gone so it doesn't really matter what we do in this
-     * case - the reply will be dropped anyway. */
-    if (peer && da_policy_check(self->policy, &peer->cred, action, arg, def) ==
+    /* Decisions are cached per sender, see access_cache.h */
+    if (access_cache_check(self->access, sender, action, arg, def) ==
         DA_ACCESS_ALLOW) {
         return TRUE;
     }
@@ -749,6 +931,9 @@ settings_plugin_dbus_connected(
     SettingsPlugin* self = THIS(plugin);
     GError* error = NULL;
 
+#ifdef HAVE_DBUSACCESS
+    access_cache_set_connection(self->access, connection);
+#endif
     if (!g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON
         (self->iface), connection, SETTINGS_DBUS_PATH, &error)) {
         GERR("%s", GERRMSG(error));
@@ -968,6 +1153,10 @@ settings_plugin_started(
         nfc_manager_request_power(self->manager, TRUE);
     }
 
+    nfc_manager_set_tag_read_policy(self->manager,
+        settings_plugin_tag_read_policy(self, config));
+    settings_plugin_apply_tag_filters(self, config);
+
     if (save_config) {
         settings_plugin_save_config(self, config);
     }
@@ -1059,8 +1248,8 @@ settings_plugin_init(
     self->plugins = g_hash_table_new_full(g_str_hash, g_str_equal,
         NULL, settings_plugin_config_free);
 #ifdef HAVE_DBUSACCESS
-    self->policy = da_policy_new_full(settings_default_policy,
-        settings_policy_actions);
+    self->access = access_cache_new(SETTINGS_DA_BUS,
+        settings_default_policy, settings_policy_actions);
 #endif
 }
 
@@ -1072,7 +1261,7 @@ settings_plugin_finalize(
     SettingsPlugin* self = THIS(plugin);
 
 #ifdef HAVE_DBUSACCESS
-    da_policy_unref(self->policy);
+    access_cache_free(self->access);
 #endif
     g_free(self->storage_file);
     g_strfreev(self->order);
@@ -44,6 +44,8 @@
 #include <glib-unix.h>
 
 #include <locale.h>
+#include <string.h>
+#include <time.h>
 
 static const NfcPluginDesc* const nfcd_builtin_plugins[] = {
     &NFC_PLUGIN_DESC(dbus_handlers),
@@ -53,10 +55,39 @@ static const NfcPluginDesc* const nfcd_builtin_plugins[] = {
     NULL
 };
 
+/*
+ * Log file is written by a separate thread, so that debug logging
+ * doesn't block the main loop on file I/O. Lines are formatted into
+ * a ring buffer which the writer thread drains in batches. The ring
+ * is lock-free between the two sides, the writer only gets woken up
+ * when it runs out of data. If the ring is full, lines get dropped
+ * and counted.
+ */
+#define NFCD_LOG_RING_SIZE (256 * 1024) /* Must be a power of 2 */
+#define NFCD_LOG_RING_MASK (NFCD_LOG_RING_SIZE - 1)
+#define NFCD_LOG_LINE_MAX (4096)
+
+typedef struct nfcd_log_writer {
+    FILE* file;
+    GThread* thread;
+    GMutex put_lock;    /* Serializes the producers */
+    GMutex wait_lock;   /* Protects the conditions */
+    GCond wakeup;
+    GCond drained;
+    gint head;          /* Advanced by the producers */
+    gint tail;          /* Advanced by the writer thread */
+    gint sleeping;      /* The writer is waiting for data */
+    gint dropped;       /* Number of lines dropped since the last report */
+    gboolean stop;
+    time_t ts_time;     /* The second formatted into ts */
+    char ts[32];
+    char ring[NFCD_LOG_RING_SIZE];
+} NfcdLogWriter;
+
 static char** nfcd_enable_plugins = NULL;
 static char** nfcd_disable_plugins = NULL;
 static GLogProc nfcd_forward_log_func;
-static FILE* nfcd_log_file = NULL;
+static NfcdLogWriter* nfcd_log_writer = NULL;
 
 typedef struct nfcd_opt {
     char* plugin_dir;
@@ -131,6 +162,151 @@ nfcd_run(
     return ret;
 }
 
+static
+void
+nfcd_log_writer_output(
+    NfcdLogWriter* w,
+    const char* data,
+    gsize len)
+{
+    if (fwrite(data, 1, len, w->file) != len) {
+        /* Not much we can do about it */
+        clearerr(w->file);
+    }
+}
+
+static
+gpointer
+nfcd_log_writer_thread(
+    gpointer data)
+{
+    NfcdLogWriter* w = data;
+
+    for (;;) {
+        const guint tail = (guint)g_atomic_int_get(&w->tail);
+        const guint head = (guint)g_atomic_int_get(&w->head);
+
+        if (head != tail) {
+            /* Everything up to the end of the ring in one go */
+            const guint pos = tail & NFCD_LOG_RING_MASK;
+            const guint n = MIN(head - tail, NFCD_LOG_RING_SIZE - pos);
+
+            nfcd_log_writer_output(w, w->ring + pos, n);
+            g_atomic_int_set(&w->tail, (gint)(tail + n));
+        } else {
+            gint dropped;
+            gboolean done;
+
+            do {
+                dropped = g_atomic_int_get(&w->dropped);
+            } while (dropped &&
+                !g_atomic_int_compare_and_exchange(&w->dropped, dropped, 0));
+            if (dropped) {
+                char msg[64];
+
+                nfcd_log_writer_output(w, msg, g_snprintf(msg, sizeof(msg),
+                    "[nfcd] %d line(s) dropped\n", dropped));
+            }
+            fflush(w->file);
+
+            g_mutex_lock(&w->wait_lock);
+            g_cond_broadcast(&w->drained);
+            g_atomic_int_set(&w->sleeping, TRUE);
+            while (g_atomic_int_get(&w->head) == g_atomic_int_get(&w->tail)
+                && !w->stop) {
+                g_cond_wait(&w->wakeup, &w->wait_lock);
+            }
+            g_atomic_int_set(&w->sleeping, FALSE);
+            done = w->stop &&
+                g_atomic_int_get(&w->head) == g_atomic_int_get(&w->tail);
+            g_mutex_unlock(&w->wait_lock);
+            if (done) {
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+static
+void
+nfcd_log_writer_put(
+    NfcdLogWriter* w,
+    const char* data,
+    guint len)
+{
+    /* Called under put_lock */
+    const guint head = (guint)g_atomic_int_get(&w->head);
+    const guint tail = (guint)g_atomic_int_get(&w->tail);
+
+    if (NFCD_LOG_RING_SIZE - (head - tail) >= len) {
+        const guint pos = head & NFCD_LOG_RING_MASK;
+        const guint n = MIN(len, NFCD_LOG_RING_SIZE - pos);
+
+        memcpy(w->ring + pos, data, n);
+        memcpy(w->ring, data + n, len - n);
+        g_atomic_int_set(&w->head, (gint)(head + len));
+        if (g_atomic_int_get(&w->sleeping)) {
+            g_mutex_lock(&w->wait_lock);
+            g_cond_signal(&w->wakeup);
+            g_mutex_unlock(&w->wait_lock);
+        }
+    } else {
+        g_atomic_int_inc(&w->dropped);
+    }
+}
+
+static
+void
+nfcd_log_writer_flush(
+    NfcdLogWriter* w)
+{
+    /* Waits until everything is written */
+    g_mutex_lock(&w->wait_lock);
+    while (g_atomic_int_get(&w->head) != g_atomic_int_get(&w->tail) ||
+        !g_atomic_int_get(&w->sleeping)) {
+        g_cond_signal(&w->wakeup);
+        g_cond_wait(&w->drained, &w->wait_lock);
+    }
+    g_mutex_unlock(&w->wait_lock);
+}
+
+static
+NfcdLogWriter*
+nfcd_log_writer_new(
+    FILE* file)
+{
+    NfcdLogWriter* w = g_new0(NfcdLogWriter, 1);
+
+    w->file = file;
+    g_mutex_init(&w->put_lock);
+    g_mutex_init(&w->wait_lock);
+    g_cond_init(&w->wakeup);
+    g_cond_init(&w->drained);
+    w->thread = g_thread_new("nfcd-log", nfcd_log_writer_thread, w);
+    return w;
+}
+
+static
+void
+nfcd_log_writer_free(
+    NfcdLogWriter* w)
+{
+    /* Writes out whatever is left in the ring */
+    g_mutex_lock(&w->wait_lock);
+    w->stop = TRUE;
+    g_cond_signal(&w->wakeup);
+    g_mutex_unlock(&w->wait_lock);
+    g_thread_join(w->thread);
+
+    fclose(w->file);
+    g_cond_clear(&w->drained);
+    g_cond_clear(&w->wakeup);
+    g_mutex_clear(&w->wait_lock);
+    g_mutex_clear(&w->put_lock);
+    g_free(w);
+}
+
 void
 nfcd_log(
     const char* name,
@@ -138,26 +314,51 @@ nfcd_log(
     const char* format,
     va_list va)
 {
+    NfcdLogWriter* w = nfcd_log_writer;
+
     if (nfcd_forward_log_func) {
-        nfcd_forward_log_func(name, level, format, va);
+        va_list va2;
+
+        va_copy(va2, va);
+        nfcd_forward_log_func(name, level, format, va2);
+        va_end(va2);
     }
-    if (nfcd_log_file) {
+    if (w) {
+        char line[NFCD_LOG_LINE_MAX];
+        const guint max = sizeof(line) - 1; /* Room for the newline */
+        guint len = 0;
+        int n;
+
+        g_mutex_lock(&w->put_lock);
         if (gutil_log_timestamp) {
-            char t[32];
             time_t now;
+
+            /* Timestamp only changes once per second */
             time(&now);
-            strftime(t, sizeof(t), "%Y-%m-%d %H:%M:%S", localtime(&now));
-            fputs(t, nfcd_log_file);
-            fputc(' ', nfcd_log_file);
+            if (now != w->ts_time) {
+                w->ts_time = now;
+                strftime(w->ts, sizeof(w->ts), "%Y-%m-%d %H:%M:%S ",
+                    localtime(&now));
+            }
+            len = g_strlcpy(line, w->ts, max);
         }
-        if (name && name[0]) {
-            fputc('[', nfcd_log_file);
-            fputs(name, nfcd_log_file);
-            fputs("] ", nfcd_log_file);
+        if (name && name[0] && len < max) {
+            n = snprintf(line + len, max - len, "[%s] ", name);
+            len = (n < 0) ? len : MIN(len + n, max - 1);
+        }
+        if (len < max) {
+            /* Long lines get truncated */
+            n = vsnprintf(line + len, max - len, format, va);
+            len = (n < 0) ? len : MIN(len + n, max - 1);
+        }
+        line[len++] = '\n';
+        nfcd_log_writer_put(w, line, len);
+        g_mutex_unlock(&w->put_lock);
+
+        /* Errors may be followed by an abort, make sure they get out */
+        if (level == GLOG_LEVEL_ERR) {
+            nfcd_log_writer_flush(w);
         }
-        vfprintf(nfcd_log_file, format, va);
-        fputs("\n", nfcd_log_file);
-        fflush(nfcd_log_file);
     }
 }
 
@@ -221,8 +422,8 @@ nfcd_opt_log_file(
 {
     FILE* f = fopen(value, "w");
     if (f) {
-        if (nfcd_log_file) fclose(nfcd_log_file);
-        nfcd_log_file = f;
+        if (nfcd_log_writer) nfcd_log_writer_free(nfcd_log_writer);
+        nfcd_log_writer = nfcd_log_writer_new(f);
         if (!nfcd_forward_log_func) {
             nfcd_forward_log_func = gutil_log_func;
             gutil_log_func = nfcd_log;
@@ -321,8 +522,10 @@ void
 nfcd_opt_cleanup(
     NfcdOpt* opts)
 {
-    if (nfcd_log_file) {
-        fclose(nfcd_log_file);
+    if (nfcd_log_writer) {
+        /* Flushes and closes the file */
+        nfcd_log_writer_free(nfcd_log_writer);
+        nfcd_log_writer = NULL;
     }
     g_free(opts->plugin_dir);
     g_strfreev(nfcd_enable_plugins);
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*==========================================================================*
+ * Unit tests aren't linked with libdbusaccess. This module provides
+ * the stubs which return the default access, unless the spec contains
+ * "Action()=deny" for the action being checked.
+ *==========================================================================*/
+
+#ifdef HAVE_DBUSACCESS
+
+#include <dbusaccess_policy.h>
+#include <dbusaccess_peer.h>
+
+#include <gutil_log.h>
+
+#include <string.h>
+
+struct da_policy {
+    gint refcount;
+    char* spec;
+    const DA_ACTION* actions;
+};
+
+DAPeer*
+da_peer_get(
+    DA_BUS bus,
+    const char* name)
+{
+    static DAPeer test_peer;
+
+    return name ? &test_peer : NULL;
+}
+
+DAPolicy*
+da_policy_new_full(
+    const char* spec,
+    const DA_ACTION* actions)
+{
+    DAPolicy* policy = g_new0(DAPolicy, 1);
+
+    g_atomic_int_set(&policy->refcount, 1);
+    policy->spec = g_strdup(spec);
+    policy->actions = actions;
+    return policy;
+}
+
+DAPolicy*
+da_policy_ref(
+    DAPolicy* policy)
+{
+    if (policy) {
+        g_atomic_int_inc(&policy->refcount);
+    }
+    return policy;
+}
+
+void
+da_policy_unref(
+    DAPolicy* policy)
+{
+    if (policy && g_atomic_int_dec_and_test(&policy->refcount)) {
+        g_free(policy->spec);
+        g_free(policy);
+    }
+}
+
+DA_ACCESS
+da_policy_check(
+    const DAPolicy* policy,
+    const DACred* cred,
+    guint action,
+    const char* arg,
+    DA_ACCESS def)
+{
+    const DA_ACTION* action_ptr = policy->actions;
+
+    while (action_ptr && action_ptr->name) {
+        if (action_ptr->value == action) {
+            char* deny = g_strconcat(action_ptr->name, "()=deny", NULL);
+            const gboolean denied = policy->spec &&
+                strstr(policy->spec, deny) != NULL;
+
+            g_free(deny);
+            if (denied) {
+                GDEBUG("%s denied", action_ptr->name);
+                return DA_ACCESS_DENY;
+            }
+            break;
+        }
+        action_ptr++;
+    }
+    return def;
+}
+
+#endif /* HAVE_DBUSACCESS */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -53,14 +53,17 @@ test_target_t2_read_done(
     NfcTarget* target = &self->target;
     const GUtilData* data = &self->data;
     NFC_TRANSMIT_STATUS status = NFC_TRANSMIT_STATUS_OK;
-    guint offset = (read->block * TEST_TARGET_T2_BLOCK_SIZE) % data->size;
+    guint offset = read->block * TEST_TARGET_T2_BLOCK_SIZE;
     guint8 buf[TEST_TARGET_T2_READ_SIZE];
     guint len = sizeof(buf);
 
     g_assert(self->transmit_id);
     self->transmit_id = 0;
 
-    if ((offset + TEST_TARGET_T2_READ_SIZE) <= data->size) {
+    if (offset >= data->size) {
+        /* Whatever follows the data area (e.g. dynamic lock bytes) */
+        memset(buf, 0, TEST_TARGET_T2_READ_SIZE);
+    } else if ((offset + TEST_TARGET_T2_READ_SIZE) <= data->size) {
         memcpy(buf, data->bytes + offset, TEST_TARGET_T2_READ_SIZE);
     } else {
         const guint remain = (offset + TEST_TARGET_T2_READ_SIZE) - data->size;
@@ -95,6 +98,9 @@ test_target_t2_read_done(
                 test_timeout_expired, NULL);
             /* Don't call nfc_target_transmit_done() */
             return G_SOURCE_REMOVE;
+        case TEST_TARGET_T2_ERROR_LOST_WRITE:
+            g_assert(FALSE);
+            break;
         }
         self->read_error = NULL;
     }
@@ -140,6 +146,9 @@ test_target_t2_write_done(
                 test_timeout_expired, NULL);
             /* Don't call nfc_target_transmit_done() */
             return G_SOURCE_REMOVE;
+        case TEST_TARGET_T2_ERROR_LOST_WRITE:
+            GDEBUG("Simulating lost write");
+            break;
         }
         self->write_error = NULL;
     } else {
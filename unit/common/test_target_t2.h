@@ -57,7 +57,8 @@ typedef enum test_target_t2_error_type {
      TEST_TARGET_T2_ERROR_CRC,
      TEST_TARGET_T2_ERROR_NACK,
      TEST_TARGET_T2_ERROR_SHORT_RESP,
-     TEST_TARGET_T2_ERROR_TIMEOUT
+     TEST_TARGET_T2_ERROR_TIMEOUT,
+     TEST_TARGET_T2_ERROR_LOST_WRITE /* ACK but don't write anything */
 } TEST_TARGET_T2_ERROR_TYPE;
 
 struct test_target_t2_error {
@@ -242,6 +242,7 @@ test_null(
     g_assert(!nfc_adapter_ref(NULL));
     g_assert(!nfc_adapter_peers(NULL));
     g_assert(!nfc_adapter_request_mode(NULL, 0));
+    g_assert(!nfc_adapter_add_tag_t1(NULL, NULL, NULL));
     g_assert(!nfc_adapter_add_tag_t2(NULL, NULL, NULL));
     g_assert(!nfc_adapter_add_tag_t4a(NULL, NULL, NULL, NULL));
     g_assert(!nfc_adapter_add_tag_t4b(NULL, NULL, NULL, NULL));
@@ -265,6 +266,7 @@ test_null(
 
     nfc_adapter_set_name(NULL, NULL);
     nfc_adapter_set_services(NULL, NULL);
+    nfc_adapter_set_tag_filters(NULL, NULL);
     nfc_adapter_mode_notify(NULL, 0, FALSE);
     nfc_adapter_target_notify(NULL, FALSE);
     nfc_adapter_power_notify(NULL, FALSE, FALSE);
@@ -301,6 +303,7 @@ test_basic(
     g_assert(!nfc_adapter_add_enabled_changed_handler(adapter, NULL, NULL));
     g_assert(!nfc_adapter_add_peer_added_handler(adapter, NULL, NULL));
     g_assert(!nfc_adapter_add_peer_removed_handler(adapter, NULL, NULL));
+    g_assert(!nfc_adapter_add_tag_t1(adapter, NULL, NULL));
     g_assert(!nfc_adapter_add_tag_t2(adapter, NULL, NULL));
     g_assert(!nfc_adapter_add_tag_t4a(adapter, NULL, NULL, NULL));
     g_assert(!nfc_adapter_add_tag_t4b(adapter, NULL, NULL, NULL));
@@ -693,6 +696,115 @@ test_tags(
     nfc_target_unref(target1);
 }
 
+/*==========================================================================*
+ * filters
+ *==========================================================================*/
+
+static
+void
+test_filters(
+    void)
+{
+    static const guint8 uid_a1[] = { 0x04, 0xa1 };
+    static const guint8 uid_a1_tag[] = { 0x04, 0xa1, 0x02, 0x03 };
+    static const guint8 uid_b0_tag[] = { 0x04, 0xb0, 0x02, 0x03 };
+    TestAdapter* test = test_adapter_new();
+    NfcAdapter* adapter = &test->adapter;
+    NfcTarget* target0 = test_target_new_tech(NFC_TECHNOLOGY_A, FALSE);
+    NfcTarget* target1 = test_target_new_tech(NFC_TECHNOLOGY_A, FALSE);
+    NfcTarget* target2 = test_target_new_tech(NFC_TECHNOLOGY_A, FALSE);
+    NfcTarget* target3 = test_target_new_tech(NFC_TECHNOLOGY_A, FALSE);
+    NfcTagFilter filter[3];
+    NfcTagFilters* filters;
+    NfcParamPollA poll_a;
+    NfcTag* tag0;
+    NfcTag* tag1;
+    NfcTag* tag3;
+    int tag_added = 0;
+    gulong id;
+
+    g_assert(!nfc_tag_filters_new(NULL, 1));
+    g_assert(!nfc_tag_filters_new(filter, 0));
+    g_assert(!nfc_tag_filters_ref(NULL));
+    nfc_tag_filters_unref(NULL);
+    g_assert_cmpint(nfc_tag_filters_check(NULL, NFC_TECHNOLOGY_A,
+        NFC_PROTOCOL_T2_TAG, NULL), == ,NFC_TAG_FILTER_ACCEPT);
+
+    /* Accept 04A1..., stub other Type 2 tags with SAK 00, skip T4A */
+    memset(filter, 0, sizeof(filter));
+    filter[0].action = NFC_TAG_FILTER_ACCEPT;
+    filter[0].uid_prefix.bytes = uid_a1;
+    filter[0].uid_prefix.size = sizeof(uid_a1);
+    filter[1].action = NFC_TAG_FILTER_STUB;
+    filter[1].technology = NFC_TECHNOLOGY_A | NFC_TECHNOLOGY_B;
+    filter[1].protocol = NFC_PROTOCOL_T2_TAG;
+    filter[1].sel_res = 0x00;
+    filter[1].sel_res_mask = 0xff;
+    filter[2].action = NFC_TAG_FILTER_SKIP;
+    filter[2].protocol = NFC_PROTOCOL_T4A_TAG;
+    filters = nfc_tag_filters_new(filter, G_N_ELEMENTS(filter));
+    g_assert(filters);
+
+    /* The filters have been copied */
+    memset(filter, 0, sizeof(filter));
+    g_assert_cmpint(nfc_tag_filters_check(filters, NFC_TECHNOLOGY_B,
+        NFC_PROTOCOL_T2_TAG, NULL), == ,NFC_TAG_FILTER_ACCEPT);
+    g_assert_cmpint(nfc_tag_filters_check(filters, NFC_TECHNOLOGY_B,
+        NFC_PROTOCOL_T4A_TAG, NULL), == ,NFC_TAG_FILTER_SKIP);
+
+    id = nfc_adapter_add_tag_added_handler(adapter, test_adapter_tag_inc,
+        &tag_added);
+    nfc_adapter_set_tag_filters(adapter, filters);
+    nfc_tag_filters_unref(filters);
+
+    /* Accepted */
+    memset(&poll_a, 0, sizeof(poll_a));
+    poll_a.nfcid1.bytes = uid_a1_tag;
+    poll_a.nfcid1.size = sizeof(uid_a1_tag);
+    target0->protocol = NFC_PROTOCOL_T2_TAG;
+    tag0 = nfc_adapter_add_tag_t2(adapter, target0, &poll_a);
+    g_assert(tag0);
+    g_assert_cmpstr(tag0->name, == ,"tag0");
+    g_assert_cmpint(tag_added, == ,1);
+
+    /* Stub */
+    poll_a.nfcid1.bytes = uid_b0_tag;
+    target1->protocol = NFC_PROTOCOL_T2_TAG;
+    tag1 = nfc_adapter_add_tag_t2(adapter, target1, &poll_a);
+    g_assert(tag1);
+    g_assert(!tag1->name);
+    g_assert(tag1->flags & NFC_TAG_FLAG_INITIALIZED);
+    g_assert(!NFC_IS_TAG_T2(tag1));
+    g_assert_cmpint(tag_added, == ,1);
+    g_assert(adapter->tags[0] == tag0);
+    g_assert(!adapter->tags[1]);
+
+    /* The stub keeps the target present */
+    nfc_adapter_remove_tag(adapter, tag0->name);
+    g_assert(adapter->target_present);
+    nfc_target_gone(target1);
+    g_assert(!adapter->target_present);
+
+    /* Skipped */
+    target2->protocol = NFC_PROTOCOL_T4A_TAG;
+    g_assert(!nfc_adapter_add_tag_t4a(adapter, target2, &poll_a, NULL));
+    g_assert(!adapter->target_present);
+
+    /* Filtering is off */
+    nfc_adapter_set_tag_filters(adapter, NULL);
+    target3->protocol = NFC_PROTOCOL_T2_TAG;
+    tag3 = nfc_adapter_add_tag_t2(adapter, target3, &poll_a);
+    g_assert(NFC_IS_TAG_T2(tag3));
+    g_assert_cmpint(tag_added, == ,2);
+
+    nfc_adapter_remove_handler(adapter, id);
+    nfc_adapter_unref(adapter);
+    nfc_target_unref(target0);
+    nfc_target_unref(target1);
+    nfc_target_unref(target2);
+    nfc_target_unref(target3);
+}
+
 /*==========================================================================*
  * peer
  *==========================================================================*/
@@ -869,6 +981,7 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("power"), test_power);
     g_test_add_func(TEST_("mode"), test_mode);
     g_test_add_func(TEST_("tags"), test_tags);
+    g_test_add_func(TEST_("filters"), test_filters);
     g_test_add_func(TEST_("peer"), test_peer);
     g_test_add_func(TEST_("no_peer"), test_no_peer);
     test_init(&test_opt, argc, argv);
@@ -647,6 +647,56 @@ test_sdreq(
     nfc_llc_param_free(params);
 }
 
+/*==========================================================================*
+ * iter
+ *==========================================================================*/
+
+static
+void
+test_iter(
+    void)
+{
+    static const guint8 data[] = {
+        NFC_LLC_PARAM_SN, 0x04, 's', 'n', 'e', 'p',
+        NFC_LLC_PARAM_RW, 0x00, /* Invalid, skipped */
+        NFC_LLC_PARAM_SDREQ, 0x03, 0x01, 'n', 'f',
+        NFC_LLC_PARAM_LTO, 0x01, 0x00,
+        NFC_LLC_PARAM_WKS, 0x02 /* Truncated */
+    };
+    NfcLlcParamIter iter;
+    const NfcLlcParam* param;
+
+    nfc_llc_param_iter_init(&iter, NULL, 0);
+    g_assert(!nfc_llc_param_iter_next(&iter));
+
+    nfc_llc_param_iter_init(&iter, data, sizeof(data));
+    param = nfc_llc_param_iter_next(&iter);
+    g_assert(param);
+    g_assert_cmpint(param->type, == ,NFC_LLC_PARAM_SN);
+    g_assert_cmpstr(param->value.sn, == ,"snep");
+
+    param = nfc_llc_param_iter_next(&iter);
+    g_assert(param);
+    g_assert_cmpint(param->type, == ,NFC_LLC_PARAM_SDREQ);
+    g_assert_cmpint(param->value.sdreq.tid, == ,0x01);
+    g_assert_cmpstr(param->value.sdreq.uri, == ,"nf");
+
+    param = nfc_llc_param_iter_next(&iter);
+    g_assert(param);
+    g_assert_cmpint(param->type, == ,NFC_LLC_PARAM_LTO);
+    g_assert_cmpuint(param->value.lto, == ,NFC_LLC_LTO_DEFAULT);
+
+    g_assert(!nfc_llc_param_iter_next(&iter));
+    g_assert(!nfc_llc_param_iter_next(&iter));
+
+    /* Find */
+    nfc_llc_param_iter_init(&iter, data, sizeof(data));
+    param = nfc_llc_param_iter_find(&iter, NFC_LLC_PARAM_LTO);
+    g_assert(param);
+    g_assert_cmpint(param->type, == ,NFC_LLC_PARAM_LTO);
+    g_assert(!nfc_llc_param_iter_find(&iter, NFC_LLC_PARAM_SN));
+}
+
 /*==========================================================================*
  * decode_invalid_param
  *==========================================================================*/
@@ -710,6 +760,7 @@ int main(int argc, char* argv[])
     g_test_add_func(TESTD_("bytes"), test_decode_bytes);
     g_test_add_func(TESTD_("sn"), test_sn);
     g_test_add_func(TESTD_("sdreq"), test_sdreq);
+    g_test_add_func(TEST_("iter"), test_iter);
     for (i = 0; i < G_N_ELEMENTS(encode_single_param_tests); i++) {
         const TestSingleParamData* test = encode_single_param_tests + i;
 
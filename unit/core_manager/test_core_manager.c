@@ -192,13 +192,17 @@ test_null(
     g_assert(!nfc_manager_add_mode_changed_handler(NULL, NULL, NULL));
     g_assert(!nfc_manager_add_stopped_handler(NULL, NULL, NULL));
     g_assert(!nfc_manager_mode_request_new(NULL, 0, 0));
+    g_assert(!nfc_manager_mode_request_new2(NULL, 0, 0, 0));
 
     nfc_manager_mode_request_free(NULL);
     nfc_manager_stop(NULL, 0);
     nfc_manager_set_enabled(NULL, FALSE);
     nfc_manager_request_power(NULL, FALSE);
     nfc_manager_request_mode(NULL, NFC_MODE_NONE);
+    nfc_manager_set_tag_read_policy(NULL, NFC_TAG_READ_NONE);
+    nfc_manager_set_tag_filters(NULL, NULL, 0);
     nfc_manager_register_service(NULL, NULL);
+    nfc_manager_register_service2(NULL, NULL, 0);
     nfc_manager_unregister_service(NULL, NULL);
     nfc_manager_remove_adapter(NULL, NULL);
     nfc_manager_remove_handler(NULL, 0);
@@ -302,12 +306,21 @@ test_adapter(
     NfcAdapter* adapter2 = &test_adapter2->adapter;
     const char* name1;
     const char* name2;
+    static const guint8 uid[] = { 0x04 };
+    NfcTagFilter filter;
     int count = 0;
     gulong id;
 
     memset(&pi, 0, sizeof(pi));
     manager = nfc_manager_new(&pi);
 
+    /* Filters get passed to the adapters added later */
+    memset(&filter, 0, sizeof(filter));
+    filter.action = NFC_TAG_FILTER_SKIP;
+    filter.uid_prefix.bytes = uid;
+    filter.uid_prefix.size = sizeof(uid);
+    nfc_manager_set_tag_filters(manager, &filter, 1);
+
     /* Add adapters */
     id = nfc_manager_add_adapter_added_handler(manager,
         test_manager_adapter_inc, &count);
@@ -347,6 +360,9 @@ test_adapter(
     g_assert(test_adapter1->mode_requested == NFC_MODE_READER_WRITER);
     g_assert(test_adapter2->mode_requested == NFC_MODE_READER_WRITER);
 
+    /* And to the existing ones */
+    nfc_manager_set_tag_filters(manager, NULL, 0);
+
     /* Remove them */
     id = nfc_manager_add_adapter_removed_handler(manager,
         test_manager_adapter_inc, &count);
@@ -446,6 +462,61 @@ test_mode(
     nfc_manager_unref(manager);
 }
 
+/*==========================================================================*
+ * read_policy
+ *==========================================================================*/
+
+static
+void
+test_read_policy(
+    void)
+{
+    NfcPluginsInfo pi;
+    NfcManager* manager;
+    NfcModeRequest* full;
+    NfcModeRequest* none;
+    NfcModeRequest* mode;
+
+    memset(&pi, 0, sizeof(pi));
+    manager = nfc_manager_new(&pi);
+    g_assert_cmpint(manager->tag_read_policy, == ,NFC_TAG_READ_NDEF);
+
+    /* Nothing to request */
+    g_assert(!nfc_manager_mode_request_new2(manager, 0, 0,
+        NFC_TAG_READ_DEFAULT));
+
+    /* DEFAULT resets the default policy back to NDEF */
+    nfc_manager_set_tag_read_policy(manager, NFC_TAG_READ_NONE);
+    g_assert_cmpint(manager->tag_read_policy, == ,NFC_TAG_READ_NONE);
+    nfc_manager_set_tag_read_policy(manager, NFC_TAG_READ_DEFAULT);
+    g_assert_cmpint(manager->tag_read_policy, == ,NFC_TAG_READ_NDEF);
+
+    /* The most recent request which cares wins */
+    full = nfc_manager_mode_request_new2(manager, 0, 0, NFC_TAG_READ_FULL);
+    g_assert(full);
+    g_assert_cmpint(manager->tag_read_policy, == ,NFC_TAG_READ_FULL);
+    none = nfc_manager_mode_request_new2(manager, 0, 0, NFC_TAG_READ_NONE);
+    g_assert_cmpint(manager->tag_read_policy, == ,NFC_TAG_READ_NONE);
+    mode = nfc_manager_mode_request_new2(manager, NFC_MODES_P2P, 0,
+        NFC_TAG_READ_DEFAULT);
+    g_assert_cmpint(manager->mode, == ,NFC_MODES_P2P | NFC_MODE_READER_WRITER);
+    g_assert_cmpint(manager->tag_read_policy, == ,NFC_TAG_READ_NONE);
+
+    /* The default doesn't matter while there are requests */
+    nfc_manager_set_tag_read_policy(manager, NFC_TAG_READ_NDEF);
+    g_assert_cmpint(manager->tag_read_policy, == ,NFC_TAG_READ_NONE);
+
+    nfc_manager_mode_request_free(none);
+    g_assert_cmpint(manager->tag_read_policy, == ,NFC_TAG_READ_FULL);
+    nfc_manager_mode_request_free(full);
+    g_assert_cmpint(manager->tag_read_policy, == ,NFC_TAG_READ_NDEF);
+    nfc_manager_mode_request_free(mode);
+    g_assert_cmpint(manager->mode, == ,NFC_MODE_READER_WRITER);
+    g_assert_cmpint(manager->tag_read_policy, == ,NFC_TAG_READ_NDEF);
+
+    nfc_manager_unref(manager);
+}
+
 /*==========================================================================*
  * service
  *==========================================================================*/
@@ -510,6 +581,16 @@ test_service(
     g_assert_cmpint(unregistered, == ,1);
     g_assert(!manager->services[0]);
 
+    /* Register it again at the specific SAP */
+    g_assert(!nfc_manager_register_service2(manager, service,
+        NFC_LLC_SAP_UNNAMED));
+    g_assert(nfc_manager_register_service2(manager, service,
+        NFC_LLC_SAP_NAMED + 1));
+    g_assert_cmpint(registered, == ,2);
+    g_assert_cmpuint(service->sap, == ,NFC_LLC_SAP_NAMED + 1);
+    nfc_manager_unregister_service(manager, service);
+    g_assert_cmpint(unregistered, == ,2);
+
     nfc_peer_service_unref(service);
     nfc_manager_unref(manager);
 }
@@ -530,6 +611,7 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("basic"), test_basic);
     g_test_add_func(TEST_("adapter"), test_adapter);
     g_test_add_func(TEST_("mode"), test_mode);
+    g_test_add_func(TEST_("read_policy"), test_read_policy);
     g_test_add_func(TEST_("service"), test_service);
     test_init(&test_opt, argc, argv);
     return g_test_run();
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) ARISING
+ * IN ANY WAY OUT OF THE USE OR INABILITY TO USE THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+
+#include "test_common.h"
+
+#include "nfc_ndef_p.h"
+
+static TestOpt test_opt;
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    guint offset = 1;
+    GUtilData data;
+
+    g_assert(!nfc_ndef_template_new(NULL));
+    g_assert(!nfc_ndef_template_ref(NULL));
+    g_assert(!nfc_ndef_template_add_field(NULL, NULL, 0));
+    g_assert(!nfc_ndef_template_set_field(NULL, 0, NULL, 0));
+    g_assert(!nfc_ndef_template_data(NULL));
+    g_assert(!nfc_ndef_template_diff(NULL, 0, &offset, &data));
+    g_assert_cmpuint(offset, == ,0);
+    g_assert(!data.bytes);
+    g_assert(!data.size);
+    nfc_ndef_template_set_baseline(NULL, NULL);
+    nfc_ndef_template_commit(NULL);
+    nfc_ndef_template_unref(NULL);
+}
+
+/*==========================================================================*
+ * basic
+ *==========================================================================*/
+
+static
+void
+test_basic(
+    void)
+{
+    static const guint8 expected[] = {
+        0x03, 0x1a,     /* NDEF Message TLV */
+        0xd1,           /* NDEF record header (MB=1, ME=1, SR=1, TNF=0x01) */
+        0x01,           /* Length of the record type */
+        0x16,           /* Length of the record payload */
+        'U',            /* Record type: 'U' (URI) */
+        0x04,           /* "https://" */
+        'j', 'o', 'l', 'l', 'a', '.', 'c', 'o', 'm', '/',
+        'i', 'd', '/', '0', '0', '0', '0', '0', '0', '0', '1',
+        0xfe            /* Terminator TLV */
+    };
+    NfcNdefRecU* urec = nfc_ndef_rec_u_new("https://jolla.com/id/XXXXXXXX");
+    NfcNdefTemplate* tmpl = nfc_ndef_template_new(&urec->rec);
+    const GUtilData* data = nfc_ndef_template_data(tmpl);
+    guint id, offset = 0;
+    GUtilData diff;
+
+    g_assert(tmpl);
+    g_assert(nfc_ndef_template_ref(tmpl) == tmpl);
+    nfc_ndef_template_unref(tmpl);
+    g_assert(data);
+    g_assert_cmpuint(data->size, == ,sizeof(expected));
+
+    /* Invalid placeholders */
+    g_assert(!nfc_ndef_template_add_field(tmpl, "YYYY", 4));
+    g_assert(!nfc_ndef_template_add_field(tmpl, "X", 0));
+
+    id = nfc_ndef_template_add_field(tmpl, "XXXXXXXX", 8);
+    g_assert(id);
+
+    /* Wrong size or id */
+    g_assert(!nfc_ndef_template_set_field(tmpl, id, "0", 1));
+    g_assert(!nfc_ndef_template_set_field(tmpl, id + 1, "00000001", 8));
+    g_assert(nfc_ndef_template_set_field(tmpl, id, "00000001", 8));
+    g_assert(!memcmp(data->bytes, expected, sizeof(expected)));
+
+    /* No baseline, everything has to be written */
+    g_assert(nfc_ndef_template_diff(tmpl, 4, &offset, &diff));
+    g_assert_cmpuint(offset, == ,0);
+    g_assert_cmpuint(diff.size, == ,sizeof(expected));
+
+    /* Once it's written, only the field needs to be updated */
+    nfc_ndef_template_commit(tmpl);
+    g_assert(!nfc_ndef_template_diff(tmpl, 4, NULL, NULL));
+    g_assert(nfc_ndef_template_set_field(tmpl, id, "00000002", 8));
+    g_assert(nfc_ndef_template_diff(tmpl, 1, &offset, &diff));
+    g_assert_cmpuint(offset, == ,sizeof(expected) - 2);
+    g_assert_cmpuint(diff.size, == ,1);
+    g_assert_cmpuint(diff.bytes[0], == ,'2');
+
+    /* Aligned to 4-byte blocks */
+    g_assert(nfc_ndef_template_diff(tmpl, 4, &offset, &diff));
+    g_assert_cmpuint(offset, == ,24);
+    g_assert_cmpuint(diff.size, == ,4);
+
+    nfc_ndef_template_unref(tmpl);
+    nfc_ndef_rec_unref(&urec->rec);
+}
+
+/*==========================================================================*
+ * baseline
+ *==========================================================================*/
+
+static
+void
+test_baseline(
+    void)
+{
+    NfcNdefRecU* urec1 = nfc_ndef_rec_u_new("https://jolla.com/id/XXXX");
+    NfcNdefRecU* urec2 = nfc_ndef_rec_u_new("https://jolla.com/id/0000");
+    NfcNdefTemplate* tmpl = nfc_ndef_template_new(&urec1->rec);
+    NfcNdefTemplate* tmpl2 = nfc_ndef_template_new(&urec2->rec);
+    GUtilData tag = *nfc_ndef_template_data(tmpl2);
+    guint id = nfc_ndef_template_add_field(tmpl, "XXXX", 4);
+    guint offset = 0;
+    GUtilData diff;
+
+    g_assert(id);
+    nfc_ndef_template_set_baseline(tmpl, &tag);
+    g_assert(nfc_ndef_template_diff(tmpl, 0, &offset, &diff));
+    g_assert_cmpuint(diff.size, == ,4);
+
+    /* Same as what's on the tag */
+    g_assert(nfc_ndef_template_set_field(tmpl, id, "0000", 4));
+    g_assert(!nfc_ndef_template_diff(tmpl, 0, NULL, NULL));
+
+    /* Short baseline */
+    tag.size--;
+    nfc_ndef_template_set_baseline(tmpl, &tag);
+    g_assert(nfc_ndef_template_diff(tmpl, 0, &offset, &diff));
+    g_assert_cmpuint(offset, == ,tag.size);
+    g_assert_cmpuint(diff.size, == ,1);
+
+    /* No baseline */
+    nfc_ndef_template_set_baseline(tmpl, NULL);
+    g_assert(nfc_ndef_template_diff(tmpl, 0, &offset, &diff));
+    g_assert_cmpuint(offset, == ,0);
+
+    nfc_ndef_template_unref(tmpl);
+    nfc_ndef_template_unref(tmpl2);
+    nfc_ndef_rec_unref(&urec1->rec);
+    nfc_ndef_rec_unref(&urec2->rec);
+}
+
+/*==========================================================================*
+ * control
+ *==========================================================================*/
+
+static
+void
+test_control(
+    void)
+{
+    static const guint8 tag_data[] = {
+        0x01, 0x03, 0xa0, 0x10, 0x44,   /* Lock Control TLV */
+        0x00,                           /* NULL TLV */
+        0x03, 0x0d,                     /* NDEF Message TLV */
+        0xd1, 0x01, 0x09, 'U', 0x04,
+        'j', 'o', 'l', 'l', 'a', '/', '0', '0',
+        0xfe                            /* Terminator TLV */
+    };
+    static const guint8 expected[] = {
+        0x01, 0x03, 0xa0, 0x10, 0x44,
+        0x00,
+        0x03, 0x0d,
+        0xd1, 0x01, 0x09, 'U', 0x04,
+        'j', 'o', 'l', 'l', 'a', '/', '0', '1',
+        0xfe
+    };
+    NfcNdefRecU* urec = nfc_ndef_rec_u_new("https://jolla/XX");
+    NfcNdefTemplate* tmpl = nfc_ndef_template_new(&urec->rec);
+    const GUtilData* data = nfc_ndef_template_data(tmpl);
+    guint id = nfc_ndef_template_add_field(tmpl, "XX", 2);
+    guint offset = 0;
+    GUtilData tag, diff;
+
+    g_assert(id);
+    g_assert_cmpuint(data->bytes[0], == ,0x03);
+
+    /* Control TLVs are taken from the baseline and kept in the image */
+    TEST_BYTES_SET(tag, tag_data);
+    nfc_ndef_template_set_baseline(tmpl, &tag);
+    g_assert_cmpuint(data->size, == ,sizeof(tag_data));
+    g_assert(!memcmp(data->bytes, tag_data, 8));
+
+    /* The field has moved together with the NDEF TLV */
+    g_assert(nfc_ndef_template_set_field(tmpl, id, "01", 2));
+    g_assert(!memcmp(data->bytes, expected, sizeof(expected)));
+    g_assert(nfc_ndef_template_diff(tmpl, 0, &offset, &diff));
+    g_assert_cmpuint(offset, == ,sizeof(expected) - 2);
+    g_assert_cmpuint(diff.size, == ,1);
+    g_assert_cmpuint(diff.bytes[0], == ,'1');
+
+    /* Aligned to the block but not beyond the end of the image */
+    g_assert(nfc_ndef_template_diff(tmpl, 4, &offset, &diff));
+    g_assert_cmpuint(offset, == ,20);
+    g_assert_cmpuint(diff.size, == ,2);
+
+    /* New field placeholders are only searched for in the NDEF */
+    g_assert(!nfc_ndef_template_add_field(tmpl, "\x01\x03", 2));
+
+    /* Blank tag, no control TLVs */
+    memset(&tag, 0, sizeof(tag));
+    tag.bytes = expected + 5;
+    tag.size = 1;
+    nfc_ndef_template_set_baseline(tmpl, &tag);
+    g_assert_cmpuint(data->size, == ,sizeof(expected) - 6);
+    g_assert_cmpuint(data->bytes[0], == ,0x03);
+    g_assert(!memcmp(data->bytes + data->size - 3, "01\xfe", 3));
+
+    nfc_ndef_template_unref(tmpl);
+    nfc_ndef_rec_unref(&urec->rec);
+}
+
+/*==========================================================================*
+ * chain
+ *==========================================================================*/
+
+static
+void
+test_chain(
+    void)
+{
+    NfcNdefRecU* urec = nfc_ndef_rec_u_new("https://jolla.com");
+    NfcNdefRecT* trec = nfc_ndef_rec_t_new("Jolla", "en");
+    NfcNdefTemplate* tmpl;
+    const GUtilData* data;
+    guint8 hdr1, hdr2;
+
+    urec->rec.next = &trec->rec;
+    tmpl = nfc_ndef_template_new(&urec->rec);
+    urec->rec.next = NULL;
+    g_assert(tmpl);
+
+    /* MB and ME bits are adjusted */
+    data = nfc_ndef_template_data(tmpl);
+    hdr1 = data->bytes[2];
+    hdr2 = data->bytes[2 + urec->rec.raw.size];
+    g_assert_cmpuint(hdr1 & (NFC_NDEF_HDR_MB | NFC_NDEF_HDR_ME), == ,
+        NFC_NDEF_HDR_MB);
+    g_assert_cmpuint(hdr2 & (NFC_NDEF_HDR_MB | NFC_NDEF_HDR_ME), == ,
+        NFC_NDEF_HDR_ME);
+    g_assert_cmpuint(data->bytes[1], == ,urec->rec.raw.size +
+        trec->rec.raw.size);
+    g_assert_cmpuint(data->bytes[data->size - 1], == ,0xfe);
+
+    nfc_ndef_template_unref(tmpl);
+    nfc_ndef_rec_unref(&urec->rec);
+    nfc_ndef_rec_unref(&trec->rec);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/core/ndef_template/" name
+
+int main(int argc, char* argv[])
+{
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("basic"), test_basic);
+    g_test_add_func(TEST_("baseline"), test_baseline);
+    g_test_add_func(TEST_("control"), test_control);
+    g_test_add_func(TEST_("chain"), test_chain);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
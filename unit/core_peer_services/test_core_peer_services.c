@@ -72,6 +72,7 @@ test_null(
     g_assert(!nfc_peer_services_find_sn(NULL, NULL));
     g_assert(!nfc_peer_services_find_sap(NULL, 0));
     g_assert(!nfc_peer_services_add(NULL, NULL));
+    g_assert(!nfc_peer_services_add2(NULL, NULL, 0));
     g_assert(!nfc_peer_services_remove(NULL, NULL));
     nfc_peer_services_peer_arrived(NULL, NULL);
     nfc_peer_services_peer_left(NULL, NULL);
@@ -251,6 +252,51 @@ test_reserved(
     nfc_peer_services_unref(services);
 }
 
+/*==========================================================================*
+ * sap
+ *==========================================================================*/
+
+static
+void
+test_sap(
+    void)
+{
+    NfcPeerServices* services = nfc_peer_services_new();
+    NfcPeerService* s1 = NFC_PEER_SERVICE(test_service_new("foo"));
+    NfcPeerService* s2 = NFC_PEER_SERVICE(test_service_new("bar"));
+    NfcPeerService* s3 = NFC_PEER_SERVICE(test_service_new(NULL));
+    NfcPeerService* snep = NFC_PEER_SERVICE(test_service_new
+        (NFC_LLC_NAME_SNEP));
+
+    /* Named services must stay in the named range */
+    g_assert(!nfc_peer_services_add2(services, s1, NFC_LLC_SAP_SNEP));
+    g_assert(!nfc_peer_services_add2(services, s1, NFC_LLC_SAP_UNNAMED));
+    g_assert(nfc_peer_services_add2(services, s1, NFC_LLC_SAP_NAMED + 5));
+    g_assert_cmpuint(s1->sap, == ,NFC_LLC_SAP_NAMED + 5);
+
+    /* The same SAP can't be taken twice */
+    g_assert(!nfc_peer_services_add2(services, s2, NFC_LLC_SAP_NAMED + 5));
+    g_assert(nfc_peer_services_add2(services, s2, 0));
+    g_assert_cmpuint(s2->sap, == ,NFC_LLC_SAP_NAMED);
+
+    /* Unnamed ones go to the unnamed range */
+    g_assert(!nfc_peer_services_add2(services, s3, NFC_LLC_SAP_NAMED + 1));
+    g_assert(!nfc_peer_services_add2(services, s3, NFC_LLC_SAP_MAX + 1));
+    g_assert(nfc_peer_services_add2(services, s3, NFC_LLC_SAP_MAX));
+    g_assert_cmpuint(s3->sap, == ,NFC_LLC_SAP_MAX);
+
+    /* And the well-known ones have their well-known SAPs */
+    g_assert(!nfc_peer_services_add2(services, snep, NFC_LLC_SAP_NAMED + 1));
+    g_assert(nfc_peer_services_add2(services, snep, NFC_LLC_SAP_SNEP));
+    g_assert_cmpuint(test_services_count(services), == ,4);
+
+    nfc_peer_service_unref(s1);
+    nfc_peer_service_unref(s2);
+    nfc_peer_service_unref(s3);
+    nfc_peer_service_unref(snep);
+    nfc_peer_services_unref(services);
+}
+
 /*==========================================================================*
  * too_many
  *==========================================================================*/
@@ -293,6 +339,7 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("basic"), test_basic);
     g_test_add_func(TEST_("copy"), test_copy);
     g_test_add_func(TEST_("reserved"), test_reserved);
+    g_test_add_func(TEST_("sap"), test_sap);
     g_test_add_func(TEST_("too_many"), test_too_many);
     test_init(&test_opt, argc, argv);
     return g_test_run();
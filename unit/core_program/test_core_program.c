@@ -0,0 +1,450 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "nfc_program.h"
+#include "nfc_target_p.h"
+
+#include "test_common.h"
+#include "test_target.h"
+
+static TestOpt test_opt;
+
+#define TEST_VAR_A (1)
+#define TEST_VAR_B (2)
+
+typedef struct test_program_data {
+    GMainLoop* loop;
+    NfcProgram prog;
+    guint result;
+    guint hook_calls;
+    GByteArray* data;
+} TestProgramData;
+
+static
+void
+test_program_data_init(
+    TestProgramData* test,
+    const NfcProgramStep* steps,
+    guint count,
+    NfcProgramHookFunc hook)
+{
+    memset(test, 0, sizeof(*test));
+    test->loop = g_main_loop_new(NULL, TRUE);
+    test->result = (guint)-1;
+    test->data = g_byte_array_new();
+    nfc_program_init(&test->prog, steps, count, hook, test);
+}
+
+static
+void
+test_program_data_deinit(
+    TestProgramData* test)
+{
+    nfc_program_deinit(&test->prog);
+    g_byte_array_free(test->data, TRUE);
+    g_main_loop_unref(test->loop);
+}
+
+static
+void
+test_program_done(
+    NfcProgram* prog,
+    guint result,
+    void* user_data)
+{
+    TestProgramData* test = user_data;
+
+    g_assert(prog == &test->prog);
+    test->result = result;
+    g_byte_array_append(test->data, prog->data->data, prog->data->len);
+    g_main_loop_quit(test->loop);
+}
+
+static
+void
+test_program_run(
+    TestProgramData* test,
+    NfcTarget* target)
+{
+    NfcTargetSequence* seq = nfc_target_sequence_new(target);
+
+    nfc_program_run(&test->prog, target, seq, test_program_done);
+    if (test->result == (guint)-1) {
+        test_run(&test_opt, test->loop);
+    }
+    nfc_target_sequence_unref(seq);
+}
+
+/*==========================================================================*
+ * loop
+ *==========================================================================*/
+
+static const guint8 test_read_cmd[] = { 0x30, 0x00 };
+
+enum test_loop_step {
+    TEST_LOOP_INIT,
+    TEST_LOOP_READ,
+    TEST_LOOP_NEXT,
+    TEST_LOOP_MORE,
+    TEST_LOOP_CHECK,
+    TEST_LOOP_OK,
+    TEST_LOOP_FAIL,
+    TEST_LOOP_ZERO
+};
+
+static const NfcProgramStep test_loop_prog[] = {
+    [TEST_LOOP_INIT] = {
+        .op = NFC_PROGRAM_OP_SET,
+        .a = TEST_VAR_A,
+        .imm = 0
+    },
+    [TEST_LOOP_READ] = {
+        .op = NFC_PROGRAM_OP_TRANSMIT,
+        .name = "Read",
+        .cmd = { test_read_cmd, sizeof(test_read_cmd) },
+        .patch = {{ 1, 1, TEST_VAR_A }},
+        .capture = {{ 0, 1, TEST_VAR_B }},
+        .min_len = 1,
+        .max_len = 2,
+        .flags = NFC_PROGRAM_FLAG_APPEND,
+        .fail = TEST_LOOP_FAIL
+    },
+    [TEST_LOOP_NEXT] = {
+        .op = NFC_PROGRAM_OP_ADD,
+        .a = TEST_VAR_A,
+        .imm = 4
+    },
+    [TEST_LOOP_MORE] = {
+        .op = NFC_PROGRAM_OP_JLT,
+        .a = TEST_VAR_A,
+        .imm = 8,
+        .fail = TEST_LOOP_READ
+    },
+    [TEST_LOOP_CHECK] = {
+        .op = NFC_PROGRAM_OP_JZ,
+        .a = TEST_VAR_B,
+        .fail = TEST_LOOP_ZERO
+    },
+    [TEST_LOOP_OK] = {
+        .op = NFC_PROGRAM_OP_EXIT,
+        .imm = 1
+    },
+    [TEST_LOOP_FAIL] = {
+        .op = NFC_PROGRAM_OP_EXIT,
+        .imm = 2
+    },
+    [TEST_LOOP_ZERO] = {
+        .op = NFC_PROGRAM_OP_EXIT,
+        .imm = 3
+    }
+};
+
+static
+void
+test_loop(
+    void)
+{
+    static const guint8 cmd1[] = { 0x30, 0x00 };
+    static const guint8 resp1[] = { 0xaa, 0x01 };
+    static const guint8 cmd2[] = { 0x30, 0x04 };
+    static const guint8 resp2[] = { 0xbb };
+    static const guint8 zero[] = { 0x00 };
+    static const guint8 too_long[] = { 0x01, 0x02, 0x03 };
+    static const guint8 data[] = { 0xaa, 0x01, 0xbb };
+    TestProgramData test;
+    NfcTarget* target;
+
+    /* Two iterations */
+    test_program_data_init(&test, test_loop_prog,
+        G_N_ELEMENTS(test_loop_prog), NULL);
+    target = test_target_new_with_data(cmd1, sizeof(cmd1),
+        resp1, sizeof(resp1));
+    test_target_add_data(target, cmd2, sizeof(cmd2), resp2, sizeof(resp2));
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,1);
+    g_assert_cmpuint(test.prog.var[TEST_VAR_A], == ,8);
+    g_assert_cmpuint(test.prog.var[TEST_VAR_B], == ,0xbb);
+    g_assert_cmpuint(test.prog.var[NFC_PROGRAM_VAR_LEN], == ,1);
+    g_assert_cmpuint(test.data->len, == ,sizeof(data));
+    g_assert(!memcmp(test.data->data, data, sizeof(data)));
+    g_assert(!test_target_tx_remaining(target));
+    nfc_target_unref(target);
+
+    /* The second run reuses the same program */
+    g_byte_array_set_size(test.data, 0);
+    test.result = (guint)-1;
+    target = test_target_new_with_data(cmd1, sizeof(cmd1),
+        resp1, sizeof(resp1));
+    test_target_add_data(target, cmd2, sizeof(cmd2), zero, sizeof(zero));
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,3);
+    g_assert_cmpuint(test.data->len, == ,3);
+    nfc_target_unref(target);
+
+    /* Response too long */
+    test.result = (guint)-1;
+    target = test_target_new_with_data(cmd1, sizeof(cmd1),
+        too_long, sizeof(too_long));
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,2);
+    nfc_target_unref(target);
+
+    /* I/O error */
+    test.result = (guint)-1;
+    target = test_target_new_with_data(cmd1, sizeof(cmd1), NULL, 0);
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,2);
+    nfc_target_unref(target);
+
+    /* Transmit failure */
+    test.result = (guint)-1;
+    target = test_target_new(TEST_TARGET_FAIL_ALL);
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,2);
+    nfc_target_unref(target);
+
+    test_program_data_deinit(&test);
+}
+
+/*==========================================================================*
+ * apdu
+ *==========================================================================*/
+
+static const guint8 test_select_cmd[] = { 0x00, 0xa4, 0x04, 0x00, 0x01 };
+static const guint8 test_read_binary_cmd[] = { 0x00, 0xb0, 0x00, 0x00 };
+
+enum test_apdu_step {
+    TEST_APDU_SELECT,
+    TEST_APDU_SET_LE,
+    TEST_APDU_READ,
+    TEST_APDU_CALL,
+    TEST_APDU_OK,
+    TEST_APDU_NOT_FOUND,
+    TEST_APDU_FAIL,
+    TEST_APDU_GOTO
+};
+
+static const NfcProgramStep test_apdu_prog[] = {
+    [TEST_APDU_SELECT] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "Select",
+        .cmd = { test_select_cmd, sizeof(test_select_cmd) },
+        .alt_sw = 0x6a82,
+        .alt = TEST_APDU_NOT_FOUND,
+        .fail = TEST_APDU_FAIL
+    },
+    [TEST_APDU_SET_LE] = {
+        .op = NFC_PROGRAM_OP_SET,
+        .a = TEST_VAR_A,
+        .imm = 0x200
+    },
+    [TEST_APDU_READ] = {
+        .op = NFC_PROGRAM_OP_APDU,
+        .name = "Read",
+        .cmd = { test_read_binary_cmd, sizeof(test_read_binary_cmd) },
+        .b = TEST_VAR_A,
+        .sw = 0x6282,
+        .capture = {{ 0, 2, TEST_VAR_B }},
+        .fail = TEST_APDU_FAIL
+    },
+    [TEST_APDU_CALL] = {
+        .op = NFC_PROGRAM_OP_CALL,
+        .imm = 7,
+        .fail = TEST_APDU_GOTO
+    },
+    [TEST_APDU_OK] = {
+        .op = NFC_PROGRAM_OP_EXIT,
+        .imm = 1
+    },
+    [TEST_APDU_NOT_FOUND] = {
+        .op = NFC_PROGRAM_OP_EXIT,
+        .imm = 2
+    },
+    [TEST_APDU_FAIL] = {
+        .op = NFC_PROGRAM_OP_EXIT,
+        .imm = 3
+    },
+    [TEST_APDU_GOTO] = {
+        .op = NFC_PROGRAM_OP_GOTO,
+        .fail = TEST_APDU_FAIL
+    }
+};
+
+static
+gboolean
+test_apdu_hook(
+    NfcProgram* prog,
+    guint id,
+    void* user_data)
+{
+    TestProgramData* test = user_data;
+
+    g_assert_cmpuint(id, == ,7);
+    g_assert(prog->resp);
+    test->hook_calls++;
+    return prog->var[TEST_VAR_B] == 0x1234;
+}
+
+static
+void
+test_apdu(
+    void)
+{
+    static const guint8 select_apdu[] = { 0x00, 0xa4, 0x04, 0x00, 0x01, 0x01 };
+    static const guint8 read_apdu[] = {
+        0x00, 0xb0, 0x00, 0x00, 0x00, 0x02, 0x00 /* Extended Le */
+    };
+    static const guint8 ok[] = { 0x90, 0x00 };
+    static const guint8 not_found[] = { 0x6a, 0x82 };
+    static const guint8 short_resp[] = { 0x90 };
+    static const guint8 data1[] = { 0x12, 0x34, 0x62, 0x82 };
+    static const guint8 data2[] = { 0x12, 0x35, 0x62, 0x82 };
+    static const guint8 data3[] = { 0x12, 0x34, 0x90, 0x00 };
+    TestProgramData test;
+    NfcTarget* target;
+
+    test_program_data_init(&test, test_apdu_prog,
+        G_N_ELEMENTS(test_apdu_prog), test_apdu_hook);
+    target = test_target_new_with_data(select_apdu, sizeof(select_apdu),
+        ok, sizeof(ok));
+    test_target_add_data(target, read_apdu, sizeof(read_apdu),
+        data1, sizeof(data1));
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,1);
+    g_assert_cmpuint(test.hook_calls, == ,1);
+    g_assert_cmpuint(test.prog.var[NFC_PROGRAM_VAR_SW], == ,0x6282);
+    g_assert_cmpuint(test.prog.var[NFC_PROGRAM_VAR_LEN], == ,2);
+    g_assert(!test_target_tx_remaining(target));
+    nfc_target_unref(target);
+
+    /* Hook fails */
+    test.result = (guint)-1;
+    target = test_target_new_with_data(select_apdu, sizeof(select_apdu),
+        ok, sizeof(ok));
+    test_target_add_data(target, read_apdu, sizeof(read_apdu),
+        data2, sizeof(data2));
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,3);
+    g_assert_cmpuint(test.hook_calls, == ,2);
+    nfc_target_unref(target);
+
+    /* Unexpected status */
+    test.result = (guint)-1;
+    target = test_target_new_with_data(select_apdu, sizeof(select_apdu),
+        ok, sizeof(ok));
+    test_target_add_data(target, read_apdu, sizeof(read_apdu),
+        data3, sizeof(data3));
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,3);
+    g_assert_cmpuint(test.hook_calls, == ,2);
+    nfc_target_unref(target);
+
+    /* Alternative status */
+    test.result = (guint)-1;
+    target = test_target_new_with_data(select_apdu, sizeof(select_apdu),
+        not_found, sizeof(not_found));
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,2);
+    nfc_target_unref(target);
+
+    /* Response too short for SW */
+    test.result = (guint)-1;
+    target = test_target_new_with_data(select_apdu, sizeof(select_apdu),
+        short_resp, sizeof(short_resp));
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,3);
+    g_assert_cmpuint(test.prog.var[NFC_PROGRAM_VAR_SW], == ,ISO_SW_IO_ERR);
+    nfc_target_unref(target);
+
+    test_program_data_deinit(&test);
+}
+
+/*==========================================================================*
+ * end
+ *==========================================================================*/
+
+static
+void
+test_end(
+    void)
+{
+    static const NfcProgramStep prog[] = {
+        {
+            .op = NFC_PROGRAM_OP_SUB,
+            .a = TEST_VAR_A,
+            .imm = 1
+        },{
+            .op = NFC_PROGRAM_OP_MIN,
+            .a = TEST_VAR_B,
+            .imm = 1
+        }
+    };
+    TestProgramData test;
+    NfcTarget* target = test_target_new(TEST_TARGET_FAIL_ALL);
+
+    /* Running past the last step completes synchronously with zero */
+    test_program_data_init(&test, prog, G_N_ELEMENTS(prog), NULL);
+    test_program_run(&test, target);
+    g_assert_cmpuint(test.result, == ,0);
+    g_assert_cmpuint(test.prog.var[TEST_VAR_A], == ,0);
+    g_assert_cmpuint(test.prog.var[TEST_VAR_B], == ,0);
+    test_program_data_deinit(&test);
+
+    /* Deinit is safe on a zeroed structure */
+    memset(&test.prog, 0, sizeof(test.prog));
+    nfc_program_deinit(&test.prog);
+    nfc_target_unref(target);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/core/program/" name
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("loop"), test_loop);
+    g_test_add_func(TEST_("apdu"), test_apdu);
+    g_test_add_func(TEST_("end"), test_end);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -303,11 +303,15 @@ static const guint8 cc_snep_data[] = {
     0x0f
 };
 
+static const guint8 disc_4_32_data[] = { 0x11, 0x60 };
+static const guint8 dm_32_4_data[] = { 0x81, 0xc4, 0x00 };
+
 static
 void
 test_ndef(
     const GUtilData* packets,
-    guint count)
+    guint count,
+    int ndef_changes)
 {
     GMainLoop* loop = g_main_loop_new(NULL, TRUE);
     TestTarget* tt = g_object_new(TEST_TYPE_TARGET, NULL);
@@ -347,7 +351,7 @@ test_ndef(
 
     /* Assert that we have received expected number of events */
     g_assert_cmpint(snep_state_change_count, == ,2);
-    g_assert_cmpint(snep_ndef_change_count, == ,1);
+    g_assert_cmpint(snep_ndef_change_count, == ,ndef_changes);
     nfc_snep_server_remove_handler(snep, snep_id[0]);
     nfc_snep_server_remove_handler(snep, snep_id[1]);
 
@@ -377,22 +381,23 @@ test_ndef_complete(
         0x63, 0x6f, 0x6d, 0x51, 0x01, 0x08, 0x54, 0x02,
         0x65, 0x6e, 0x4a, 0x6f, 0x6c, 0x6c, 0x61
     };
-    static const guint8 rnr_32_4_data[] = { 0x83, 0x84, 0x01 };
-    static const guint8 disc_32_4_data[] = { 0x81, 0x44 };
-    static const guint8 dm_4_32_data[] = { 0x11, 0xe0, 0x00 };
+    static const guint8 i_snep_32_4_success_data[] = {
+        0x83, 0x04, 0x01,
+        0x10, 0x81, 0x00, 0x00, 0x00, 0x00
+    };
     static const GUtilData packets[] = {
         { TEST_ARRAY_AND_SIZE(symm_data) },
         { TEST_ARRAY_AND_SIZE(connect_snep_data) },
         { TEST_ARRAY_AND_SIZE(cc_snep_data) },
         { TEST_ARRAY_AND_SIZE(i_snep_4_32_put_data) },
-        { TEST_ARRAY_AND_SIZE(rnr_32_4_data) },
+        { TEST_ARRAY_AND_SIZE(i_snep_32_4_success_data) },
+        { TEST_ARRAY_AND_SIZE(disc_4_32_data) },
+        { TEST_ARRAY_AND_SIZE(dm_32_4_data) },
         { TEST_ARRAY_AND_SIZE(symm_data) },
-        { TEST_ARRAY_AND_SIZE(disc_32_4_data) },
-        { TEST_ARRAY_AND_SIZE(dm_4_32_data) },
         { TEST_ARRAY_AND_SIZE(symm_data) },
         { TEST_ARRAY_AND_SIZE(symm_data) }
     };
-    test_ndef(TEST_ARRAY_AND_COUNT(packets));
+    test_ndef(TEST_ARRAY_AND_COUNT(packets), 1);
 }
 
 static
@@ -415,9 +420,10 @@ test_ndef_flagmented(
         0x63, 0x6f, 0x6d, 0x51, 0x01, 0x08, 0x54, 0x02,
         0x65, 0x6e, 0x4a, 0x6f, 0x6c, 0x6c, 0x61
     };
-    static const guint8 rnr_32_4_data[] = { 0x83, 0x84, 0x02 };
-    static const guint8 disc_32_4_data[] = { 0x81, 0x44 };
-    static const guint8 dm_4_32_data[] = { 0x11, 0xe0, 0x00 };
+    static const guint8 i_snep_32_4_success_data[] = {
+        0x83, 0x04, 0x12,
+        0x10, 0x81, 0x00, 0x00, 0x00, 0x00
+    };
     static const GUtilData packets[] = {
         { TEST_ARRAY_AND_SIZE(symm_data) },
         { TEST_ARRAY_AND_SIZE(connect_snep_data) },
@@ -425,14 +431,60 @@ test_ndef_flagmented(
         { TEST_ARRAY_AND_SIZE(i_snep_4_32_put_data) },
         { TEST_ARRAY_AND_SIZE(i_snep_32_4_continue_data) },
         { TEST_ARRAY_AND_SIZE(i_snep_4_32_ndef_data) },
-        { TEST_ARRAY_AND_SIZE(rnr_32_4_data) },
+        { TEST_ARRAY_AND_SIZE(i_snep_32_4_success_data) },
+        { TEST_ARRAY_AND_SIZE(disc_4_32_data) },
+        { TEST_ARRAY_AND_SIZE(dm_32_4_data) },
+        { TEST_ARRAY_AND_SIZE(symm_data) },
+        { TEST_ARRAY_AND_SIZE(symm_data) },
+        { TEST_ARRAY_AND_SIZE(symm_data) }
+    };
+    test_ndef(TEST_ARRAY_AND_COUNT(packets), 1);
+}
+
+static
+void
+test_ndef_multiple(
+    void)
+{
+    static const guint8 i_snep_4_32_put1_data[] = {
+        0x13, 0x20, 0x00,
+        0x10, 0x02, 0x00, 0x00, 0x00, 0x1f,
+        0xd1, 0x02, 0x1a, 0x53, 0x70, 0x91, 0x01, 0x0a,
+        0x55, 0x03, 0x6a, 0x6f, 0x6c, 0x6c, 0x61, 0x2e,
+        0x63, 0x6f, 0x6d, 0x51, 0x01, 0x08, 0x54, 0x02,
+        0x65, 0x6e, 0x4a, 0x6f, 0x6c, 0x6c, 0x61
+    };
+    static const guint8 i_snep_32_4_success1_data[] = {
+        0x83, 0x04, 0x01,
+        0x10, 0x81, 0x00, 0x00, 0x00, 0x00
+    };
+    static const guint8 i_snep_4_32_put2_data[] = {
+        0x13, 0x20, 0x11,
+        0x10, 0x02, 0x00, 0x00, 0x00, 0x1f,
+        0xd1, 0x02, 0x1a, 0x53, 0x70, 0x91, 0x01, 0x0a,
+        0x55, 0x03, 0x6a, 0x6f, 0x6c, 0x6c, 0x61, 0x2e,
+        0x63, 0x6f, 0x6d, 0x51, 0x01, 0x08, 0x54, 0x02,
+        0x65, 0x6e, 0x4a, 0x6f, 0x6c, 0x6c, 0x61
+    };
+    static const guint8 i_snep_32_4_success2_data[] = {
+        0x83, 0x04, 0x12,
+        0x10, 0x81, 0x00, 0x00, 0x00, 0x00
+    };
+    static const GUtilData packets[] = {
+        { TEST_ARRAY_AND_SIZE(symm_data) },
+        { TEST_ARRAY_AND_SIZE(connect_snep_data) },
+        { TEST_ARRAY_AND_SIZE(cc_snep_data) },
+        { TEST_ARRAY_AND_SIZE(i_snep_4_32_put1_data) },
+        { TEST_ARRAY_AND_SIZE(i_snep_32_4_success1_data) },
+        { TEST_ARRAY_AND_SIZE(i_snep_4_32_put2_data) },
+        { TEST_ARRAY_AND_SIZE(i_snep_32_4_success2_data) },
+        { TEST_ARRAY_AND_SIZE(disc_4_32_data) },
+        { TEST_ARRAY_AND_SIZE(dm_32_4_data) },
         { TEST_ARRAY_AND_SIZE(symm_data) },
-        { TEST_ARRAY_AND_SIZE(disc_32_4_data) },
-        { TEST_ARRAY_AND_SIZE(dm_4_32_data) },
         { TEST_ARRAY_AND_SIZE(symm_data) },
         { TEST_ARRAY_AND_SIZE(symm_data) }
     };
-    test_ndef(TEST_ARRAY_AND_COUNT(packets));
+    test_ndef(TEST_ARRAY_AND_COUNT(packets), 2);
 }
 
 /*==========================================================================*
@@ -662,6 +714,7 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("idle"), test_idle);
     g_test_add_func(TEST_("ndef/complete"), test_ndef_complete);
     g_test_add_func(TEST_("ndef/flagmented"), test_ndef_flagmented);
+    g_test_add_func(TEST_("ndef/multiple"), test_ndef_multiple);
     g_test_add_func(TEST_("fail/short"), test_fail_short);
     g_test_add_func(TEST_("fail/version"), test_fail_version);
     g_test_add_func(TEST_("fail/get"), test_fail_get);
@@ -63,6 +63,7 @@ test_null(
     /* Public interfaces are NULL tolerant */
     g_assert(!nfc_tag_ref(NULL));
     g_assert(!nfc_tag_param(NULL));
+    g_assert(!nfc_tag_cache_size(NULL));
     g_assert(!nfc_tag_add_initialized_handler(NULL, NULL, NULL));
     g_assert(!nfc_tag_add_gone_handler(NULL, NULL, NULL));
     nfc_tag_remove_handler(NULL, 0);
@@ -94,6 +95,7 @@ test_basic(
     g_assert(tag->target == target);
     g_assert(tag->present == TRUE);
     g_assert(!nfc_tag_param(tag)); /* No params for NFC_TECHNOLOGY_UNKNOWN */
+    g_assert(!nfc_tag_cache_size(tag)); /* Generic tag caches nothing */
 
     g_assert(!tag->name);
     nfc_tag_set_name(tag, name);
@@ -0,0 +1,601 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "nfc_tag_p.h"
+#include "nfc_tag_t1.h"
+#include "nfc_ndef.h"
+
+#include "test_common.h"
+#include "test_target.h"
+
+static TestOpt test_opt;
+
+#define TEST_MEM_SIZE (512)
+#define TEST_STATIC_SIZE (120)
+#define TEST_SEGMENT_SIZE (128)
+#define TEST_BLOCK_SIZE (8)
+#define TEST_HR0_STATIC (0x11)
+#define TEST_HR0_DYNAMIC (0x12)
+#define TEST_HR1 (0x48)
+#define TEST_TMS_STATIC (0x0e)
+#define TEST_TMS_DYNAMIC (0x3f)
+
+static const guint8 test_uid[] = { 0x01, 0x02, 0x03, 0x04 };
+static const guint8 test_cmd_rid[] = {
+    0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+static const guint8 test_cmd_rall[] = {
+    0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04
+};
+
+/* Lock Control and Memory Control TLVs of Topaz 512 */
+static const guint8 test_control_tlvs[] = {
+    0x01, 0x03, 0xf2, 0x30, 0x33,
+    0x02, 0x03, 0xf0, 0x02, 0x03
+};
+
+static
+void
+test_tag_quit_loop_cb(
+    NfcTag* tag,
+    void* user_data)
+{
+    g_main_loop_quit((GMainLoop*)user_data);
+}
+
+static
+NfcTagType1*
+test_tag_new(
+    NfcTarget* target,
+    const NfcParamPollA* poll_a,
+    NFC_TAG_READ_POLICY policy)
+{
+    NfcTagType1* t1 = nfc_tag_t1_new(target, poll_a, policy);
+    NfcTag* tag = &t1->tag;
+
+    g_assert(NFC_IS_TAG_T1(t1));
+    if (!(tag->flags & NFC_TAG_FLAG_INITIALIZED)) {
+        GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+        const gulong id = nfc_tag_add_initialized_handler(tag,
+            test_tag_quit_loop_cb, loop);
+
+        test_run(&test_opt, loop);
+        nfc_tag_remove_handler(tag, id);
+        g_main_loop_unref(loop);
+        g_assert(tag->flags & NFC_TAG_FLAG_INITIALIZED);
+    }
+    return t1;
+}
+
+static
+void
+test_poll_a(
+    NfcParamPollA* poll_a)
+{
+    memset(poll_a, 0, sizeof(*poll_a));
+    poll_a->nfcid1.bytes = test_uid;
+    poll_a->nfcid1.size = sizeof(test_uid);
+}
+
+static
+GByteArray*
+test_tlv_new(
+    gboolean control,
+    guint payload)
+{
+    /* NDEF TLV with a single media-type record of the given size */
+    GByteArray* tlv = g_byte_array_new();
+    const guint8 hdr[] = {
+        0x03, 6 + payload,
+        0xd2, 0x03, payload, 'a', '/', 'b'
+    };
+    const guint8 terminator = 0xfe;
+    guint i;
+
+    g_assert_cmpuint(payload, < ,250);
+    if (control) {
+        g_byte_array_append(tlv, TEST_ARRAY_AND_SIZE(test_control_tlvs));
+    }
+    g_byte_array_append(tlv, TEST_ARRAY_AND_SIZE(hdr));
+    for (i = 0; i < payload; i++) {
+        const guint8 b = (guint8)i;
+
+        g_byte_array_append(tlv, &b, 1);
+    }
+    g_byte_array_append(tlv, &terminator, 1);
+    return tlv;
+}
+
+static
+guint8*
+test_mem_new(
+    guint8 tms,
+    const GByteArray* tlv)
+{
+    guint8* mem = g_malloc0(TEST_MEM_SIZE);
+    guint i, addr = 12;
+
+    /* UID, then CC, then the data area skipping blocks 0Dh..0Fh */
+    memcpy(mem, test_uid, sizeof(test_uid));
+    mem[8] = 0xe1;
+    mem[9] = 0x10;
+    mem[10] = tms;
+    for (i = 0; i < tlv->len; i++, addr++) {
+        if (addr == 104) {
+            addr = 128;
+        }
+        mem[addr] = tlv->data[i];
+    }
+    return mem;
+}
+
+static
+void
+test_add_rall(
+    NfcTarget* target,
+    guint8 hr0,
+    const guint8* mem)
+{
+    guint8 resp[2 + TEST_STATIC_SIZE];
+
+    resp[0] = hr0;
+    resp[1] = TEST_HR1;
+    memcpy(resp + 2, mem, TEST_STATIC_SIZE);
+    test_target_add_data(target, TEST_ARRAY_AND_SIZE(test_cmd_rall),
+        TEST_ARRAY_AND_SIZE(resp));
+}
+
+static
+void
+test_add_rseg(
+    NfcTarget* target,
+    guint seg,
+    guint8 echo,
+    const guint8* mem)
+{
+    guint8 cmd[14];
+    guint8 resp[1 + TEST_SEGMENT_SIZE];
+
+    memset(cmd, 0, sizeof(cmd));
+    cmd[0] = 0x10;
+    cmd[1] = seg << 4;
+    memcpy(cmd + 10, test_uid, sizeof(test_uid));
+    resp[0] = echo;
+    memcpy(resp + 1, mem + seg * TEST_SEGMENT_SIZE, TEST_SEGMENT_SIZE);
+    test_target_add_data(target, TEST_ARRAY_AND_SIZE(cmd),
+        TEST_ARRAY_AND_SIZE(resp));
+}
+
+static
+void
+test_add_read8(
+    NfcTarget* target,
+    guint block,
+    const guint8* mem)
+{
+    guint8 cmd[14];
+    guint8 resp[1 + TEST_BLOCK_SIZE];
+
+    memset(cmd, 0, sizeof(cmd));
+    cmd[0] = 0x02;
+    cmd[1] = block;
+    memcpy(cmd + 10, test_uid, sizeof(test_uid));
+    resp[0] = block;
+    memcpy(resp + 1, mem + block * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE);
+    test_target_add_data(target, TEST_ARRAY_AND_SIZE(cmd),
+        TEST_ARRAY_AND_SIZE(resp));
+}
+
+static
+void
+test_check_ndef(
+    NfcTagType1* t1,
+    guint payload)
+{
+    NfcNdefRec* ndef = t1->tag.ndef;
+
+    g_assert(ndef);
+    g_assert(!ndef->next);
+    g_assert_cmpint(ndef->tnf, == ,NFC_NDEF_TNF_MEDIA_TYPE);
+    g_assert_cmpuint(ndef->payload.size, == ,payload);
+}
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    g_assert(!nfc_tag_t1_new(NULL, NULL, NFC_TAG_READ_DEFAULT));
+    g_assert_cmpint(nfc_tag_t1_read_data_sync(NULL, 0, 0, NULL), == ,
+        NFC_TAG_T1_IO_STATUS_FAILURE);
+}
+
+/*==========================================================================*
+ * static
+ *==========================================================================*/
+
+static
+void
+test_static(
+    void)
+{
+    NfcTarget* target = test_target_new_tech(NFC_TECHNOLOGY_A,
+        TEST_TARGET_FAIL_NONE);
+    GByteArray* tlv = test_tlv_new(FALSE, 10);
+    guint8* mem = test_mem_new(TEST_TMS_STATIC, tlv);
+    guint8 buf[4];
+    NfcParamPollA poll_a;
+    NfcTagType1* t1;
+
+    /* Just one RALL */
+    test_add_rall(target, TEST_HR0_STATIC, mem);
+    test_poll_a(&poll_a);
+    t1 = test_tag_new(target, &poll_a, NFC_TAG_READ_DEFAULT);
+    g_assert(!test_target_tx_remaining(target));
+    test_check_ndef(t1, 10);
+
+    g_assert_cmpuint(t1->hr0, == ,TEST_HR0_STATIC);
+    g_assert_cmpuint(t1->hr1, == ,TEST_HR1);
+    g_assert_cmpuint(t1->t1flags, == ,NFC_TAG_T1_FLAG_NFC_FORUM_COMPATIBLE);
+    g_assert_cmpuint(t1->data_size, == ,92);
+    g_assert_cmpuint(t1->uid.size, == ,sizeof(test_uid));
+    g_assert(!memcmp(t1->uid.bytes, test_uid, sizeof(test_uid)));
+
+    /* 120 bytes of static memory plus valid and reserved bitmaps */
+    g_assert_cmpuint(nfc_tag_cache_size(&t1->tag), == ,120 + 2 + 15);
+
+    g_assert_cmpint(nfc_tag_t1_read_data_sync(t1, 0, sizeof(buf), buf),
+        == ,NFC_TAG_T1_IO_STATUS_OK);
+    g_assert(!memcmp(buf, tlv->data, sizeof(buf)));
+    g_assert_cmpint(nfc_tag_t1_read_data_sync(t1, 88, sizeof(buf), NULL),
+        == ,NFC_TAG_T1_IO_STATUS_OK);
+    g_assert_cmpint(nfc_tag_t1_read_data_sync(t1, 89, sizeof(buf), buf),
+        == ,NFC_TAG_T1_IO_STATUS_BAD_SIZE);
+    g_assert_cmpint(nfc_tag_t1_read_data_sync(t1, 93, 0, buf),
+        == ,NFC_TAG_T1_IO_STATUS_BAD_SIZE);
+
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+    g_byte_array_free(tlv, TRUE);
+    g_free(mem);
+}
+
+/*==========================================================================*
+ * rid
+ *==========================================================================*/
+
+static
+void
+test_rid(
+    void)
+{
+    static const guint8 rid_resp[] = {
+        TEST_HR0_STATIC, TEST_HR1, 0x01, 0x02, 0x03, 0x04
+    };
+    NfcTarget* target = test_target_new_tech(NFC_TECHNOLOGY_A,
+        TEST_TARGET_FAIL_NONE);
+    GByteArray* tlv = test_tlv_new(FALSE, 10);
+    guint8* mem = test_mem_new(TEST_TMS_STATIC, tlv);
+    NfcTagType1* t1;
+
+    /* UID is unknown, RID goes first */
+    test_target_add_data(target, TEST_ARRAY_AND_SIZE(test_cmd_rid),
+        TEST_ARRAY_AND_SIZE(rid_resp));
+    test_add_rall(target, TEST_HR0_STATIC, mem);
+    t1 = test_tag_new(target, NULL, NFC_TAG_READ_DEFAULT);
+    g_assert(!test_target_tx_remaining(target));
+    test_check_ndef(t1, 10);
+    g_assert_cmpuint(t1->uid.size, == ,sizeof(test_uid));
+    g_assert(!memcmp(t1->uid.bytes, test_uid, sizeof(test_uid)));
+
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+    g_byte_array_free(tlv, TRUE);
+    g_free(mem);
+}
+
+/*==========================================================================*
+ * rseg
+ *==========================================================================*/
+
+static
+void
+test_rseg(
+    void)
+{
+    NfcTarget* target = test_target_new_tech(NFC_TECHNOLOGY_A,
+        TEST_TARGET_FAIL_NONE);
+    GByteArray* tlv = test_tlv_new(TRUE, 194);
+    guint8* mem = test_mem_new(TEST_TMS_DYNAMIC, tlv);
+    guint8 buf[8];
+    NfcParamPollA poll_a;
+    NfcTagType1* t1;
+
+    /* NDEF continues in segment 1 */
+    test_add_rall(target, TEST_HR0_DYNAMIC, mem);
+    test_add_rseg(target, 1, 0x10, mem);
+    test_poll_a(&poll_a);
+    t1 = test_tag_new(target, &poll_a, NFC_TAG_READ_NDEF);
+    g_assert(!test_target_tx_remaining(target));
+    test_check_ndef(t1, 194);
+
+    g_assert_cmpuint(t1->t1flags, == ,NFC_TAG_T1_FLAG_NFC_FORUM_COMPATIBLE |
+        NFC_TAG_T1_FLAG_DYNAMIC_MEMORY);
+    g_assert_cmpuint(t1->data_size, == ,TEST_MEM_SIZE - 12 - 24);
+
+    /* Reading across blocks 0Dh..0Fh */
+    g_assert_cmpint(nfc_tag_t1_read_data_sync(t1, 88, sizeof(buf), buf),
+        == ,NFC_TAG_T1_IO_STATUS_OK);
+    g_assert(!memcmp(buf, tlv->data + 88, sizeof(buf)));
+
+    /* Segments 2 and 3 haven't been read */
+    g_assert_cmpint(nfc_tag_t1_read_data_sync(t1, 300, sizeof(buf), buf),
+        == ,NFC_TAG_T1_IO_STATUS_NOT_CACHED);
+
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+    g_byte_array_free(tlv, TRUE);
+    g_free(mem);
+}
+
+/*==========================================================================*
+ * read8
+ *==========================================================================*/
+
+static
+void
+test_read8(
+    void)
+{
+    NfcTarget* target = test_target_new_tech(NFC_TECHNOLOGY_A,
+        TEST_TARGET_FAIL_NONE);
+    GByteArray* tlv = test_tlv_new(TRUE, 81);
+    guint8* mem = test_mem_new(TEST_TMS_DYNAMIC, tlv);
+    NfcParamPollA poll_a;
+    NfcTagType1* t1;
+
+    /* The last 8 bytes of the TLV sequence are in block 10h */
+    g_assert_cmpuint(tlv->len, == ,100);
+    test_add_rall(target, TEST_HR0_DYNAMIC, mem);
+    test_add_read8(target, 0x10, mem);
+    test_poll_a(&poll_a);
+    t1 = test_tag_new(target, &poll_a, NFC_TAG_READ_NDEF);
+    g_assert(!test_target_tx_remaining(target));
+    test_check_ndef(t1, 81);
+
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+    g_byte_array_free(tlv, TRUE);
+    g_free(mem);
+}
+
+/*==========================================================================*
+ * full
+ *==========================================================================*/
+
+static
+void
+test_full(
+    void)
+{
+    NfcTarget* target = test_target_new_tech(NFC_TECHNOLOGY_A,
+        TEST_TARGET_FAIL_NONE);
+    GByteArray* tlv = test_tlv_new(TRUE, 10);
+    guint8* mem = test_mem_new(TEST_TMS_DYNAMIC, tlv);
+    guint8 buf[TEST_MEM_SIZE];
+    NfcParamPollA poll_a;
+    NfcTagType1* t1;
+
+    /* Block 0Fh is the only one missing from segment 0 */
+    test_add_rall(target, TEST_HR0_DYNAMIC, mem);
+    test_add_read8(target, 0x0f, mem);
+    test_add_rseg(target, 1, 0x10, mem);
+    test_add_rseg(target, 2, 0x20, mem);
+    test_add_rseg(target, 3, 0x30, mem);
+    test_poll_a(&poll_a);
+    t1 = test_tag_new(target, &poll_a, NFC_TAG_READ_FULL);
+    g_assert(!test_target_tx_remaining(target));
+    test_check_ndef(t1, 10);
+
+    g_assert_cmpint(nfc_tag_t1_read_data_sync(t1, 0, t1->data_size, buf),
+        == ,NFC_TAG_T1_IO_STATUS_OK);
+    g_assert(!memcmp(buf, tlv->data, tlv->len));
+
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+    g_byte_array_free(tlv, TRUE);
+    g_free(mem);
+}
+
+/*==========================================================================*
+ * not_ndef
+ *==========================================================================*/
+
+static
+void
+test_not_ndef(
+    void)
+{
+    NfcTarget* target = test_target_new_tech(NFC_TECHNOLOGY_A,
+        TEST_TARGET_FAIL_NONE);
+    GByteArray* tlv = test_tlv_new(FALSE, 10);
+    guint8* mem = test_mem_new(TEST_TMS_STATIC, tlv);
+    NfcParamPollA poll_a;
+    NfcTagType1* t1;
+
+    /* Not NDEF capable according to HR0 */
+    test_add_rall(target, 0x01, mem);
+    test_poll_a(&poll_a);
+    t1 = test_tag_new(target, &poll_a, NFC_TAG_READ_DEFAULT);
+    g_assert(!test_target_tx_remaining(target));
+    g_assert(!t1->tag.ndef);
+    g_assert_cmpuint(t1->hr0, == ,0x01);
+    g_assert_cmpuint(t1->t1flags, == ,NFC_TAG_T1_FLAGS_NONE);
+    g_assert_cmpint(nfc_tag_t1_read_data_sync(t1, 0, 1, NULL), == ,
+        NFC_TAG_T1_IO_STATUS_FAILURE);
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+
+    /* Invalid CC */
+    target = test_target_new_tech(NFC_TECHNOLOGY_A, TEST_TARGET_FAIL_NONE);
+    mem[8] = 0;
+    test_add_rall(target, TEST_HR0_STATIC, mem);
+    t1 = test_tag_new(target, &poll_a, NFC_TAG_READ_DEFAULT);
+    g_assert(!test_target_tx_remaining(target));
+    g_assert(!t1->tag.ndef);
+    g_assert_cmpuint(t1->data_size, == ,0);
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+
+    g_byte_array_free(tlv, TRUE);
+    g_free(mem);
+}
+
+/*==========================================================================*
+ * read_none
+ *==========================================================================*/
+
+static
+void
+test_read_none(
+    void)
+{
+    NfcTarget* target = test_target_new_tech(NFC_TECHNOLOGY_A,
+        TEST_TARGET_FAIL_ALL);
+    NfcParamPollA poll_a;
+    NfcTagType1* t1;
+
+    /* Initialized right away */
+    test_poll_a(&poll_a);
+    t1 = nfc_tag_t1_new(target, &poll_a, NFC_TAG_READ_NONE);
+    g_assert(t1->tag.flags & NFC_TAG_FLAG_INITIALIZED);
+    g_assert(!t1->tag.ndef);
+    g_assert(!nfc_tag_cache_size(&t1->tag));
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+}
+
+/*==========================================================================*
+ * error
+ *==========================================================================*/
+
+static
+void
+test_error(
+    void)
+{
+    static const guint8 short_resp[] = { TEST_HR0_STATIC, TEST_HR1 };
+    GByteArray* tlv = test_tlv_new(TRUE, 194);
+    guint8* mem = test_mem_new(TEST_TMS_DYNAMIC, tlv);
+    NfcParamPollA poll_a;
+    NfcTarget* target;
+    NfcTagType1* t1;
+
+    test_poll_a(&poll_a);
+
+    /* Transmission fails right away */
+    target = test_target_new_tech(NFC_TECHNOLOGY_A, TEST_TARGET_FAIL_ALL);
+    t1 = nfc_tag_t1_new(target, &poll_a, NFC_TAG_READ_DEFAULT);
+    g_assert(t1->tag.flags & NFC_TAG_FLAG_INITIALIZED);
+    g_assert(!t1->tag.ndef);
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+
+    /* Short RID response */
+    target = test_target_new_tech(NFC_TECHNOLOGY_A, TEST_TARGET_FAIL_NONE);
+    test_target_add_data(target, TEST_ARRAY_AND_SIZE(test_cmd_rid),
+        TEST_ARRAY_AND_SIZE(short_resp));
+    t1 = test_tag_new(target, NULL, NFC_TAG_READ_DEFAULT);
+    g_assert(!t1->tag.ndef);
+    g_assert(!t1->uid.size);
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+
+    /* Short RALL response */
+    target = test_target_new_tech(NFC_TECHNOLOGY_A, TEST_TARGET_FAIL_NONE);
+    test_target_add_data(target, TEST_ARRAY_AND_SIZE(test_cmd_rall),
+        TEST_ARRAY_AND_SIZE(short_resp));
+    t1 = test_tag_new(target, &poll_a, NFC_TAG_READ_DEFAULT);
+    g_assert(!t1->tag.ndef);
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+
+    /* RSEG response with a wrong segment address */
+    target = test_target_new_tech(NFC_TECHNOLOGY_A, TEST_TARGET_FAIL_NONE);
+    test_add_rall(target, TEST_HR0_DYNAMIC, mem);
+    test_add_rseg(target, 1, 0x20, mem);
+    t1 = test_tag_new(target, &poll_a, NFC_TAG_READ_NDEF);
+    g_assert(!test_target_tx_remaining(target));
+    g_assert(!t1->tag.ndef);
+    nfc_tag_unref(&t1->tag);
+    nfc_target_unref(target);
+
+    g_byte_array_free(tlv, TRUE);
+    g_free(mem);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/core/tag_t1/" name
+
+int main(int argc, char* argv[])
+{
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("static"), test_static);
+    g_test_add_func(TEST_("rid"), test_rid);
+    g_test_add_func(TEST_("rseg"), test_rseg);
+    g_test_add_func(TEST_("read8"), test_read8);
+    g_test_add_func(TEST_("full"), test_full);
+    g_test_add_func(TEST_("not_ndef"), test_not_ndef);
+    g_test_add_func(TEST_("read_none"), test_read_none);
+    g_test_add_func(TEST_("error"), test_error);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -354,9 +354,10 @@ static const guint8 test_data_ntag216[] = { /* "https://www.merproject.org" */
 
 static
 NfcTagType2*
-test_tag_new(
+test_tag_new2(
     TestTargetT2* test,
-    guint8 sel_res)
+    guint8 sel_res,
+    NFC_TAG_READ_POLICY policy)
 {
     static const guint8 nfcid1[] = {0x04, 0x9b, 0xfb, 0x4a, 0xeb, 0x2b, 0x80};
     NfcParamPollA param;
@@ -365,11 +366,20 @@ test_tag_new(
     memset(&param, 0, sizeof(param));
     TEST_BYTES_SET(param.nfcid1, nfcid1);
     param.sel_res = sel_res;
-    tag = nfc_tag_t2_new(&test->target, &param);
+    tag = nfc_tag_t2_new2(&test->target, &param, policy);
     g_assert(tag);
     return tag;
 }
 
+static
+NfcTagType2*
+test_tag_new(
+    TestTargetT2* test,
+    guint8 sel_res)
+{
+    return test_tag_new2(test, sel_res, NFC_TAG_READ_NDEF);
+}
+
 /*==========================================================================*
  * null
  *==========================================================================*/
@@ -390,6 +400,10 @@ test_null(
         NFC_TAG_T2_IO_STATUS_FAILURE);
     g_assert(!nfc_tag_t2_write(NULL, 0, 0, NULL, NULL, NULL, NULL));
     g_assert(!nfc_tag_t2_write_data(NULL, 0, NULL, NULL, NULL, NULL));
+    g_assert(!nfc_tag_t2_write_data_seq2(NULL, 0, NULL, NULL,
+        NFC_TAG_T2_WRITE_FLAG_VERIFY, NULL, NULL, NULL));
+    g_assert(!nfc_tag_t2_data_locked(NULL, 0, 1));
+    g_assert(!nfc_tag_t2_cache_size(NULL));
     nfc_target_unref(target);
 }
 
@@ -714,6 +728,11 @@ test_read_data_872_start(
     g_assert(!g_strcmp0(NFC_NDEF_REC_U(rec)->uri,
         "https://www.merproject.org"));
 
+    /* Only the pages holding the NDEF have been allocated */
+    g_assert_cmpuint(nfc_tag_t2_cache_size(t2), < ,t2->data_size);
+    g_assert_cmpuint(nfc_tag_cache_size(&t2->tag), == ,
+        nfc_tag_t2_cache_size(t2));
+
     /* Note: reusing test_read_data_done callback */
     g_assert(nfc_tag_t2_read_data(t2, 0, t2->data_size,
         test_read_data_done, test_destroy_quit_loop, user_data /* loop */));
@@ -733,6 +752,7 @@ test_read_data_872(
         test_read_data_872_start, loop);
 
     test_run(&test_opt, loop);
+    g_assert_cmpuint(nfc_tag_t2_cache_size(t2), > ,t2->data_size);
 
     nfc_tag_remove_handler(tag, init_id);
     nfc_tag_unref(tag);
@@ -1616,6 +1636,653 @@ test_write_data_err2(
     g_main_loop_unref(loop);
 }
 
+/*==========================================================================*
+ * write_verify
+ *==========================================================================*/
+
+#define TEST_WRITE_VERIFY_OFFSET (1)
+
+static
+void
+test_write_verify_done(
+    NfcTagType2* tag,
+    NFC_TAG_T2_IO_STATUS status,
+    guint written,
+    void* user_data)
+{
+    g_assert_cmpint(status, == ,NFC_TAG_T2_IO_STATUS_OK);
+    g_assert_cmpuint(written, == ,sizeof(jolla_rec));
+}
+
+static
+void
+test_write_verify_start(
+    NfcTag* tag,
+    void* user_data)
+{
+    NfcTagType2* t2 = NFC_TAG_T2(tag);
+    GBytes* rec = g_bytes_new_static(TEST_ARRAY_AND_SIZE(jolla_rec));
+
+    g_assert(nfc_tag_t2_write_data_seq2(t2, TEST_WRITE_VERIFY_OFFSET, rec,
+        NULL, NFC_TAG_T2_WRITE_FLAG_VERIFY, test_write_verify_done,
+        test_destroy_quit_loop, user_data /* loop */));
+    g_bytes_unref(rec);
+}
+
+static
+void
+test_write_verify(
+    void)
+{
+    TestTargetT2* test = test_target_t2_new
+        (TEST_ARRAY_AND_SIZE(test_data_google));
+    NfcTagType2* t2 = test_tag_new(test, 0);
+    NfcTag* tag = &t2->tag;
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    guint8 buf[sizeof(jolla_rec)];
+    gulong id = nfc_tag_add_initialized_handler(tag,
+        test_write_verify_start, loop);
+
+    test_run(&test_opt, loop);
+
+    /* Check the contents */
+    g_assert(!memcmp(test->data.bytes + TEST_TARGET_T2_DATA_OFFSET +
+        TEST_WRITE_VERIFY_OFFSET, TEST_ARRAY_AND_SIZE(jolla_rec)));
+
+    /* Verification has refreshed the cache */
+    g_assert(nfc_tag_t2_read_data_sync(t2, TEST_WRITE_VERIFY_OFFSET,
+        sizeof(buf), buf) == NFC_TAG_T2_IO_STATUS_OK);
+    g_assert(!memcmp(buf, jolla_rec, sizeof(buf)));
+
+    nfc_tag_remove_handler(tag, id);
+    nfc_tag_unref(tag);
+    nfc_target_unref(&test->target);
+    g_main_loop_unref(loop);
+}
+
+/*==========================================================================*
+ * write_verify_err
+ *==========================================================================*/
+
+#define TEST_WRITE_VERIFY_ERR_BLOCK (2)
+
+static
+void
+test_write_verify_err_done(
+    NfcTagType2* tag,
+    NFC_TAG_T2_IO_STATUS status,
+    guint written,
+    void* user_data)
+{
+    g_assert_cmpint(status, == ,NFC_TAG_T2_IO_STATUS_VERIFY_FAILED);
+    g_assert_cmpuint(written, == ,TEST_WRITE_VERIFY_ERR_BLOCK *
+        TEST_TARGET_T2_BLOCK_SIZE);
+}
+
+static
+void
+test_write_verify_err_start(
+    NfcTag* tag,
+    void* user_data)
+{
+    NfcTagType2* t2 = NFC_TAG_T2(tag);
+    GBytes* rec = g_bytes_new_static(TEST_ARRAY_AND_SIZE(jolla_rec));
+
+    g_assert(nfc_tag_t2_write_data_seq2(t2, 0, rec, NULL,
+        NFC_TAG_T2_WRITE_FLAG_VERIFY, test_write_verify_err_done,
+        test_destroy_quit_loop, user_data /* loop */));
+    g_bytes_unref(rec);
+}
+
+static
+void
+test_write_verify_err(
+    void)
+{
+    TestTargetT2* test = test_target_t2_new
+        (TEST_ARRAY_AND_SIZE(test_data_empty));
+    NfcTagType2* t2 = test_tag_new(test, 0);
+    NfcTag* tag = &t2->tag;
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    TestTargetT2Error error;
+    gulong id = nfc_tag_add_initialized_handler(tag,
+        test_write_verify_err_start, loop);
+
+    /* The third block is ACKed but not actually written */
+    memset(&error, 0, sizeof(error));
+    error.block = TEST_TARGET_T2_FIRST_DATA_BLOCK +
+        TEST_WRITE_VERIFY_ERR_BLOCK;
+    error.type = TEST_TARGET_T2_ERROR_LOST_WRITE;
+    test->write_error = &error;
+
+    test_run(&test_opt, loop);
+
+    nfc_tag_remove_handler(tag, id);
+    nfc_tag_unref(tag);
+    nfc_target_unref(&test->target);
+    g_main_loop_unref(loop);
+}
+
+/*==========================================================================*
+ * write_tlv
+ *==========================================================================*/
+
+static
+void
+test_write_tlv_done(
+    NfcTagType2* tag,
+    NFC_TAG_T2_IO_STATUS status,
+    guint written,
+    void* user_data)
+{
+    g_assert_cmpint(status, == ,NFC_TAG_T2_IO_STATUS_OK);
+    g_assert_cmpuint(written, == ,sizeof(jolla_rec));
+}
+
+static
+void
+test_write_tlv_start(
+    NfcTag* tag,
+    void* user_data)
+{
+    NfcTagType2* t2 = NFC_TAG_T2(tag);
+    GBytes* rec = g_bytes_new_static(TEST_ARRAY_AND_SIZE(jolla_rec));
+    GBytes* junk = g_bytes_new_static(TEST_ARRAY_AND_SIZE(test_data_empty));
+
+    /* The data must start with NDEF (or other) TLV */
+    g_assert(!nfc_tag_t2_write_tlv_seq(t2, junk, NULL,
+        test_unexpected_write_data_completion, NULL, NULL));
+    g_assert(nfc_tag_t2_write_tlv_seq(t2, rec, NULL, test_write_tlv_done,
+        test_destroy_quit_loop, user_data /* loop */));
+    g_bytes_unref(junk);
+    g_bytes_unref(rec);
+}
+
+static
+void
+test_write_tlv(
+    void)
+{
+    TestTargetT2* test = test_target_t2_new
+        (TEST_ARRAY_AND_SIZE(test_data_google));
+    NfcTagType2* t2 = test_tag_new(test, 0);
+    NfcTag* tag = &t2->tag;
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    gulong id = nfc_tag_add_initialized_handler(tag,
+        test_write_tlv_start, loop);
+
+    g_assert(!nfc_tag_t2_write_tlv_seq(NULL, NULL, NULL, NULL, NULL, NULL));
+    g_assert(!nfc_tag_t2_write_tlv_pending(NULL));
+    test_run(&test_opt, loop);
+
+    g_assert(!nfc_tag_t2_write_tlv_pending(t2));
+    g_assert(!memcmp(test->data.bytes + TEST_TARGET_T2_DATA_OFFSET,
+        TEST_ARRAY_AND_SIZE(jolla_rec)));
+
+    nfc_tag_remove_handler(tag, id);
+    nfc_tag_unref(tag);
+    nfc_target_unref(&test->target);
+    g_main_loop_unref(loop);
+}
+
+/*==========================================================================*
+ * write_tlv_resume
+ *==========================================================================*/
+
+#define TEST_WRITE_TLV_RESUME_ERR_BLOCK (3)
+#define TEST_WRITE_TLV_RESUME_SKIP_BLOCK (1)
+
+static
+void
+test_write_tlv_resume_err(
+    NfcTagType2* tag,
+    NFC_TAG_T2_IO_STATUS status,
+    guint written,
+    void* user_data)
+{
+    g_assert_cmpint(status, == ,NFC_TAG_T2_IO_STATUS_IO_ERROR);
+    g_assert_cmpuint(written, == ,0);
+}
+
+static
+void
+test_write_tlv_resume_start(
+    NfcTag* tag,
+    void* user_data)
+{
+    NfcTagType2* t2 = NFC_TAG_T2(tag);
+    GBytes* rec = g_bytes_new_static(TEST_ARRAY_AND_SIZE(jolla_rec));
+    const gboolean resume = nfc_tag_t2_write_tlv_pending(t2);
+
+    g_assert(nfc_tag_t2_write_tlv_seq(t2, rec, NULL, resume ?
+        test_write_tlv_done : test_write_tlv_resume_err,
+        test_destroy_quit_loop, user_data /* loop */));
+    g_bytes_unref(rec);
+}
+
+static
+void
+test_write_tlv_resume(
+    void)
+{
+    TestTargetT2* test = test_target_t2_new
+        (TEST_ARRAY_AND_SIZE(test_data_google));
+    NfcTagType2* t2 = test_tag_new(test, 0);
+    NfcTag* tag = &t2->tag;
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    guint8* data = test->storage + TEST_TARGET_T2_DATA_OFFSET;
+    guint8* skip = data + TEST_WRITE_TLV_RESUME_SKIP_BLOCK *
+        TEST_TARGET_T2_BLOCK_SIZE;
+    TestTargetT2Error error;
+    gulong id = nfc_tag_add_initialized_handler(tag,
+        test_write_tlv_resume_start, loop);
+
+    /* The tag "leaves" in the middle of the transaction */
+    memset(&error, 0, sizeof(error));
+    error.block = TEST_TARGET_T2_FIRST_DATA_BLOCK +
+        TEST_WRITE_TLV_RESUME_ERR_BLOCK;
+    error.type = TEST_TARGET_T2_ERROR_TRANSMIT;
+    test->write_error = &error;
+    test_run(&test_opt, loop);
+
+    /* NDEF length has been zeroed, the journal is there */
+    g_assert_cmpuint(data[1], == ,0);
+    g_assert(nfc_tag_t2_write_tlv_pending(t2));
+    nfc_tag_remove_handler(tag, id);
+    nfc_tag_unref(tag);
+
+    /* Blocks written before the failure aren't touched on resume */
+    memset(skip, 0xff, TEST_TARGET_T2_BLOCK_SIZE);
+
+    /* Next tap */
+    t2 = test_tag_new(test, 0);
+    tag = &t2->tag;
+    id = nfc_tag_add_initialized_handler(tag,
+        test_write_tlv_resume_start, loop);
+    test_run(&test_opt, loop);
+
+    g_assert(!nfc_tag_t2_write_tlv_pending(t2));
+    g_assert(!memcmp(data, jolla_rec, skip - data));
+    g_assert_cmpuint(skip[0], == ,0xff);
+    g_assert(!memcmp(skip + TEST_TARGET_T2_BLOCK_SIZE, jolla_rec +
+        (skip - data) + TEST_TARGET_T2_BLOCK_SIZE, sizeof(jolla_rec) -
+        (skip - data) - TEST_TARGET_T2_BLOCK_SIZE));
+
+    nfc_tag_remove_handler(tag, id);
+    nfc_tag_unref(tag);
+    nfc_target_unref(&test->target);
+    g_main_loop_unref(loop);
+}
+
+/*==========================================================================*
+ * write_tlv_twice
+ *==========================================================================*/
+
+#define TEST_WRITE_TLV_TWICE_SKIP_BLOCK (1)
+
+static const guint8 test_write_tlv_twice_rec[] = { /* www.jolla.net */
+    0x03, 0x0e, 0xd1, 0x01, 0x0a,  'U', 0x02,  'j',
+     'o',  'l',  'l',  'a',  '.',  'n',  'e',  't',
+    0xfe, 0x00, 0x00, 0x00
+};
+
+static
+void
+test_write_tlv_twice_check(
+    NfcTagType2* t2,
+    const guint8* rec,
+    const char* uri)
+{
+    NfcNdefRec* ndef = t2->tag.ndef;
+    guint8 buf[sizeof(jolla_rec)];
+
+    /* Both the cache and NDEF must reflect what has been written */
+    g_assert_cmpint(nfc_tag_t2_read_data_sync(t2, 0, sizeof(buf), buf), == ,
+        NFC_TAG_T2_IO_STATUS_OK);
+    g_assert(!memcmp(buf, rec, sizeof(buf)));
+    g_assert(NFC_IS_NDEF_REC_U(ndef));
+    g_assert_cmpstr(NFC_NDEF_REC_U(ndef)->uri, == ,uri);
+}
+
+static
+void
+test_write_tlv_twice(
+    void)
+{
+    TestTargetT2* test = test_target_t2_new
+        (TEST_ARRAY_AND_SIZE(test_data_google));
+    NfcTagType2* t2 = test_tag_new(test, 0);
+    NfcTag* tag = &t2->tag;
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    GBytes* rec = g_bytes_new_static
+        (TEST_ARRAY_AND_SIZE(test_write_tlv_twice_rec));
+    TestTargetT2Error error;
+    gulong id = nfc_tag_add_initialized_handler(tag,
+        test_write_tlv_start, loop);
+
+    /* First transaction */
+    test_run(&test_opt, loop);
+    g_assert(!memcmp(test->data.bytes + TEST_TARGET_T2_DATA_OFFSET,
+        TEST_ARRAY_AND_SIZE(jolla_rec)));
+    test_write_tlv_twice_check(t2, jolla_rec, "https://www.jolla.com");
+
+    /* Unchanged blocks must not be written by the second transaction */
+    memset(&error, 0, sizeof(error));
+    error.block = TEST_TARGET_T2_FIRST_DATA_BLOCK +
+        TEST_WRITE_TLV_TWICE_SKIP_BLOCK;
+    error.type = TEST_TARGET_T2_ERROR_TRANSMIT;
+    test->write_error = &error;
+
+    /* Second transaction */
+    g_assert(nfc_tag_t2_write_tlv_seq(t2, rec, NULL, test_write_tlv_done,
+        test_destroy_quit_loop, loop));
+    test_run(&test_opt, loop);
+    g_assert(test->write_error == &error);
+    g_assert(!nfc_tag_t2_write_tlv_pending(t2));
+    g_assert(!memcmp(test->data.bytes + TEST_TARGET_T2_DATA_OFFSET,
+        TEST_ARRAY_AND_SIZE(test_write_tlv_twice_rec)));
+    test_write_tlv_twice_check(t2, test_write_tlv_twice_rec,
+        "https://www.jolla.net");
+
+    nfc_tag_remove_handler(tag, id);
+    nfc_tag_unref(tag);
+    nfc_target_unref(&test->target);
+    g_bytes_unref(rec);
+    g_main_loop_unref(loop);
+}
+
+/*==========================================================================*
+ * locked
+ *==========================================================================*/
+
+typedef struct test_locked_data {
+    const char* name;
+    guint8 patch[2][2]; /* Offset and value, zero offset terminates */
+    guint locked;       /* Write protected data offset */
+    guint unlocked;     /* Writable data offset */
+    NFC_TAG_READ_POLICY policy;
+} TestLockedData;
+
+static const TestLockedData test_locked_data[] = {
+    {
+        /* Static lock bit 8 protects block 8 (data offset 16) */
+        "static", { { 11, 0x01 } }, 16, 12
+    },{
+        /* Lock Control TLV points to byte 144 within the data area,
+         * 16 bytes per lock bit, the first bit covers data offset 48.
+         * The whole tag is read, so the lock bits come from the cache */
+        "dynamic", { { 18, 0x90 }, { 144, 0x01 } }, 48, 64,
+        NFC_TAG_READ_FULL
+    },{
+        /* No write access according to CC */
+        "read_only", { { 15, 0x0f } }, 0, 144
+    },{
+        /* Lock bytes pointed to by Lock Control TLV (data offset 128) */
+        "reserved", { { 18, 0x90 } }, 128, 124
+    }
+};
+
+static
+void
+test_locked_check(
+    NfcTag* tag,
+    void* user_data)
+{
+    NfcTagType2* t2 = NFC_TAG_T2(tag);
+    const TestLockedData* test = g_object_get_data(G_OBJECT(tag), "test");
+    GBytes* bytes = g_bytes_new_static(TEST_ARRAY_AND_SIZE(jolla_rec));
+
+    g_assert(nfc_tag_t2_data_locked(t2, test->locked, 1));
+    g_assert(!nfc_tag_t2_data_locked(t2, test->unlocked, 1));
+    g_assert(!nfc_tag_t2_write_data(t2, test->locked, bytes,
+        test_unexpected_write_data_completion, NULL, NULL));
+    g_bytes_unref(bytes);
+    g_main_loop_quit((GMainLoop*)user_data);
+}
+
+static
+void
+test_locked(
+    gconstpointer data)
+{
+    const TestLockedData* test = data;
+    guint8 buf[sizeof(test_data_empty)];
+    TestTargetT2* target;
+    NfcTagType2* t2;
+    NfcTag* tag;
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    gulong id;
+    guint i;
+
+    memcpy(buf, test_data_empty, sizeof(buf));
+    for (i = 0; i < G_N_ELEMENTS(test->patch) && test->patch[i][0]; i++) {
+        buf[test->patch[i][0]] = test->patch[i][1];
+    }
+
+    target = test_target_t2_new(TEST_ARRAY_AND_SIZE(buf));
+    t2 = test_tag_new2(target, 0, test->policy);
+    tag = &t2->tag;
+    g_assert(!nfc_tag_t2_data_locked(t2, test->locked, 1));
+    g_object_set_data(G_OBJECT(tag), "test", (gpointer)test);
+    id = nfc_tag_add_initialized_handler(tag, test_locked_check, loop);
+
+    test_run(&test_opt, loop);
+
+    nfc_tag_remove_handler(tag, id);
+    nfc_tag_unref(tag);
+    nfc_target_unref(&target->target);
+    g_main_loop_unref(loop);
+}
+
+/*==========================================================================*
+ * locked_fetch
+ *==========================================================================*/
+
+#define TEST_LOCKED_FETCH_LOCK_BLOCK (36) /* Byte 144 */
+#define TEST_LOCKED_FETCH_LOCKED (48)
+#define TEST_LOCKED_FETCH_UNLOCKED (64)
+
+static
+void
+test_locked_fetch_done(
+    NfcTagType2* tag,
+    NFC_TAG_T2_IO_STATUS status,
+    guint written,
+    void* user_data)
+{
+    g_assert_cmpint(status, == ,NFC_TAG_T2_IO_STATUS_FAILURE);
+    g_assert_cmpuint(written, == ,0);
+}
+
+static
+void
+test_locked_fetch_start(
+    NfcTag* tag,
+    void* user_data)
+{
+    NfcTagType2* t2 = NFC_TAG_T2(tag);
+    TestTargetT2* test = TEST_TARGET_T2(tag->target);
+    GBytes* bytes = g_bytes_new_static(TEST_ARRAY_AND_SIZE(jolla_rec));
+
+    /* Initialization hasn't read the lock bytes */
+    g_assert(test->read_error);
+    test->read_error = NULL;
+
+    /* Dynamic lock bits aren't known yet */
+    g_assert(!nfc_tag_t2_data_locked(t2, TEST_LOCKED_FETCH_LOCKED, 1));
+
+    /* The write fetches them and then fails without writing anything */
+    g_assert(nfc_tag_t2_write_data(t2, TEST_LOCKED_FETCH_LOCKED, bytes,
+        test_locked_fetch_done, test_destroy_quit_loop, user_data));
+    g_bytes_unref(bytes);
+}
+
+static
+void
+test_locked_fetch(
+    void)
+{
+    guint8 buf[sizeof(test_data_empty)];
+    guint8* data;
+    TestTargetT2* test;
+    TestTargetT2Error error;
+    NfcTagType2* t2;
+    NfcTag* tag;
+    GBytes* bytes = g_bytes_new_static(TEST_ARRAY_AND_SIZE(jolla_rec));
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    gulong id;
+
+    /* Same as the "dynamic" case of the locked test */
+    memcpy(buf, test_data_empty, sizeof(buf));
+    buf[18] = 0x90;
+    buf[144] = 0x01;
+    test = test_target_t2_new(TEST_ARRAY_AND_SIZE(buf));
+    data = test->storage + TEST_TARGET_T2_DATA_OFFSET;
+
+    /* Lock bytes must not be read at initialization (see the handler) */
+    memset(&error, 0, sizeof(error));
+    error.block = TEST_LOCKED_FETCH_LOCK_BLOCK;
+    error.type = TEST_TARGET_T2_ERROR_TRANSMIT;
+    test->read_error = &error;
+
+    t2 = test_tag_new(test, 0);
+    tag = &t2->tag;
+    id = nfc_tag_add_initialized_handler(tag, test_locked_fetch_start, loop);
+    test_run(&test_opt, loop);
+
+    /* The lock bits have been fetched by the write */
+    g_assert(nfc_tag_t2_data_locked(t2, TEST_LOCKED_FETCH_LOCKED, 1));
+    g_assert(!nfc_tag_t2_data_locked(t2, TEST_LOCKED_FETCH_UNLOCKED, 1));
+    g_assert(!memcmp(data + TEST_LOCKED_FETCH_LOCKED, buf +
+        TEST_TARGET_T2_DATA_OFFSET + TEST_LOCKED_FETCH_LOCKED,
+        sizeof(jolla_rec)));
+
+    /* Now it's rejected up front */
+    g_assert(!nfc_tag_t2_write_data(t2, TEST_LOCKED_FETCH_LOCKED, bytes,
+        test_unexpected_write_data_completion, NULL, NULL));
+
+    nfc_tag_remove_handler(tag, id);
+    nfc_tag_unref(tag);
+    nfc_target_unref(&test->target);
+    g_bytes_unref(bytes);
+    g_main_loop_unref(loop);
+}
+
+/*==========================================================================*
+ * read_none
+ *==========================================================================*/
+
+static
+void
+test_read_data_not_reached(
+    NfcTagType2* tag,
+    NFC_TAG_T2_IO_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data)
+{
+    g_assert_not_reached();
+}
+
+static
+void
+test_read_none(
+    void)
+{
+    static const guint8 nfcid1[] = {0x04, 0x9b, 0xfb, 0x4a, 0xeb, 0x2b, 0x80};
+    TestTargetT2* test = test_target_t2_new
+        (TEST_ARRAY_AND_SIZE(test_data_google));
+    static const guint8 tlv[] = { 0x03, 0x00, 0xfe, 0x00 };
+    GBytes* bytes = g_bytes_new_static(tlv, sizeof(tlv));
+    NfcParamPollA param;
+    NfcTagType2* t2;
+    NfcTag* tag;
+
+    memset(&param, 0, sizeof(param));
+    TEST_BYTES_SET(param.nfcid1, nfcid1);
+    t2 = nfc_tag_t2_new2(&test->target, &param, NFC_TAG_READ_NONE);
+    tag = &t2->tag;
+
+    /* Initialized right away, with nothing read */
+    g_assert(tag->flags & NFC_TAG_FLAG_INITIALIZED);
+    g_assert(!tag->ndef);
+    g_assert(!t2->data_size);
+    g_assert(gutil_data_equal(&t2->serial, &t2->nfcid1));
+    g_assert(nfc_tag_t2_read_data_sync(t2, 0, 1, NULL) ==
+        NFC_TAG_T2_IO_STATUS_BAD_BLOCK);
+
+    /* Data area is unknown, nothing can be read or written */
+    g_assert(!nfc_tag_t2_read_data(t2, 0, 16, test_read_data_not_reached,
+        NULL, NULL));
+    g_assert(!nfc_tag_t2_read_data_seq(t2, 0, t2->data_size, NULL,
+        test_read_data_not_reached, NULL, NULL));
+    g_assert(!nfc_tag_t2_write_data(t2, 0, bytes, NULL, NULL, NULL));
+    g_assert(!nfc_tag_t2_write(t2, 0, NFC_TAG_T2_DATA_BLOCK0, bytes,
+        NULL, NULL, NULL));
+    g_assert(!nfc_tag_t2_write_tlv_seq(t2, bytes, NULL, NULL, NULL, NULL));
+    g_assert(!nfc_tag_t2_data_locked(t2, 0, 4));
+    g_assert_cmpuint(nfc_tag_t2_cache_size(t2), == ,0);
+    g_bytes_unref(bytes);
+
+    nfc_tag_unref(tag);
+    nfc_target_unref(&test->target);
+}
+
+/*==========================================================================*
+ * read_full
+ *==========================================================================*/
+
+static
+void
+test_read_full_start(
+    NfcTag* tag,
+    void* user_data)
+{
+    TestTargetT2* test = TEST_TARGET_T2(tag->target);
+    NfcTagType2* t2 = NFC_TAG_T2(tag);
+    guint8* buf;
+
+    g_assert(tag->ndef);
+    g_assert(t2->data_size == test->data.size - TEST_TARGET_T2_DATA_OFFSET);
+
+    /* Unlike test_read_data, the whole thing must be cached */
+    buf = g_malloc(t2->data_size);
+    g_assert(nfc_tag_t2_read_data_sync(t2, 0, t2->data_size, buf) ==
+        NFC_TAG_T2_IO_STATUS_OK);
+    g_assert(!memcmp(buf, test->data.bytes + TEST_TARGET_T2_DATA_OFFSET,
+        t2->data_size));
+    g_free(buf);
+    g_main_loop_quit((GMainLoop*)user_data);
+}
+
+static
+void
+test_read_full(
+    void)
+{
+    static const guint8 nfcid1[] = {0x04, 0x9b, 0xfb, 0x4a, 0xeb, 0x2b, 0x80};
+    TestTargetT2* test = test_target_t2_new
+        (TEST_ARRAY_AND_SIZE(test_data_google));
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    NfcParamPollA param;
+    NfcTagType2* t2;
+    NfcTag* tag;
+    gulong id;
+
+    memset(&param, 0, sizeof(param));
+    TEST_BYTES_SET(param.nfcid1, nfcid1);
+    t2 = nfc_tag_t2_new2(&test->target, &param, NFC_TAG_READ_FULL);
+    tag = &t2->tag;
+    id = nfc_tag_add_initialized_handler(tag, test_read_full_start, loop);
+
+    test_run(&test_opt, loop);
+
+    nfc_tag_remove_handler(tag, id);
+    nfc_tag_unref(tag);
+    nfc_target_unref(&test->target);
+    g_main_loop_unref(loop);
+}
+
 /*==========================================================================*
  * Common
  *==========================================================================*/
@@ -1624,6 +2291,8 @@ test_write_data_err2(
 
 int main(int argc, char* argv[])
 {
+    guint i;
+
     G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
     g_type_init();
     G_GNUC_END_IGNORE_DEPRECATIONS;
@@ -1642,6 +2311,8 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("read_crc_err"), test_read_crc_err);
     g_test_add_func(TEST_("read_nack"), test_read_nack);
     g_test_add_func(TEST_("read_timeout"), test_read_timeout);
+    g_test_add_func(TEST_("read_none"), test_read_none);
+    g_test_add_func(TEST_("read_full"), test_read_full);
     g_test_add_func(TEST_("write"), test_write);
     g_test_add_func(TEST_("write_data1"), test_write_data1);
     g_test_add_func(TEST_("write_data2"), test_write_data2);
@@ -1649,6 +2320,19 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("write_err1"), test_write_err1);
     g_test_add_func(TEST_("write_data_err1"), test_write_data_err1);
     g_test_add_func(TEST_("write_data_err2"), test_write_data_err2);
+    g_test_add_func(TEST_("write_verify"), test_write_verify);
+    g_test_add_func(TEST_("write_verify_err"), test_write_verify_err);
+    g_test_add_func(TEST_("write_tlv"), test_write_tlv);
+    g_test_add_func(TEST_("write_tlv_resume"), test_write_tlv_resume);
+    g_test_add_func(TEST_("write_tlv_twice"), test_write_tlv_twice);
+    for (i = 0; i < G_N_ELEMENTS(test_locked_data); i++) {
+        const TestLockedData* test = test_locked_data + i;
+        char* path = g_strconcat(TEST_("locked/"), test->name, NULL);
+
+        g_test_add_data_func(path, test, test_locked);
+        g_free(path);
+    }
+    g_test_add_func(TEST_("locked_fetch"), test_locked_fetch);
     test_init(&test_opt, argc, argv);
     return g_test_run();
 }
@@ -46,6 +46,7 @@ static TestOpt test_opt;
 static const guint8 test_resp_ok[] = { 0x90, 0x00 };
 static const guint8 test_resp_not_found[] = { 0x6a, 0x82 };
 static const guint8 test_resp_err[] = { 0x6a, 0x00 };
+static const guint8 test_resp_not_supported[] = { 0x6a, 0x81 };
 static const guint8 test_cmd_select_ndef_app[] = {
     0x00, 0xa4, 0x04, 0x00, 0x07,             /* CLA|INS|P1|P2|Lc  */
     0xd2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01, /* Data */
@@ -58,6 +59,9 @@ static const guint8 test_cmd_select_ndef_cc[] = {
 static const guint8 test_cmd_read_ndef_cc[] = {
     0x00, 0xb0, 0x00, 0x00, 0x0f              /* CLA|INS|P1|P2|Le  */
 };
+static const guint8 test_cmd_read_ndef_cc_sfi[] = {
+    0x00, 0xb0, 0x83, 0x00, 0x0f              /* CLA|INS|P1|P2|Le  */
+};
 static const guint8 test_resp_read_ndef_cc[] = {
     0x00, 0x0f, 0x20, 0x00, 0x3b, 0x00, 0x34, /* Data */
     0x04, 0x06, 0xe1, 0x04, 0x0f, 0xff, 0x00,
@@ -71,6 +75,58 @@ static const guint8 test_resp_read_ndef_cc_v3[] = {
     0xff,
     0x90, 0x00                                /* SW1|SW2 */
 };
+static const guint8 test_resp_read_ndef_cc_v4[] = {
+    0x00, 0x0f, 0x40, 0x00, 0x3b, 0x00, 0x34, /* Data */
+    /*            ^ version 4                */
+    0x04, 0x06, 0xe1, 0x04, 0x0f, 0xff, 0x00,
+    0xff,
+    0x90, 0x00                                /* SW1|SW2 */
+};
+static const guint8 test_resp_read_endef_cc[] = {
+    0x00, 0x11, 0x30, 0x00, 0x3b, 0x00, 0x34, /* Data */
+    0x06, 0x08, 0xe1, 0x04, 0x00, 0x00, 0xff,
+    /* ^ ENDEF File Control TLV              */
+    0xff,
+    0x90, 0x00                                /* SW1|SW2 */
+};
+static const guint8 test_resp_read_endef_cc_v2[] = {
+    0x00, 0x11, 0x20, 0x00, 0x3b, 0x00, 0x34, /* Data */
+    /*            ^ version 2                */
+    0x06, 0x08, 0xe1, 0x04, 0x00, 0x00, 0xff,
+    0xff,
+    0x90, 0x00                                /* SW1|SW2 */
+};
+static const guint8 test_cmd_read_endef_cc_tlv[] = {
+    0x00, 0xb0, 0x00, 0x0f, 0x02              /* CLA|INS|P1|P2|Le  */
+};
+static const guint8 test_resp_read_endef_cc_tlv[] = {
+    0x00, 0x00,                               /* Data */
+    0x90, 0x00                                /* SW1|SW2 */
+};
+static const guint8 test_resp_read_endef_cc_tlv_no_access[] = {
+    0xff, 0x00,                               /* Data */
+    0x90, 0x00                                /* SW1|SW2 */
+};
+static const guint8 test_cmd_read_endef_len[] = {
+    0x00, 0xb0, 0x00, 0x00, 0x04              /* CLA|INS|P1|P2|Le  */
+};
+static const guint8 test_cmd_read_endef_len_sfi[] = {
+    0x00, 0xb0, 0x84, 0x00, 0x04              /* CLA|INS|P1|P2|Le  */
+};
+static const guint8 test_resp_read_endef_len[] = {
+    0x00, 0x00, 0x00, 0x42,                   /* Data */
+    0x90, 0x00                                /* SW1|SW2 */
+};
+static const guint8 test_resp_read_endef_len_too_big[] = {
+    0x01, 0x00, 0x00, 0x00,                   /* Data */
+    0x90, 0x00                                /* SW1|SW2 */
+};
+static const guint8 test_cmd_read_endef_1[] = {
+    0x00, 0xb0, 0x00, 0x04, 0x3b              /* CLA|INS|P1|P2|Le  */
+};
+static const guint8 test_cmd_read_endef_2[] = {
+    0x00, 0xb0, 0x00, 0x3f, 0x07              /* CLA|INS|P1|P2|Le  */
+};
 static const guint8 test_resp_read_ndef_cc_short_mle[] = {
     0x00, 0x0f, 0x20, 0x00, 0x00, 0x00, 0x34, /* Data */
     /*        short MLe ^^    ^^             */
@@ -134,6 +190,17 @@ static const guint8 test_resp_read_ndef_cc_invalid_fid_5[] = {
     0xff,
     0x90, 0x00                                /* SW1|SW2 */
 };
+static const guint8 test_resp_read_ndef_cc_fid_e123[] = {
+    0x00, 0x0f, 0x20, 0x00, 0x3b, 0x00, 0x34, /* Data */
+    0x04, 0x06, 0xe1, 0x23, 0x0f, 0xff, 0x00,
+    /*            ^^    ^^ maps onto SFI 03  */
+    0xff,
+    0x90, 0x00                                /* SW1|SW2 */
+};
+static const guint8 test_cmd_select_ndef_ef_e123[] = {
+    0x00, 0xa4, 0x00, 0x0c, 0x02,             /* CLA|INS|P1|P2|Lc  */
+    0xe1, 0x23                                /* Data */
+};
 static const guint8 test_cmd_select_ndef_ef[] = {
     0x00, 0xa4, 0x00, 0x0c, 0x02,             /* CLA|INS|P1|P2|Lc  */
     0xe1, 0x04                                /* Data */
@@ -141,6 +208,9 @@ static const guint8 test_cmd_select_ndef_ef[] = {
 static const guint8 test_cmd_read_ndef_len[] = {
     0x00, 0xb0, 0x00, 0x00, 0x02              /* CLA|INS|P1|P2|Le  */
 };
+static const guint8 test_cmd_read_ndef_len_sfi[] = {
+    0x00, 0xb0, 0x84, 0x00, 0x02              /* CLA|INS|P1|P2|Le  */
+};
 static const guint8 test_resp_read_ndef_len[] = {
     0x00, 0x42,                               /* Data */
     0x90, 0x00                                /* SW1|SW2 */
@@ -149,6 +219,10 @@ static const guint8 test_resp_read_ndef_len_zero[] = {
     0x00, 0x00,                               /* Data */
     0x90, 0x00                                /* SW1|SW2 */
 };
+static const guint8 test_resp_read_ndef_len_too_big[] = {
+    0x10, 0x00,                               /* Data (exceeds 0FFFh) */
+    0x90, 0x00                                /* SW1|SW2 */
+};
 static const guint8 test_resp_read_ndef_len_wrong[] = {
     0x00,                                     /* Data */
     0x90, 0x00                                /* SW1|SW2 */
@@ -520,6 +594,8 @@ static const GUtilData test_init_data_app_select_resp_empty[] = {
 static const GUtilData test_init_data_cc_not_found[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_not_found) }
 };
@@ -527,6 +603,8 @@ static const GUtilData test_init_data_cc_not_found[] = {
 static const GUtilData test_init_data_cc_select_err[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_err) }
 };
@@ -541,6 +619,8 @@ static const GUtilData test_init_data_cc_select_io_err[] = {
 static const GUtilData test_init_data_cc_short_read[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -550,6 +630,8 @@ static const GUtilData test_init_data_cc_short_read[] = {
 static const GUtilData test_init_data_cc_read_err[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -559,6 +641,8 @@ static const GUtilData test_init_data_cc_read_err[] = {
 static const GUtilData test_init_data_cc_read_io_err[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) }
@@ -568,15 +652,38 @@ static const GUtilData test_init_data_cc_read_io_err[] = {
 static const GUtilData test_init_data_cc_v3[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc_v3) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+static const GUtilData test_init_data_cc_v4[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
-    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc_v3) }
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc_v4) }
 };
 
 static const GUtilData test_init_data_cc_short_mle[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -586,6 +693,8 @@ static const GUtilData test_init_data_cc_short_mle[] = {
 static const GUtilData test_init_data_cc_no_access[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -595,6 +704,8 @@ static const GUtilData test_init_data_cc_no_access[] = {
 static const GUtilData test_init_data_cc_invalid_t[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -604,6 +715,8 @@ static const GUtilData test_init_data_cc_invalid_t[] = {
 static const GUtilData test_init_data_cc_invalid_l[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -613,6 +726,8 @@ static const GUtilData test_init_data_cc_invalid_l[] = {
 static const GUtilData test_init_data_cc_invalid_fid_1[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -622,6 +737,8 @@ static const GUtilData test_init_data_cc_invalid_fid_1[] = {
 static const GUtilData test_init_data_cc_invalid_fid_2[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -631,6 +748,8 @@ static const GUtilData test_init_data_cc_invalid_fid_2[] = {
 static const GUtilData test_init_data_cc_invalid_fid_3[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -640,6 +759,8 @@ static const GUtilData test_init_data_cc_invalid_fid_3[] = {
 static const GUtilData test_init_data_cc_invalid_fid_4[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -649,6 +770,8 @@ static const GUtilData test_init_data_cc_invalid_fid_4[] = {
 static const GUtilData test_init_data_cc_invalid_fid_5[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -658,6 +781,8 @@ static const GUtilData test_init_data_cc_invalid_fid_5[] = {
 static const GUtilData test_init_data_ndef_not_found[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -669,6 +794,8 @@ static const GUtilData test_init_data_ndef_not_found[] = {
 static const GUtilData test_init_data_ndef_select_io_err[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -680,6 +807,8 @@ static const GUtilData test_init_data_ndef_select_io_err[] = {
 static const GUtilData test_init_data_ndef_read_len_zero[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -693,6 +822,8 @@ static const GUtilData test_init_data_ndef_read_len_zero[] = {
 static const GUtilData test_init_data_ndef_read_len_wrong[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -706,6 +837,8 @@ static const GUtilData test_init_data_ndef_read_len_wrong[] = {
 static const GUtilData test_init_data_ndef_read_len_err[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -719,6 +852,8 @@ static const GUtilData test_init_data_ndef_read_len_err[] = {
 static const GUtilData test_init_data_ndef_read_len_io_err[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -732,6 +867,8 @@ static const GUtilData test_init_data_ndef_read_len_io_err[] = {
 static const GUtilData test_init_data_ndef_read_err[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -747,6 +884,8 @@ static const GUtilData test_init_data_ndef_read_err[] = {
 static const GUtilData test_init_data_ndef_read_io_err[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -762,6 +901,8 @@ static const GUtilData test_init_data_ndef_read_io_err[] = {
 static const GUtilData test_init_data_ndef_short[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -774,17 +915,36 @@ static const GUtilData test_init_data_ndef_short[] = {
     { TEST_ARRAY_AND_SIZE(test_resp_ok) }
 };
 
-#define test_init_data_app_select_submit_failure test_init_data_success
-#define test_init_data_cc_select_submit_error test_init_data_success
-#define test_init_data_cc_read_submit_error test_init_data_success
-#define test_init_data_ndef_select_submit_error test_init_data_success
-#define test_init_data_ndef_read_submit_error1 test_init_data_success
-#define test_init_data_ndef_read_submit_error2 test_init_data_success
-#define test_init_data_ndef_read_submit_error3 test_init_data_success
-#define test_init_data_success_no_react test_init_data_success
-static const GUtilData test_init_data_success[] = {
+#define test_init_data_cc_select_submit_error test_init_data_success_select
+#define test_init_data_cc_read_submit_error test_init_data_success_select
+#define test_init_data_ndef_select_submit_error test_init_data_success_select
+#define test_init_data_ndef_read_submit_error1 test_init_data_success_select
+#define test_init_data_ndef_read_submit_error2 test_init_data_success_select
+#define test_init_data_ndef_read_submit_error3 test_init_data_success_select
+static const GUtilData test_init_data_success_select[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+static const GUtilData test_init_data_cc_sfi_short_read[] = {
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
     { TEST_ARRAY_AND_SIZE(test_resp_ok) },
     { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
@@ -799,6 +959,263 @@ static const GUtilData test_init_data_success[] = {
     { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
 };
 
+static const GUtilData test_init_data_cc_sfi_invalid[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc_invalid_t) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc_invalid_t) }
+};
+
+/* The failed READ BINARY consumes the command but not the response */
+static const GUtilData test_init_data_cc_sfi_submit_error[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+static const GUtilData test_init_data_ndef_sfi_err[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+static const GUtilData test_init_data_ndef_sfi_len_zero[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len_zero) },
+    /* Empty NDEF is confirmed by selecting the file */
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len_zero) }
+};
+
+/* NLEN doesn't fit into the NDEF file, must be some other file */
+static const GUtilData test_init_data_ndef_sfi_len_too_big[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len_too_big) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+/* NDEF read fails after NLEN has been read by short EF id */
+static const GUtilData test_init_data_ndef_sfi_read_err[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_err) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+/* The failed READ BINARY consumes the command but not the response */
+static const GUtilData test_init_data_ndef_sfi_read_submit_error1[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+static const GUtilData test_init_data_ndef_sfi_read_submit_error2[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+/* Short EF id of E123 would be the same as the one of E103 */
+static const GUtilData test_init_data_ndef_sfi_none[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc_fid_e123) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef_e123) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+static const GUtilData test_init_data_endef_v2[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc_v2) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc_v2) }
+};
+
+static const GUtilData test_init_data_endef_no_access[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_cc_tlv) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc_tlv_no_access) }
+};
+
+static const GUtilData test_init_data_endef_too_big[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_cc_tlv) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc_tlv) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_len_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_len_too_big) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_len_too_big) }
+};
+
+static const GUtilData test_init_data_endef_len_wrong[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_cc_tlv) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc_tlv) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) }
+};
+
+static const GUtilData test_init_data_endef[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_cc_tlv) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc_tlv) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_len_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+static const GUtilData test_init_data_endef_select[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_not_supported) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_cc_tlv) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc_tlv) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_ef) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_len) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_endef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
+#define test_init_data_app_select_submit_failure test_init_data_success
+#define test_init_data_success_no_react test_init_data_success
+static const GUtilData test_init_data_success[] = {
+    { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+    { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_cc) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_len_sfi) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_len) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_1) },
+    { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_2) },
+    { TEST_ARRAY_AND_SIZE(test_resp_read_ndef_2) }
+};
+
 static const TestInitData init_tests[] = {
 #define TEST_INIT(x,y,z) {#x, TEST_ARRAY_AND_COUNT(test_init_data_##x), y, z}
     TEST_INIT(app_not_found, 0, 0),
@@ -811,7 +1228,8 @@ static const TestInitData init_tests[] = {
     TEST_INIT(cc_short_read, 0, 0),
     TEST_INIT(cc_read_err, 0, 0),
     TEST_INIT(cc_read_io_err, 0, 0),
-    TEST_INIT(cc_v3, 0, 0),
+    TEST_INIT(cc_v3, 0, TEST_INIT_NDEF),
+    TEST_INIT(cc_v4, 0, 0),
     TEST_INIT(cc_short_mle, 0, 0),
     TEST_INIT(cc_no_access, 0, 0),
     TEST_INIT(cc_invalid_t, 0, 0),
@@ -830,14 +1248,31 @@ static const TestInitData init_tests[] = {
     TEST_INIT(ndef_read_err, 0, 0),
     TEST_INIT(ndef_read_io_err, 0, 0),
     TEST_INIT(ndef_short, 0, 0),
+    TEST_INIT(cc_sfi_short_read, 0, TEST_INIT_NDEF),
+    TEST_INIT(cc_sfi_invalid, 0, 0),
+    TEST_INIT(ndef_sfi_err, 0, TEST_INIT_NDEF),
+    TEST_INIT(ndef_sfi_len_zero, 0, 0),
+    TEST_INIT(ndef_sfi_len_too_big, 0, TEST_INIT_NDEF),
+    TEST_INIT(ndef_sfi_read_err, 0, TEST_INIT_NDEF),
+    TEST_INIT(ndef_sfi_none, 0, TEST_INIT_NDEF),
+    TEST_INIT(endef_v2, 0, 0),
+    TEST_INIT(endef_no_access, 0, 0),
+    TEST_INIT(endef_too_big, 0, 0),
+    TEST_INIT(endef_len_wrong, 0, 0),
+    TEST_INIT(endef, 0, TEST_INIT_NDEF),
+    TEST_INIT(endef_select, 0, TEST_INIT_NDEF),
     TEST_INIT(app_select_submit_failure, 1, 0),
-    TEST_INIT(cc_select_submit_error, 2, 0),
-    TEST_INIT(cc_read_submit_error, 3, 0),
-    TEST_INIT(ndef_select_submit_error, 4, 0),
-    TEST_INIT(ndef_read_submit_error1, 5, 0),
-    TEST_INIT(ndef_read_submit_error2, 6, 0),
-    TEST_INIT(ndef_read_submit_error3, 7, 0),
+    TEST_INIT(cc_sfi_submit_error, 2, TEST_INIT_NDEF),
+    TEST_INIT(cc_select_submit_error, 3, 0),
+    TEST_INIT(cc_read_submit_error, 4, 0),
+    TEST_INIT(ndef_select_submit_error, 5, 0),
+    TEST_INIT(ndef_read_submit_error1, 6, 0),
+    TEST_INIT(ndef_read_submit_error2, 7, 0),
+    TEST_INIT(ndef_read_submit_error3, 8, 0),
+    TEST_INIT(ndef_sfi_read_submit_error1, 4, TEST_INIT_NDEF),
+    TEST_INIT(ndef_sfi_read_submit_error2, 5, TEST_INIT_NDEF),
     TEST_INIT(success, 0, TEST_INIT_NDEF),
+    TEST_INIT(success_select, 0, TEST_INIT_NDEF),
     TEST_INIT(success_no_react, 0, TEST_INIT_NDEF | TEST_INIT_FAIL_REACT)
 };
 
@@ -890,6 +1325,74 @@ test_init_seq(
     nfc_target_unref(target);
 }
 
+/*==========================================================================*
+ * init_endef_odo
+ *==========================================================================*/
+
+static
+void
+test_init_endef_odo(
+    void)
+{
+    static const guint8 cc[] = {
+        0x00, 0x11, 0x30, 0xff, 0xff, 0x00, 0x34, /* MLe FFFFh */
+        0x06, 0x08, 0xe1, 0x04, 0x00, 0x01, 0x00,
+        0x00,
+        0x90, 0x00
+    };
+    static const guint8 enlen[] = {
+        0x00, 0x00, 0x80, 0x10,                   /* ENLEN 8010h */
+        0x90, 0x00
+    };
+    static const guint8 read_1[] = {
+        0x00, 0xb0, 0x00, 0x04, 0x00, 0x80, 0x10  /* Case 2e, Le 8010h */
+    };
+    static const guint8 read_2[] = {
+        0x00, 0xb1, 0x00, 0x00, 0x05,             /* CLA|INS|P1|P2|Lc */
+        0x54, 0x03, 0x00, 0x80, 0x00,             /* Offset 8000h */
+        0x18                                      /* Le */
+    };
+    static const guint8 rec[] = {
+        0xc2, 0x03, 0x00, 0x00, 0x80, 0x07,       /* Media-type record */
+        'a', '/', 'b'                             /* with 8007h bytes */
+    };
+    const guint part1 = 0x8000 - 4; /* Offset 8000h can't be in P1-P2 */
+    const guint part2 = 0x8010 - part1;
+    guint8* resp_1 = g_malloc0(part1 + 2);
+    guint8* resp_2 = g_malloc0(part2 + 4);
+    const GUtilData cmd_resp[] = {
+        { TEST_ARRAY_AND_SIZE(test_cmd_select_ndef_app) },
+        { TEST_ARRAY_AND_SIZE(test_resp_ok) },
+        { TEST_ARRAY_AND_SIZE(test_cmd_read_ndef_cc_sfi) },
+        { TEST_ARRAY_AND_SIZE(cc) },
+        { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_cc_tlv) },
+        { TEST_ARRAY_AND_SIZE(test_resp_read_endef_cc_tlv) },
+        { TEST_ARRAY_AND_SIZE(test_cmd_read_endef_len_sfi) },
+        { TEST_ARRAY_AND_SIZE(enlen) },
+        { TEST_ARRAY_AND_SIZE(read_1) },
+        { resp_1, part1 + 2 },
+        { TEST_ARRAY_AND_SIZE(read_2) },
+        { resp_2, part2 + 4 }
+    };
+    TestInitData test;
+
+    memcpy(resp_1, rec, sizeof(rec));
+    resp_1[part1] = 0x90;
+    resp_2[0] = 0x53;      /* Discretionary data */
+    resp_2[1] = part2;
+    resp_2[part2 + 2] = 0x90;
+
+    memset(&test, 0, sizeof(test));
+    test.name = "endef_odo";
+    test.cmd_resp = cmd_resp;
+    test.count = G_N_ELEMENTS(cmd_resp);
+    test.flags = TEST_INIT_NDEF;
+    test_init_seq(&test);
+
+    g_free(resp_1);
+    g_free(resp_2);
+}
+
 /*==========================================================================*
  * apdu_ok
  *==========================================================================*/
@@ -1431,6 +1934,16 @@ test_encode_case4e(
           0xf0, 0xf1, 0xf2, 0xf3, 0xf3, 0xf5, 0xf6, 0xf7,
           0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff,
           0x01, 0x00 /* Le */ };
+    static const guint8 lc_5_le_257[] =
+        /* CLA   INS    P1    P2    00   LC1   LC2  BODY...  LE1 LE2 */
+        { 0x01, 0x02, 0x03, 0x04, 0x00, 0x00, 0x05,
+          0x54, 0x03, 0x00, 0x80, 0x00,
+          0x01, 0x01 /* Le */ };
+    static const guint8 lc_5_le_65536[] =
+        /* CLA   INS    P1    P2    00   LC1   LC2  BODY...  LE1 LE2 */
+        { 0x01, 0x02, 0x03, 0x04, 0x00, 0x00, 0x05,
+          0x54, 0x03, 0x00, 0x80, 0x00,
+          0x00, 0x00 /* Le */ };
     GByteArray* a = g_byte_array_new();
 
     g_assert(nfc_tag_t4_build_apdu(a, 0x01, 0x02, 0x03, 0x04,
@@ -1443,6 +1956,17 @@ test_encode_case4e(
     g_assert_cmpuint(a->len, == ,sizeof(lc_256_le_256));
     g_assert(!memcmp(a->data, TEST_ARRAY_AND_SIZE(lc_256_le_256)));
 
+    /* Short Lc but Le doesn't fit into one byte */
+    g_assert(nfc_tag_t4_build_apdu(a, 0x01, 0x02, 0x03, 0x04,
+        5, lc_5_le_257 + 7, 257));
+    g_assert_cmpuint(a->len, == ,sizeof(lc_5_le_257));
+    g_assert(!memcmp(a->data, TEST_ARRAY_AND_SIZE(lc_5_le_257)));
+
+    g_assert(nfc_tag_t4_build_apdu(a, 0x01, 0x02, 0x03, 0x04,
+        5, lc_5_le_65536 + 7, 65536));
+    g_assert_cmpuint(a->len, == ,sizeof(lc_5_le_65536));
+    g_assert(!memcmp(a->data, TEST_ARRAY_AND_SIZE(lc_5_le_65536)));
+
     g_byte_array_free(a, TRUE);
 }
 
@@ -1479,6 +2003,7 @@ int main(int argc, char* argv[])
         g_test_add_data_func(path, test, test_apdu_ok);
         g_free(path);
     }
+    g_test_add_func(TEST_("init_endef_odo"), test_init_endef_odo);
     g_test_add_func(TEST_("apdu_fail"), test_apdu_fail);
     g_test_add_func(TEST_("encode/fail"), test_encode_fail);
     g_test_add_func(TEST_("encode/case1"), test_encode_case1);
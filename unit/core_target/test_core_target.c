@@ -164,6 +164,7 @@ typedef struct test_target {
     gboolean fail_transmit;
     guint transmit_id;
     GSList* transmit_responses;
+    GByteArray* sent; /* First byte of each transmitted frame */
     guint succeeded;
     guint failed;
 } TestTarget;
@@ -218,6 +219,9 @@ test_target_transmit(
             (target, data, len);
     } else {
         g_assert(!self->transmit_id);
+        if (len) {
+            g_byte_array_append(self->sent, data, 1);
+        }
         self->transmit_id = g_idle_add(test_target_transmit_cb, self);
         return TRUE;
     }
@@ -247,6 +251,7 @@ void
 test_target_init(
     TestTarget* self)
 {
+    self->sent = g_byte_array_new();
 }
 
 static
@@ -260,6 +265,7 @@ test_target_finalize(
         g_source_remove(self->transmit_id);
     }
     g_slist_free_full(self->transmit_responses, test_transmit_response_free1);
+    g_byte_array_free(self->sent, TRUE);
     G_OBJECT_CLASS(test_target_parent_class)->finalize(object);
 }
 
@@ -381,6 +387,8 @@ test_null(
     /* Public interfaces are NULL tolerant */
     g_assert(!nfc_target_ref(NULL));
     g_assert(!nfc_target_transmit(NULL, NULL, 0, NULL, NULL, NULL, NULL));
+    g_assert(!nfc_target_transmit2(NULL, NULL, 0, NULL,
+        NFC_TARGET_PRIORITY_DEFAULT, 0, NULL, NULL, NULL));
     g_assert(!nfc_target_add_gone_handler(NULL, NULL, NULL));
     g_assert(!nfc_target_add_sequence_handler(NULL, NULL, NULL));
     g_assert(!nfc_target_generate_id(NULL));
@@ -398,6 +406,9 @@ test_null(
     g_assert(!nfc_target_sequence_new(NULL));
     g_assert(!nfc_target_sequence_new2(NULL, NFC_SEQUENCE_FLAGS_NONE));
     g_assert(!nfc_target_sequence_flags(NULL));
+    g_assert(!nfc_target_sequence_renew(NULL));
+    g_assert(!nfc_target_add_lease_expired_handler(NULL, NULL, NULL));
+    nfc_target_sequence_set_lease(NULL, 0, 0);
     nfc_target_sequence_free(NULL);
 }
 
@@ -889,6 +900,206 @@ test_sequence2(
     g_main_loop_unref(loop);
 }
 
+/*==========================================================================*
+ * priority
+ *==========================================================================*/
+
+static
+void
+test_priority_expired_resp(
+    NfcTarget* target,
+    NFC_TRANSMIT_STATUS status,
+    const void* data,
+    guint len,
+    void* user_data)
+{
+    TestTarget* test = TEST_TARGET(target);
+
+    g_assert(status == NFC_TRANSMIT_STATUS_TIMEOUT);
+    test->failed++;
+}
+
+static
+void
+test_priority(
+    void)
+{
+    static const guint8 d1[] = { 0x01 };
+    static const guint8 d2[] = { 0x02 };
+    static const guint8 d3[] = { 0x03 };
+    static const guint8 d4[] = { 0x04 };
+    static const guint8 d5[] = { 0x05 };
+    static const guint8 d6[] = { 0x06 };
+    static const guint8 d7[] = { 0x07 };
+    static const guint8 d8[] = { 0x08 };
+    static const guint8 expected[] = { 0x01, 0x08, 0x06, 0x05, 0x04, 0x03,
+        0x02 };
+    TestTarget* test = test_target_new();
+    NfcTarget* target = &test->target;
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    NfcTargetSequence* seq;
+
+    nfc_target_set_transmit_timeout(target, 0);
+
+    /* This one gets submitted right away */
+    g_assert(nfc_target_transmit(target, TEST_ARRAY_AND_SIZE(d1), NULL,
+        NULL, NULL, NULL));
+
+    /* These get queued */
+    g_assert(nfc_target_transmit2(target, TEST_ARRAY_AND_SIZE(d2), NULL,
+        NFC_TARGET_PRIORITY_BACKGROUND, 0, NULL, test_quit_loop, loop));
+    g_assert(nfc_target_transmit2(target, TEST_ARRAY_AND_SIZE(d3), NULL,
+        NFC_TARGET_PRIORITY_NORMAL, 0, NULL, NULL, NULL));
+    g_assert(nfc_target_transmit2(target, TEST_ARRAY_AND_SIZE(d4), NULL,
+        NFC_TARGET_PRIORITY_INTERACTIVE, 0, NULL, NULL, NULL));
+    g_assert(nfc_target_transmit2(target, TEST_ARRAY_AND_SIZE(d5), NULL,
+        NFC_TARGET_PRIORITY_INTERACTIVE, 10000, NULL, NULL, NULL));
+    g_assert(nfc_target_transmit2(target, TEST_ARRAY_AND_SIZE(d6), NULL,
+        NFC_TARGET_PRIORITY_INTERACTIVE, 5000, NULL, NULL, NULL));
+
+    /* This one expires before it gets a chance to run */
+    g_assert(nfc_target_transmit2(target, TEST_ARRAY_AND_SIZE(d7), NULL,
+        NFC_TARGET_PRIORITY_BACKGROUND, 1, test_priority_expired_resp,
+        NULL, NULL));
+
+    /*
+     * There's no active sequence, so this one becomes active right away
+     * and gets served first despite being submitted last.
+     */
+    seq = nfc_target_sequence_new2(target, NFC_SEQUENCE_FLAG_INTERACTIVE);
+    g_assert(nfc_target_sequence_flags(seq) == NFC_SEQUENCE_FLAG_INTERACTIVE);
+    g_assert(nfc_target_transmit(target, TEST_ARRAY_AND_SIZE(d8), seq,
+        NULL, NULL, NULL));
+    nfc_target_sequence_free(seq);
+
+    g_usleep(2000);
+    test_run(&test_opt, loop);
+
+    g_assert_cmpuint(test->failed, == ,1);
+    g_assert_cmpuint(test->sent->len, == ,sizeof(expected));
+    g_assert(!memcmp(test->sent->data, expected, sizeof(expected)));
+
+    nfc_target_unref(target);
+    g_main_loop_unref(loop);
+}
+
+/*==========================================================================*
+ * priority_fifo
+ *==========================================================================*/
+
+static
+void
+test_priority_fifo(
+    void)
+{
+    static const guint8 d1[] = { 0x01 };
+    static const guint8 d2[] = { 0x02 };
+    static const guint8 d3[] = { 0x03 };
+    static const guint8 d4[] = { 0x04 };
+    static const guint8 expected[] = { 0x01, 0x02, 0x03, 0x04 };
+    TestTarget* test = test_target_new();
+    NfcTarget* target = &test->target;
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    NfcTargetSequence* seq;
+
+    nfc_target_set_transmit_timeout(target, 0);
+
+    /* This one gets submitted right away */
+    g_assert(nfc_target_transmit(target, TEST_ARRAY_AND_SIZE(d1), NULL,
+        NULL, NULL, NULL));
+
+    /* Priorities don't reorder requests within the same sequence */
+    seq = nfc_target_sequence_new(target);
+    g_assert(nfc_target_transmit2(target, TEST_ARRAY_AND_SIZE(d2), seq,
+        NFC_TARGET_PRIORITY_BACKGROUND, 0, NULL, NULL, NULL));
+    g_assert(nfc_target_transmit2(target, TEST_ARRAY_AND_SIZE(d3), seq,
+        NFC_TARGET_PRIORITY_NORMAL, 0, NULL, NULL, NULL));
+    g_assert(nfc_target_transmit2(target, TEST_ARRAY_AND_SIZE(d4), seq,
+        NFC_TARGET_PRIORITY_INTERACTIVE, 5000, NULL, test_quit_loop, loop));
+
+    test_run(&test_opt, loop);
+    nfc_target_sequence_free(seq);
+
+    g_assert_cmpuint(test->sent->len, == ,sizeof(expected));
+    g_assert(!memcmp(test->sent->data, expected, sizeof(expected)));
+
+    nfc_target_unref(target);
+    g_main_loop_unref(loop);
+}
+
+/*==========================================================================*
+ * lease
+ *==========================================================================*/
+
+static
+void
+test_lease_expired(
+    NfcTarget* target,
+    NfcTargetSequence* seq,
+    void* user_data)
+{
+    GDEBUG("Lease expired");
+    g_assert(target->sequence == seq);
+
+    /* Someone else is waiting, can't renew */
+    g_assert(!nfc_target_sequence_renew(seq));
+    (*(int*)user_data)++;
+}
+
+static
+void
+test_lease(
+    void)
+{
+    static const guint8 d1[] = { 0x01 };
+    static const guint8 d2[] = { 0x02 };
+    static const guint8 d3[] = { 0x03 };
+    static const guint8 expected[] = { 0x01, 0x02, 0x03 };
+    TestTarget* test = test_target_new();
+    NfcTarget* target = &test->target;
+    GMainLoop* loop = g_main_loop_new(NULL, TRUE);
+    NfcTargetSequence* seq;
+    int expired = 0;
+    gulong id;
+
+    nfc_target_set_transmit_timeout(target, 0);
+    g_assert(!nfc_target_add_lease_expired_handler(target, NULL, NULL));
+    id = nfc_target_add_lease_expired_handler(target, test_lease_expired,
+        &expired);
+
+    seq = nfc_target_sequence_new(target);
+    g_assert(target->sequence == seq);
+    nfc_target_sequence_set_lease(seq, 10, 0);
+    g_assert(nfc_target_sequence_renew(seq));
+
+    /* The second one waits for the sequence to yield */
+    g_assert(nfc_target_transmit(target, TEST_ARRAY_AND_SIZE(d1), seq,
+        NULL, NULL, NULL));
+    g_assert(nfc_target_transmit(target, TEST_ARRAY_AND_SIZE(d2), NULL,
+        NULL, test_quit_loop, loop));
+
+    test_run(&test_opt, loop);
+    g_assert_cmpint(expired, == ,1);
+    g_assert(target->sequence != seq);
+    g_assert(!nfc_target_sequence_renew(seq));
+
+    /* The sequence becomes current again when its turn comes */
+    g_assert(nfc_target_transmit(target, TEST_ARRAY_AND_SIZE(d3), seq,
+        NULL, test_quit_loop, loop));
+
+    test_run(&test_opt, loop);
+    g_assert(target->sequence == seq);
+    g_assert(nfc_target_sequence_renew(seq));
+    nfc_target_sequence_free(seq);
+
+    g_assert_cmpuint(test->sent->len, == ,sizeof(expected));
+    g_assert(!memcmp(test->sent->data, expected, sizeof(expected)));
+
+    nfc_target_remove_handler(target, id);
+    nfc_target_unref(target);
+    g_main_loop_unref(loop);
+}
+
 /*==========================================================================*
  * reactivate
  *==========================================================================*/
@@ -1057,6 +1268,9 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("sequence_basic"), test_sequence_basic);
     g_test_add_func(TEST_("sequence_ok"), test_sequence_ok);
     g_test_add_func(TEST_("sequence2"), test_sequence2);
+    g_test_add_func(TEST_("priority"), test_priority);
+    g_test_add_func(TEST_("priority_fifo"), test_priority_fifo);
+    g_test_add_func(TEST_("lease"), test_lease);
     g_test_add_func(TEST_("reactivate"), test_reactivate);
     g_test_add_func(TEST_("reactivate_ok"), test_reactivate_ok);
     g_test_add_func(TEST_("reactivate_gone"), test_reactivate_gone);
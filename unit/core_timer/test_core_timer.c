@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "test_common.h"
+
+#include "nfc_timer.h"
+
+static TestOpt test_opt;
+
+typedef struct test_timer_data {
+    GMainLoop* loop;
+    guint id;
+    guint other_id;
+    guint count;
+    guint stop_after;
+} TestTimerData;
+
+static
+gboolean
+test_timer_quit(
+    gpointer user_data)
+{
+    TestTimerData* test = user_data;
+
+    test->count++;
+    if (test->count >= test->stop_after) {
+        test->id = 0;
+        g_main_loop_quit(test->loop);
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+static
+gboolean
+test_timer_unreachable(
+    gpointer user_data)
+{
+    g_assert_not_reached();
+    return G_SOURCE_REMOVE;
+}
+
+static
+gboolean
+test_timer_count(
+    gpointer user_data)
+{
+    TestTimerData* test = user_data;
+
+    test->count++;
+    return G_SOURCE_REMOVE;
+}
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    const guint wakeups = nfc_timer_wakeups();
+
+    g_assert_cmpuint(nfc_timer_add(0, 0, NULL, NULL), == ,0);
+    nfc_timer_remove(0);
+    nfc_timer_remove(1234);
+    g_assert_cmpuint(nfc_timer_wakeups(), == ,wakeups);
+}
+
+/*==========================================================================*
+ * basic
+ *==========================================================================*/
+
+static
+void
+test_basic(
+    void)
+{
+    TestTimerData test;
+    guint wakeups;
+
+    memset(&test, 0, sizeof(test));
+    test.loop = g_main_loop_new(NULL, TRUE);
+    test.stop_after = 3;
+    wakeups = nfc_timer_wakeups();
+
+    /* Re-armed twice, then removed */
+    test.id = nfc_timer_add(10, 0, test_timer_quit, &test);
+    g_assert(test.id);
+    test_run(&test_opt, test.loop);
+    g_assert_cmpuint(test.count, == ,3);
+    g_assert_cmpuint(nfc_timer_wakeups(), >= ,wakeups + 3);
+    g_assert_cmpuint(nfc_timer_wakeups_per_minute(), >= ,3);
+
+    /* The wheel is gone with the last timer, nothing is pending */
+    g_assert(!g_main_context_pending(NULL));
+    g_main_loop_unref(test.loop);
+}
+
+/*==========================================================================*
+ * coalesce
+ *==========================================================================*/
+
+static
+void
+test_coalesce(
+    void)
+{
+    TestTimerData test;
+    guint wakeups;
+
+    memset(&test, 0, sizeof(test));
+    test.loop = g_main_loop_new(NULL, TRUE);
+    test.stop_after = 1;
+    wakeups = nfc_timer_wakeups();
+
+    /* Both deadlines pass within the slack of the first timer */
+    g_assert(nfc_timer_add(10, 1000, test_timer_count, &test));
+    test.id = nfc_timer_add(20, 1000, test_timer_quit, &test);
+    test_run(&test_opt, test.loop);
+    g_assert_cmpuint(test.count, == ,2);
+    g_assert_cmpuint(nfc_timer_wakeups(), == ,wakeups + 1);
+    g_main_loop_unref(test.loop);
+}
+
+/*==========================================================================*
+ * remove
+ *==========================================================================*/
+
+static
+gboolean
+test_remove_other(
+    gpointer user_data)
+{
+    TestTimerData* test = user_data;
+
+    /* Both timers are due at the same time */
+    nfc_timer_remove(test->other_id);
+    test->other_id = 0;
+
+    /* Removing itself and returning G_SOURCE_CONTINUE is fine too */
+    nfc_timer_remove(test->id);
+    test->id = 0;
+    test_quit_later(test->loop);
+    return G_SOURCE_CONTINUE;
+}
+
+static
+void
+test_remove(
+    void)
+{
+    TestTimerData test;
+
+    memset(&test, 0, sizeof(test));
+    test.loop = g_main_loop_new(NULL, TRUE);
+
+    /* Removed before it fires */
+    nfc_timer_remove(nfc_timer_add(0, 0, test_timer_unreachable, NULL));
+    g_assert(!g_main_context_pending(NULL));
+
+    test.id = nfc_timer_add(0, 0, test_remove_other, &test);
+    test.other_id = nfc_timer_add(0, 0, test_timer_unreachable, NULL);
+    test_run(&test_opt, test.loop);
+    g_assert(!test.id);
+    g_assert(!test.other_id);
+    g_main_loop_unref(test.loop);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/core/timer/" name
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("basic"), test_basic);
+    g_test_add_func(TEST_("coalesce"), test_coalesce);
+    g_test_add_func(TEST_("remove"), test_remove);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test_common.h"
+#include "test_dbus.h"
+
+#include "common/access_cache.h"
+
+static TestOpt test_opt;
+
+#ifdef HAVE_DBUSACCESS
+
+#define TEST_BUS DA_BUS_SYSTEM
+#define TEST_POLICY DA_POLICY_VERSION ";group(privileged)=allow"
+#define TEST_GONE ":1.666"
+
+enum test_action {
+    TEST_ACTION_ONE = 1,
+    TEST_ACTION_TWO
+};
+
+static const DA_ACTION test_actions[] = {
+    { "One", TEST_ACTION_ONE, 0 },
+    { "Two", TEST_ACTION_TWO, 1 },
+    { NULL }
+};
+
+static int test_check_count;
+static DA_ACCESS test_access;
+
+/*==========================================================================*
+ * Stubs
+ *==========================================================================*/
+
+struct da_policy {
+    gint refcount;
+};
+
+DAPeer*
+da_peer_get(
+    DA_BUS bus,
+    const char* name)
+{
+    static DAPeer test_peer;
+
+    return g_strcmp0(name, TEST_GONE) ? &test_peer : NULL;
+}
+
+DAPolicy*
+da_policy_new_full(
+    const char* spec,
+    const DA_ACTION* actions)
+{
+    DAPolicy* policy = g_new0(DAPolicy, 1);
+
+    g_atomic_int_set(&policy->refcount, 1);
+    return policy;
+}
+
+DAPolicy*
+da_policy_ref(
+    DAPolicy* policy)
+{
+    if (policy) {
+        g_atomic_int_inc(&policy->refcount);
+    }
+    return policy;
+}
+
+void
+da_policy_unref(
+    DAPolicy* policy)
+{
+    if (policy && g_atomic_int_dec_and_test(&policy->refcount)) {
+        g_free(policy);
+    }
+}
+
+DA_ACCESS
+da_policy_check(
+    const DAPolicy* policy,
+    const DACred* cred,
+    guint action,
+    const char* arg,
+    DA_ACCESS def)
+{
+    test_check_count++;
+    return test_access;
+}
+
+/*==========================================================================*
+ * null
+ *==========================================================================*/
+
+static
+void
+test_null(
+    void)
+{
+    access_cache_free(NULL);
+    access_cache_set_connection(NULL, NULL);
+    access_cache_set_policy(NULL, NULL);
+    access_cache_drop_peer(NULL, NULL);
+}
+
+/*==========================================================================*
+ * basic
+ *==========================================================================*/
+
+static
+void
+test_basic(
+    void)
+{
+    AccessCache* cache = access_cache_new(TEST_BUS, TEST_POLICY,
+        test_actions);
+    DAPolicy* policy = da_policy_new_full(TEST_POLICY, test_actions);
+    const char* name = ":1.0";
+
+    test_check_count = 0;
+    test_access = DA_ACCESS_DENY;
+
+    /* The second check doesn't evaluate the policy */
+    g_assert_cmpint(access_cache_check(cache, name, TEST_ACTION_ONE, NULL,
+        DA_ACCESS_ALLOW), == ,DA_ACCESS_DENY);
+    g_assert_cmpint(test_check_count, == ,1);
+    test_access = DA_ACCESS_ALLOW;
+    g_assert_cmpint(access_cache_check(cache, name, TEST_ACTION_ONE, NULL,
+        DA_ACCESS_ALLOW), == ,DA_ACCESS_DENY);
+    g_assert_cmpint(test_check_count, == ,1);
+
+    /* Another action and another argument are evaluated separately */
+    g_assert_cmpint(access_cache_check(cache, name, TEST_ACTION_TWO, "a",
+        DA_ACCESS_ALLOW), == ,DA_ACCESS_ALLOW);
+    g_assert_cmpint(test_check_count, == ,2);
+    g_assert_cmpint(access_cache_check(cache, name, TEST_ACTION_TWO, "a",
+        DA_ACCESS_ALLOW), == ,DA_ACCESS_ALLOW);
+    g_assert_cmpint(test_check_count, == ,2);
+    g_assert_cmpint(access_cache_check(cache, name, TEST_ACTION_TWO, "b",
+        DA_ACCESS_ALLOW), == ,DA_ACCESS_ALLOW);
+    g_assert_cmpint(test_check_count, == ,3);
+
+    /* Dropping the peer forces re-evaluation */
+    access_cache_drop_peer(cache, name);
+    access_cache_drop_peer(cache, name);
+    g_assert_cmpint(access_cache_check(cache, name, TEST_ACTION_ONE, NULL,
+        DA_ACCESS_ALLOW), == ,DA_ACCESS_ALLOW);
+    g_assert_cmpint(test_check_count, == ,4);
+
+    /* So does replacing the policy */
+    test_access = DA_ACCESS_DENY;
+    access_cache_set_policy(cache, policy);
+    access_cache_set_policy(cache, policy);
+    g_assert_cmpint(access_cache_check(cache, name, TEST_ACTION_ONE, NULL,
+        DA_ACCESS_ALLOW), == ,DA_ACCESS_DENY);
+    g_assert_cmpint(test_check_count, == ,5);
+
+    /* Nothing is cached for the peers which are gone */
+    g_assert_cmpint(access_cache_check(cache, TEST_GONE, TEST_ACTION_ONE,
+        NULL, DA_ACCESS_ALLOW), == ,DA_ACCESS_DENY);
+    g_assert_cmpint(test_check_count, == ,5);
+
+    da_policy_unref(policy);
+    access_cache_free(cache);
+}
+
+/*==========================================================================*
+ * cred
+ *==========================================================================*/
+
+static
+void
+test_cred(
+    void)
+{
+    AccessCache* cache = access_cache_new(TEST_BUS, TEST_POLICY,
+        test_actions);
+    DACred cred;
+
+    memset(&cred, 0, sizeof(cred));
+    test_check_count = 0;
+    test_access = DA_ACCESS_DENY;
+
+    /* Nothing is cached, the policy is evaluated every time */
+    g_assert_cmpint(access_cache_check_cred(cache, &cred, TEST_ACTION_ONE,
+        NULL, DA_ACCESS_ALLOW), == ,DA_ACCESS_DENY);
+    g_assert_cmpint(test_check_count, == ,1);
+    test_access = DA_ACCESS_ALLOW;
+    g_assert_cmpint(access_cache_check_cred(cache, &cred, TEST_ACTION_ONE,
+        NULL, DA_ACCESS_ALLOW), == ,DA_ACCESS_ALLOW);
+    g_assert_cmpint(test_check_count, == ,2);
+
+    access_cache_free(cache);
+}
+
+/*==========================================================================*
+ * name_owner_changed
+ *==========================================================================*/
+
+typedef struct test_name_owner_changed_data {
+    GMainLoop* loop;
+    AccessCache* cache;
+} TestNameOwnerChangedData;
+
+#define TEST_NAME ":1.1"
+#define TEST_OTHER_NAME ":1.2"
+
+static
+void
+test_name_owner_changed_signal(
+    GDBusConnection* connection,
+    const char* sender,
+    const char* path,
+    const char* iface,
+    const char* name,
+    GVariant* args,
+    gpointer user_data)
+{
+    TestNameOwnerChangedData* test = user_data;
+    const char* owner = NULL;
+    const char* new_owner = NULL;
+
+    /* This handler is invoked after the one registered by the cache */
+    g_variant_get(args, "(&s&s&s)", &owner, NULL, &new_owner);
+    g_assert_cmpint(access_cache_check(test->cache, TEST_NAME,
+        TEST_ACTION_ONE, NULL, DA_ACCESS_ALLOW), == ,DA_ACCESS_ALLOW);
+    if (g_strcmp0(owner, TEST_NAME)) {
+        /* Other names don't affect this one */
+        g_assert_cmpint(test_check_count, == ,1);
+    } else if (new_owner[0]) {
+        /* Still cached */
+        g_assert_cmpint(test_check_count, == ,1);
+    } else {
+        /* Re-evaluated */
+        g_assert_cmpint(test_check_count, == ,2);
+        test_quit_later(test->loop);
+    }
+}
+
+static
+void
+test_name_owner_changed_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestNameOwnerChangedData* test = user_data;
+
+    /* Entries cached without the connection are dropped */
+    g_assert_cmpint(access_cache_check(test->cache, TEST_NAME,
+        TEST_ACTION_ONE, NULL, DA_ACCESS_ALLOW), == ,DA_ACCESS_ALLOW);
+    g_assert_cmpint(test_check_count, == ,1);
+    access_cache_set_connection(test->cache, server);
+    access_cache_set_connection(test->cache, server);
+    test_check_count = 0;
+
+    /* Populate the cache (which starts watching the name) */
+    g_assert_cmpint(access_cache_check(test->cache, TEST_NAME,
+        TEST_ACTION_ONE, NULL, DA_ACCESS_ALLOW), == ,DA_ACCESS_ALLOW);
+    g_assert_cmpint(access_cache_check(test->cache, TEST_NAME,
+        TEST_ACTION_ONE, NULL, DA_ACCESS_ALLOW), == ,DA_ACCESS_ALLOW);
+    g_assert_cmpint(test_check_count, == ,1);
+    g_assert(g_dbus_connection_signal_subscribe(server, NULL,
+        "org.freedesktop.DBus", "NameOwnerChanged", "/org/freedesktop/DBus",
+        NULL, G_DBUS_SIGNAL_FLAGS_NONE, test_name_owner_changed_signal,
+        test, NULL));
+
+    /* Another name is gone, which has nothing to do with this one */
+    g_assert(g_dbus_connection_emit_signal(client, NULL,
+        "/org/freedesktop/DBus", "org.freedesktop.DBus", "NameOwnerChanged",
+        g_variant_new("(sss)", TEST_OTHER_NAME, TEST_OTHER_NAME, ""), NULL));
+
+    /* Name owner change without losing the owner is ignored */
+    g_assert(g_dbus_connection_emit_signal(client, NULL,
+        "/org/freedesktop/DBus", "org.freedesktop.DBus", "NameOwnerChanged",
+        g_variant_new("(sss)", TEST_NAME, "", TEST_NAME), NULL));
+
+    /* And this one drops the cached decisions */
+    g_assert(g_dbus_connection_emit_signal(client, NULL,
+        "/org/freedesktop/DBus", "org.freedesktop.DBus", "NameOwnerChanged",
+        g_variant_new("(sss)", TEST_NAME, TEST_NAME, ""), NULL));
+}
+
+static
+void
+test_name_owner_changed(
+    void)
+{
+    TestNameOwnerChangedData test;
+    TestDBus* dbus;
+
+    test_check_count = 0;
+    test_access = DA_ACCESS_ALLOW;
+    test.cache = access_cache_new(TEST_BUS, TEST_POLICY, test_actions);
+    test.loop = g_main_loop_new(NULL, TRUE);
+    dbus = test_dbus_new(test_name_owner_changed_start, &test);
+    test_run(&test_opt, test.loop);
+    access_cache_free(test.cache);
+    test_dbus_free(dbus);
+    g_main_loop_unref(test.loop);
+}
+
+#endif /* HAVE_DBUSACCESS */
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_(name) "/plugins/common/access_cache/" name
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+#ifdef HAVE_DBUSACCESS
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("basic"), test_basic);
+    g_test_add_func(TEST_("cred"), test_cred);
+    g_test_add_func(TEST_("name_owner_changed"), test_name_owner_changed);
+#endif
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
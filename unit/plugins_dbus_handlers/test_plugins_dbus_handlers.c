@@ -38,6 +38,8 @@
 #include "test_dbus.h"
 #include "test.handler.h"
 
+#include <gutil_strv.h>
+
 #include <glib/gstdio.h>
 
 static TestOpt test_opt;
@@ -165,7 +167,9 @@ test_null(
 {
     g_assert(!dbus_handlers_new(NULL, NULL));
     dbus_handlers_run(NULL, NULL);
+    dbus_handlers_prewarm(NULL);
     dbus_handlers_free(NULL);
+    g_assert(!dbus_handlers_config_load_prewarm(NULL));
 }
 
 /*==========================================================================*
@@ -742,6 +746,513 @@ test_no_return(
     test_data_cleanup(&test);
 }
 
+/*==========================================================================*
+ * cache
+ *==========================================================================*/
+
+typedef struct test_cache_data {
+    TestData data;
+    int refused;
+    int handled;
+    int notified;
+} TestCacheData;
+
+static
+gboolean
+test_cache_donthandle(
+    TestHandler* object,
+    GDBusMethodInvocation* call,
+    GVariant* data,
+    gpointer user_data)
+{
+    TestCacheData* test = user_data;
+
+    test->refused++;
+    GDEBUG("Not handling the message (%d)", test->refused);
+    test_handler_complete_handle(object, call, FALSE);
+    return TRUE;
+}
+
+static
+gboolean
+test_cache_handle(
+    TestHandler* object,
+    GDBusMethodInvocation* call,
+    GVariant* data,
+    gpointer user_data)
+{
+    TestCacheData* test = user_data;
+
+    test->handled++;
+    GDEBUG("Handling the message (%d)", test->handled);
+    test_handler_complete_handle2(object, call, TRUE);
+    return TRUE;
+}
+
+static
+gboolean
+test_cache_notify(
+    TestHandler* object,
+    GDBusMethodInvocation* call,
+    gboolean handled,
+    GVariant* data,
+    gpointer user_data)
+{
+    TestCacheData* test = user_data;
+
+    g_assert(handled);
+    test_handler_complete_notify(object, call);
+    if (++(test->notified) == 1) {
+        /* The second run goes straight to the handler that took it */
+        GDEBUG("Again");
+        g_assert_cmpint(test->refused, == ,1);
+        g_assert_cmpint(test->handled, == ,1);
+        dbus_handlers_run(test->data.handlers, test->data.rec);
+    } else {
+        GDEBUG("Done");
+        g_assert_cmpint(test->refused, == ,1);
+        g_assert_cmpint(test->handled, == ,2);
+        test_quit_later_n(test->data.loop, 100);
+    }
+    return TRUE;
+}
+
+static
+void
+test_cache(
+    void)
+{
+    TestCacheData test;
+    TestDBus* dbus;
+    char* fname2;
+    char* fname3;
+    const char* config1 =
+        "[Handler]\n"
+        "Service = " TEST_SERVICE "\n"
+        "Method = " TEST_INTERFACE ".Handle\n"
+        "Path = " TEST_PATH "\n";
+
+    const char* config2 =
+        "[Handler]\n"
+        "Service = " TEST_SERVICE "\n"
+        "Method = " TEST_INTERFACE ".Handle2\n"
+        "Path = " TEST_PATH "\n";
+
+    const char* config3 =
+        "[Listener]\n"
+        "Service = " TEST_SERVICE "\n"
+        "Method = " TEST_INTERFACE ".Notify\n"
+        "Path = " TEST_PATH "\n";
+
+    memset(&test, 0, sizeof(test));
+    test_data_init(&test.data, config1);
+    fname2 = g_build_filename(test.data.dir, "test2.conf", NULL);
+    fname3 = g_build_filename(test.data.dir, "test3.conf", NULL);
+    g_assert(g_file_set_contents(fname2, config2, -1, NULL));
+    g_assert(g_file_set_contents(fname3, config3, -1, NULL));
+
+    g_assert(g_signal_connect(test.data.dbus_handler, "handle-handle",
+        G_CALLBACK(test_cache_donthandle), &test));
+    g_assert(g_signal_connect(test.data.dbus_handler, "handle-handle2",
+        G_CALLBACK(test_cache_handle), &test));
+    g_assert(g_signal_connect(test.data.dbus_handler, "handle-notify",
+        G_CALLBACK(test_cache_notify), &test));
+
+    dbus = test_dbus_new(test_start, &test.data);
+    test_run(&test_opt, test.data.loop);
+    g_assert_cmpint(test.notified, == ,2);
+    test_dbus_free(dbus);
+    g_unlink(fname2);
+    g_unlink(fname3);
+    g_free(fname2);
+    g_free(fname3);
+    test_data_cleanup(&test.data);
+}
+
+/*==========================================================================*
+ * cache/script
+ *
+ * Handle and Handle2 accept or refuse the NDEF according to the test,
+ * and the calls are logged as 'a'/'A' and 'b'/'B' respectively, lower
+ * case meaning that the NDEF was refused. The listener starts the next
+ * run until the test says it's done.
+ *==========================================================================*/
+
+typedef struct test_cache_script TestCacheScript;
+
+struct test_cache_script {
+    TestData data;
+    GString* log;
+    int handle_calls;
+    int handle2_calls;
+    int runs;
+    gboolean (*accept_handle)(TestCacheScript* test);
+    gboolean (*accept_handle2)(TestCacheScript* test);
+    gboolean (*next)(TestCacheScript* test);
+};
+
+static
+gboolean
+test_cache_script_handle(
+    TestHandler* object,
+    GDBusMethodInvocation* call,
+    GVariant* data,
+    gpointer user_data)
+{
+    TestCacheScript* test = user_data;
+    gboolean accept;
+
+    test->handle_calls++;
+    accept = test->accept_handle(test);
+    g_string_append_c(test->log, accept ? 'A' : 'a');
+    test_handler_complete_handle(object, call, accept);
+    return TRUE;
+}
+
+static
+gboolean
+test_cache_script_handle2(
+    TestHandler* object,
+    GDBusMethodInvocation* call,
+    GVariant* data,
+    gpointer user_data)
+{
+    TestCacheScript* test = user_data;
+    gboolean accept;
+
+    test->handle2_calls++;
+    accept = test->accept_handle2(test);
+    g_string_append_c(test->log, accept ? 'B' : 'b');
+    test_handler_complete_handle2(object, call, accept);
+    return TRUE;
+}
+
+static
+gboolean
+test_cache_script_notify(
+    TestHandler* object,
+    GDBusMethodInvocation* call,
+    gboolean handled,
+    GVariant* data,
+    gpointer user_data)
+{
+    TestCacheScript* test = user_data;
+
+    test_handler_complete_notify(object, call);
+    test->runs++;
+    GDEBUG("Run %d: %s", test->runs, test->log->str);
+    if (!test->next(test)) {
+        GDEBUG("Done");
+        test_quit_later_n(test->data.loop, 100);
+    }
+    return TRUE;
+}
+
+static
+gboolean
+test_cache_script_accept(
+    TestCacheScript* test)
+{
+    return TRUE;
+}
+
+static
+gboolean
+test_cache_script_refuse(
+    TestCacheScript* test)
+{
+    return FALSE;
+}
+
+static
+void
+test_cache_script_run(
+    TestCacheScript* test)
+{
+    /* Handlers are called in the order of their config files */
+    static const char config1[] =
+        "[Handler]\n"
+        "Service = " TEST_SERVICE "\n"
+        "Method = " TEST_INTERFACE ".Handle\n"
+        "Path = " TEST_PATH "\n";
+    static const char config2[] =
+        "[Handler]\n"
+        "Service = " TEST_SERVICE "\n"
+        "Method = " TEST_INTERFACE ".Handle2\n"
+        "Path = " TEST_PATH "\n"
+        "[Listener]\n"
+        "Service = " TEST_SERVICE "\n"
+        "Method = " TEST_INTERFACE ".Notify\n"
+        "Path = " TEST_PATH "\n";
+    char* fname2;
+    TestDBus* dbus;
+
+    test_data_init(&test->data, config1);
+    fname2 = g_build_filename(test->data.dir, "test2.conf", NULL);
+    g_assert(g_file_set_contents(fname2, config2, -1, NULL));
+    test->log = g_string_new(NULL);
+
+    g_assert(g_signal_connect(test->data.dbus_handler, "handle-handle",
+        G_CALLBACK(test_cache_script_handle), test));
+    g_assert(g_signal_connect(test->data.dbus_handler, "handle-handle2",
+        G_CALLBACK(test_cache_script_handle2), test));
+    g_assert(g_signal_connect(test->data.dbus_handler, "handle-notify",
+        G_CALLBACK(test_cache_script_notify), test));
+
+    dbus = test_dbus_new(test_start, &test->data);
+    test_run(&test_opt, test->data.loop);
+    test_dbus_free(dbus);
+    g_unlink(fname2);
+    g_free(fname2);
+    test_data_cleanup(&test->data);
+}
+
+/*==========================================================================*
+ * cache/fallback
+ *==========================================================================*/
+
+static
+gboolean
+test_cache_fallback_handle(
+    TestCacheScript* test)
+{
+    /* Refuses the first time, accepts afterwards */
+    return test->handle_calls > 1;
+}
+
+static
+gboolean
+test_cache_fallback_handle2(
+    TestCacheScript* test)
+{
+    /* Accepts the first time, refuses afterwards */
+    return test->handle2_calls == 1;
+}
+
+static
+gboolean
+test_cache_fallback_next(
+    TestCacheScript* test)
+{
+    if (test->runs < 3) {
+        dbus_handlers_run(test->data.handlers, test->data.rec);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static
+void
+test_cache_fallback(
+    void)
+{
+    TestCacheScript test;
+
+    memset(&test, 0, sizeof(test));
+    test.accept_handle = test_cache_fallback_handle;
+    test.accept_handle2 = test_cache_fallback_handle2;
+    test.next = test_cache_fallback_next;
+    test_cache_script_run(&test);
+
+    /*
+     * 1. Handle refuses, Handle2 accepts
+     * 2. Cached Handle2 refuses, Handle (not Handle2 again) accepts
+     * 3. Handle is now cached and accepts
+     */
+    g_assert_cmpint(test.runs, == ,3);
+    g_assert_cmpstr(test.log->str, == ,"aBbAA");
+    g_string_free(test.log, TRUE);
+}
+
+/*==========================================================================*
+ * cache/chain
+ *==========================================================================*/
+
+static
+gboolean
+test_cache_chain_next(
+    TestCacheScript* test)
+{
+    if (test->runs == 1) {
+        /* Another Handle2 handler in front of the chain */
+        static const char config[] =
+            "[Handler]\n"
+            "Service = " TEST_SERVICE "\n"
+            "Method = " TEST_INTERFACE ".Handle2\n"
+            "Path = " TEST_PATH "\n";
+        char* fname = g_build_filename(test->data.dir, "a.conf", NULL);
+
+        g_assert(g_file_set_contents(fname, config, -1, NULL));
+        dbus_handlers_run(test->data.handlers, test->data.rec);
+        g_unlink(fname);
+        g_free(fname);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static
+void
+test_cache_chain(
+    void)
+{
+    TestCacheScript test;
+
+    memset(&test, 0, sizeof(test));
+    test.accept_handle = test_cache_script_refuse;
+    test.accept_handle2 = test_cache_script_accept;
+    test.next = test_cache_chain_next;
+    test_cache_script_run(&test);
+
+    /*
+     * The chain has changed, the remembered position (second) is
+     * ignored and the chain is walked from the top. Otherwise it
+     * would have been "aBaB".
+     */
+    g_assert_cmpint(test.runs, == ,2);
+    g_assert_cmpstr(test.log->str, == ,"aBB");
+    g_string_free(test.log, TRUE);
+}
+
+/*==========================================================================*
+ * cache/evict
+ *==========================================================================*/
+
+#define TEST_CACHE_EVICT_COUNT (65)
+
+static
+void
+test_cache_evict_run(
+    TestCacheScript* test,
+    guint8 id)
+{
+    /* Same type as test_ndef_data, different payload */
+    const guint8 data[] = { 0xd1, 0x01, 0x01, 'x', id };
+    GUtilData bytes;
+    NfcNdefRec* rec;
+
+    TEST_BYTES_SET(bytes, data);
+    rec = nfc_ndef_rec_new(&bytes);
+    g_assert(rec);
+    dbus_handlers_run(test->data.handlers, rec);
+    nfc_ndef_rec_unref(rec);
+}
+
+static
+gboolean
+test_cache_evict_next(
+    TestCacheScript* test)
+{
+    if (test->runs < TEST_CACHE_EVICT_COUNT) {
+        test_cache_evict_run(test, test->runs);
+        return TRUE;
+    } else if (test->runs == TEST_CACHE_EVICT_COUNT) {
+        /* Mark the end of the first pass */
+        g_string_append_c(test->log, '|');
+        /* The second one is still there */
+        test_cache_evict_run(test, 1);
+        return TRUE;
+    } else if (test->runs == TEST_CACHE_EVICT_COUNT + 1) {
+        /* But the first one (test_ndef_data) has been evicted */
+        g_string_append_c(test->log, '|');
+        dbus_handlers_run(test->data.handlers, test->data.rec);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static
+void
+test_cache_evict(
+    void)
+{
+    TestCacheScript test;
+    const char* tail;
+
+    memset(&test, 0, sizeof(test));
+    test.accept_handle = test_cache_script_refuse;
+    test.accept_handle2 = test_cache_script_accept;
+    test.next = test_cache_evict_next;
+    test_cache_script_run(&test);
+
+    /*
+     * The very first run is with test_ndef_data, after that there are
+     * 64 more distinct NDEFs, 65 in total. Each of them had to go
+     * through the whole chain.
+     */
+    g_assert_cmpint(test.runs, == ,TEST_CACHE_EVICT_COUNT + 2);
+    g_assert_cmpuint(test.log->len, == ,2 * TEST_CACHE_EVICT_COUNT + 5);
+    tail = test.log->str + 2 * TEST_CACHE_EVICT_COUNT;
+    g_assert_cmpstr(tail, == ,"|B|aB");
+    g_assert_cmpint(test.handle_calls, == ,TEST_CACHE_EVICT_COUNT + 1);
+    g_assert_cmpint(test.handle2_calls, == ,TEST_CACHE_EVICT_COUNT + 2);
+    g_string_free(test.log, TRUE);
+}
+
+/*==========================================================================*
+ * prewarm
+ *==========================================================================*/
+
+static
+void
+test_prewarm_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestData* test = user_data;
+    GStrV* services;
+
+    g_assert(g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON
+        (test->dbus_handler), server, TEST_PATH, NULL));
+
+    /* Duplicates are dropped, invalid names are ignored */
+    services = dbus_handlers_config_load_prewarm(test->dir);
+    g_assert(services);
+    g_assert_cmpuint(gutil_strv_length(services), == ,1);
+    g_assert_cmpstr(services[0], == ,TEST_SERVICE);
+    g_strfreev(services);
+
+    test->handlers = dbus_handlers_new(client, test->dir);
+    g_assert(test->handlers);
+    dbus_handlers_prewarm(test->handlers);
+    dbus_handlers_run(test->handlers, test->rec);
+}
+
+static
+void
+test_prewarm(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+    const char* config =
+        "[Common]\n"
+        "Prewarm = true\n"
+        "[Handler]\n"
+        "Service = " TEST_SERVICE "\n"
+        "Method = " TEST_INTERFACE ".Handle\n"
+        "Path = " TEST_PATH "\n"
+        "[Listener]\n"
+        "Service = " TEST_SERVICE "\n"
+        "Method = " TEST_INTERFACE ".Notify\n"
+        "Path = " TEST_PATH "\n"
+        "Prewarm = false\n"
+        "[Foo]\n"
+        "Service = invalid..name\n";
+
+    test_data_init(&test, config);
+    g_assert(g_signal_connect(test.dbus_handler, "handle-handle",
+        G_CALLBACK(test_handler_listener_handle), &test));
+    g_assert(g_signal_connect(test.dbus_handler, "handle-notify",
+        G_CALLBACK(test_handler_listener_notify), &test));
+
+    dbus = test_dbus_new(test_prewarm_start, &test);
+    test_run(&test_opt, test.loop);
+    test_dbus_free(dbus);
+    test_data_cleanup(&test);
+}
+
 /*==========================================================================*
  * Common
  *==========================================================================*/
@@ -764,6 +1275,11 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("listeners"), test_listeners);
     g_test_add_func(TEST_("invalid_return"), test_invalid_return);
     g_test_add_func(TEST_("no_return"), test_no_return);
+    g_test_add_func(TEST_("cache/basic"), test_cache);
+    g_test_add_func(TEST_("cache/fallback"), test_cache_fallback);
+    g_test_add_func(TEST_("cache/chain"), test_cache_chain);
+    g_test_add_func(TEST_("cache/evict"), test_cache_evict);
+    g_test_add_func(TEST_("prewarm"), test_prewarm);
     test_init(&test_opt, argc, argv);
     return g_test_run();
 }
@@ -49,7 +49,7 @@
 #include "test_dbus.h"
 
 #define NFC_ADAPTER_INTERFACE "org.sailfishos.nfc.Adapter"
-#define NFC_ADAPTER_INTERFACE_VERSION  (2)
+#define NFC_ADAPTER_INTERFACE_VERSION  (3)
 
 static TestOpt test_opt;
 
@@ -1195,6 +1195,81 @@ test_peer_removed(
     test_dbus_free(dbus);
 }
 
+/*==========================================================================*
+ * properties_changed
+ *==========================================================================*/
+
+static
+void
+test_properties_changed_handler(
+    GDBusConnection* connection,
+    const char* sender,
+    const char* path,
+    const char* iface,
+    const char* name,
+    GVariant* args,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    const char* interface = NULL;
+    GVariant* changed = NULL;
+    gboolean powered = FALSE;
+    guint mode = 0;
+
+    g_variant_get(args, "(&s@a{sv}as)", &interface, &changed, NULL);
+    GDEBUG("%s", interface);
+    g_assert_cmpstr(interface, ==, NFC_ADAPTER_INTERFACE);
+
+    /* Both changes are delivered by a single signal */
+    g_assert_cmpuint(g_variant_n_children(changed), ==, 2);
+    g_assert(g_variant_lookup(changed, "Powered", "b", &powered));
+    g_assert(g_variant_lookup(changed, "Mode", "u", &mode));
+    g_assert(powered);
+    g_assert_cmpuint(mode, ==, NFC_MODE_READER_WRITER);
+    g_variant_unref(changed);
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_properties_changed_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestData* test = user_data;
+
+    test->service = dbus_service_adapter_new(test->adapter, server);
+    g_assert(test->service);
+
+    g_assert(g_dbus_connection_signal_subscribe(client, NULL,
+        "org.freedesktop.DBus.Properties", "PropertiesChanged",
+        dbus_service_adapter_path(test->service), NULL,
+        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE, test_properties_changed_handler,
+        test, NULL));
+
+    /* Power up the adapter and change its mode */
+    g_assert(!test->adapter->powered);
+    g_assert(!test->adapter->mode);
+    nfc_adapter_power_notify(test->adapter, TRUE, FALSE);
+    nfc_adapter_mode_notify(test->adapter, NFC_MODE_READER_WRITER, FALSE);
+}
+
+static
+void
+test_properties_changed(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+
+    test_data_init(&test);
+    dbus = test_dbus_new(test_properties_changed_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+}
+
 /*==========================================================================*
  * Common
  *==========================================================================*/
@@ -1226,6 +1301,7 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("tag_removed"), test_tag_removed);
     g_test_add_func(TEST_("peer_added"), test_peer_added);
     g_test_add_func(TEST_("peer_removed"), test_peer_removed);
+    g_test_add_func(TEST_("properties_changed"), test_properties_changed);
     test_init(&test_opt, argc, argv);
     return g_test_run();
 }
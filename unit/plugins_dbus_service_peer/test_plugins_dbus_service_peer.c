@@ -46,7 +46,7 @@
 #include "test_dbus.h"
 
 #define NFC_PEER_INTERFACE "org.sailfishos.nfc.Peer"
-#define NFC_PEER_INTERFACE_VERSION  (1)
+#define NFC_PEER_INTERFACE_VERSION  (2)
 #define NFC_PEER_DEFAULT_WKS \
     ((1 << NFC_LLC_SAP_SDP) | \
      (1 << NFC_LLC_SAP_SNEP) | \
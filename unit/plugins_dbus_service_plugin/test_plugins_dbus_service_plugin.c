@@ -36,18 +36,25 @@
 #include "nfc_types_p.h"
 #include "internal/nfc_manager_i.h"
 #include "nfc_adapter.h"
+#include "nfc_config.h"
 #include "nfc_version.h"
 
-#include "dbus_service/dbus_service.h"
+#include "dbus_service/dbus_service_plugin_p.h"
 #include "dbus_service/plugin.h"
 
 #include "test_common.h"
 #include "test_adapter.h"
+#include "test_target.h"
 #include "test_dbus.h"
 #include "test_dbus_name.h"
 
 #include <gutil_misc.h>
 
+#include <gio/gunixfdlist.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
 #define NFC_DAEMON_PATH "/"
 #define NFC_DAEMON_INTERFACE "org.sailfishos.nfc.Daemon"
 #define NFC_DAEMON_INTERFACE_VERSION  (3)
@@ -63,6 +70,8 @@ typedef struct test_data {
     NfcManager* manager;
     NfcAdapter* adapter;
     GDBusConnection* client; /* Owned by TestDBus */
+    GDBusConnection* private_client;
+    GAsyncReadyCallback private_connected;
 } TestData;
 
 static
@@ -101,6 +110,10 @@ void
 test_data_cleanup(
     TestData* test)
 {
+    if (test->private_client) {
+        g_dbus_connection_close_sync(test->private_client, NULL, NULL);
+        g_object_unref(test->private_client);
+    }
     nfc_adapter_unref(test->adapter);
     nfc_manager_stop(test->manager, 0);
     nfc_manager_unref(test->manager);
@@ -670,6 +683,189 @@ test_unregister_svc_err(
     test_dbus_free(dbus);
 }
 
+/*==========================================================================*
+ * publish_ndef
+ *==========================================================================*/
+
+static const char test_publish_ndef_name[] = "urn:nfc:xsn:test";
+static const guint8 test_publish_ndef_data[] = {
+    0xd1, 0x01, 0x04, 0x54, 0x02, 0x65, 0x6e, 0x78
+};
+
+static
+void
+test_publish_ndef_call(
+    TestData* test,
+    const char* name,
+    GAsyncReadyCallback callback)
+{
+    test_call(test, "PublishNdef", g_variant_new("(s@ay)", name,
+        g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+        test_publish_ndef_data, sizeof(test_publish_ndef_data), 1)),
+        callback);
+}
+
+static
+void
+test_publish_ndef_check_error(
+    GObject* object,
+    GAsyncResult* result,
+    DBusServiceError code)
+{
+    GError* error = NULL;
+
+    g_assert(!g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+       result, &error));
+    g_assert(g_error_matches(error, DBUS_SERVICE_ERROR, code));
+    g_error_free(error);
+}
+
+static
+void
+test_publish_ndef_unpublish_again_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+
+    test_publish_ndef_check_error(object, result,
+        DBUS_SERVICE_ERROR_NOT_FOUND);
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_publish_ndef_unpublish_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GVariant* ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+       result, NULL);
+
+    g_assert(ret);
+    g_variant_unref(ret);
+    g_assert_cmpuint(gutil_ptrv_length(test->manager->services), == ,0);
+
+    /* It's not there anymore */
+    test_call(test, "UnpublishNdef", g_variant_new("(s)",
+        test_publish_ndef_name), test_publish_ndef_unpublish_again_done);
+}
+
+static
+void
+test_publish_ndef_taken_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+
+    dbus_sender = ":1.0";
+    test_publish_ndef_check_error(object, result,
+        DBUS_SERVICE_ERROR_ALREADY_EXISTS);
+    test_call(test, "UnpublishNdef", g_variant_new("(s)",
+        test_publish_ndef_name), test_publish_ndef_unpublish_done);
+}
+
+static
+void
+test_publish_ndef_update_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GVariant* ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+       result, NULL);
+    guint sap = 0;
+
+    g_assert(ret);
+    g_variant_get(ret, "(u)", &sap);
+    g_variant_unref(ret);
+    g_assert_cmpuint(sap, == ,test->manager->services[0]->sap);
+    g_assert_cmpuint(gutil_ptrv_length(test->manager->services), == ,1);
+
+    /* Another client can't take it over */
+    dbus_sender = ":1.1";
+    test_publish_ndef_call(test, test_publish_ndef_name,
+        test_publish_ndef_taken_done);
+}
+
+static
+void
+test_publish_ndef_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GVariant* ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+       result, NULL);
+    NfcPeerService* const* services = test->manager->services;
+    guint sap = 0;
+
+    g_assert(ret);
+    g_variant_get(ret, "(u)", &sap);
+    g_variant_unref(ret);
+    GDEBUG("sap=%u", sap);
+    g_assert(sap);
+    g_assert_cmpuint(gutil_ptrv_length(services), == ,1);
+    g_assert_cmpuint(services[0]->sap, == ,sap);
+    g_assert_cmpstr(services[0]->name, == ,test_publish_ndef_name);
+
+    /* Publishing again replaces the data */
+    test_publish_ndef_call(test, test_publish_ndef_name,
+        test_publish_ndef_update_done);
+}
+
+static
+void
+test_publish_ndef_default_sn_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+
+    test_publish_ndef_check_error(object, result,
+        DBUS_SERVICE_ERROR_INVALID_ARGS);
+    test_publish_ndef_call(test, test_publish_ndef_name,
+        test_publish_ndef_done);
+}
+
+static
+void
+test_publish_ndef_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestData* test = user_data;
+
+    /* Default SNEP server can't be used for that */
+    test->client = client;
+    test_publish_ndef_call(test, NFC_LLC_NAME_SNEP,
+        test_publish_ndef_default_sn_done);
+}
+
+static
+void
+test_publish_ndef(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+
+    test_data_init(&test);
+    dbus = test_dbus_new2(test_start, test_publish_ndef_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+}
+
 /*==========================================================================*
  * adapter_added
  *==========================================================================*/
@@ -784,6 +980,931 @@ test_adapter_removed(
     test_dbus_free(dbus);
 }
 
+/*==========================================================================*
+ * object_manager
+ *==========================================================================*/
+
+static
+void
+test_object_manager_removed(
+    GDBusConnection* connection,
+    const char* sender,
+    const char* path,
+    const char* iface,
+    const char* name,
+    GVariant* args,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    const char* object = NULL;
+    gchar** ifaces = NULL;
+
+    g_variant_get(args, "(&o^as)", &object, &ifaces);
+    GDEBUG("%s removed", object);
+    g_assert_cmpstr(object + 1, ==, test->adapter->name);
+    g_assert_cmpuint(g_strv_length(ifaces), ==, 1);
+    g_assert_cmpstr(ifaces[0], ==, "org.sailfishos.nfc.Adapter");
+    g_strfreev(ifaces);
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_object_manager_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GError* error = NULL;
+    GVariant* var = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+        result, &error);
+    GVariant* objects;
+    GVariant* ifaces;
+    GVariant* props;
+    const char* path = NULL;
+    gboolean enabled = FALSE;
+
+    g_assert(var);
+    g_assert(!error);
+
+    /* The only managed object is the adapter */
+    objects = g_variant_get_child_value(var, 0);
+    g_assert_cmpuint(g_variant_n_children(objects), ==, 1);
+    g_variant_get_child(objects, 0, "{&o@a{sa{sv}}}", &path, &ifaces);
+    GDEBUG("%s", path);
+    g_assert_cmpstr(path + 1, ==, test->adapter->name);
+    g_assert((props = g_variant_lookup_value(ifaces,
+        "org.sailfishos.nfc.Adapter", G_VARIANT_TYPE_VARDICT)) != NULL);
+    g_assert(g_variant_lookup(props, "Enabled", "b", &enabled));
+    g_assert(enabled == test->adapter->enabled);
+    g_variant_unref(props);
+    g_variant_unref(ifaces);
+    g_variant_unref(objects);
+    g_variant_unref(var);
+
+    /* Removing the adapter emits InterfacesRemoved */
+    g_assert(g_dbus_connection_signal_subscribe(test->client, NULL,
+        "org.freedesktop.DBus.ObjectManager", "InterfacesRemoved",
+        NFC_DAEMON_PATH, NULL, G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
+        test_object_manager_removed, test, NULL));
+    nfc_manager_remove_adapter(test->manager, test->adapter->name);
+}
+
+static
+void
+test_object_manager_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    g_dbus_connection_call(client, NULL, NFC_DAEMON_PATH,
+        "org.freedesktop.DBus.ObjectManager", "GetManagedObjects", NULL,
+        NULL, G_DBUS_CALL_FLAGS_NONE, TEST_DBUS_TIMEOUT, NULL,
+        test_object_manager_done, user_data);
+}
+
+static
+void
+test_object_manager(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+
+    test_data_init(&test);
+    dbus = test_dbus_new2(test_start, test_object_manager_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+}
+
+/*==========================================================================*
+ * private_connection
+ *==========================================================================*/
+
+static const char test_private_bus_xml[] =
+    "<node>"
+    "  <interface name='org.freedesktop.DBus'>"
+    "    <method name='GetConnectionUnixUser'>"
+    "      <arg name='name' type='s' direction='in'/>"
+    "      <arg name='uid' type='u' direction='out'/>"
+    "    </method>"
+    "  </interface>"
+    "</node>";
+
+static
+void
+test_private_bus_method_call(
+    GDBusConnection* connection,
+    const char* sender,
+    const char* path,
+    const char* iface,
+    const char* method,
+    GVariant* args,
+    GDBusMethodInvocation* call,
+    gpointer user_data)
+{
+    const char* name = NULL;
+
+    /* Pretend to be the bus daemon */
+    g_assert_cmpstr(method, == ,"GetConnectionUnixUser");
+    g_variant_get(args, "(&s)", &name);
+    g_assert_cmpstr(name, == ,dbus_sender);
+    g_dbus_method_invocation_return_value(call,
+        g_variant_new("(u)", (guint32)getuid()));
+}
+
+static const GDBusInterfaceVTable test_private_bus_vtable = {
+    test_private_bus_method_call
+};
+
+static
+void
+test_private_bus_register(
+    GDBusConnection* client)
+{
+    GDBusNodeInfo* info = g_dbus_node_info_new_for_xml(test_private_bus_xml,
+        NULL);
+
+    g_assert(g_dbus_connection_register_object(client,
+        "/org/freedesktop/DBus", info->interfaces[0],
+        &test_private_bus_vtable, NULL, NULL, NULL));
+    g_dbus_node_info_unref(info);
+}
+
+static
+void
+test_private_connection_subscribe_events_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GError* error = NULL;
+
+    /* Not available over the private connection either */
+    g_assert(!g_dbus_connection_call_with_unix_fd_list_finish
+        (G_DBUS_CONNECTION(object), NULL, result, &error));
+    g_assert(g_error_matches(error, DBUS_SERVICE_ERROR,
+        DBUS_SERVICE_ERROR_NOT_SUPPORTED));
+    g_error_free(error);
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_private_connection_request_mode_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GError* error = NULL;
+
+    /* Not available over the private connection */
+    g_assert(!g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+       result, &error));
+    g_assert(g_error_matches(error, DBUS_SERVICE_ERROR,
+        DBUS_SERVICE_ERROR_NOT_SUPPORTED));
+    g_error_free(error);
+
+    g_dbus_connection_call_with_unix_fd_list(test->private_client, NULL,
+        NFC_DAEMON_PATH, NFC_DAEMON_INTERFACE, "SubscribeEvents",
+        g_variant_new("(t)", (guint64)0), G_VARIANT_TYPE("(ht)"),
+        G_DBUS_CALL_FLAGS_NONE, TEST_DBUS_TIMEOUT, NULL, NULL,
+        test_private_connection_subscribe_events_done, test);
+}
+
+static
+void
+test_private_connection_get_all_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    gint version = 0;
+    gchar** adapters = NULL;
+    GError* error = NULL;
+    GVariant* var = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+        result, &error);
+
+    g_assert(var);
+    g_variant_get(var, "(i^ao)", &version, &adapters);
+    GDEBUG("version=%d, %u adapter", version, g_strv_length(adapters));
+    g_assert(g_strv_length(adapters) == 1);
+    g_variant_unref(var);
+    g_strfreev(adapters);
+
+    g_dbus_connection_call(test->private_client, NULL, NFC_DAEMON_PATH,
+        NFC_DAEMON_INTERFACE, "RequestMode", g_variant_new("(uu)", 0, 0),
+        NULL, G_DBUS_CALL_FLAGS_NONE, TEST_DBUS_TIMEOUT, NULL,
+        test_private_connection_request_mode_done, test);
+}
+
+static
+void
+test_private_connection_connected(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GError* error = NULL;
+
+    test->private_client = g_dbus_connection_new_finish(result, &error);
+    g_assert(test->private_client);
+    g_dbus_connection_call(test->private_client, NULL, NFC_DAEMON_PATH,
+        NFC_DAEMON_INTERFACE, "GetAll", NULL, NULL, G_DBUS_CALL_FLAGS_NONE,
+        TEST_DBUS_TIMEOUT, NULL, test_private_connection_get_all_done, test);
+}
+
+static
+void
+test_private_connection_opened(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GUnixFDList* fdl = NULL;
+    GError* error = NULL;
+    GVariant* var = g_dbus_connection_call_with_unix_fd_list_finish
+        (G_DBUS_CONNECTION(object), &fdl, result, &error);
+    GSocket* sock;
+    GSocketConnection* stream;
+    gint32 idx = -1;
+    int fd;
+
+    g_assert(var);
+    g_assert(fdl);
+    g_variant_get(var, "(h)", &idx);
+    g_variant_unref(var);
+    fd = g_unix_fd_list_get(fdl, idx, NULL);
+    g_assert(fd >= 0);
+    g_object_unref(fdl);
+
+    sock = g_socket_new_from_fd(fd, NULL);
+    g_assert(sock);
+    stream = g_socket_connection_factory_create_connection(sock);
+    g_dbus_connection_new(G_IO_STREAM(stream), NULL,
+        G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT, NULL, NULL,
+        test->private_connected, test);
+    g_object_unref(stream);
+    g_object_unref(sock);
+}
+
+static
+void
+test_private_connection_open(
+    TestData* test,
+    GDBusConnection* client,
+    GAsyncReadyCallback connected)
+{
+    /* The private connection gets passed to the connected callback */
+    test->private_connected = connected;
+    g_dbus_connection_call_with_unix_fd_list(client, NULL, NFC_DAEMON_PATH,
+        NFC_DAEMON_INTERFACE, "OpenPrivateConnection", NULL,
+        G_VARIANT_TYPE("(h)"), G_DBUS_CALL_FLAGS_NONE, TEST_DBUS_TIMEOUT,
+        NULL, NULL, test_private_connection_opened, test);
+}
+
+static
+void
+test_private_connection_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestData* test = user_data;
+
+    test_private_bus_register(client);
+    test_private_connection_open(test, client,
+        test_private_connection_connected);
+}
+
+static
+void
+test_private_connection(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+
+    test_data_init(&test);
+    dbus = test_dbus_new2(test_start, test_private_connection_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+}
+
+/*==========================================================================*
+ * private_access
+ *==========================================================================*/
+
+#define TEST_PRIVATE_ACCESS_POLICY "1;Transceive()=deny"
+#define NFC_TAG_INTERFACE "org.sailfishos.nfc.Tag"
+
+static char* test_private_access_tag_path;
+
+static
+void
+test_private_access_transceive(
+    TestData* test,
+    GDBusConnection* connection,
+    GAsyncReadyCallback callback)
+{
+    static const guint8 data[] = { 0x01, 0x02, 0x03 };
+
+    g_dbus_connection_call(connection, NULL, test_private_access_tag_path,
+        NFC_TAG_INTERFACE, "Transceive", g_variant_new("(@ay)",
+        g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, data,
+        sizeof(data), 1)), NULL, G_DBUS_CALL_FLAGS_NONE,
+        TEST_DBUS_TIMEOUT, NULL, callback, test);
+}
+
+static
+void
+test_private_access_check_denied(
+    GObject* object,
+    GAsyncResult* result)
+{
+    GError* error = NULL;
+
+    g_assert(!g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+       result, &error));
+    g_assert(g_error_matches(error, DBUS_SERVICE_ERROR,
+        DBUS_SERVICE_ERROR_ACCESS_DENIED));
+    g_error_free(error);
+}
+
+static
+void
+test_private_access_private_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+
+    /* Still denied over the private connection */
+    test_private_access_check_denied(object, result);
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_private_access_connected(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GError* error = NULL;
+
+    test->private_client = g_dbus_connection_new_finish(result, &error);
+    g_assert(test->private_client);
+    test_private_access_transceive(test, test->private_client,
+        test_private_access_private_done);
+}
+
+static
+void
+test_private_access_bus_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+
+    /* Denied on the bus */
+    test_private_access_check_denied(object, result);
+    test_private_connection_open(test, test->client,
+        test_private_access_connected);
+}
+
+static
+void
+test_private_access_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestData* test = user_data;
+
+    g_assert(nfc_config_set_value(NFC_CONFIGURABLE
+        (test_dbus_service_plugin(test)), "AccessPolicy",
+        g_variant_new_string(TEST_PRIVATE_ACCESS_POLICY)));
+    test_private_bus_register(client);
+    test_private_access_transceive(test, client,
+        test_private_access_bus_done);
+}
+
+static
+void
+test_private_access(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+    NfcTarget* target;
+    NfcParamPoll poll;
+
+    test_data_init(&test);
+    target = test_target_new(FALSE);
+    memset(&poll, 0, sizeof(poll));
+    g_assert(nfc_adapter_add_other_tag2(test.adapter, target, &poll));
+    nfc_target_unref(target);
+    test_private_access_tag_path = g_strconcat("/", test.adapter->name,
+        "/", test.adapter->tags[0]->name, NULL);
+
+    dbus = test_dbus_new2(test_start, test_private_access_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+    g_free(test_private_access_tag_path);
+    test_private_access_tag_path = NULL;
+}
+
+/*==========================================================================*
+ * subscribe_events
+ *==========================================================================*/
+
+static
+int
+test_subscribe_events_fd(
+    GObject* object,
+    GAsyncResult* result,
+    guint64* seq)
+{
+    GUnixFDList* fdl = NULL;
+    GError* error = NULL;
+    GVariant* var = g_dbus_connection_call_with_unix_fd_list_finish
+        (G_DBUS_CONNECTION(object), &fdl, result, &error);
+    gint32 idx = -1;
+    int fd;
+
+    g_assert(var);
+    g_assert(fdl);
+    g_variant_get(var, "(ht)", &idx, seq);
+    g_variant_unref(var);
+    fd = g_unix_fd_list_get(fdl, idx, NULL);
+    g_assert(fd >= 0);
+    g_object_unref(fdl);
+    return fd;
+}
+
+static
+guint64
+test_subscribe_events_find(
+    TestData* test,
+    int fd,
+    DBUS_SERVICE_EVENT type)
+{
+    union {
+        DBusServiceEventHeader header;
+        guint8 bytes[256];
+    } buf;
+    char* path = g_strconcat("/", test->adapter->name, NULL);
+    guint64 last_seq = 0;
+    ssize_t n;
+
+    /* Events have been delivered synchronously */
+    while ((n = recv(fd, &buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        const DBusServiceEventHeader* event = &buf.header;
+
+        GDEBUG("Event %u seq %" G_GUINT64_FORMAT " %s", event->type,
+            event->seq, (char*)(event + 1));
+        g_assert_cmpuint(event->size, == ,n);
+        g_assert_cmpuint(event->seq, > ,last_seq);
+        last_seq = event->seq;
+        if (event->type == type) {
+            g_assert_cmpstr((char*)(event + 1), == ,path);
+            g_free(path);
+            return event->seq;
+        }
+    }
+    g_assert_not_reached();
+    return 0;
+}
+
+static
+void
+test_subscribe_events_replay_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    guint64 seq = 0;
+    int fd = test_subscribe_events_fd(object, result, &seq);
+
+    /* The event is replayed */
+    g_assert_cmpuint(test_subscribe_events_find(test, fd,
+        DBUS_SERVICE_EVENT_ADAPTER_REMOVED), <= ,seq);
+    close(fd);
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_subscribe_events_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    guint64 seq = 0;
+    int fd = test_subscribe_events_fd(object, result, &seq);
+
+    /* Nothing has happened yet */
+    g_assert_cmpuint(seq, == ,0);
+    nfc_manager_remove_adapter(test->manager, test->adapter->name);
+    g_assert_cmpuint(test_subscribe_events_find(test, fd,
+        DBUS_SERVICE_EVENT_ADAPTER_REMOVED), > ,seq);
+    close(fd);
+
+    /* Subscribe again, from the very beginning */
+    g_dbus_connection_call_with_unix_fd_list(test->client, NULL,
+        NFC_DAEMON_PATH, NFC_DAEMON_INTERFACE, "SubscribeEvents",
+        g_variant_new("(t)", (guint64)0), G_VARIANT_TYPE("(ht)"),
+        G_DBUS_CALL_FLAGS_NONE, TEST_DBUS_TIMEOUT, NULL, NULL,
+        test_subscribe_events_replay_done, test);
+}
+
+static
+void
+test_subscribe_events_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    g_dbus_connection_call_with_unix_fd_list(client, NULL, NFC_DAEMON_PATH,
+        NFC_DAEMON_INTERFACE, "SubscribeEvents",
+        g_variant_new("(t)", (guint64)0), G_VARIANT_TYPE("(ht)"),
+        G_DBUS_CALL_FLAGS_NONE, TEST_DBUS_TIMEOUT, NULL, NULL,
+        test_subscribe_events_done, user_data);
+}
+
+static
+void
+test_subscribe_events(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+
+    test_data_init(&test);
+    dbus = test_dbus_new2(test_start, test_subscribe_events_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+}
+
+/*==========================================================================*
+ * state
+ *==========================================================================*/
+
+#define TMP_DIR_TEMPLATE "test_XXXXXX"
+
+static const char test_state_path[] = "/state";
+static const char test_state_other_client[] = ":1.1";
+static const char test_state_gone_client[] = ":1.2";
+static guint test_state_mode_id;
+static guint test_state_name_checks;
+
+#define TEST_STATE_SAP (20)
+
+static
+void
+test_state_release_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GVariant* ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+       result, NULL);
+
+    /* The restored request is gone */
+    g_assert(ret);
+    g_variant_unref(ret);
+    g_assert(test->manager->mode & NFC_MODE_READER_WRITER);
+
+    /* The other clients haven't been restored */
+    g_assert_cmpint(test_name_watch_count(), == ,1);
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_state_register_fail(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GError* error = NULL;
+
+    /* The service has been restored */
+    g_assert(!g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+       result, &error));
+    g_assert(g_error_matches(error, DBUS_SERVICE_ERROR,
+        DBUS_SERVICE_ERROR_ALREADY_EXISTS));
+    g_error_free(error);
+
+    /* At the same SAP */
+    g_assert(test->manager->services[0]);
+    g_assert(!test->manager->services[1]);
+    g_assert_cmpuint(test->manager->services[0]->sap, == ,TEST_STATE_SAP);
+
+    /* And so has the mode request, with the same id */
+    g_assert(!(test->manager->mode & NFC_MODE_READER_WRITER));
+    test_call(test, "ReleaseMode", g_variant_new("(u)", test_state_mode_id),
+        test_state_release_done);
+}
+
+static const char test_state_bus_xml[] =
+    "<node>"
+    "  <interface name='org.freedesktop.DBus'>"
+    "    <method name='NameHasOwner'>"
+    "      <arg name='name' type='s' direction='in'/>"
+    "      <arg name='has_owner' type='b' direction='out'/>"
+    "    </method>"
+    "  </interface>"
+    "</node>";
+
+static
+void
+test_state_bus_method_call(
+    GDBusConnection* connection,
+    const char* sender,
+    const char* path,
+    const char* iface,
+    const char* method,
+    GVariant* args,
+    GDBusMethodInvocation* call,
+    gpointer test)
+{
+    const char* name = NULL;
+
+    /* Pretend to be the bus daemon */
+    g_assert_cmpstr(method, == ,"NameHasOwner");
+    g_variant_get(args, "(&s)", &name);
+    GDEBUG("NameHasOwner %s", name);
+    g_dbus_method_invocation_return_value(call, g_variant_new("(b)",
+        strcmp(name, test_state_gone_client) != 0));
+
+    /* Continue when all three clients have been checked */
+    if (++test_state_name_checks == 3) {
+        test_call_register_local_service(test, test_state_path,
+            test_register_service_name, test_state_register_fail);
+    }
+}
+
+static const GDBusInterfaceVTable test_state_bus_vtable = {
+    test_state_bus_method_call
+};
+
+static
+void
+test_state_restore_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* test)
+{
+    GDBusNodeInfo* info = g_dbus_node_info_new_for_xml(test_state_bus_xml,
+        NULL);
+
+    /* The bus object must be there before the plugin starts */
+    g_assert(g_dbus_connection_register_object(client,
+        "/org/freedesktop/DBus", info->interfaces[0],
+        &test_state_bus_vtable, test, NULL, NULL));
+    g_dbus_node_info_unref(info);
+    test_state_name_checks = 0;
+    test_start(client, server, test);
+}
+
+static
+void
+test_state_edit(
+    const char* file)
+{
+    GKeyFile* state = g_key_file_new();
+    gchar** keys;
+    gchar** list;
+    gsize i, n = 0;
+    char* key;
+    static const gint mode[] = { NFC_MODE_NONE, NFC_MODE_P2P_INITIATOR, 0 };
+    static const char* const service[] = { "/other", "urn:nfc:sn:other" };
+
+    g_assert(g_key_file_load_from_file(state, file, 0, NULL));
+
+    /* Move the service to another SAP */
+    keys = g_key_file_get_keys(state, dbus_sender, NULL, NULL);
+    g_assert(keys);
+    for (i = 0; keys[i] && !g_str_has_prefix(keys[i], "Service."); i++);
+    g_assert(keys[i]);
+    list = g_key_file_get_string_list(state, dbus_sender, keys[i], &n, NULL);
+    g_assert(list);
+    g_assert(g_key_file_remove_key(state, dbus_sender, keys[i], NULL));
+    key = g_strdup_printf("Service.%u", TEST_STATE_SAP);
+    g_key_file_set_string_list(state, dbus_sender, key,
+        (const gchar* const*)list, n);
+    g_strfreev(list);
+    g_strfreev(keys);
+    g_free(key);
+
+    /* This one wants a SAP which it can't have (it's named) */
+    g_key_file_set_integer_list(state, test_state_other_client, "Mode.100",
+        (gint*)mode, G_N_ELEMENTS(mode));
+    g_key_file_set_string_list(state, test_state_other_client, "Service.40",
+        service, G_N_ELEMENTS(service));
+
+    /* And this one is gone */
+    g_key_file_set_integer_list(state, test_state_gone_client, "Mode.101",
+        (gint*)mode, G_N_ELEMENTS(mode));
+
+    g_assert(g_key_file_save_to_file(state, file, NULL));
+    g_key_file_unref(state);
+}
+
+static
+void
+test_state_register_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GVariant* ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+       result, NULL);
+
+    g_assert(ret);
+    g_variant_unref(ret);
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_state_request_done(
+    GObject* object,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    GVariant* ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object),
+       result, NULL);
+
+    g_assert(ret);
+    g_variant_get(ret, "(u)", &test_state_mode_id);
+    g_variant_unref(ret);
+    g_assert(test_state_mode_id);
+    g_assert(!(test->manager->mode & NFC_MODE_READER_WRITER));
+    test_call_register_local_service(test, test_state_path,
+        test_register_service_name, test_state_register_done);
+}
+
+static
+void
+test_state_save_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* test)
+{
+    test_call((TestData*)test, "RequestMode", g_variant_new("(uu)",
+        NFC_MODE_NONE, NFC_MODE_READER_WRITER), test_state_request_done);
+}
+
+static
+void
+test_state(
+    void)
+{
+    DBusServicePluginClass* klass = g_type_class_ref(DBUS_SERVICE_PLUGIN_TYPE);
+    const char* default_state_dir = klass->state_dir;
+    char* dir = g_dir_make_tmp(TMP_DIR_TEMPLATE, NULL);
+    char* file = g_build_filename(dir, "dbus-service", NULL);
+    TestData test;
+    TestDBus* dbus;
+
+    klass->state_dir = dir;
+
+    /* Written on exit at the latest */
+    test_data_init(&test);
+    dbus = test_dbus_new2(test_start, test_state_save_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+    g_assert(g_file_test(file, G_FILE_TEST_IS_REGULAR));
+    test_state_edit(file);
+
+    /* And restored on the next start */
+    test_data_init(&test);
+    dbus = test_dbus_new(test_state_restore_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+
+    klass->state_dir = default_state_dir;
+    g_type_class_unref(klass);
+    g_assert_cmpint(test_rmdir(dir), == ,0);
+    g_free(file);
+    g_free(dir);
+}
+
+/*==========================================================================*
+ * config
+ *==========================================================================*/
+
+#define TEST_ACCESS_POLICY_KEY "AccessPolicy"
+#define TEST_ACCESS_POLICY "1;group(privileged)=deny"
+
+static
+void
+test_config_changed(
+    NfcConfigurable* config,
+    const char* key,
+    GVariant* value,
+    void* user_data)
+{
+    int* count = user_data;
+
+    g_assert_cmpstr(key, == ,TEST_ACCESS_POLICY_KEY);
+    (*count)++;
+}
+
+static
+void
+test_config_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestData* test = user_data;
+    NfcConfigurable* config;
+    const char* const* keys;
+    GVariant* value;
+    gulong id;
+    int count = 0;
+
+    config = NFC_CONFIGURABLE(test_dbus_service_plugin(test));
+    keys = nfc_config_get_keys(config);
+    g_assert(keys);
+    g_assert_cmpuint(gutil_strv_length((const GStrV*)keys), == ,1);
+    g_assert_cmpstr(keys[0], == ,TEST_ACCESS_POLICY_KEY);
+    id = nfc_config_add_change_handler(config, TEST_ACCESS_POLICY_KEY,
+        test_config_changed, &count);
+    g_assert(id);
+
+    /* Default policy */
+    g_assert(!nfc_config_get_value(config, TEST_ACCESS_POLICY_KEY));
+    g_assert(!nfc_config_get_value(config, "foo"));
+
+    /* Invalid key and value type */
+    g_assert(!nfc_config_set_value(config, "foo", NULL));
+    g_assert(!nfc_config_set_value(config, TEST_ACCESS_POLICY_KEY,
+        g_variant_new_int32(1)));
+    g_assert(nfc_config_set_value(config, TEST_ACCESS_POLICY_KEY, NULL));
+    g_assert_cmpint(count, == ,0);
+
+    /* Replace the policy (twice but the change is signaled once) */
+    g_assert(nfc_config_set_value(config, TEST_ACCESS_POLICY_KEY,
+        g_variant_new_string(TEST_ACCESS_POLICY)));
+    g_assert(nfc_config_set_value(config, TEST_ACCESS_POLICY_KEY,
+        g_variant_new_string(TEST_ACCESS_POLICY)));
+    g_assert_cmpint(count, == ,1);
+    value = nfc_config_get_value(config, TEST_ACCESS_POLICY_KEY);
+    g_assert(value);
+    g_assert_cmpstr(g_variant_get_string(value, NULL), == ,
+        TEST_ACCESS_POLICY);
+    g_variant_unref(value);
+
+    /* And back to default */
+    g_assert(nfc_config_set_value(config, TEST_ACCESS_POLICY_KEY, NULL));
+    g_assert_cmpint(count, == ,2);
+    g_assert(!nfc_config_get_value(config, TEST_ACCESS_POLICY_KEY));
+
+    nfc_config_remove_handler(config, id);
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_config(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+
+    test_data_init(&test);
+    dbus = test_dbus_new2(test_start, test_config_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+}
+
 /*==========================================================================*
  * Common
  *==========================================================================*/
@@ -805,8 +1926,15 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("get_daemon_version"), test_get_daemon_version);
     g_test_add_func(TEST_("register_service"), test_register_service);
     g_test_add_func(TEST_("unregister_service_error"), test_unregister_svc_err);
+    g_test_add_func(TEST_("publish_ndef"), test_publish_ndef);
     g_test_add_func(TEST_("adapter_added"), test_adapter_added);
     g_test_add_func(TEST_("adapter_removed"), test_adapter_removed);
+    g_test_add_func(TEST_("object_manager"), test_object_manager);
+    g_test_add_func(TEST_("private_connection"), test_private_connection);
+    g_test_add_func(TEST_("private_access"), test_private_access);
+    g_test_add_func(TEST_("subscribe_events"), test_subscribe_events);
+    g_test_add_func(TEST_("state"), test_state);
+    g_test_add_func(TEST_("config"), test_config);
     test_init(&test_opt, argc, argv);
     return g_test_run();
 }
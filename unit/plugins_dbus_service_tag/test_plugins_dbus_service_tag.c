@@ -1744,6 +1744,202 @@ test_lock_fail(
     test_dbus_free(dbus);
 }
 
+/*==========================================================================*
+ * lock_lease
+ *==========================================================================*/
+
+typedef struct test_lock_lease_data {
+    TestData test;
+    NfcTargetSequence* seq;
+} TestLockLeaseData;
+
+static
+void
+test_lock_lease_done(
+    GObject* connection,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+
+    /* The lock is gone, there's nothing to release */
+    test_complete_error(connection, result, DBUS_SERVICE_ERROR_NOT_FOUND);
+    GDEBUG("Nothing to release, good!");
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_lock_lease_lost(
+    GDBusConnection* connection,
+    const char* sender,
+    const char* path,
+    const char* iface,
+    const char* name,
+    GVariant* args,
+    gpointer user_data)
+{
+    TestLockLeaseData* data = user_data;
+    TestData* test = &data->test;
+    guint flags = 0;
+
+    g_variant_get(args, "(u)", &flags);
+    GDEBUG("Lock lost, flags 0x%02x", flags);
+    g_assert_cmpuint(flags, == , 0);
+
+    /* The waiting sequence has taken over */
+    g_assert(test->adapter->tags[0]->target->sequence == data->seq);
+    test_call_release(test, test_lock_lease_done);
+}
+
+static
+void
+test_lock_lease_locked(
+    GObject* connection,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestLockLeaseData* data = user_data;
+    TestData* test = &data->test;
+    NfcTarget* target = test->adapter->tags[0]->target;
+
+    test_complete_ok(connection, result);
+    GDEBUG("Lock acquired");
+    g_assert(g_dbus_connection_signal_subscribe(test->connection, NULL,
+        NFC_TAG_INTERFACE, "LockLost", test_tag_path(test,
+        test->adapter->tags[0]), NULL, G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
+        test_lock_lease_lost, data, NULL));
+
+    /* Someone else wants the target, the idle lease will expire */
+    g_assert((data->seq = nfc_target_sequence_new(target)) != NULL);
+    g_assert(target->sequence != data->seq);
+}
+
+static
+void
+test_lock_lease_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestLockLeaseData* data = user_data;
+    TestData* test = &data->test;
+
+    test_sender = test_sender_1;
+    test->service = dbus_service_adapter_new(test->adapter, server);
+    g_assert(test->service);
+    g_object_ref(test->connection = client);
+    g_dbus_connection_call(test->connection, NULL,
+        test_tag_path(test, test->adapter->tags[0]), NFC_TAG_INTERFACE,
+        "AcquireLease", g_variant_new("(bbuu)", TRUE, FALSE, 100, 0), NULL,
+        G_DBUS_CALL_FLAGS_NONE, TEST_DBUS_TIMEOUT, NULL,
+        test_lock_lease_locked, data);
+}
+
+static
+void
+test_lock_lease(
+    void)
+{
+    TestLockLeaseData data;
+    TestDBus* dbus;
+
+    memset(&data, 0, sizeof(data));
+    test_data_init(&data.test);
+    dbus = test_dbus_new(test_lock_lease_start, &data);
+    test_run(&test_opt, data.test.loop);
+    g_assert(data.seq);
+    nfc_target_sequence_unref(data.seq);
+    test_data_cleanup(&data.test);
+    test_dbus_free(dbus);
+}
+
+/*==========================================================================*
+ * lock_no_lease
+ *==========================================================================*/
+
+static
+void
+test_lock_no_lease_done(
+    GObject* connection,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestLockLeaseData* data = user_data;
+    TestData* test = &data->test;
+
+    /* Released, now the waiting sequence gets its turn */
+    test_complete_ok(connection, result);
+    g_assert(test->adapter->tags[0]->target->sequence == data->seq);
+    test_quit_later(test->loop);
+}
+
+static
+gboolean
+test_lock_no_lease_check(
+    gpointer user_data)
+{
+    TestLockLeaseData* data = user_data;
+    TestData* test = &data->test;
+
+    /* Plain Acquire has no lease, the lock is still there */
+    g_assert(test->adapter->tags[0]->target->sequence != data->seq);
+    test_call_release(test, test_lock_no_lease_done);
+    return G_SOURCE_REMOVE;
+}
+
+static
+void
+test_lock_no_lease_locked(
+    GObject* connection,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestLockLeaseData* data = user_data;
+    TestData* test = &data->test;
+    NfcTarget* target = test->adapter->tags[0]->target;
+
+    test_complete_ok(connection, result);
+    g_assert((data->seq = nfc_target_sequence_new(target)) != NULL);
+    g_assert(target->sequence != data->seq);
+    g_timeout_add(200, test_lock_no_lease_check, data);
+}
+
+static
+void
+test_lock_no_lease_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestLockLeaseData* data = user_data;
+    TestData* test = &data->test;
+
+    test_sender = test_sender_1;
+    test->service = dbus_service_adapter_new(test->adapter, server);
+    g_assert(test->service);
+    g_object_ref(test->connection = client);
+    test_call_acquire(test, TRUE, test_lock_no_lease_locked);
+}
+
+static
+void
+test_lock_no_lease(
+    void)
+{
+    TestLockLeaseData data;
+    TestDBus* dbus;
+
+    memset(&data, 0, sizeof(data));
+    test_data_init(&data.test);
+    dbus = test_dbus_new(test_lock_no_lease_start, &data);
+    test_run(&test_opt, data.test.loop);
+    g_assert(data.seq);
+    nfc_target_sequence_unref(data.seq);
+    test_data_cleanup(&data.test);
+    test_dbus_free(dbus);
+}
+
 /*==========================================================================*
  * get_all3
  *==========================================================================*/
@@ -2343,6 +2539,8 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("lock_drop_wait"), test_lock_drop_wait);
     g_test_add_func(TEST_("lock_release_wait"), test_lock_release_wait);
     g_test_add_func(TEST_("lock_fail"), test_lock_fail);
+    g_test_add_func(TEST_("lock_lease"), test_lock_lease);
+    g_test_add_func(TEST_("lock_no_lease"), test_lock_no_lease);
     g_test_add_func(TEST_("get_all3"), test_get_all3);
     g_test_add_func(TEST_("get_poll_parameters"), test_get_poll_parameters);
     g_test_add_func(TEST_("get_all3_tag_b"), test_get_all3_tag_b);
@@ -287,6 +287,23 @@ test_call_write_data(
         G_DBUS_CALL_FLAGS_NONE, TEST_DBUS_TIMEOUT, NULL, callback, test);
 }
 
+static
+void
+test_call_write_data2(
+    TestData* test,
+    guint offset,
+    const void* data,
+    guint size,
+    guint flags,
+    GAsyncReadyCallback callback)
+{
+    g_assert(test->connection);
+    g_dbus_connection_call(test->connection, NULL, test_tag_path(test),
+        NFC_TAG_T2_INTERFACE, "WriteData2", g_variant_new("(u@ayu)", offset,
+        dbus_service_dup_byte_array_as_variant(data, size), flags), NULL,
+        G_DBUS_CALL_FLAGS_NONE, TEST_DBUS_TIMEOUT, NULL, callback, test);
+}
+
 static
 void
 test_start_and_call(
@@ -1259,6 +1276,170 @@ test_write_data_txfail(
     test_dbus_free(dbus);
 }
 
+/*==========================================================================*
+ * write_data2/verify
+ *==========================================================================*/
+
+static
+void
+test_write_data2_verify_done(
+    GObject* conn,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    guint written = 0, status = 0;
+    GVariant* var = g_dbus_connection_call_finish(G_DBUS_CONNECTION(conn),
+        result, NULL);
+
+    g_assert(var);
+    g_variant_get(var, "(uu)", &written, &status);
+    GDEBUG("written=%u status=%u", written, status);
+    g_assert_cmpuint(written, == ,sizeof(test_write_data));
+    g_assert_cmpuint(status, == ,0);
+    g_variant_unref(var);
+
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_write_data2_verify_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestData* test = user_data;
+
+    g_object_ref(test->connection = client);
+    test->service = dbus_service_adapter_new(test->adapter, server);
+    g_assert(test->service);
+    test_call_write_data2(test, 0, TEST_ARRAY_AND_SIZE(test_write_data),
+        NFC_TAG_T2_WRITE_FLAG_VERIFY, test_write_data2_verify_done);
+}
+
+static
+void
+test_write_data2_verify(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+
+    test_data_init(&test);
+    dbus = test_dbus_new(test_write_data2_verify_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+}
+
+/*==========================================================================*
+ * write_data2/lost
+ *==========================================================================*/
+
+static
+void
+test_write_data2_lost_done(
+    GObject* conn,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestData* test = user_data;
+    guint written = 0, status = 0;
+    GVariant* var = g_dbus_connection_call_finish(G_DBUS_CONNECTION(conn),
+        result, NULL);
+
+    /* Everything has been sent but doesn't read back the same */
+    g_assert(var);
+    g_variant_get(var, "(uu)", &written, &status);
+    GDEBUG("written=%u status=%u", written, status);
+    g_assert_cmpuint(written, == ,sizeof(test_write_data));
+    g_assert_cmpuint(status, == ,2);
+    g_variant_unref(var);
+
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_write_data2_lost_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestData* test = user_data;
+
+    g_object_ref(test->connection = client);
+    test->service = dbus_service_adapter_new(test->adapter, server);
+    g_assert(test->service);
+    test_call_write_data2(test, 0, TEST_ARRAY_AND_SIZE(test_write_data),
+        NFC_TAG_T2_WRITE_FLAG_VERIFY, test_write_data2_lost_done);
+}
+
+static
+void
+test_write_data2_lost(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+    TestTargetT2Error error;
+
+    test_data_init(&test);
+
+    /* The first data block is ACKed but not written */
+    memset(&error, 0, sizeof(error));
+    error.block = TEST_TARGET_T2_FIRST_DATA_BLOCK;
+    error.type = TEST_TARGET_T2_ERROR_LOST_WRITE;
+    test.target->write_error = &error;
+
+    dbus = test_dbus_new(test_write_data2_lost_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+}
+
+/*==========================================================================*
+ * write_data2/noverify
+ *==========================================================================*/
+
+static
+void
+test_write_data2_noverify_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    TestData* test = user_data;
+    static const TestTargetT2Error error = {
+        TEST_TARGET_T2_ERROR_TRANSMIT, TEST_TARGET_T2_FIRST_DATA_BLOCK
+    };
+
+    g_object_ref(test->connection = client);
+    test->service = dbus_service_adapter_new(test->adapter, server);
+    g_assert(test->service);
+
+    /* The data gets written but can't be read back */
+    test->target->read_error = &error;
+    test_call_write_data2(test, 0, TEST_ARRAY_AND_SIZE(test_write_data),
+        NFC_TAG_T2_WRITE_FLAG_VERIFY, test_write_data2_lost_done);
+}
+
+static
+void
+test_write_data2_noverify(
+    void)
+{
+    TestData test;
+    TestDBus* dbus;
+
+    test_data_init(&test);
+    dbus = test_dbus_new(test_write_data2_noverify_start, &test);
+    test_run(&test_opt, test.loop);
+    test_data_cleanup(&test);
+    test_dbus_free(dbus);
+}
+
 /*==========================================================================*
  * Common
  *==========================================================================*/
@@ -1292,6 +1473,9 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("write_data/ok"), test_write_data_ok);
     g_test_add_func(TEST_("write_data/ioerr"), test_write_data_ioerr);
     g_test_add_func(TEST_("write_data/txfail"), test_write_data_txfail);
+    g_test_add_func(TEST_("write_data2/verify"), test_write_data2_verify);
+    g_test_add_func(TEST_("write_data2/lost"), test_write_data2_lost);
+    g_test_add_func(TEST_("write_data2/noverify"), test_write_data2_noverify);
     g_test_init(&argc, &argv, NULL);
     test_init(&test_opt, argc, argv);
     return g_test_run();
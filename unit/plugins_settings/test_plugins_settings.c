@@ -53,6 +53,8 @@ static DA_ACCESS test_access = DA_ACCESS_ALLOW;
 #include <gutil_idlepool.h>
 
 #include "test_common.h"
+#include "test_adapter.h"
+#include "test_target.h"
 #include "test_dbus.h"
 
 #define TMP_DIR_TEMPLATE                 "test_XXXXXX"
@@ -66,6 +68,8 @@ static DA_ACCESS test_access = DA_ACCESS_ALLOW;
 #define SETTINGS_GROUP                   "Settings"
 #define SETTINGS_KEY_ENABLED             "Enabled"
 #define SETTINGS_KEY_ALWAYS_ON           "AlwaysOn"
+#define SETTINGS_KEY_TAG_READ_POLICY     "TagReadPolicy"
+#define SETTINGS_KEY_TAG_FILTERS         "TagFilters"
 
 #define SETTINGS_DBUS_PATH               "/"
 #define SETTINGS_DBUS_INTERFACE          "org.sailfishos.nfc.Settings"
@@ -1117,6 +1121,16 @@ da_policy_new_full(
     return policy;
 }
 
+DAPolicy*
+da_policy_ref(
+    DAPolicy* policy)
+{
+    if (policy) {
+        g_atomic_int_inc(&policy->refcount);
+    }
+    return policy;
+}
+
 void
 da_policy_unref(
     DAPolicy* policy)
@@ -1308,6 +1322,7 @@ test_defaults_override_start(
 
     /* Verify the state */
     g_assert(test->manager->enabled);
+    g_assert_cmpint(test->manager->tag_read_policy, == ,NFC_TAG_READ_FULL);
     test_call_get_plugin_value(test, client, TEST_PLUGIN_NAME, TEST_PLUGIN_KEY,
         test_defaults_override_done);
 }
@@ -1325,12 +1340,17 @@ test_defaults_override_prestart(
     static const char defaults[] =
         "[" SETTINGS_GROUP "]\n"
         SETTINGS_KEY_ENABLED "=false\n"
+        SETTINGS_KEY_TAG_READ_POLICY "=none\n"
         "[" TEST_PLUGIN_NAME "]\n"
         TEST_PLUGIN_KEY "='foo'\n"
         "invalid-key=false\n";
     static const char override[] =
         "[" SETTINGS_GROUP "]\n"
         SETTINGS_KEY_ENABLED "=true\n"
+        SETTINGS_KEY_TAG_READ_POLICY "=Full\n"
+        SETTINGS_KEY_TAG_FILTERS "=accept:uid=04A1,sak=00/FF;"
+        "stub:technology=AB,protocol=T2;skip:sak=08;;skip:foo=bar;"
+        "skip:uid=xx;skip:sak=0;drop\n"
         "[" TEST_PLUGIN_NAME "]\n"
         TEST_PLUGIN_KEY "='bar'\n"
         "[whatever]\n"
@@ -1385,6 +1405,7 @@ test_defaults_no_override_start(
 
     /* Verify the state */
     g_assert(!test->manager->enabled);
+    g_assert_cmpint(test->manager->tag_read_policy, == ,NFC_TAG_READ_NDEF);
     test_call_get_plugin_value(test, client, TEST_PLUGIN_NAME, TEST_PLUGIN_KEY,
         test_defaults_no_override_done);
 }
@@ -1436,6 +1457,97 @@ test_defaults_no_override(
         test_defaults_no_override_start);
 }
 
+/*==========================================================================*
+ * tag_filters
+ *==========================================================================*/
+
+static
+NfcTag*
+test_tag_filters_add(
+    NfcAdapter* adapter,
+    NFC_PROTOCOL protocol,
+    const guint8* uid,
+    guint8 sak)
+{
+    NfcTarget* target = test_target_new_tech(NFC_TECHNOLOGY_A, FALSE);
+    NfcParamPoll poll;
+    NfcTag* tag;
+
+    memset(&poll, 0, sizeof(poll));
+    poll.a.sel_res = sak;
+    poll.a.nfcid1.bytes = uid;
+    poll.a.nfcid1.size = 4;
+    target->protocol = protocol;
+    tag = nfc_adapter_add_other_tag2(adapter, target, &poll);
+    nfc_target_unref(target);
+    return tag;
+}
+
+static
+void
+test_tag_filters_start(
+    GDBusConnection* client,
+    GDBusConnection* server,
+    void* user_data)
+{
+    static const guint8 uid_a1[] = { 0x04, 0xa1, 0x02, 0x03 };
+    static const guint8 uid_b0[] = { 0x04, 0xb0, 0x02, 0x03 };
+    TestData* test = user_data;
+    NfcAdapter* adapter = test_adapter_new();
+    NfcTag* tag;
+
+    /* The adapter picks up the filters from the manager */
+    g_assert(nfc_manager_add_adapter(test->manager, adapter));
+
+    /* accept:uid=04A1,sak=00/FF */
+    tag = test_tag_filters_add(adapter, NFC_PROTOCOL_T2_TAG, uid_a1, 0x00);
+    g_assert(tag);
+    g_assert(tag->name);
+    g_assert(adapter->tags[0] == tag);
+
+    /* SAK doesn't match the first one, stub:technology=AB,protocol=T2 */
+    tag = test_tag_filters_add(adapter, NFC_PROTOCOL_T2_TAG, uid_a1, 0x20);
+    g_assert(tag);
+    g_assert(!tag->name);
+
+    /* Neither does UID prefix */
+    tag = test_tag_filters_add(adapter, NFC_PROTOCOL_T2_TAG, uid_b0, 0x00);
+    g_assert(tag);
+    g_assert(!tag->name);
+
+    /* skip:sak=08/0F */
+    g_assert(!test_tag_filters_add(adapter, NFC_PROTOCOL_T4A_TAG,
+        uid_b0, 0x18));
+
+    /*
+     * Nothing matches, the tag is accepted. It would have been skipped
+     * if any of the invalid entries had turned into a filter matching
+     * everything, or SAK 00 for that matter.
+     */
+    tag = test_tag_filters_add(adapter, NFC_PROTOCOL_T4A_TAG, uid_b0, 0x00);
+    g_assert(tag);
+    g_assert(tag->name);
+    g_assert(adapter->tags[0]);
+    g_assert(adapter->tags[1] == tag);
+    g_assert(!adapter->tags[2]);
+
+    nfc_manager_remove_adapter(test->manager, adapter->name);
+    nfc_adapter_unref(adapter);
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_tag_filters(
+    void)
+{
+    test_normal2("[" SETTINGS_GROUP "]\n"
+        SETTINGS_KEY_TAG_FILTERS "=accept:uid=04A1,sak=00/FF;"
+        "stub:technology=AB,protocol=T2;skip:sak=08/0F;;skip:foo=bar;"
+        "skip:uid=xx;skip:sak=0;skip:uid;drop\n",
+        test_tag_filters_start);
+}
+
 /*==========================================================================*
  * config/load
  *==========================================================================*/
@@ -2664,6 +2776,7 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("defaults/load"), test_defaults_load);
     g_test_add_func(TEST_("defaults/override"), test_defaults_override);
     g_test_add_func(TEST_("defaults/no_override"), test_defaults_no_override);
+    g_test_add_func(TEST_("tag_filters"), test_tag_filters);
     g_test_add_func(TEST_("config/load"), test_config_load);
     g_test_add_func(TEST_("config/save"), test_config_save);
     g_test_add_func(TEST_("migrate"), test_migrate);